@@ -5,16 +5,43 @@
 #include "CommandLine.h"
 #include "FileSystem.h"
 
+#include <HashUtils.h>
+#include <ParallelUtils.h>
+
 // Constants
 const wchar_t * PARAM_OUTFILE = L"-o";
 const wchar_t * PARAM_TMPDIR = L"-temp-directory";
 const wchar_t * PARAM_LOD = L"-lod";
 const wchar_t * PARAM_SCREENCOVERAGE = L"-screen-coverage";
+const wchar_t * PARAM_GENERATELODS = L"-generate-lods";
+const wchar_t * PARAM_FLATTENSCENES = L"-flatten-scenes";
+const wchar_t * PARAM_OPTIMIZEMESHES = L"-optimize-meshes";
+const wchar_t * PARAM_QUANTIZEMESHES = L"-quantize-meshes";
+const wchar_t * PARAM_COMPRESSMESHES = L"-compress-meshes";
 const wchar_t * PARAM_MAXTEXTURESIZE = L"-max-texture-size";
+const wchar_t * PARAM_ATLASTEXTURES = L"-atlas-textures";
+const wchar_t * PARAM_MAXPARALLELISM = L"-max-parallelism";
+const wchar_t * PARAM_TEXTURECACHE = L"-texture-cache";
+const wchar_t * PARAM_TEXTUREQUALITY = L"-texture-quality";
+const wchar_t * PARAM_TEXTURETILEROWS = L"-texture-tile-rows";
+const wchar_t * PARAM_INCREMENTAL = L"-incremental";
+const wchar_t * PARAM_BATCH = L"-batch";
+const wchar_t * PARAM_MAXIMAGESINFLIGHT = L"-max-images-in-flight";
+const wchar_t * PARAM_PROFILE = L"-profile";
+const wchar_t * PARAM_TRACE = L"-trace";
 const wchar_t * SUFFIX_CONVERTED = L"_converted";
+const wchar_t * MESHCOMPRESSION_REQUIRED = L"required";
+const wchar_t * MESHCOMPRESSION_FALLBACK = L"fallback";
+const wchar_t * TEXTUREQUALITY_FAST = L"fast";
+const wchar_t * TEXTUREQUALITY_BALANCED = L"balanced";
+const wchar_t * TEXTUREQUALITY_MAX = L"max";
 const wchar_t * CLI_INDENT = L"    ";
 const size_t MAXTEXTURESIZE_DEFAULT = 512;
 const size_t MAXTEXTURESIZE_MAX = 4096;
+const size_t ATLASTEXTURESIZE_DEFAULT = 0; // Textures are not atlased
+const size_t MAXPARALLELISM_DEFAULT = 0; // One worker per hardware thread
+const size_t TEXTURETILEROWS_DEFAULT = 0; // Textures are processed whole
+const Microsoft::glTF::Toolkit::TextureCompressionQuality TEXTUREQUALITY_DEFAULT = Microsoft::glTF::Toolkit::TextureCompressionQuality::Balanced;
 
 enum class CommandLineParsingState
 {
@@ -24,7 +51,17 @@ enum class CommandLineParsingState
     ReadTmpDir,
     ReadLods,
     ReadScreenCoverage,
-    ReadMaxTextureSize
+    ReadGenerateLods,
+    ReadMeshCompression,
+    ReadMaxTextureSize,
+    ReadAtlasTextures,
+    ReadMaxParallelism,
+    ReadTextureCache,
+    ReadTextureQuality,
+    ReadTextureTileRows,
+    ReadIncremental,
+    ReadProfile,
+    ReadTrace
 };
 
 void CommandLine::PrintHelp()
@@ -43,7 +80,20 @@ void CommandLine::PrintHelp()
         << indent << "[" << std::wstring(PARAM_TMPDIR) << L" <temporary folder, default is the system temp folder for the user>]" << std::endl
         << indent << "[" << std::wstring(PARAM_LOD) << " <path to each lower LOD asset in descending order of quality>]" << std::endl
         << indent << "[" << std::wstring(PARAM_SCREENCOVERAGE) << " <LOD screen coverage values>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_GENERATELODS) << " <fraction of the triangles kept in each generated LOD, defaults to the screen coverage ratios>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_FLATTENSCENES) << "] (bakes the transforms of static nodes into their meshes, and merges the primitives that share a material)" << std::endl
+        << indent << "[" << std::wstring(PARAM_OPTIMIZEMESHES) << "] (reorders triangles and vertices for the GPU vertex cache and to reduce overdraw)" << std::endl
+        << indent << "[" << std::wstring(PARAM_QUANTIZEMESHES) << "] (stores vertex attributes as integers with KHR_mesh_quantization, which the Windows MR home does not support)" << std::endl
+        << indent << "[" << std::wstring(PARAM_COMPRESSMESHES) << L" <" << MESHCOMPRESSION_REQUIRED << L" | " << MESHCOMPRESSION_FALLBACK << L">] (compresses vertex and index data with EXT_meshopt_compression, which the Windows MR home does not support; " << MESHCOMPRESSION_FALLBACK << L" also keeps the uncompressed data for other loaders)" << std::endl
         << indent << "[" << std::wstring(PARAM_MAXTEXTURESIZE) << " <Max texture size in pixels, defaults to 512>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_ATLASTEXTURES) << " <Max size in pixels of the textures gathered into atlases, so that the materials that use them are merged; disabled by default>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_MAXPARALLELISM) << " <Max number of textures or meshes processed at the same time, defaults to the number of processors>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_TEXTURECACHE) << L" <folder in which compressed textures are cached across runs, disabled by default>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_TEXTUREQUALITY) << L" <" << TEXTUREQUALITY_FAST << L" | " << TEXTUREQUALITY_BALANCED << L" | " << TEXTUREQUALITY_MAX << L">] (speed and quality of BC7 texture compression, defaults to " << TEXTUREQUALITY_BALANCED << L")" << std::endl
+        << indent << "[" << std::wstring(PARAM_TEXTURETILEROWS) << L" <rows of each texture decoded, packed and compressed at a time, to bound the memory used by very large textures; disabled by default>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_INCREMENTAL) << L" <folder in which intermediate files and a manifest of their inputs are kept, so that a later conversion only redoes the stages whose inputs changed>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_PROFILE) << L" <JSON file in which the time, memory and I/O of each conversion stage are written>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_TRACE) << L" <file in which the conversion stages are written in the Chrome trace format>]" << std::endl
         << std::endl
         << "Example:" << std::endl
         << indent << "WindowsMRAssetConverter FileToConvert.gltf "
@@ -56,13 +106,65 @@ void CommandLine::PrintHelp()
         << std::endl
         << "If the file is a GLB and the output name is not specified, defaults to the same name as input "
         << "+ \"_converted.glb\"." << std::endl
+        << std::endl
+        << L"Batch usage: WindowsMRAssetConverter " << std::wstring(PARAM_BATCH) << L" <path to a manifest file or a folder>" << std::endl
+        << std::endl
+        << "Converts many assets in one process. Each line of a manifest holds the arguments of one asset, starting with its path, "
+        << "and lines starting with # are ignored. For a folder, every GLTF and GLB file in it is converted." << std::endl
+        << std::endl
+        << L"Optional batch arguments, in addition to the arguments above, which apply to every asset:" << std::endl
+        << indent << "[" << std::wstring(PARAM_OUTFILE) << L" <output folder, default is the folder of each asset>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_TMPDIR) << L" <temporary folder, in which each asset gets a sub-folder>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_INCREMENTAL) << L" <incremental folder, in which each asset gets a sub-folder named after it>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_MAXPARALLELISM) << " <Max number of assets, and of textures or meshes of each asset, processed at the same time>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_MAXIMAGESINFLIGHT) << " <Max number of images decoded in memory at the same time across all assets, defaults to the max parallelism>]" << std::endl
+        << indent << "[" << std::wstring(PARAM_PROFILE) << L" and " << std::wstring(PARAM_TRACE) << L" record every asset of the batch in the same file]" << std::endl
         << std::endl;
 }
 
+// Splits a line of a batch manifest into arguments at white space, keeping quoted arguments together
+std::vector<std::wstring> SplitArguments(const std::wstring& line)
+{
+    std::vector<std::wstring> arguments;
+    std::wstring argument;
+    bool hasArgument = false;
+    bool inQuotes = false;
+
+    for (auto c : line)
+    {
+        if (c == L'"')
+        {
+            inQuotes = !inQuotes;
+            hasArgument = true;
+        }
+        else if (iswspace(c) && !inQuotes)
+        {
+            if (hasArgument)
+            {
+                arguments.push_back(argument);
+                argument.clear();
+                hasArgument = false;
+            }
+        }
+        else
+        {
+            argument += c;
+            hasArgument = true;
+        }
+    }
+
+    if (hasArgument)
+    {
+        arguments.push_back(argument);
+    }
+
+    return arguments;
+}
+
 void CommandLine::ParseCommandLineArguments(
     int argc, wchar_t *argv[],
     std::wstring& inputFilePath, AssetType& inputAssetType, std::wstring& outFilePath, std::wstring& tempDirectory,
-    std::vector<std::wstring>& lodFilePaths, std::vector<double>& screenCoveragePercentages, size_t& maxTextureSize)
+    std::vector<std::wstring>& lodFilePaths, std::vector<double>& screenCoveragePercentages, bool& generateLods, std::vector<double>& generatedLodRatios, bool& flattenScenes, bool& optimizeMeshes, bool& quantizeMeshes, Microsoft::glTF::Toolkit::MeshCompression& meshCompression, size_t& maxTextureSize, size_t& atlasTextureSize, size_t& maxParallelism, std::wstring& textureCacheDirectory, Microsoft::glTF::Toolkit::TextureCompressionQuality& textureQuality, size_t& textureTileRows, std::wstring& incrementalDirectory, std::wstring& profileFilePath, std::wstring& traceFilePath)
 {
     CommandLineParsingState state = CommandLineParsingState::Initial;
 
@@ -75,7 +177,21 @@ void CommandLine::ParseCommandLineArguments(
     tempDirectory = L"";
     lodFilePaths.clear();
     screenCoveragePercentages.clear();
+    generateLods = false;
+    generatedLodRatios.clear();
+    flattenScenes = false;
+    optimizeMeshes = false;
+    quantizeMeshes = false;
+    meshCompression = Microsoft::glTF::Toolkit::MeshCompression::None;
     maxTextureSize = MAXTEXTURESIZE_DEFAULT;
+    atlasTextureSize = ATLASTEXTURESIZE_DEFAULT;
+    maxParallelism = MAXPARALLELISM_DEFAULT;
+    textureCacheDirectory = L"";
+    textureQuality = TEXTUREQUALITY_DEFAULT;
+    textureTileRows = TEXTURETILEROWS_DEFAULT;
+    incrementalDirectory = L"";
+    profileFilePath = L"";
+    traceFilePath = L"";
 
     state = CommandLineParsingState::InputRead;
 
@@ -105,11 +221,77 @@ void CommandLine::ParseCommandLineArguments(
             screenCoveragePercentages.clear();
             state = CommandLineParsingState::ReadScreenCoverage;
         }
+        else if (param == PARAM_GENERATELODS)
+        {
+            generateLods = true;
+            generatedLodRatios.clear();
+            state = CommandLineParsingState::ReadGenerateLods;
+        }
+        else if (param == PARAM_FLATTENSCENES)
+        {
+            flattenScenes = true;
+            state = CommandLineParsingState::InputRead;
+        }
+        else if (param == PARAM_OPTIMIZEMESHES)
+        {
+            optimizeMeshes = true;
+            state = CommandLineParsingState::InputRead;
+        }
+        else if (param == PARAM_QUANTIZEMESHES)
+        {
+            quantizeMeshes = true;
+            state = CommandLineParsingState::InputRead;
+        }
+        else if (param == PARAM_COMPRESSMESHES)
+        {
+            meshCompression = Microsoft::glTF::Toolkit::MeshCompression::None;
+            state = CommandLineParsingState::ReadMeshCompression;
+        }
         else if (param == PARAM_MAXTEXTURESIZE)
         {
             maxTextureSize = MAXTEXTURESIZE_DEFAULT;
             state = CommandLineParsingState::ReadMaxTextureSize;
         }
+        else if (param == PARAM_ATLASTEXTURES)
+        {
+            atlasTextureSize = ATLASTEXTURESIZE_DEFAULT;
+            state = CommandLineParsingState::ReadAtlasTextures;
+        }
+        else if (param == PARAM_MAXPARALLELISM)
+        {
+            maxParallelism = MAXPARALLELISM_DEFAULT;
+            state = CommandLineParsingState::ReadMaxParallelism;
+        }
+        else if (param == PARAM_TEXTURECACHE)
+        {
+            textureCacheDirectory = L"";
+            state = CommandLineParsingState::ReadTextureCache;
+        }
+        else if (param == PARAM_TEXTUREQUALITY)
+        {
+            textureQuality = TEXTUREQUALITY_DEFAULT;
+            state = CommandLineParsingState::ReadTextureQuality;
+        }
+        else if (param == PARAM_TEXTURETILEROWS)
+        {
+            textureTileRows = TEXTURETILEROWS_DEFAULT;
+            state = CommandLineParsingState::ReadTextureTileRows;
+        }
+        else if (param == PARAM_INCREMENTAL)
+        {
+            incrementalDirectory = L"";
+            state = CommandLineParsingState::ReadIncremental;
+        }
+        else if (param == PARAM_PROFILE)
+        {
+            profileFilePath = L"";
+            state = CommandLineParsingState::ReadProfile;
+        }
+        else if (param == PARAM_TRACE)
+        {
+            traceFilePath = L"";
+            state = CommandLineParsingState::ReadTrace;
+        }
         else
         {
             switch (state)
@@ -131,9 +313,78 @@ void CommandLine::ParseCommandLineArguments(
                 screenCoveragePercentages.push_back(std::atof(paramA.c_str()));
                 break;
             }
+            case CommandLineParsingState::ReadGenerateLods:
+            {
+                auto paramA = std::string(param.begin(), param.end());
+                generatedLodRatios.push_back(std::atof(paramA.c_str()));
+                break;
+            }
+            case CommandLineParsingState::ReadMeshCompression:
+                if (param == MESHCOMPRESSION_REQUIRED)
+                {
+                    meshCompression = Microsoft::glTF::Toolkit::MeshCompression::Meshopt;
+                }
+                else if (param == MESHCOMPRESSION_FALLBACK)
+                {
+                    meshCompression = Microsoft::glTF::Toolkit::MeshCompression::MeshoptWithFallback;
+                }
+                else
+                {
+                    throw std::invalid_argument("Invalid mesh compression. For help, try the command again without parameters.");
+                }
+
+                state = CommandLineParsingState::InputRead;
+                break;
             case CommandLineParsingState::ReadMaxTextureSize:
                 maxTextureSize = std::min(static_cast<size_t>(std::stoul(param.c_str())), MAXTEXTURESIZE_MAX);
                 break;
+            case CommandLineParsingState::ReadAtlasTextures:
+                atlasTextureSize = static_cast<size_t>(std::stoul(param.c_str()));
+                state = CommandLineParsingState::InputRead;
+                break;
+            case CommandLineParsingState::ReadMaxParallelism:
+                maxParallelism = static_cast<size_t>(std::stoul(param.c_str()));
+                break;
+            case CommandLineParsingState::ReadTextureCache:
+                textureCacheDirectory = FileSystem::GetFullPath(param);
+                state = CommandLineParsingState::InputRead;
+                break;
+            case CommandLineParsingState::ReadTextureQuality:
+                if (param == TEXTUREQUALITY_FAST)
+                {
+                    textureQuality = Microsoft::glTF::Toolkit::TextureCompressionQuality::Fast;
+                }
+                else if (param == TEXTUREQUALITY_BALANCED)
+                {
+                    textureQuality = Microsoft::glTF::Toolkit::TextureCompressionQuality::Balanced;
+                }
+                else if (param == TEXTUREQUALITY_MAX)
+                {
+                    textureQuality = Microsoft::glTF::Toolkit::TextureCompressionQuality::Max;
+                }
+                else
+                {
+                    throw std::invalid_argument("Invalid texture quality. For help, try the command again without parameters.");
+                }
+
+                state = CommandLineParsingState::InputRead;
+                break;
+            case CommandLineParsingState::ReadTextureTileRows:
+                textureTileRows = static_cast<size_t>(std::stoul(param.c_str()));
+                state = CommandLineParsingState::InputRead;
+                break;
+            case CommandLineParsingState::ReadIncremental:
+                incrementalDirectory = FileSystem::GetFullPath(param);
+                state = CommandLineParsingState::InputRead;
+                break;
+            case CommandLineParsingState::ReadProfile:
+                profileFilePath = FileSystem::GetFullPath(param);
+                state = CommandLineParsingState::InputRead;
+                break;
+            case CommandLineParsingState::ReadTrace:
+                traceFilePath = FileSystem::GetFullPath(param);
+                state = CommandLineParsingState::InputRead;
+                break;
             case CommandLineParsingState::Initial:
             case CommandLineParsingState::InputRead:
             default:
@@ -163,10 +414,228 @@ void CommandLine::ParseCommandLineArguments(
 
     outFilePath = outFile;
 
+    if (!incrementalDirectory.empty())
+    {
+        if (CreateDirectory(incrementalDirectory.c_str(), NULL) == 0 && GetLastError() != ERROR_ALREADY_EXISTS)
+        {
+            throw std::invalid_argument("Could not create the incremental folder.");
+        }
+
+        if (incrementalDirectory.back() != L'\\')
+        {
+            incrementalDirectory += L'\\';
+        }
+
+        // Intermediate files must keep their paths across runs, so they are kept in the incremental folder
+        if (tmpDir.empty())
+        {
+            tmpDir = incrementalDirectory;
+        }
+    }
+
     if (tmpDir.empty())
     {
         tmpDir = FileSystem::CreateTempFolder();
     }
 
     tempDirectory = tmpDir;
+
+    if (!textureCacheDirectory.empty())
+    {
+        if (CreateDirectory(textureCacheDirectory.c_str(), NULL) == 0 && GetLastError() != ERROR_ALREADY_EXISTS)
+        {
+            throw std::invalid_argument("Could not create the texture cache folder.");
+        }
+    }
 }
+
+void CommandLine::ParseBatchArguments(
+    int argc, wchar_t *argv[],
+    std::vector<std::vector<std::wstring>>& assetArguments, size_t& maxParallelism, size_t& maxImagesInFlight, std::wstring& profileFilePath, std::wstring& traceFilePath)
+{
+    if (argc < 3)
+    {
+        throw std::invalid_argument("Invalid usage. For help, try the command again without parameters.");
+    }
+
+    auto batchPath = FileSystem::GetFullPath(std::wstring(argv[2]));
+
+    // Reset input parameters
+    assetArguments.clear();
+    maxParallelism = MAXPARALLELISM_DEFAULT;
+    maxImagesInFlight = 0;
+    profileFilePath = L"";
+    traceFilePath = L"";
+
+    // The output and temporary folders and the profiles are shared by the batch, and every other argument is passed on to each asset
+    std::wstring outDirectory;
+    std::wstring tmpDir;
+    std::wstring incrementalDirectory;
+    std::vector<std::wstring> sharedArguments;
+    for (int i = 3; i < argc; i++)
+    {
+        std::wstring param = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if ((param == PARAM_OUTFILE || param == PARAM_TMPDIR || param == PARAM_INCREMENTAL || param == PARAM_MAXIMAGESINFLIGHT || param == PARAM_PROFILE || param == PARAM_TRACE) && !hasValue)
+        {
+            throw std::invalid_argument("Invalid usage. For help, try the command again without parameters.");
+        }
+
+        if (param == PARAM_OUTFILE)
+        {
+            outDirectory = FileSystem::GetFullPath(std::wstring(argv[++i]));
+        }
+        else if (param == PARAM_TMPDIR)
+        {
+            tmpDir = FileSystem::GetFullPath(std::wstring(argv[++i]));
+        }
+        else if (param == PARAM_INCREMENTAL)
+        {
+            incrementalDirectory = FileSystem::GetFullPath(std::wstring(argv[++i]));
+        }
+        else if (param == PARAM_MAXIMAGESINFLIGHT)
+        {
+            maxImagesInFlight = static_cast<size_t>(std::stoul(argv[++i]));
+        }
+        else if (param == PARAM_PROFILE)
+        {
+            profileFilePath = FileSystem::GetFullPath(std::wstring(argv[++i]));
+        }
+        else if (param == PARAM_TRACE)
+        {
+            traceFilePath = FileSystem::GetFullPath(std::wstring(argv[++i]));
+        }
+        else
+        {
+            if (param == PARAM_MAXPARALLELISM && hasValue)
+            {
+                maxParallelism = static_cast<size_t>(std::stoul(argv[i + 1]));
+            }
+
+            sharedArguments.push_back(param);
+        }
+    }
+
+    if (maxImagesInFlight == 0)
+    {
+        maxImagesInFlight = maxParallelism == 0 ? Microsoft::glTF::Toolkit::ParallelUtils::GetDefaultParallelism() : maxParallelism;
+    }
+
+    // The path and the arguments that are specific to each asset
+    std::vector<std::vector<std::wstring>> assets;
+    if (PathIsDirectory(batchPath.c_str()))
+    {
+        std::wstring convertedSuffix = std::wstring(SUFFIX_CONVERTED) + EXTENSION_GLB;
+
+        for (const auto& filePath : FileSystem::GetFilesInFolder(batchPath))
+        {
+            auto extension = PathFindExtension(filePath.c_str());
+            if (_wcsicmp(extension, EXTENSION_GLTF) != 0 && _wcsicmp(extension, EXTENSION_GLB) != 0)
+            {
+                continue;
+            }
+
+            // Skip the output of a previous conversion of a GLB in the same folder
+            if (filePath.length() >= convertedSuffix.length() &&
+                _wcsicmp(filePath.c_str() + filePath.length() - convertedSuffix.length(), convertedSuffix.c_str()) == 0)
+            {
+                continue;
+            }
+
+            assets.push_back({ filePath });
+        }
+    }
+    else
+    {
+        std::ifstream manifest(batchPath);
+        if (!manifest)
+        {
+            throw std::invalid_argument("Could not read the batch manifest.");
+        }
+
+        std::string line;
+        while (std::getline(manifest, line))
+        {
+            auto arguments = SplitArguments(std::wstring(line.begin(), line.end()));
+            if (!arguments.empty() && arguments[0].compare(0, 1, L"#") != 0)
+            {
+                assets.push_back(std::move(arguments));
+            }
+        }
+    }
+
+    if (!outDirectory.empty())
+    {
+        if (CreateDirectory(outDirectory.c_str(), NULL) == 0 && GetLastError() != ERROR_ALREADY_EXISTS)
+        {
+            throw std::invalid_argument("Could not create the output folder.");
+        }
+    }
+
+    if (!incrementalDirectory.empty())
+    {
+        if (CreateDirectory(incrementalDirectory.c_str(), NULL) == 0 && GetLastError() != ERROR_ALREADY_EXISTS)
+        {
+            throw std::invalid_argument("Could not create the incremental folder.");
+        }
+    }
+
+    for (size_t i = 0; i < assets.size(); i++)
+    {
+        const auto& asset = assets[i];
+        auto inputFilePath = FileSystem::GetFullPath(asset[0]);
+
+        // Arguments of the asset come last, so that they override the shared ones
+        std::vector<std::wstring> arguments = { argv[0], inputFilePath };
+        arguments.insert(arguments.end(), sharedArguments.begin(), sharedArguments.end());
+        arguments.insert(arguments.end(), asset.begin() + 1, asset.end());
+
+        if (!outDirectory.empty() && std::find(asset.begin() + 1, asset.end(), PARAM_OUTFILE) == asset.end())
+        {
+            std::wstring outFileName = PathFindFileName(inputFilePath.c_str());
+            PathRemoveExtension(&outFileName[0]);
+            outFileName = std::wstring(outFileName.c_str());
+
+            if (AssetTypeUtils::AssetTypeFromFilePath(inputFilePath) == AssetType::GLB)
+            {
+                outFileName += SUFFIX_CONVERTED;
+            }
+
+            wchar_t outFilePath[MAX_PATH];
+            if (FAILED(PathCchCombine(outFilePath, ARRAYSIZE(outFilePath), outDirectory.c_str(), (outFileName + EXTENSION_GLB).c_str())))
+            {
+                throw std::invalid_argument("Invalid output folder.");
+            }
+
+            arguments.push_back(PARAM_OUTFILE);
+            arguments.push_back(outFilePath);
+        }
+
+        // The incremental folder of an asset must not depend on its position in the batch, so it is named after the asset,
+        // with a hash of its path to tell apart assets with the same name in different folders
+        bool hasIncrementalDirectory = std::find(asset.begin() + 1, asset.end(), PARAM_INCREMENTAL) != asset.end();
+        if (!incrementalDirectory.empty() && !hasIncrementalDirectory)
+        {
+            std::wstring assetName = PathFindFileName(inputFilePath.c_str());
+            PathRemoveExtension(&assetName[0]);
+            assetName = std::wstring(assetName.c_str());
+
+            std::string inputFilePathA(inputFilePath.begin(), inputFilePath.end());
+            auto pathHash = Microsoft::glTF::Toolkit::HashUtils::ComputeSHA256(inputFilePathA.data(), inputFilePathA.size()).substr(0, 8);
+
+            arguments.push_back(PARAM_INCREMENTAL);
+            arguments.push_back(FileSystem::CreateSubFolder(incrementalDirectory, assetName + L"_" + std::wstring(pathHash.begin(), pathHash.end())));
+            hasIncrementalDirectory = true;
+        }
+
+        // Assets write files with the same names, so each one needs its own temporary folder. An incremental asset keeps them in its incremental folder instead.
+        if (!tmpDir.empty() && !hasIncrementalDirectory && std::find(asset.begin() + 1, asset.end(), PARAM_TMPDIR) == asset.end())
+        {
+            arguments.push_back(PARAM_TMPDIR);
+            arguments.push_back(FileSystem::CreateSubFolder(tmpDir, L"asset" + std::to_wstring(i + 1)));
+        }
+
+        assetArguments.push_back(std::move(arguments));
+    }
+}
\ No newline at end of file
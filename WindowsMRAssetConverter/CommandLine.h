@@ -4,8 +4,13 @@
 #pragma once
 
 #include <vector>
+#include <GLTFMeshCompressionUtils.h>
+#include <GLTFTextureCompressionUtils.h>
+
 #include "AssetType.h"
 
+extern const wchar_t * PARAM_BATCH;
+
 namespace CommandLine
 {
     void PrintHelp();
@@ -13,6 +18,11 @@ namespace CommandLine
     void ParseCommandLineArguments(
         int argc, wchar_t *argv[],
         std::wstring& inputFilePath, AssetType& inputAssetType, std::wstring& outFilePath, std::wstring& tempDirectory,
-        std::vector<std::wstring>& lodFilePaths, std::vector<double>& screenCoveragePercentages, size_t& maxTextureSize);
+        std::vector<std::wstring>& lodFilePaths, std::vector<double>& screenCoveragePercentages, bool& generateLods, std::vector<double>& generatedLodRatios, bool& flattenScenes, bool& optimizeMeshes, bool& quantizeMeshes, Microsoft::glTF::Toolkit::MeshCompression& meshCompression, size_t& maxTextureSize, size_t& atlasTextureSize, size_t& maxParallelism, std::wstring& textureCacheDirectory, Microsoft::glTF::Toolkit::TextureCompressionQuality& textureQuality, size_t& textureTileRows, std::wstring& incrementalDirectory, std::wstring& profileFilePath, std::wstring& traceFilePath);
+
+    // Reads the assets of a batch, and returns the command line of each one, in the form read by ParseCommandLineArguments
+    void ParseBatchArguments(
+        int argc, wchar_t *argv[],
+        std::vector<std::vector<std::wstring>>& assetArguments, size_t& maxParallelism, size_t& maxImagesInFlight, std::wstring& profileFilePath, std::wstring& traceFilePath);
 };
 
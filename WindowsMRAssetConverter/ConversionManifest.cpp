@@ -0,0 +1,230 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+
+#include <HashUtils.h>
+
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "ConversionManifest.h"
+
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    // Manifests written by other versions are ignored, since their keys may not cover the same inputs
+    const int MANIFEST_VERSION = 1;
+
+    bool IsString(const rapidjson::Value& value, const char* name)
+    {
+        return value.HasMember(name) && value[name].IsString();
+    }
+}
+
+ConversionManifest::ConversionManifest(const std::wstring& filePath) :
+    m_filePath(filePath)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file)
+    {
+        return;
+    }
+
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    rapidjson::Document document;
+    document.Parse(json.c_str());
+    if (document.HasParseError() || !document.IsObject() ||
+        !document.HasMember("version") || !document["version"].IsInt() || document["version"].GetInt() != MANIFEST_VERSION ||
+        !document.HasMember("stages") || !document["stages"].IsObject())
+    {
+        return;
+    }
+
+    const auto& stages = document["stages"];
+    for (auto stage = stages.MemberBegin(); stage != stages.MemberEnd(); ++stage)
+    {
+        const auto& stageJson = stage->value;
+        if (!stageJson.IsObject() || !IsString(stageJson, "key") ||
+            !stageJson.HasMember("outputs") || !stageJson["outputs"].IsArray() ||
+            !stageJson.HasMember("result") || !stageJson["result"].IsObject())
+        {
+            continue;
+        }
+
+        StageRecord record;
+        record.key = stageJson["key"].GetString();
+
+        bool validOutputs = true;
+        const auto& outputs = stageJson["outputs"];
+        for (rapidjson::SizeType i = 0; i < outputs.Size(); i++)
+        {
+            if (!outputs[i].IsObject() || !IsString(outputs[i], "path") || !IsString(outputs[i], "hash"))
+            {
+                validOutputs = false;
+                break;
+            }
+
+            std::string path = outputs[i]["path"].GetString();
+            record.outputFiles.emplace_back(std::wstring(path.begin(), path.end()), outputs[i]["hash"].GetString());
+        }
+
+        if (!validOutputs)
+        {
+            continue;
+        }
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        stageJson["result"].Accept(writer);
+        record.result = buffer.GetString();
+
+        m_stages.emplace(stage->name.GetString(), std::move(record));
+    }
+}
+
+bool ConversionManifest::TryGetResult(const std::string& stage, const std::string& key, std::string& result) const
+{
+    StageRecord record;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto found = m_stages.find(stage);
+        if (found == m_stages.end() || found->second.key != key)
+        {
+            return false;
+        }
+
+        record = found->second;
+    }
+
+    // The outputs are hashed outside of the lock, since they can be large
+    for (const auto& outputFile : record.outputFiles)
+    {
+        if (HashFile(outputFile.first) != outputFile.second)
+        {
+            return false;
+        }
+    }
+
+    result = record.result;
+    return true;
+}
+
+void ConversionManifest::SetResult(const std::string& stage, const std::string& key, const std::vector<std::wstring>& outputFiles, const std::string& result)
+{
+    StageRecord record;
+    record.key = key;
+    record.result = result;
+
+    for (const auto& outputFile : outputFiles)
+    {
+        auto hash = HashFile(outputFile);
+        if (hash.empty())
+        {
+            throw std::runtime_error("Could not read the output file of a conversion stage.");
+        }
+
+        record.outputFiles.emplace_back(outputFile, hash);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stages[stage] = std::move(record);
+    Save();
+}
+
+std::string ConversionManifest::HashFile(const std::wstring& filePath)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file)
+    {
+        return "";
+    }
+
+    HashUtils::SHA256Hasher hasher;
+    std::vector<char> block(1 << 20);
+    while (file)
+    {
+        file.read(block.data(), block.size());
+        hasher.Update(block.data(), static_cast<size_t>(file.gcount()));
+    }
+
+    return hasher.Finish();
+}
+
+void ConversionManifest::Save() const
+{
+    rapidjson::Document document;
+    document.SetObject();
+    auto& allocator = document.GetAllocator();
+
+    document.AddMember("version", MANIFEST_VERSION, allocator);
+
+    // Sorted, so that the manifest does not depend on the order in which the stages finished
+    std::vector<std::string> stageNames;
+    for (const auto& stage : m_stages)
+    {
+        stageNames.push_back(stage.first);
+    }
+
+    std::sort(stageNames.begin(), stageNames.end());
+
+    rapidjson::Value stages(rapidjson::kObjectType);
+    for (const auto& stageName : stageNames)
+    {
+        const auto& record = m_stages.at(stageName);
+
+        rapidjson::Value stageJson(rapidjson::kObjectType);
+        stageJson.AddMember("key", rapidjson::Value(record.key.c_str(), allocator), allocator);
+
+        rapidjson::Value outputs(rapidjson::kArrayType);
+        for (const auto& outputFile : record.outputFiles)
+        {
+            std::string path(outputFile.first.begin(), outputFile.first.end());
+
+            rapidjson::Value output(rapidjson::kObjectType);
+            output.AddMember("path", rapidjson::Value(path.c_str(), allocator), allocator);
+            output.AddMember("hash", rapidjson::Value(outputFile.second.c_str(), allocator), allocator);
+            outputs.PushBack(output, allocator);
+        }
+
+        stageJson.AddMember("outputs", outputs, allocator);
+
+        rapidjson::Document result;
+        result.Parse(record.result.c_str());
+        if (result.HasParseError() || !result.IsObject())
+        {
+            throw std::logic_error("The result of a conversion stage must be a JSON object.");
+        }
+
+        stageJson.AddMember("result", rapidjson::Value(result, allocator), allocator);
+
+        stages.AddMember(rapidjson::Value(stageName.c_str(), allocator), stageJson, allocator);
+    }
+
+    document.AddMember("stages", stages, allocator);
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    document.Accept(writer);
+
+    // Written to a temporary file and renamed, so that a conversion that is stopped never leaves a partial manifest
+    std::wstring temporaryPath = m_filePath + L".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary);
+        file << buffer.GetString();
+        if (!file)
+        {
+            throw std::runtime_error("Could not write the conversion manifest.");
+        }
+    }
+
+    if (!MoveFileExW(temporaryPath.c_str(), m_filePath.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        throw std::runtime_error("Could not write the conversion manifest.");
+    }
+}
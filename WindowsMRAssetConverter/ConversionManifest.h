@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Records the inputs and outputs of each stage of a conversion, so that a later conversion into the same folder can skip
+// the stages whose inputs have not changed. The inputs of a stage are identified by a key, a hash of their contents and
+// of the options that affect the stage. A stage is only skipped if the files it wrote still exist, unchanged.
+// Stages may be recorded from several threads at once.
+class ConversionManifest
+{
+public:
+    // Reads the manifest from the file, if it exists. A missing or unreadable manifest is empty, so that every stage runs.
+    explicit ConversionManifest(const std::wstring& filePath);
+
+    // Gets the result recorded for the stage, a JSON object, if it was recorded with the same key and its output files are unchanged
+    bool TryGetResult(const std::string& stage, const std::string& key, std::string& result) const;
+
+    // Records the key, output files and result of a stage, replacing any previous record, and saves the manifest
+    void SetResult(const std::string& stage, const std::string& key, const std::vector<std::wstring>& outputFiles, const std::string& result);
+
+    // The SHA-256 hash of the contents of a file, or an empty string if it cannot be read
+    static std::string HashFile(const std::wstring& filePath);
+
+private:
+    struct StageRecord
+    {
+        std::string key;
+        std::vector<std::pair<std::wstring, std::string>> outputFiles;
+        std::string result;
+    };
+
+    void Save() const;
+
+    const std::wstring m_filePath;
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, StageRecord> m_stages;
+};
@@ -72,4 +72,41 @@ std::wstring FileSystem::CreateTempFolder()
     }
 
     return std::move(CreateSubFolder(tmpDirRaw, guidRaw));
+}
+
+std::vector<std::wstring> FileSystem::GetFilesInFolder(const std::wstring& folderPath)
+{
+    wchar_t searchPath[MAX_PATH];
+    if (FAILED(PathCchCombine(searchPath, ARRAYSIZE(searchPath), folderPath.c_str(), L"*")))
+    {
+        throw std::invalid_argument("Invalid folder path.");
+    }
+
+    std::vector<std::wstring> filePaths;
+
+    WIN32_FIND_DATA findData;
+    HANDLE findHandle = FindFirstFile(searchPath, &findData);
+    if (findHandle == INVALID_HANDLE_VALUE)
+    {
+        return filePaths;
+    }
+
+    do
+    {
+        if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+        {
+            wchar_t filePath[MAX_PATH];
+            if (SUCCEEDED(PathCchCombine(filePath, ARRAYSIZE(filePath), folderPath.c_str(), findData.cFileName)))
+            {
+                filePaths.push_back(filePath);
+            }
+        }
+    } while (FindNextFile(findHandle, &findData));
+
+    FindClose(findHandle);
+
+    // The order in which files are found depends on the file system
+    std::sort(filePaths.begin(), filePaths.end());
+
+    return filePaths;
 }
\ No newline at end of file
@@ -3,11 +3,14 @@
 
 #pragma once
 
+#include <vector>
+
 namespace FileSystem
 {
     std::wstring GetBasePath(const std::wstring& path);
     std::wstring GetFullPath(const std::wstring& path);
     std::wstring CreateSubFolder(const std::wstring& parentPath, const std::wstring& subFolderName);
     std::wstring CreateTempFolder();
+    std::vector<std::wstring> GetFilesInFolder(const std::wstring& folderPath);
 };
 
@@ -5,15 +5,31 @@
 
 #include <GLTFSDK/GLTF.h>
 #include <GLTFSDK/Deserialize.h>
+#include <GLTFSDK/Serialize.h>
 #include <GLTFSDK/IStreamFactory.h>
 #include <GLTFSDK/GLBResourceReader.h>
+#include <GLTFTextureAtlasUtils.h>
 #include <GLTFTexturePackingUtils.h>
 #include <GLTFTextureCompressionUtils.h>
+#include <GLTFTextureLoadingUtils.h>
 #include <GLTFLODUtils.h>
+#include <GLTFMeshSimplifyUtils.h>
+#include <GLTFMeshOptimizationUtils.h>
+#include <GLTFMeshQuantizationUtils.h>
+#include <GLTFSceneFlatteningUtils.h>
 #include <SerializeBinary.h>
 #include <GLBtoGLTF.h>
+#include <GLBStreamReader.h>
+#include <HashUtils.h>
+#include <Instrumentation.h>
+#include <ParallelUtils.h>
+#include <ScratchArena.h>
+
+#include <atomic>
+#include <mutex>
 
 #include "CommandLine.h"
+#include "ConversionManifest.h"
 #include "FileSystem.h"
 
 using namespace Microsoft::glTF;
@@ -46,8 +62,7 @@ class GLBStreamFactory : public Microsoft::glTF::IStreamFactory
 {
 public:
     GLBStreamFactory(const std::wstring& filename) :
-        m_stream(std::make_shared<std::ofstream>(filename, std::ios_base::binary | std::ios_base::out)),
-        m_tempStream(std::make_shared<std::stringstream>(std::ios_base::binary | std::ios_base::in | std::ios_base::out))
+        m_stream(std::make_shared<std::ofstream>(filename, std::ios_base::binary | std::ios_base::out))
     { }
 
     std::shared_ptr<std::istream> GetInputStream(const std::string&) const override
@@ -62,148 +77,659 @@ public:
 
     std::shared_ptr<std::iostream> GetTemporaryStream(const std::string&) const override
     {
-        return m_tempStream;
+        // SerializeBinary writes straight to the output stream
+        throw std::logic_error("Not implemented");
     }
 private:
     std::shared_ptr<std::ofstream> m_stream;
-    std::shared_ptr<std::stringstream> m_tempStream;
 };
 
+// Enables instrumentation if a profile or a trace is requested, and writes them when destroyed,
+// so that they are saved even if the conversion fails
+class InstrumentationWriter
+{
+public:
+    InstrumentationWriter(const std::wstring& profileFilePath, const std::wstring& traceFilePath) :
+        m_profileFilePath(profileFilePath),
+        m_traceFilePath(traceFilePath)
+    {
+        if (!m_profileFilePath.empty() || !m_traceFilePath.empty())
+        {
+            Instrumentation::SetEnabled(true);
+        }
+    }
+
+    ~InstrumentationWriter()
+    {
+        if (!m_profileFilePath.empty())
+        {
+            std::ofstream profile(m_profileFilePath);
+            Instrumentation::WriteJson(profile);
+        }
+
+        if (!m_traceFilePath.empty())
+        {
+            std::ofstream trace(m_traceFilePath);
+            Instrumentation::WriteChromeTrace(trace);
+        }
+    }
+
+private:
+    const std::wstring m_profileFilePath;
+    const std::wstring m_traceFilePath;
+};
+
+// The members of a document that texture packing and compression read and write
+const char* TEXTURE_STAGE_MEMBERS[] = { "materials", "textures", "images", "samplers", "extensionsUsed", "extensionsRequired" };
+
+std::string WriteJson(const rapidjson::Value& value)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    value.Accept(writer);
+    return buffer.GetString();
+}
+
+void HashString(HashUtils::SHA256Hasher& hasher, const std::string& value)
+{
+    // Each value is terminated, so that consecutive values can't be mistaken for each other
+    hasher.Update(value.c_str(), value.size() + 1);
+}
+
+// Identifies the inputs of the texture stages of a document: the options that affect their output, the parts of
+// the document that they read, and the contents of every image
+std::string GetTextureStageKey(const std::string& json, const GLTFDocument& document, const IStreamReader& streamReader, const std::string& options)
+{
+    rapidjson::Document inputJson;
+    inputJson.Parse(json.c_str());
+
+    HashUtils::SHA256Hasher hasher;
+    HashString(hasher, options);
+
+    for (auto member : TEXTURE_STAGE_MEMBERS)
+    {
+        HashString(hasher, member);
+        HashString(hasher, inputJson.HasMember(member) ? WriteJson(inputJson[member]) : "");
+    }
+
+    GLTFResourceReader gltfResourceReader(streamReader);
+    for (const auto& image : document.images.Elements())
+    {
+        auto imageData = gltfResourceReader.ReadBinaryData(document, image);
+        HashString(hasher, HashUtils::ComputeSHA256(imageData.data(), imageData.size()));
+    }
+
+    return hasher.Finish();
+}
+
+// Gets the result of the texture stages, the members of the converted document that they wrote, and the images that they added
+void GetTextureStageResult(const std::string& json, const GLTFDocument& document, std::string& result, std::vector<std::wstring>& outputFiles)
+{
+    rapidjson::Document inputJson;
+    inputJson.Parse(json.c_str());
+
+    std::set<std::string> inputImageUris;
+    if (inputJson.HasMember("images") && inputJson["images"].IsArray())
+    {
+        const auto& images = inputJson["images"];
+        for (rapidjson::SizeType i = 0; i < images.Size(); i++)
+        {
+            if (images[i].HasMember("uri") && images[i]["uri"].IsString())
+            {
+                inputImageUris.insert(images[i]["uri"].GetString());
+            }
+        }
+    }
+
+    // The packed and compressed images are saved with their full paths
+    outputFiles.clear();
+    for (const auto& image : document.images.Elements())
+    {
+        if (!image.uri.empty() && image.uri.compare(0, 5, "data:") != 0 && inputImageUris.find(image.uri) == inputImageUris.end())
+        {
+            outputFiles.push_back(std::wstring(image.uri.begin(), image.uri.end()));
+        }
+    }
+
+    rapidjson::Document outputJson;
+    outputJson.Parse(Serialize(document).c_str());
+
+    rapidjson::Document resultJson;
+    resultJson.SetObject();
+    for (auto member : TEXTURE_STAGE_MEMBERS)
+    {
+        if (outputJson.HasMember(member))
+        {
+            resultJson.AddMember(rapidjson::StringRef(member), rapidjson::Value(outputJson[member], resultJson.GetAllocator()), resultJson.GetAllocator());
+        }
+    }
+
+    result = WriteJson(resultJson);
+}
+
+// Applies a recorded result of the texture stages to the JSON of the document that they converted
+std::string ApplyTextureStageResult(const std::string& json, const std::string& result)
+{
+    rapidjson::Document inputJson;
+    inputJson.Parse(json.c_str());
+
+    rapidjson::Document resultJson;
+    resultJson.Parse(result.c_str());
+
+    for (auto member : TEXTURE_STAGE_MEMBERS)
+    {
+        inputJson.RemoveMember(member);
+        if (resultJson.HasMember(member))
+        {
+            inputJson.AddMember(rapidjson::StringRef(member), rapidjson::Value(resultJson[member], inputJson.GetAllocator()), inputJson.GetAllocator());
+        }
+    }
+
+    return WriteJson(inputJson);
+}
+
+// Adds an input asset to a hash: the GLB file, or the GLTF file and every external buffer and image that it references
+void HashInputAsset(HashUtils::SHA256Hasher& hasher, const std::wstring& filePath)
+{
+    std::string filePathA(filePath.begin(), filePath.end());
+    HashString(hasher, filePathA);
+    HashString(hasher, ConversionManifest::HashFile(filePath));
+
+    if (AssetTypeUtils::AssetTypeFromFilePath(filePath) != AssetType::GLTF)
+    {
+        return;
+    }
+
+    std::ifstream stream(filePath, std::ios::binary);
+    std::string json((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    rapidjson::Document gltfJson;
+    gltfJson.Parse(json.c_str());
+    if (gltfJson.HasParseError() || !gltfJson.IsObject())
+    {
+        return;
+    }
+
+    auto basePath = FileSystem::GetBasePath(filePath);
+    for (auto member : { "buffers", "images" })
+    {
+        if (!gltfJson.HasMember(member) || !gltfJson[member].IsArray())
+        {
+            continue;
+        }
+
+        const auto& resources = gltfJson[member];
+        for (rapidjson::SizeType i = 0; i < resources.Size(); i++)
+        {
+            if (!resources[i].HasMember("uri") || !resources[i]["uri"].IsString())
+            {
+                continue;
+            }
+
+            std::string uri = resources[i]["uri"].GetString();
+            if (uri.compare(0, 5, "data:") == 0)
+            {
+                continue;
+            }
+
+            wchar_t resourcePath[MAX_PATH];
+            if (SUCCEEDED(PathCchCombine(resourcePath, ARRAYSIZE(resourcePath), basePath.c_str(), std::wstring(uri.begin(), uri.end()).c_str())))
+            {
+                HashString(hasher, uri);
+                HashString(hasher, ConversionManifest::HashFile(resourcePath));
+            }
+        }
+    }
+}
+
+// Identifies the inputs of a whole conversion: its arguments, the paths that they resolve to, and every input file
+std::string GetConversionKey(int argc, wchar_t *argv[], const std::wstring& inputFilePath, const std::wstring& outFilePath, const std::wstring& tempDirectory, const std::vector<std::wstring>& lodFilePaths)
+{
+    HashUtils::SHA256Hasher hasher;
+
+    for (int i = 2; i < argc; i++)
+    {
+        std::wstring argument = argv[i];
+        HashString(hasher, std::string(argument.begin(), argument.end()));
+    }
+
+    HashString(hasher, std::string(outFilePath.begin(), outFilePath.end()));
+    HashString(hasher, std::string(tempDirectory.begin(), tempDirectory.end()));
+
+    HashInputAsset(hasher, inputFilePath);
+    for (const auto& lodFilePath : lodFilePaths)
+    {
+        HashInputAsset(hasher, lodFilePath);
+    }
+
+    return hasher.Finish();
+}
+
 GLTFDocument LoadAndConvertDocumentForWindowsMR(
     std::wstring& inputFilePath,
     AssetType inputAssetType,
     const std::wstring& tempDirectory,
-    size_t maxTextureSize)
+    size_t maxTextureSize,
+    size_t atlasTextureSize,
+    size_t maxParallelism,
+    const std::wstring& textureCacheDirectory,
+    TextureCompressionQuality textureQuality,
+    size_t textureTileRows,
+    ConversionManifest* manifest,
+    const std::string& stageName,
+    bool unpackGLB,
+    std::wostream& log,
+    std::shared_ptr<IStreamReader>& streamReader)
 {
     // Load the document
     std::wstring inputFileName = PathFindFileName(inputFilePath.c_str());
-    std::wcout << L"Loading input document: " << inputFileName << L"..." << std::endl;
+    log << L"Loading input document: " << inputFileName << L"..." << std::endl;
 
-    if (inputAssetType == AssetType::GLB)
-    {
-        // Convert the GLB to GLTF in the temp directory
+    Instrumentation::Stage stage("LoadAndConvertDocument");
+    stage.SetProperty("document", std::string(inputFileName.begin(), inputFileName.end()));
+
+    std::string json;
 
+    if (inputAssetType == AssetType::GLB && !unpackGLB)
+    {
+        // Read the GLB resources directly from the GLB file
         std::string inputFilePathA(inputFilePath.begin(), inputFilePath.end());
-        std::string tempDirectoryA(tempDirectory.begin(), tempDirectory.end());
 
-        wchar_t *inputFileNameRaw = &inputFileName[0];
-        PathRemoveExtension(inputFileNameRaw);
+        auto glbStreamReader = std::make_shared<GLBStreamReader>(inputFilePathA);
+        json = glbStreamReader->GetJson();
+        streamReader = glbStreamReader;
+    }
+    else
+    {
+        if (inputAssetType == AssetType::GLB)
+        {
+            // Convert the GLB to GLTF in the temp directory
 
-        // inputGltfName is the path to the converted GLTF without extension
-        std::wstring inputGltfName = inputFileNameRaw;
-        std::string inputGltfNameA = std::string(inputGltfName.begin(), inputGltfName.end());
+            std::string inputFilePathA(inputFilePath.begin(), inputFilePath.end());
+            std::string tempDirectoryA(tempDirectory.begin(), tempDirectory.end());
 
-        GLBToGLTF::UnpackGLB(inputFilePathA, tempDirectoryA, inputGltfNameA);
+            wchar_t *inputFileNameRaw = &inputFileName[0];
+            PathRemoveExtension(inputFileNameRaw);
 
-        inputFilePath = tempDirectory + inputGltfName + EXTENSION_GLTF;
+            // inputGltfName is the path to the converted GLTF without extension
+            std::wstring inputGltfName = inputFileNameRaw;
+            std::string inputGltfNameA = std::string(inputGltfName.begin(), inputGltfName.end());
+
+            GLBToGLTF::UnpackGLB(inputFilePathA, tempDirectoryA, inputGltfNameA);
+
+            inputFilePath = tempDirectory + inputGltfName + EXTENSION_GLTF;
+        }
+
+        std::ifstream stream(inputFilePath, std::ios::binary);
+        json.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+        // Get the base path from where to read all the assets
+        streamReader = std::make_shared<GLTFStreamReader>(FileSystem::GetBasePath(inputFilePath));
     }
 
-    auto stream = std::make_shared<std::ifstream>(inputFilePath, std::ios::binary);
-    GLTFDocument document = DeserializeJson(*stream);
+    GLTFDocument document = DeserializeJson(json);
+
+    auto tempDirectoryA = std::string(tempDirectory.begin(), tempDirectory.end());
+
+    // 0. Texture Atlasing
+    if (atlasTextureSize > 0)
+    {
+        log << L"Atlasing textures..." << std::endl;
+
+        // The atlases are no larger than the compressed textures, so that compression never scales them down
+        TextureAtlasOptions atlasOptions;
+        atlasOptions.maxTextureSize = atlasTextureSize;
+        atlasOptions.maxAtlasSize = maxTextureSize;
 
-    // Get the base path from where to read all the assets
+        GLTFTextureAtlasUtils::AtlasTexturesInPlace(*streamReader, document, atlasOptions, tempDirectoryA, maxParallelism);
 
-    GLTFStreamReader streamReader(FileSystem::GetBasePath(inputFilePath));
+        // The texture stages read the atlased document, which is keyed and restored like an input
+        json = Serialize(document);
+    }
 
-    std::wcout << L"Packing textures..." << std::endl;
+    // With a manifest, packing and compression are skipped if the document, its images and the options are unchanged
+    std::string textureStageKey;
+    if (manifest != nullptr)
+    {
+        auto options = std::to_string(maxTextureSize) + " " + std::to_string(atlasTextureSize) + " " + std::to_string(static_cast<int>(textureQuality)) + " " + std::to_string(textureTileRows) + " " +
+            std::string(tempDirectory.begin(), tempDirectory.end());
+        textureStageKey = GetTextureStageKey(json, document, *streamReader, options);
+
+        std::string result;
+        if (manifest->TryGetResult(stageName, textureStageKey, result))
+        {
+            log << L"Textures are up to date." << std::endl;
+            return DeserializeJson(ApplyTextureStageResult(json, result));
+        }
+    }
+
+    log << L"Packing textures..." << std::endl;
 
     // 1. Texture Packing
-    auto tempDirectoryA = std::string(tempDirectory.begin(), tempDirectory.end());
-    document = GLTFTexturePackingUtils::PackAllMaterialsForWindowsMR(streamReader, document, TexturePacking::RoughnessMetallicOcclusion, tempDirectoryA);
+    {
+        Instrumentation::Stage packingStage("TexturePacking");
 
-    std::wcout << L"Compressing textures - this can take a few minutes..." << std::endl;
+        // The packed textures are saved as 8-bit PNGs, so there is no need to pack them in floating point
+        GLTFTexturePackingUtils::PackAllMaterialsForWindowsMRInPlace(*streamReader, document, TexturePacking::RoughnessMetallicOcclusion, tempDirectoryA, DXGI_FORMAT_R8G8B8A8_UNORM, textureTileRows);
+    }
+
+    log << L"Compressing textures - this can take a few minutes..." << std::endl;
 
     // 2. Texture Compression
-    document = GLTFTextureCompressionUtils::CompressAllTexturesForWindowsMR(streamReader, document, tempDirectoryA, maxTextureSize);
+    {
+        Instrumentation::Stage compressionStage("TextureCompression");
 
-    return document;
-}
+        auto textureCacheDirectoryA = std::string(textureCacheDirectory.begin(), textureCacheDirectory.end());
+        GLTFTextureCompressionUtils::CompressAllTexturesForWindowsMRInPlace(*streamReader, document, tempDirectoryA, maxTextureSize, true, maxParallelism, textureCacheDirectoryA, textureQuality, textureTileRows);
+    }
 
-int wmain(int argc, wchar_t *argv[])
-{
-    if (argc < 2)
+    if (manifest != nullptr)
     {
-        CommandLine::PrintHelp();
-        return 0;
+        std::string result;
+        std::vector<std::wstring> outputFiles;
+        GetTextureStageResult(json, document, result, outputFiles);
+        manifest->SetResult(stageName, textureStageKey, outputFiles, result);
     }
 
-    // Initialize COM
-    CoInitialize(NULL);
+    return document;
+}
 
-    try
+// Converts the asset described by a command line: the input path followed by the optional arguments.
+// Progress is written to the log, and errors are thrown.
+void ConvertAsset(int argc, wchar_t *argv[], std::wostream& log)
+{
+    // Arguments
+    std::wstring inputFilePath;
+    AssetType inputAssetType;
+    std::wstring outFilePath;
+    std::wstring tempDirectory;
+    std::vector<std::wstring> lodFilePaths;
+    std::vector<double> screenCoveragePercentages;
+    bool generateLods;
+    std::vector<double> generatedLodRatios;
+    bool flattenScenes;
+    bool optimizeMeshes;
+    bool quantizeMeshes;
+    MeshCompression meshCompression;
+    size_t maxTextureSize;
+    size_t atlasTextureSize;
+    size_t maxParallelism;
+    std::wstring textureCacheDirectory;
+    TextureCompressionQuality textureQuality;
+    size_t textureTileRows;
+    std::wstring incrementalDirectory;
+    std::wstring profileFilePath;
+    std::wstring traceFilePath;
+
+    CommandLine::ParseCommandLineArguments(argc, argv, inputFilePath, inputAssetType, outFilePath, tempDirectory, lodFilePaths, screenCoveragePercentages, generateLods, generatedLodRatios, flattenScenes, optimizeMeshes, quantizeMeshes, meshCompression, maxTextureSize, atlasTextureSize, maxParallelism, textureCacheDirectory, textureQuality, textureTileRows, incrementalDirectory, profileFilePath, traceFilePath);
+
+    InstrumentationWriter instrumentationWriter(profileFilePath, traceFilePath);
+
+    // Every stage of the conversion, including those on worker threads, is labeled with the asset
+    std::wstring inputFileName = PathFindFileName(inputFilePath.c_str());
+    Instrumentation::ContextScope instrumentationContext({ std::string(inputFileName.begin(), inputFileName.end()) });
+    Instrumentation::Stage stage("ConvertAsset");
+
+    // With an incremental folder, the whole conversion is skipped if its arguments, its input files and its output are unchanged.
+    // Otherwise, each document only redoes texture packing and compression if its own inputs changed. The geometry stages
+    // always run again, since they take little time compared to texture compression.
+    std::unique_ptr<ConversionManifest> manifest;
+    std::string conversionKey;
+    if (!incrementalDirectory.empty())
     {
-        // Arguments
-        std::wstring inputFilePath;
-        AssetType inputAssetType;
-        std::wstring outFilePath;
-        std::wstring tempDirectory;
-        std::vector<std::wstring> lodFilePaths;
-        std::vector<double> screenCoveragePercentages;
-        size_t maxTextureSize;
+        manifest = std::make_unique<ConversionManifest>(incrementalDirectory + L"manifest.json");
+        conversionKey = GetConversionKey(argc, argv, inputFilePath, outFilePath, tempDirectory, lodFilePaths);
 
-        CommandLine::ParseCommandLineArguments(argc, argv, inputFilePath, inputAssetType, outFilePath, tempDirectory, lodFilePaths, screenCoveragePercentages, maxTextureSize);
+        std::string result;
+        if (manifest->TryGetResult("export", conversionKey, result))
+        {
+            log << L"The output is up to date." << std::endl;
+            log << L"Output file: " << outFilePath << std::endl;
+            return;
+        }
+    }
 
-        // Load document, and perform steps:
-        // 1. Texture Packing
-        // 2. Texture Compression
-        auto document = LoadAndConvertDocumentForWindowsMR(inputFilePath, inputAssetType, tempDirectory, maxTextureSize);
+    // Load the main document and each LOD, and perform steps:
+    // 0. Texture Atlasing, if enabled
+    // 1. Texture Packing
+    // 2. Texture Compression
+    // The documents are converted concurrently, since each one writes to its own folder, and their texture
+    // jobs share the worker pool. The readers let textures shared by several LODs be stored only once.
+    std::vector<GLTFDocument> lodDocuments(lodFilePaths.size() + 1);
+    std::vector<std::shared_ptr<IStreamReader>> lodStreamReaders(lodFilePaths.size() + 1);
+    std::vector<std::wostringstream> lodLogs(lodFilePaths.size() + 1);
 
-        // 3. LOD Merging
-        if (lodFilePaths.size() > 0)
+    ParallelUtils::ParallelFor(lodDocuments.size(), maxParallelism, [&](size_t i)
+    {
+        if (i == 0)
         {
-            std::wcout << L"Merging LODs..." << std::endl;
+            lodDocuments[0] = LoadAndConvertDocumentForWindowsMR(inputFilePath, inputAssetType, tempDirectory, maxTextureSize, atlasTextureSize, maxParallelism, textureCacheDirectory, textureQuality, textureTileRows, manifest.get(), "textures", false, lodLogs[0], lodStreamReaders[0]);
+            return;
+        }
 
-            std::vector<GLTFDocument> lodDocuments;
-            lodDocuments.push_back(document);
+        // Apply the same optimizations for each LOD
+        auto lod = lodFilePaths[i - 1];
+        auto subFolder = FileSystem::CreateSubFolder(tempDirectory, L"lod" + std::to_wstring(i));
 
-            for (size_t i = 0; i < lodFilePaths.size(); i++)
-            {
-                // Apply the same optimizations for each LOD
-                auto lod = lodFilePaths[i];
-                auto subFolder = FileSystem::CreateSubFolder(tempDirectory, L"lod" + std::to_wstring(i + 1));
+        // LODs are unpacked, since the merged document can only be read from one GLB
+        lodDocuments[i] = LoadAndConvertDocumentForWindowsMR(lod, AssetTypeUtils::AssetTypeFromFilePath(lod), subFolder, maxTextureSize, atlasTextureSize, maxParallelism, textureCacheDirectory, textureQuality, textureTileRows, manifest.get(), "textures.lod" + std::to_string(i), true, lodLogs[i], lodStreamReaders[i]);
+    });
 
-                lodDocuments.push_back(LoadAndConvertDocumentForWindowsMR(lod, AssetTypeUtils::AssetTypeFromFilePath(lod), subFolder, maxTextureSize));
-            }
+    // The progress of each document is logged in order once they are all done
+    for (const auto& lodLog : lodLogs)
+    {
+        log << lodLog.str();
+    }
 
-            // TODO: LOD assets can be in different places in disk, so the merged document will not have 
-            // the right relative paths to resources. We must either compute the correct relative paths or embed
-            // all resources as base64 in the source document, otherwise the export to GLB will fail.
-            document = GLTFLODUtils::MergeDocumentsAsLODs(lodDocuments, screenCoveragePercentages);
-        }
+    std::shared_ptr<IStreamReader> streamReader = lodStreamReaders[0];
+    GLTFDocument document;
 
-        // 4. GLB Export
-        std::wcout << L"Exporting as GLB..." << std::endl;
+    // 3. LOD Merging
+    if (lodFilePaths.size() > 0 || generateLods)
+    {
+        log << L"Merging LODs..." << std::endl;
 
-        // The Windows MR Fall Creators update has restrictions on the supported
-        // component types of accessors.
-        AccessorConversionStrategy accessorConversion = [](const Accessor& accessor)
+        // Generated LODs follow the authored ones, and are simplified from the primary document, which has already
+        // been packed and compressed. They point to the primary resources, so they are read with the primary stream reader.
+        if (generateLods)
         {
-            if (accessor.type == AccessorType::TYPE_SCALAR)
+            if (generatedLodRatios.empty())
             {
-                switch (accessor.componentType)
+                auto coverageRatios = GLTFMeshSimplifyUtils::GetTriangleRatios(screenCoveragePercentages);
+                if (coverageRatios.size() > lodFilePaths.size())
                 {
-                case ComponentType::COMPONENT_BYTE:
-                case ComponentType::COMPONENT_UNSIGNED_BYTE:
-                case ComponentType::COMPONENT_SHORT:
-                    return ComponentType::COMPONENT_UNSIGNED_SHORT;
-                default:
-                    return accessor.componentType;
+                    generatedLodRatios.assign(coverageRatios.begin() + lodFilePaths.size(), coverageRatios.end());
                 }
             }
-            else if (accessor.type == AccessorType::TYPE_VEC2 || accessor.type == AccessorType::TYPE_VEC3)
+
+            log << L"Generating LODs..." << std::endl;
+
+            Instrumentation::Stage generationStage("LODGeneration");
+            auto subFolder = FileSystem::CreateSubFolder(tempDirectory, L"generated_lods");
+            auto generatedLods = GLTFMeshSimplifyUtils::GenerateLODs(*streamReader, lodDocuments[0], generatedLodRatios, std::string(subFolder.begin(), subFolder.end()), maxParallelism);
+            for (auto& generatedLod : generatedLods)
+            {
+                lodDocuments.push_back(std::move(generatedLod));
+                lodStreamReaders.push_back(streamReader);
+            }
+        }
+
+        // TODO: LOD assets can be in different places in disk, so the merged document will not have 
+        // the right relative paths to resources. We must either compute the correct relative paths or embed
+        // all resources as base64 in the source document, otherwise the export to GLB will fail.
+        document = GLTFLODUtils::MergeDocumentsAsLODs(lodDocuments, screenCoveragePercentages, lodStreamReaders);
+    }
+    else
+    {
+        document = std::move(lodDocuments[0]);
+    }
+
+    // 4. Scene Flattening
+    if (flattenScenes)
+    {
+        log << L"Flattening scenes..." << std::endl;
+
+        Instrumentation::Stage flatteningStage("SceneFlattening");
+
+        // Runs after LOD merging, so that the root of each LOD is kept, and before mesh optimization, so that the
+        // merged primitives are optimized as a whole
+        auto subFolder = FileSystem::CreateSubFolder(tempDirectory, L"flattened_scenes");
+        GLTFSceneFlatteningUtils::FlattenScenesInPlace(*streamReader, document, std::string(subFolder.begin(), subFolder.end()), maxParallelism);
+    }
+
+    // 5. Mesh Optimization
+    if (optimizeMeshes)
+    {
+        log << L"Optimizing meshes..." << std::endl;
+
+        Instrumentation::Stage optimizationStage("MeshOptimization");
+
+        // Runs after LOD merging, so that the primary and generated LODs that share vertices are optimized together
+        auto subFolder = FileSystem::CreateSubFolder(tempDirectory, L"optimized_meshes");
+        GLTFMeshOptimizationUtils::OptimizeMeshesInPlace(*streamReader, document, std::string(subFolder.begin(), subFolder.end()), maxParallelism);
+    }
+
+    // 6. Mesh Quantization
+    if (quantizeMeshes)
+    {
+        log << L"Quantizing meshes..." << std::endl;
+
+        Instrumentation::Stage quantizationStage("MeshQuantization");
+
+        auto subFolder = FileSystem::CreateSubFolder(tempDirectory, L"quantized_meshes");
+        GLTFMeshQuantizationUtils::QuantizeMeshesInPlace(*streamReader, document, QuantizationErrorBounds(), std::string(subFolder.begin(), subFolder.end()), maxParallelism);
+    }
+
+    // 7. GLB Export
+    log << L"Exporting as GLB..." << std::endl;
+
+    // The Windows MR Fall Creators update has restrictions on the supported
+    // component types of accessors.
+    AccessorConversionStrategy accessorConversion = [](const Accessor& accessor)
+    {
+        if (accessor.type == AccessorType::TYPE_SCALAR)
+        {
+            switch (accessor.componentType)
             {
-                return ComponentType::COMPONENT_FLOAT;
+            case ComponentType::COMPONENT_BYTE:
+            case ComponentType::COMPONENT_UNSIGNED_BYTE:
+            case ComponentType::COMPONENT_SHORT:
+                return ComponentType::COMPONENT_UNSIGNED_SHORT;
+            default:
+                return accessor.componentType;
             }
+        }
+        else if (accessor.type == AccessorType::TYPE_VEC2 || accessor.type == AccessorType::TYPE_VEC3)
+        {
+            return ComponentType::COMPONENT_FLOAT;
+        }
+
+        return accessor.componentType;
+    };
+
+    // Quantized attributes are integers by design, so they are not converted back to floats
+    accessorConversion = GLTFMeshQuantizationUtils::PreserveQuantizedAttributes(document, accessorConversion);
+
+    // The coarsest LOD is written first, so that it can be drawn before the rest of the file is downloaded. Assets without LODs
+    // are laid out in document order.
+    std::unique_ptr<const IStreamFactory> streamFactory = std::make_unique<GLBStreamFactory>(outFilePath);
+    SerializeBinary(document, *streamReader, streamFactory, accessorConversion, maxParallelism, true, meshCompression, BinaryLayout::CoarsestLODFirst);
+
+    if (manifest != nullptr)
+    {
+        // Closes the output file before it is hashed
+        streamFactory.reset();
+        manifest->SetResult("export", conversionKey, { outFilePath }, "{}");
+    }
+
+    // The scratch memory of the process so far, which a batch shares between its assets, is what bounds how many can be converted at once
+    auto scratchStatistics = ScratchArena::GetShared().GetStatistics();
+    stage.SetProperty("scratch_peak_bytes_in_use", std::to_string(scratchStatistics.peakBytesInUse));
+    stage.SetProperty("scratch_peak_bytes_reserved", std::to_string(scratchStatistics.peakBytesReserved));
+    stage.SetProperty("scratch_reuses", std::to_string(scratchStatistics.reuses) + "/" + std::to_string(scratchStatistics.acquisitions));
+
+    log << L"Done!" << std::endl;
+    log << L"Output file: " << outFilePath << std::endl;
+}
+
+// Converts every asset of a batch in this process. Assets are converted concurrently, and the texture jobs of
+// all of them share the same worker threads and the same limit on decoded images in memory.
+int ConvertBatch(int argc, wchar_t *argv[])
+{
+    std::vector<std::vector<std::wstring>> assetArguments;
+    size_t maxParallelism;
+    size_t maxImagesInFlight;
+    std::wstring profileFilePath;
+    std::wstring traceFilePath;
+
+    CommandLine::ParseBatchArguments(argc, argv, assetArguments, maxParallelism, maxImagesInFlight, profileFilePath, traceFilePath);
+
+    // The profiles cover every asset of the batch
+    InstrumentationWriter instrumentationWriter(profileFilePath, traceFilePath);
+
+    GLTFTextureLoadingUtils::GetInFlightImageLimit().SetLimit(maxImagesInFlight);
+
+    std::wcout << L"Converting " << assetArguments.size() << L" assets..." << std::endl;
+
+    std::mutex logMutex;
+    std::atomic<size_t> completedCount(0);
+    std::atomic<size_t> failedCount(0);
 
-            return accessor.componentType;
-        };
+    // A failed asset is reported, and does not stop the others
+    ParallelUtils::ParallelFor(assetArguments.size(), maxParallelism, [&](size_t assetIndex)
+    {
+        auto& arguments = assetArguments[assetIndex];
+
+        std::vector<wchar_t*> assetArgv;
+        for (auto& argument : arguments)
+        {
+            assetArgv.push_back(&argument[0]);
+        }
+
+        // Each asset logs to its own buffer, so that the output of concurrent assets doesn't interleave
+        std::wostringstream log;
+
+        try
+        {
+            ConvertAsset(static_cast<int>(assetArgv.size()), assetArgv.data(), log);
+        }
+        catch (const std::exception& ex)
+        {
+            log << L"Failed: " << ex.what() << std::endl;
+            failedCount++;
+        }
+
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::wcout << L"[" << ++completedCount << L"/" << assetArguments.size() << L"] " << arguments[1] << std::endl << log.str() << std::endl;
+    });
+
+    std::wcout << L"Converted " << (assetArguments.size() - failedCount) << L" of " << assetArguments.size() << L" assets." << std::endl;
+
+    auto scratchStatistics = ScratchArena::GetShared().GetStatistics();
+    std::wcout << L"Peak scratch memory: " << (scratchStatistics.peakBytesInUse >> 20) << L" MB in use, " << (scratchStatistics.peakBytesReserved >> 20) << L" MB reserved." << std::endl;
+
+    return failedCount > 0 ? 1 : 0;
+}
 
-        GLTFStreamReader streamReader(FileSystem::GetBasePath(inputFilePath));
-        std::unique_ptr<const IStreamFactory> streamFactory = std::make_unique<GLBStreamFactory>(outFilePath);
-        SerializeBinary(document, streamReader, streamFactory, accessorConversion);
+int wmain(int argc, wchar_t *argv[])
+{
+    if (argc < 2)
+    {
+        CommandLine::PrintHelp();
+        return 0;
+    }
+
+    // Initialize COM
+    CoInitialize(NULL);
+
+    try
+    {
+        if (std::wstring(argv[1]) == PARAM_BATCH)
+        {
+            return ConvertBatch(argc, argv);
+        }
 
-        std::wcout << L"Done!" << std::endl;
-        std::wcout << L"Output file: " << outFilePath << std::endl;
+        ConvertAsset(argc, argv, std::wcout);
     }
     catch (std::exception ex)
     {
@@ -0,0 +1,128 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+
+#include <chrono>
+#include <iomanip>
+
+#include "Benchmark.h"
+
+namespace
+{
+    std::vector<std::string> SplitCsvLine(const std::string& line)
+    {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ','))
+        {
+            fields.push_back(field);
+        }
+
+        return fields;
+    }
+}
+
+BenchmarkResult RunBenchmark(const BenchmarkCase& benchmarkCase, const BenchmarkOptions& options)
+{
+    auto action = benchmarkCase.prepare();
+
+    action();
+
+    std::vector<double> durations;
+    auto start = std::chrono::steady_clock::now();
+    while (durations.size() < options.minIterations ||
+        (durations.size() < options.maxIterations && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < options.minSeconds))
+    {
+        auto iterationStart = std::chrono::steady_clock::now();
+        action();
+        durations.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - iterationStart).count());
+    }
+
+    std::sort(durations.begin(), durations.end());
+
+    BenchmarkResult result;
+    result.name = benchmarkCase.name;
+    result.parameter = benchmarkCase.parameter;
+    result.iterations = durations.size();
+    result.minMilliseconds = durations.front();
+    result.medianMilliseconds = durations.size() % 2 == 1 ?
+        durations[durations.size() / 2] :
+        (durations[durations.size() / 2 - 1] + durations[durations.size() / 2]) / 2;
+
+    return result;
+}
+
+void WriteBenchmarkResults(const std::vector<BenchmarkResult>& results, std::ostream& output)
+{
+    output << "name,parameter,iterations,median_ms,min_ms\n";
+    output << std::fixed << std::setprecision(4);
+    for (const auto& result : results)
+    {
+        output << result.name << ',' << result.parameter << ',' << result.iterations << ',' << result.medianMilliseconds << ',' << result.minMilliseconds << '\n';
+    }
+}
+
+std::vector<BenchmarkResult> ReadBenchmarkResults(std::istream& input)
+{
+    std::vector<BenchmarkResult> results;
+    std::string line;
+
+    // Skip the header
+    std::getline(input, line);
+
+    while (std::getline(input, line))
+    {
+        auto fields = SplitCsvLine(line);
+        if (fields.size() != 5)
+        {
+            continue;
+        }
+
+        BenchmarkResult result;
+        result.name = fields[0];
+        result.parameter = fields[1];
+        result.iterations = std::stoul(fields[2]);
+        result.medianMilliseconds = std::stod(fields[3]);
+        result.minMilliseconds = std::stod(fields[4]);
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
+size_t CompareBenchmarkResults(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double threshold, std::ostream& output)
+{
+    size_t regressions = 0;
+
+    output << std::fixed << std::setprecision(3);
+    for (const auto& result : results)
+    {
+        auto baselineResult = std::find_if(baseline.begin(), baseline.end(), [&](const BenchmarkResult& candidate)
+        {
+            return candidate.name == result.name && candidate.parameter == result.parameter;
+        });
+
+        output << std::left << std::setw(32) << result.name << std::setw(28) << result.parameter << std::right;
+
+        if (baselineResult == baseline.end() || baselineResult->medianMilliseconds <= 0.0)
+        {
+            output << std::setw(12) << result.medianMilliseconds << " ms  (no baseline)\n";
+            continue;
+        }
+
+        double change = result.medianMilliseconds / baselineResult->medianMilliseconds - 1.0;
+        bool regressed = change > threshold;
+        if (regressed)
+        {
+            regressions++;
+        }
+
+        output << std::setw(12) << result.medianMilliseconds << " ms  vs " << std::setw(12) << baselineResult->medianMilliseconds << " ms  "
+            << std::showpos << std::setprecision(1) << change * 100 << '%' << std::noshowpos << std::setprecision(3)
+            << (regressed ? "  REGRESSION" : "") << '\n';
+    }
+
+    return regressions;
+}
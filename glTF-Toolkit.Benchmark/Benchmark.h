@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// A benchmark of one operation at one input size. Prepare builds the input once, outside of the measurement,
+// and returns the action that is timed; the action must leave its input unchanged so that it can be repeated.
+struct BenchmarkCase
+{
+    std::string name;
+    std::string parameter;
+    std::function<std::function<void()>()> prepare;
+};
+
+struct BenchmarkResult
+{
+    std::string name;
+    std::string parameter;
+    size_t iterations = 0;
+    double medianMilliseconds = 0.0;
+    double minMilliseconds = 0.0;
+};
+
+struct BenchmarkOptions
+{
+    // Every case runs at least minIterations times, and then until minSeconds have passed or maxIterations are reached
+    size_t minIterations = 5;
+    size_t maxIterations = 1000;
+    double minSeconds = 1.0;
+};
+
+// Prepares the case, runs it once to warm up caches and devices, and then times each iteration
+BenchmarkResult RunBenchmark(const BenchmarkCase& benchmarkCase, const BenchmarkOptions& options);
+
+// Writes the results as CSV (name,parameter,iterations,median_ms,min_ms), which ReadBenchmarkResults reads back
+void WriteBenchmarkResults(const std::vector<BenchmarkResult>& results, std::ostream& output);
+std::vector<BenchmarkResult> ReadBenchmarkResults(std::istream& input);
+
+// Prints each result next to its baseline, and returns the number of cases whose median is slower than
+// the baseline by more than the given fraction. Cases that are missing from the baseline are not counted.
+size_t CompareBenchmarkResults(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double threshold, std::ostream& output);
@@ -0,0 +1,494 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+
+#include <GLTFSDK/GLTF.h>
+#include <GLTFSDK/Deserialize.h>
+#include <GLTFSDK/IStreamFactory.h>
+#include <AccessorUtils.h>
+#include <GLBtoGLTF.h>
+#include <GLTFLODUtils.h>
+#include <GLTFTextureCompressionUtils.h>
+#include <GLTFTextureLoadingUtils.h>
+#include <GLTFTexturePackingUtils.h>
+#include <SerializeBinary.h>
+
+#include <DirectXTex.h>
+
+#include <cmath>
+#include <random>
+#include <unordered_map>
+
+#include "Benchmarks.h"
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    const std::vector<size_t> c_textureSizes = { 256, 1024, 2048 };
+    const std::vector<size_t> c_softwareTextureSizes = { 256, 512 };
+    const std::vector<size_t> c_accessorCounts = { 1000, 100000, 1000000 };
+    const std::vector<size_t> c_vertexCounts = { 10000, 100000, 1000000 };
+    const std::vector<size_t> c_lodCounts = { 2, 4, 8 };
+    const size_t c_lodVertexCount = 10000;
+    const uint32_t c_seed = 42;
+
+    // Serves each URI from memory, so that synthetic assets don't depend on the disk
+    class MemoryStreamReader : public IStreamReader
+    {
+    public:
+        void Add(const std::string& uri, std::string contents)
+        {
+            m_contents[uri] = std::move(contents);
+        }
+
+        std::shared_ptr<std::istream> GetInputStream(const std::string& uri) const override
+        {
+            return std::make_shared<std::stringstream>(m_contents.at(uri), std::ios_base::binary | std::ios_base::in);
+        }
+    private:
+        std::unordered_map<std::string, std::string> m_contents;
+    };
+
+    class FileStreamReader : public IStreamReader
+    {
+    public:
+        FileStreamReader(std::string basePath) : m_basePath(std::move(basePath)) {}
+
+        std::shared_ptr<std::istream> GetInputStream(const std::string& filename) const override
+        {
+            return std::make_shared<std::ifstream>(m_basePath + filename, std::ios::binary);
+        }
+    private:
+        const std::string m_basePath;
+    };
+
+    class OutputStreamFactory : public IStreamFactory
+    {
+    public:
+        OutputStreamFactory(std::shared_ptr<std::ostream> stream) : m_stream(std::move(stream)) {}
+
+        std::shared_ptr<std::istream> GetInputStream(const std::string&) const override
+        {
+            throw std::logic_error("Not implemented");
+        }
+
+        std::shared_ptr<std::ostream> GetOutputStream(const std::string&) const override
+        {
+            return m_stream;
+        }
+
+        std::shared_ptr<std::iostream> GetTemporaryStream(const std::string&) const override
+        {
+            throw std::logic_error("Not implemented");
+        }
+    private:
+        std::shared_ptr<std::ostream> m_stream;
+    };
+
+    struct Asset
+    {
+        GLTFDocument doc;
+        std::shared_ptr<IStreamReader> streamReader;
+    };
+
+    // Builds the input of a benchmark when it is prepared, so that only the cases that run allocate their inputs
+    typedef std::function<Asset()> AssetSource;
+    typedef std::function<DirectX::ScratchImage()> ImageSource;
+
+    // Smooth gradients with some noise, which encoders handle more like real textures than flat colors or pure noise
+    DirectX::ScratchImage MakeImage(size_t size, uint32_t seed)
+    {
+        DirectX::ScratchImage image;
+        if (FAILED(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, size, size, 1, 1)))
+        {
+            throw std::runtime_error("Failed to create the synthetic image.");
+        }
+
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> noise(-16, 16);
+        const auto* target = image.GetImage(0, 0, 0);
+        for (size_t y = 0; y < size; y++)
+        {
+            uint8_t* row = target->pixels + y * target->rowPitch;
+            for (size_t x = 0; x < size; x++)
+            {
+                const int gradient[] = { static_cast<int>(x * 255 / size), static_cast<int>(y * 255 / size), static_cast<int>((x + y) * 127 / size) };
+                for (size_t channel = 0; channel < 3; channel++)
+                {
+                    row[x * 4 + channel] = static_cast<uint8_t>(std::clamp(gradient[channel] + noise(random), 0, 255));
+                }
+                row[x * 4 + 3] = 255;
+            }
+        }
+
+        return image;
+    }
+
+    std::string EncodePng(const DirectX::ScratchImage& image)
+    {
+        DirectX::Blob blob;
+        if (FAILED(DirectX::SaveToWICMemory(*image.GetImage(0, 0, 0), DirectX::WIC_FLAGS_NONE, GUID_ContainerFormatPng, blob)))
+        {
+            throw std::runtime_error("Failed to encode the synthetic image.");
+        }
+
+        return std::string(static_cast<const char*>(blob.GetBufferPointer()), blob.GetBufferSize());
+    }
+
+    // A document with one PNG texture per image, each of the given size, and a material that uses the first one
+    // as its metallic-roughness texture and the second one (if any) as its occlusion texture
+    Asset MakeTextureAsset(size_t size, size_t imageCount)
+    {
+        Asset asset;
+        auto streamReader = std::make_shared<MemoryStreamReader>();
+
+        for (size_t i = 0; i < imageCount; i++)
+        {
+            std::string id = std::to_string(i);
+
+            Image image;
+            image.id = id;
+            image.uri = "texture" + id + "_" + std::to_string(size) + ".png";
+            streamReader->Add(image.uri, EncodePng(MakeImage(size, c_seed + static_cast<uint32_t>(i))));
+            asset.doc.images.Append(std::move(image));
+
+            Texture texture;
+            texture.id = id;
+            texture.imageId = id;
+            asset.doc.textures.Append(std::move(texture));
+        }
+
+        Material material;
+        material.id = "0";
+        material.metallicRoughness.metallicRoughnessTextureId = "0";
+        if (imageCount > 1)
+        {
+            material.occlusionTexture.id = "1";
+        }
+        asset.doc.materials.Append(std::move(material));
+
+        asset.streamReader = streamReader;
+        return asset;
+    }
+
+    // A grid mesh of about vertexCount vertices, with positions, normals, texture coordinates and 32-bit indices,
+    // drawn by the only node of the default scene
+    Asset MakeMeshAsset(size_t vertexCount)
+    {
+        const uint32_t size = std::max(2u, static_cast<uint32_t>(std::sqrt(static_cast<double>(vertexCount))));
+
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<float> texCoords;
+        std::vector<uint32_t> indices;
+
+        std::mt19937 random(c_seed);
+        std::uniform_real_distribution<float> height(0.0f, 0.1f);
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                positions.insert(positions.end(), { static_cast<float>(x), height(random), static_cast<float>(y) });
+                normals.insert(normals.end(), { 0.0f, 1.0f, 0.0f });
+                texCoords.insert(texCoords.end(), { static_cast<float>(x) / static_cast<float>(size - 1), static_cast<float>(y) / static_cast<float>(size - 1) });
+            }
+        }
+
+        for (uint32_t y = 0; y + 1 < size; y++)
+        {
+            for (uint32_t x = 0; x + 1 < size; x++)
+            {
+                uint32_t corner = y * size + x;
+                indices.insert(indices.end(), { corner, corner + size + 1, corner + 1, corner, corner + size, corner + size + 1 });
+            }
+        }
+
+        Asset asset;
+        asset.doc = GLTFDocument("0", {});
+        std::string data;
+
+        auto addAccessor = [&](const auto& values, AccessorType type, ComponentType componentType, BufferViewTarget target)
+        {
+            BufferView bufferView;
+            bufferView.id = std::to_string(asset.doc.bufferViews.Size());
+            bufferView.bufferId = "0";
+            bufferView.byteOffset = data.size();
+            bufferView.byteLength = values.size() * sizeof(values[0]);
+            bufferView.target = target;
+            data.append(reinterpret_cast<const char*>(values.data()), bufferView.byteLength);
+
+            Accessor accessor;
+            accessor.id = std::to_string(asset.doc.accessors.Size());
+            accessor.bufferViewId = bufferView.id;
+            accessor.componentType = componentType;
+            accessor.type = type;
+            accessor.count = values.size() / Accessor::GetTypeCount(type);
+
+            asset.doc.bufferViews.Append(std::move(bufferView));
+            asset.doc.accessors.Append(std::move(accessor));
+            return std::to_string(asset.doc.accessors.Size() - 1);
+        };
+
+        MeshPrimitive primitive;
+        primitive.positionsAccessorId = addAccessor(positions, AccessorType::TYPE_VEC3, ComponentType::COMPONENT_FLOAT, BufferViewTarget::ARRAY_BUFFER);
+        primitive.normalsAccessorId = addAccessor(normals, AccessorType::TYPE_VEC3, ComponentType::COMPONENT_FLOAT, BufferViewTarget::ARRAY_BUFFER);
+        primitive.uv0AccessorId = addAccessor(texCoords, AccessorType::TYPE_VEC2, ComponentType::COMPONENT_FLOAT, BufferViewTarget::ARRAY_BUFFER);
+        primitive.indicesAccessorId = addAccessor(indices, AccessorType::TYPE_SCALAR, ComponentType::COMPONENT_UNSIGNED_INT, BufferViewTarget::ELEMENT_ARRAY_BUFFER);
+        primitive.mode = MeshMode::MESH_TRIANGLES;
+
+        Mesh mesh;
+        mesh.id = "0";
+        mesh.primitives.push_back(std::move(primitive));
+        asset.doc.meshes.Append(std::move(mesh));
+
+        Node node;
+        node.id = "0";
+        node.meshId = "0";
+        asset.doc.nodes.Append(std::move(node));
+
+        Scene scene;
+        scene.id = "0";
+        scene.nodes.push_back("0");
+        asset.doc.scenes.Append(std::move(scene));
+
+        Buffer buffer;
+        buffer.id = "0";
+        buffer.uri = "mesh" + std::to_string(vertexCount) + ".bin";
+        buffer.byteLength = data.size();
+        asset.doc.buffers.Append(std::move(buffer));
+
+        auto streamReader = std::make_shared<MemoryStreamReader>();
+        streamReader->Add("mesh" + std::to_string(vertexCount) + ".bin", std::move(data));
+        asset.streamReader = streamReader;
+        return asset;
+    }
+
+    AssetSource LoadResourceAsset(const std::string& gltfPath)
+    {
+        return [gltfPath]()
+        {
+            std::ifstream input(gltfPath, std::ios::binary);
+            if (!input)
+            {
+                throw std::runtime_error("Could not open " + gltfPath);
+            }
+
+            Asset asset;
+            asset.doc = DeserializeJson(std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()));
+            asset.streamReader = std::make_shared<FileStreamReader>(gltfPath.substr(0, gltfPath.find_last_of("\\/") + 1));
+            return asset;
+        };
+    }
+
+    BenchmarkCase LoadTextureBenchmark(std::string parameter, AssetSource source, std::string textureId)
+    {
+        return { "LoadTexture", std::move(parameter), [source, textureId]()
+        {
+            auto asset = std::make_shared<Asset>(source());
+            return std::function<void()>([asset, textureId]()
+            {
+                GLTFTextureLoadingUtils::LoadTexture(*asset->streamReader, asset->doc, textureId);
+            });
+        } };
+    }
+
+    BenchmarkCase PackMaterialBenchmark(std::string parameter, AssetSource source, std::string materialId, std::string outputDirectory)
+    {
+        return { "PackMaterialForWindowsMR", std::move(parameter), [source, materialId, outputDirectory]()
+        {
+            auto asset = std::make_shared<Asset>(source());
+            return std::function<void()>([asset, materialId, outputDirectory]()
+            {
+                GLTFTexturePackingUtils::PackMaterialForWindowsMR(*asset->streamReader, asset->doc, asset->doc.materials.Get(materialId), TexturePacking::OcclusionRoughnessMetallic, outputDirectory);
+            });
+        } };
+    }
+
+    // The GPU case goes through the toolkit, which falls back to software compression if no device can be created.
+    // The software case calls DirectXTex the way that fallback does, so that it is measured even on a machine with a GPU.
+    BenchmarkCase CompressImageBenchmark(std::string parameter, ImageSource source, TextureCompression compression, bool software)
+    {
+        return { software ? "CompressImage.Software" : "CompressImage.GPU", std::move(parameter), [source, compression, software]()
+        {
+            auto image = std::make_shared<DirectX::ScratchImage>(source());
+            return std::function<void()>([image, compression, software]()
+            {
+                if (software)
+                {
+                    DirectX::ScratchImage compressedImage;
+                    DXGI_FORMAT format = compression == TextureCompression::BC3 ? DXGI_FORMAT_BC3_UNORM : (compression == TextureCompression::BC5 ? DXGI_FORMAT_BC5_UNORM : DXGI_FORMAT_BC7_UNORM);
+                    if (FAILED(DirectX::Compress(image->GetImages(), image->GetImageCount(), image->GetMetadata(), format, DirectX::TEX_COMPRESS_DEFAULT, 0, compressedImage)))
+                    {
+                        throw std::runtime_error("Failed to compress the image.");
+                    }
+                }
+                else
+                {
+                    // CompressImage works in place, so each iteration compresses a copy of the source image
+                    DirectX::ScratchImage copy;
+                    if (FAILED(copy.InitializeFromImage(*image->GetImage(0, 0, 0))))
+                    {
+                        throw std::runtime_error("Failed to copy the image.");
+                    }
+
+                    GLTFTextureCompressionUtils::CompressImage(copy, compression);
+                }
+            });
+        } };
+    }
+
+    BenchmarkCase CalculateMinMaxBenchmark(size_t count)
+    {
+        return { "CalculateMinMax", std::to_string(count) + " vec3", [count]()
+        {
+            auto accessor = std::make_shared<Accessor>();
+            accessor->type = AccessorType::TYPE_VEC3;
+            accessor->componentType = ComponentType::COMPONENT_FLOAT;
+            accessor->count = count;
+
+            auto values = std::make_shared<std::vector<float>>(count * 3);
+            std::mt19937 random(c_seed);
+            std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+            std::generate(values->begin(), values->end(), [&]() { return distribution(random); });
+
+            return std::function<void()>([accessor, values]()
+            {
+                AccessorUtils::CalculateMinMax(*accessor, *values);
+            });
+        } };
+    }
+
+    BenchmarkCase SerializeBinaryBenchmark(std::string parameter, AssetSource source)
+    {
+        return { "SerializeBinary", std::move(parameter), [source]()
+        {
+            auto asset = std::make_shared<Asset>(source());
+            return std::function<void()>([asset]()
+            {
+                std::unique_ptr<const IStreamFactory> streamFactory = std::make_unique<OutputStreamFactory>(
+                    std::make_shared<std::stringstream>(std::ios_base::binary | std::ios_base::in | std::ios_base::out));
+                SerializeBinary(asset->doc, *asset->streamReader, streamFactory);
+            });
+        } };
+    }
+
+    BenchmarkCase UnpackGLBBenchmark(std::string parameter, std::string name, AssetSource source, std::string tempDirectory)
+    {
+        return { "UnpackGLB", std::move(parameter), [source, name, tempDirectory]()
+        {
+            auto asset = source();
+            auto glbPath = tempDirectory + name + ".glb";
+            {
+                std::unique_ptr<const IStreamFactory> streamFactory = std::make_unique<OutputStreamFactory>(
+                    std::make_shared<std::ofstream>(glbPath, std::ios_base::binary | std::ios_base::out));
+                SerializeBinary(asset.doc, *asset.streamReader, streamFactory);
+            }
+
+            return std::function<void()>([glbPath, name, tempDirectory]()
+            {
+                GLBToGLTF::UnpackGLB(glbPath, tempDirectory, name + "_unpacked");
+            });
+        } };
+    }
+
+    BenchmarkCase MergeDocumentsAsLODsBenchmark(std::string parameter, AssetSource source, size_t lodCount)
+    {
+        return { "MergeDocumentsAsLODs", std::move(parameter), [source, lodCount]()
+        {
+            auto lods = std::make_shared<std::vector<GLTFDocument>>(lodCount, source().doc);
+            return std::function<void()>([lods]()
+            {
+                GLTFLODUtils::MergeDocumentsAsLODs(*lods);
+            });
+        } };
+    }
+
+    bool FileExists(const std::string& path)
+    {
+        return std::ifstream(path).good();
+    }
+}
+
+std::string GetDefaultResourcesDirectory()
+{
+    std::string sourcePath = __FILE__;
+    std::string solutionPath = sourcePath.substr(0, sourcePath.substr(0, sourcePath.find_last_of("\\/")).find_last_of("\\/") + 1);
+    return solutionPath + "glTF-Toolkit.Test\\Resources\\gltf\\";
+}
+
+std::vector<BenchmarkCase> GetToolkitBenchmarks(const std::string& resourcesDirectory, const std::string& tempDirectory)
+{
+    std::vector<BenchmarkCase> benchmarks;
+
+    for (auto size : c_textureSizes)
+    {
+        benchmarks.push_back(LoadTextureBenchmark(std::to_string(size), [size]() { return MakeTextureAsset(size, 1); }, "0"));
+    }
+
+    for (auto size : c_textureSizes)
+    {
+        benchmarks.push_back(PackMaterialBenchmark(std::to_string(size), [size]() { return MakeTextureAsset(size, 2); }, "0", tempDirectory));
+    }
+
+    for (auto size : c_textureSizes)
+    {
+        benchmarks.push_back(CompressImageBenchmark("BC7 " + std::to_string(size), [size]() { return MakeImage(size, c_seed); }, TextureCompression::BC7, false));
+    }
+
+    for (auto size : c_softwareTextureSizes)
+    {
+        benchmarks.push_back(CompressImageBenchmark("BC3 " + std::to_string(size), [size]() { return MakeImage(size, c_seed); }, TextureCompression::BC3, true));
+        benchmarks.push_back(CompressImageBenchmark("BC7 " + std::to_string(size), [size]() { return MakeImage(size, c_seed); }, TextureCompression::BC7, true));
+    }
+
+    for (auto count : c_accessorCounts)
+    {
+        benchmarks.push_back(CalculateMinMaxBenchmark(count));
+    }
+
+    for (auto count : c_vertexCounts)
+    {
+        benchmarks.push_back(SerializeBinaryBenchmark(std::to_string(count) + " vertices", [count]() { return MakeMeshAsset(count); }));
+    }
+
+    for (auto count : c_vertexCounts)
+    {
+        benchmarks.push_back(UnpackGLBBenchmark(std::to_string(count) + " vertices", "mesh" + std::to_string(count), [count]() { return MakeMeshAsset(count); }, tempDirectory));
+    }
+
+    for (auto lodCount : c_lodCounts)
+    {
+        benchmarks.push_back(MergeDocumentsAsLODsBenchmark(std::to_string(lodCount) + " LODs", []() { return MakeMeshAsset(c_lodVertexCount); }, lodCount));
+    }
+
+    // The sample assets, when the folder is available
+    auto waterBottlePath = resourcesDirectory + "WaterBottle\\WaterBottle.gltf";
+    if (FileExists(waterBottlePath))
+    {
+        auto waterBottle = LoadResourceAsset(waterBottlePath);
+        benchmarks.push_back(LoadTextureBenchmark("WaterBottle baseColor", waterBottle, "0"));
+        benchmarks.push_back(PackMaterialBenchmark("WaterBottle", waterBottle, "0", tempDirectory));
+        benchmarks.push_back(CompressImageBenchmark("BC7 WaterBottle baseColor", [waterBottle]()
+        {
+            auto asset = waterBottle();
+            return GLTFTextureLoadingUtils::LoadTexture(*asset.streamReader, asset.doc, "0");
+        }, TextureCompression::BC7, false));
+        benchmarks.push_back(SerializeBinaryBenchmark("WaterBottle", waterBottle));
+        benchmarks.push_back(UnpackGLBBenchmark("WaterBottle", "WaterBottle", waterBottle, tempDirectory));
+    }
+
+    auto cubePath = resourcesDirectory + "CubeAsset3D.gltf";
+    if (FileExists(cubePath))
+    {
+        auto cube = LoadResourceAsset(cubePath);
+        for (auto lodCount : c_lodCounts)
+        {
+            benchmarks.push_back(MergeDocumentsAsLODsBenchmark("CubeAsset3D " + std::to_string(lodCount) + " LODs", cube, lodCount));
+        }
+    }
+
+    return benchmarks;
+}
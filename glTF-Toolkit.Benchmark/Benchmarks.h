@@ -0,0 +1,14 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include "Benchmark.h"
+
+// Gets the default folder of the sample assets, which are shared with the unit tests
+std::string GetDefaultResourcesDirectory();
+
+// Gets the benchmarks of the toolkit hot paths, on synthetic inputs of several sizes and on the sample assets in
+// resourcesDirectory. Synthetic inputs are generated from fixed seeds, so that every run measures the same data.
+// Both folders must end with a path separator; files written by the benchmarks go to tempDirectory.
+std::vector<BenchmarkCase> GetToolkitBenchmarks(const std::string& resourcesDirectory, const std::string& tempDirectory);
@@ -0,0 +1,208 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+
+#include <iomanip>
+
+#include "Benchmarks.h"
+
+const wchar_t * PARAM_FILTER = L"-filter";
+const wchar_t * PARAM_LIST = L"-list";
+const wchar_t * PARAM_OUTFILE = L"-o";
+const wchar_t * PARAM_BASELINE = L"-baseline";
+const wchar_t * PARAM_THRESHOLD = L"-threshold";
+const wchar_t * PARAM_MINTIME = L"-min-time";
+const wchar_t * PARAM_MINITERATIONS = L"-min-iterations";
+const wchar_t * PARAM_RESOURCES = L"-resources";
+const double DEFAULT_THRESHOLD = 0.1;
+
+void PrintHelp()
+{
+    std::wcerr << std::endl
+        << L"Benchmarks the glTF Toolkit hot paths on synthetic inputs and on the sample assets." << std::endl << std::endl
+        << L"Usage: glTF-Toolkit.Benchmark "
+        << L"[" << PARAM_FILTER << L" <text>] "
+        << L"[" << PARAM_LIST << L"] "
+        << L"[" << PARAM_OUTFILE << L" <results.csv>] "
+        << L"[" << PARAM_BASELINE << L" <baseline.csv>] "
+        << L"[" << PARAM_THRESHOLD << L" <fraction>] "
+        << L"[" << PARAM_MINTIME << L" <seconds>] "
+        << L"[" << PARAM_MINITERATIONS << L" <count>] "
+        << L"[" << PARAM_RESOURCES << L" <folder>]" << std::endl << std::endl
+        << PARAM_FILTER << L": only runs the benchmarks whose name or parameter contains the text" << std::endl
+        << PARAM_LIST << L": lists the benchmarks without running them" << std::endl
+        << PARAM_OUTFILE << L": saves the results as CSV, to be used later as a baseline" << std::endl
+        << PARAM_BASELINE << L": compares the results with a previous run, and fails if any benchmark regressed" << std::endl
+        << PARAM_THRESHOLD << L": the slowdown of the median time that counts as a regression (default: " << DEFAULT_THRESHOLD << L")" << std::endl
+        << PARAM_MINTIME << L": the minimum time spent measuring each benchmark (default: 1 second)" << std::endl
+        << PARAM_MINITERATIONS << L": the minimum number of timed iterations of each benchmark (default: 5)" << std::endl
+        << PARAM_RESOURCES << L": the folder of the sample assets (default: the unit test resources)" << std::endl;
+}
+
+std::string GetTempDirectory()
+{
+    char tempPath[MAX_PATH];
+    if (GetTempPathA(ARRAYSIZE(tempPath), tempPath) == 0)
+    {
+        throw std::runtime_error("Could not get the temporary folder.");
+    }
+
+    std::string tempDirectory = std::string(tempPath) + "glTF-Toolkit.Benchmark\\";
+    if (!CreateDirectoryA(tempDirectory.c_str(), NULL) && GetLastError() != ERROR_ALREADY_EXISTS)
+    {
+        throw std::runtime_error("Could not create the temporary folder " + tempDirectory);
+    }
+
+    return tempDirectory;
+}
+
+int RunBenchmarks(int argc, wchar_t *argv[])
+{
+    std::string filter;
+    bool listOnly = false;
+    std::wstring outFile;
+    std::wstring baselineFile;
+    double threshold = DEFAULT_THRESHOLD;
+    BenchmarkOptions options;
+    std::string resourcesDirectory = GetDefaultResourcesDirectory();
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::wstring param = argv[i];
+        if (param == PARAM_LIST)
+        {
+            listOnly = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+        {
+            PrintHelp();
+            throw std::invalid_argument("Missing value for parameter.");
+        }
+
+        std::wstring value = argv[++i];
+        if (param == PARAM_FILTER)
+        {
+            filter = std::string(value.begin(), value.end());
+        }
+        else if (param == PARAM_OUTFILE)
+        {
+            outFile = value;
+        }
+        else if (param == PARAM_BASELINE)
+        {
+            baselineFile = value;
+        }
+        else if (param == PARAM_THRESHOLD)
+        {
+            threshold = std::stod(value);
+        }
+        else if (param == PARAM_MINTIME)
+        {
+            options.minSeconds = std::stod(value);
+        }
+        else if (param == PARAM_MINITERATIONS)
+        {
+            options.minIterations = std::max<size_t>(1, std::stoul(value));
+        }
+        else if (param == PARAM_RESOURCES)
+        {
+            resourcesDirectory = std::string(value.begin(), value.end());
+            if (!resourcesDirectory.empty() && resourcesDirectory.back() != '\\' && resourcesDirectory.back() != '/')
+            {
+                resourcesDirectory += '\\';
+            }
+        }
+        else
+        {
+            PrintHelp();
+            throw std::invalid_argument("Unknown parameter.");
+        }
+    }
+
+    std::vector<BenchmarkResult> baseline;
+    if (!baselineFile.empty())
+    {
+        std::ifstream baselineStream(baselineFile);
+        if (!baselineStream)
+        {
+            throw std::invalid_argument("Could not open the baseline file.");
+        }
+
+        baseline = ReadBenchmarkResults(baselineStream);
+    }
+
+    auto benchmarks = GetToolkitBenchmarks(resourcesDirectory, GetTempDirectory());
+    benchmarks.erase(std::remove_if(benchmarks.begin(), benchmarks.end(), [&](const BenchmarkCase& benchmarkCase)
+    {
+        return benchmarkCase.name.find(filter) == std::string::npos && benchmarkCase.parameter.find(filter) == std::string::npos;
+    }), benchmarks.end());
+
+    if (listOnly)
+    {
+        for (const auto& benchmarkCase : benchmarks)
+        {
+            std::cout << benchmarkCase.name << " (" << benchmarkCase.parameter << ")" << std::endl;
+        }
+
+        return 0;
+    }
+
+    std::vector<BenchmarkResult> results;
+    size_t failures = 0;
+
+    std::cout << std::left << std::setw(32) << "Benchmark" << std::setw(28) << "Parameter" << std::right
+        << std::setw(12) << "Iterations" << std::setw(14) << "Median (ms)" << std::setw(14) << "Min (ms)" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (const auto& benchmarkCase : benchmarks)
+    {
+        std::cout << std::left << std::setw(32) << benchmarkCase.name << std::setw(28) << benchmarkCase.parameter << std::right << std::flush;
+
+        try
+        {
+            auto result = RunBenchmark(benchmarkCase, options);
+            std::cout << std::setw(12) << result.iterations << std::setw(14) << result.medianMilliseconds << std::setw(14) << result.minMilliseconds << std::endl;
+            results.push_back(std::move(result));
+        }
+        catch (const std::exception& ex)
+        {
+            std::cout << "  FAILED: " << ex.what() << std::endl;
+            failures++;
+        }
+    }
+
+    if (!outFile.empty())
+    {
+        std::ofstream outStream(outFile);
+        WriteBenchmarkResults(results, outStream);
+    }
+
+    size_t regressions = 0;
+    if (!baselineFile.empty())
+    {
+        std::cout << std::endl << "Compared with the baseline (threshold " << threshold * 100 << "%):" << std::endl;
+        regressions = CompareBenchmarkResults(results, baseline, threshold, std::cout);
+        std::cout << regressions << " regression(s)" << std::endl;
+    }
+
+    return failures == 0 && regressions == 0 ? 0 : 1;
+}
+
+int wmain(int argc, wchar_t *argv[])
+{
+    // Initialize COM
+    CoInitialize(NULL);
+
+    try
+    {
+        return RunBenchmarks(argc, argv);
+    }
+    catch (std::exception ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+}
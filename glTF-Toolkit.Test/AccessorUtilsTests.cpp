@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>  
+
+#include "AccessorUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(AccessorUtilsTests)
+    {
+        // Checks the fused kernel against a plain cast followed by CalculateMinMax
+        template <typename Source, typename Destination, size_t TypeCount>
+        static void CheckConvertWithMinMax(const std::vector<Source>& source, AccessorType type)
+        {
+            Accessor accessor;
+            accessor.type = type;
+            accessor.count = source.size() / TypeCount;
+
+            std::vector<Destination> expected(source.size());
+            std::transform(source.begin(), source.end(), expected.begin(), [](Source value) { return static_cast<Destination>(value); });
+            auto expectedMinMax = AccessorUtils::CalculateMinMax(accessor, expected);
+
+            std::vector<Destination> converted(source.size());
+            std::vector<float> min, max;
+            AccessorUtils::ConvertWithMinMax<Source, Destination, TypeCount>(source.data(), accessor.count, converted.data(), min, max);
+
+            Assert::IsTrue(expected == converted);
+            Assert::IsTrue(expectedMinMax.first == min);
+            Assert::IsTrue(expectedMinMax.second == max);
+        }
+
+        template <typename T>
+        static std::vector<T> MakeSequence(size_t size, int64_t first, int64_t step)
+        {
+            std::vector<T> values(size);
+            for (size_t i = 0; i < size; i++)
+            {
+                values[i] = static_cast<T>(first + static_cast<int64_t>((i * 7919) % size) * step);
+            }
+
+            return values;
+        }
+
+        TEST_METHOD(AccessorUtils_ConvertWithMinMax_Vec3ShortToFloat)
+        {
+            // 13 elements leave a tail after the vectorized blocks of 4 elements
+            CheckConvertWithMinMax<int16_t, float, 3>(MakeSequence<int16_t>(39, -20000, 1000), TYPE_VEC3);
+            CheckConvertWithMinMax<uint16_t, float, 3>(MakeSequence<uint16_t>(39, 0, 1600), TYPE_VEC3);
+        }
+
+        TEST_METHOD(AccessorUtils_ConvertWithMinMax_Vec2ByteToFloat)
+        {
+            CheckConvertWithMinMax<int8_t, float, 2>(MakeSequence<int8_t>(22, -120, 11), TYPE_VEC2);
+            CheckConvertWithMinMax<uint8_t, float, 2>(MakeSequence<uint8_t>(22, 0, 11), TYPE_VEC2);
+        }
+
+        TEST_METHOD(AccessorUtils_ConvertWithMinMax_LargeUnsignedIntToFloat)
+        {
+            // Values above INT32_MAX must convert as unsigned
+            CheckConvertWithMinMax<uint32_t, float, 1>(MakeSequence<uint32_t>(17, 0, 250000000), TYPE_SCALAR);
+        }
+
+        TEST_METHOD(AccessorUtils_ConvertWithMinMax_Mat4FloatToFloat)
+        {
+            CheckConvertWithMinMax<float, float, 16>(MakeSequence<float>(48, -24, 1), TYPE_MAT4);
+        }
+
+        TEST_METHOD(AccessorUtils_ConvertWithMinMax_IntegerDestination)
+        {
+            CheckConvertWithMinMax<uint16_t, uint32_t, 1>(MakeSequence<uint16_t>(10, 0, 6000), TYPE_SCALAR);
+        }
+
+        TEST_METHOD(AccessorUtils_AccumulateMinMax_Blocks)
+        {
+            const std::vector<float> values = { 1.0f, 5.0f, -3.0f, 2.0f, 4.0f, -7.0f };
+            std::vector<float> min, max;
+
+            // Two elements at a time, as if they were read in blocks
+            AccessorUtils::AccumulateMinMax(values.data(), 1, 2, min, max);
+            AccessorUtils::AccumulateMinMax(values.data() + 2, 2, 2, min, max);
+
+            Assert::IsTrue(min == std::vector<float>({ -3.0f, -7.0f }));
+            Assert::IsTrue(max == std::vector<float>({ 4.0f, 5.0f }));
+        }
+    };
+}
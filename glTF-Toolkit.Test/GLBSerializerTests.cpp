@@ -50,6 +50,48 @@ namespace Microsoft::glTF::Toolkit::Test
         std::shared_ptr<std::stringstream> m_tempStream;
     };
 
+    // A factory that only hands out the output stream, to check that the serializer doesn't need a temporary copy
+    class OutputOnlyStreamFactory : public Microsoft::glTF::IStreamFactory
+    {
+    public:
+        OutputOnlyStreamFactory(std::shared_ptr<std::stringstream> stream) :
+            m_stream(stream)
+        { }
+
+        std::shared_ptr<std::istream> GetInputStream(const std::string&) const override
+        {
+            throw std::logic_error("Not implemented");
+        }
+
+        std::shared_ptr<std::ostream> GetOutputStream(const std::string&) const override
+        {
+            return m_stream;
+        }
+
+        std::shared_ptr<std::iostream> GetTemporaryStream(const std::string&) const override
+        {
+            throw std::logic_error("Not implemented");
+        }
+    private:
+        std::shared_ptr<std::stringstream> m_stream;
+    };
+
+    // A reader that serves a single buffer from memory, whatever the URI
+    class InMemoryStreamReader : public IStreamReader
+    {
+    public:
+        InMemoryStreamReader(const std::string& data) :
+            m_data(data)
+        { }
+
+        std::shared_ptr<std::istream> GetInputStream(const std::string&) const override
+        {
+            return std::make_shared<std::stringstream>(m_data, std::ios_base::binary | std::ios_base::in);
+        }
+    private:
+        const std::string m_data;
+    };
+
     TEST_CLASS(GLBSerializerTests)
     {
 
@@ -144,5 +186,379 @@ namespace Microsoft::glTF::Toolkit::Test
                 Assert::Fail(WStringUtils::ToWString(ss).c_str());
             }
         }
+
+        TEST_METHOD(GLBSerializerTests_RoundTrip_StreamedAccessors)
+        {
+            auto data = ReadLocalJson(c_waterBottleJson);
+            auto doc = DeserializeJson(data);
+
+            // Serialize GLTFDocument to GLB, converting the indices to 32 bits along the way
+            TestStreamReader streamReader(TestUtils::GetAbsolutePath(c_waterBottleJson));
+            auto stream = std::make_shared<std::stringstream>(std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+            std::unique_ptr<const IStreamFactory> streamFactory = std::make_unique<OutputOnlyStreamFactory>(stream);
+            SerializeBinary(doc, streamReader, streamFactory, [](const Accessor& accessor)
+            {
+                return accessor.componentType == COMPONENT_UNSIGNED_SHORT ? COMPONENT_UNSIGNED_INT : accessor.componentType;
+            });
+
+            // The length in the header must match what was written
+            auto glb = stream->str();
+            Assert::IsTrue(glb.size() > GLB2_HEADER_BYTE_SIZE);
+            uint32_t totalLength = 0;
+            memcpy(&totalLength, glb.data() + 8, sizeof(totalLength));
+            Assert::AreEqual(glb.size(), static_cast<size_t>(totalLength));
+
+            GLBResourceReader glbReader(streamReader, stream);
+            auto outputDoc = DeserializeJson(glbReader.GetJson());
+
+            GLTFResourceReader gltfReader(streamReader);
+            Assert::AreEqual(doc.accessors.Size(), outputDoc.accessors.Size());
+            for (const auto& accessor : doc.accessors.Elements())
+            {
+                const auto& outputAccessor = outputDoc.accessors.Get(accessor.id);
+                Assert::AreEqual(accessor.count, outputAccessor.count);
+                Assert::IsFalse(outputAccessor.min.empty());
+                Assert::IsFalse(outputAccessor.max.empty());
+                Assert::AreEqual(static_cast<size_t>(0), outputDoc.bufferViews.Get(outputAccessor.bufferViewId).byteOffset % GLB_BUFFER_OFFSET_ALIGNMENT);
+
+                if (accessor.componentType == COMPONENT_FLOAT)
+                {
+                    Assert::IsTrue(gltfReader.ReadBinaryData<float>(doc, accessor) == glbReader.ReadBinaryData<float>(outputDoc, outputAccessor));
+                }
+                else if (accessor.componentType == COMPONENT_UNSIGNED_SHORT)
+                {
+                    Assert::IsTrue(outputAccessor.componentType == COMPONENT_UNSIGNED_INT);
+
+                    auto original = gltfReader.ReadBinaryData<uint16_t>(doc, accessor);
+                    auto converted = glbReader.ReadBinaryData<uint32_t>(outputDoc, outputAccessor);
+                    Assert::IsTrue(std::equal(original.begin(), original.end(), converted.begin(), converted.end()));
+                }
+            }
+        }
+
+        TEST_METHOD(GLBSerializerTests_RoundTrip_InterleavedAccessors)
+        {
+            // Two accessors share an 8-byte stride: a VEC2 of unsigned shorts followed by a float
+            const uint16_t shorts[] = { 1, 9, 5, 2, 3, 7 };
+            const float floats[] = { 0.5f, -2.0f, 4.0f };
+            std::string bufferData(24, '\0');
+            for (size_t i = 0; i < 3; i++)
+            {
+                memcpy(&bufferData[i * 8], &shorts[i * 2], 2 * sizeof(uint16_t));
+                memcpy(&bufferData[i * 8 + 4], &floats[i], sizeof(float));
+            }
+
+            const char* json = R"({
+                "asset": { "version": "2.0" },
+                "buffers": [ { "uri": "interleaved.bin", "byteLength": 24 } ],
+                "bufferViews": [ { "buffer": 0, "byteOffset": 0, "byteLength": 24, "byteStride": 8, "target": 34962 } ],
+                "accessors": [
+                    { "bufferView": 0, "byteOffset": 0, "componentType": 5123, "count": 3, "type": "VEC2" },
+                    { "bufferView": 0, "byteOffset": 4, "componentType": 5126, "count": 3, "type": "SCALAR" }
+                ]
+            })";
+            auto doc = DeserializeJson(json);
+
+            InMemoryStreamReader streamReader(bufferData);
+            auto stream = std::make_shared<std::stringstream>(std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+            std::unique_ptr<const IStreamFactory> streamFactory = std::make_unique<OutputOnlyStreamFactory>(stream);
+            SerializeBinary(doc, streamReader, streamFactory);
+
+            GLBResourceReader glbReader(streamReader, stream);
+            auto outputDoc = DeserializeJson(glbReader.GetJson());
+
+            // The accessors are copied out of the interleaved bufferView into tightly packed ones
+            auto shortAccessor = outputDoc.accessors.Get("0");
+            auto floatAccessor = outputDoc.accessors.Get("1");
+            Assert::IsTrue(glbReader.ReadBinaryData<uint16_t>(outputDoc, shortAccessor) == std::vector<uint16_t>(std::begin(shorts), std::end(shorts)));
+            Assert::IsTrue(glbReader.ReadBinaryData<float>(outputDoc, floatAccessor) == std::vector<float>(std::begin(floats), std::end(floats)));
+
+            Assert::IsTrue(shortAccessor.min == std::vector<float>({ 1.0f, 2.0f }));
+            Assert::IsTrue(shortAccessor.max == std::vector<float>({ 5.0f, 9.0f }));
+            Assert::IsTrue(floatAccessor.min == std::vector<float>({ -2.0f }));
+            Assert::IsTrue(floatAccessor.max == std::vector<float>({ 4.0f }));
+        }
+
+        TEST_METHOD(GLBSerializerTests_RoundTrip_PaddedVertexAttributes)
+        {
+            // Normalized byte normals, padded to a 4-byte stride, and indices, which are not padded
+            const int8_t normals[] = { 0, 0, 127, 0x55, 0, 0, -127, 0x55, 90, 0, 90 };
+            std::string bufferData(reinterpret_cast<const char*>(normals), sizeof(normals));
+
+            const uint8_t indices[] = { 0, 1, 2 };
+            bufferData.append(reinterpret_cast<const char*>(indices), sizeof(indices));
+
+            const char* json = R"({
+                "asset": { "version": "2.0" },
+                "buffers": [ { "uri": "normals.bin", "byteLength": 14 } ],
+                "bufferViews": [
+                    { "buffer": 0, "byteOffset": 0, "byteLength": 11, "byteStride": 4, "target": 34962 },
+                    { "buffer": 0, "byteOffset": 11, "byteLength": 3, "target": 34963 }
+                ],
+                "accessors": [
+                    { "bufferView": 0, "componentType": 5120, "normalized": true, "count": 3, "type": "VEC3" },
+                    { "bufferView": 1, "componentType": 5121, "count": 3, "type": "SCALAR" }
+                ]
+            })";
+            auto doc = DeserializeJson(json);
+
+            InMemoryStreamReader streamReader(bufferData);
+            auto stream = std::make_shared<std::stringstream>(std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+            std::unique_ptr<const IStreamFactory> streamFactory = std::make_unique<OutputOnlyStreamFactory>(stream);
+            SerializeBinary(doc, streamReader, streamFactory);
+
+            GLBResourceReader glbReader(streamReader, stream);
+            auto outputDoc = DeserializeJson(glbReader.GetJson());
+
+            auto normalsAccessor = outputDoc.accessors.Get("0");
+            auto indicesAccessor = outputDoc.accessors.Get("1");
+            Assert::AreEqual(static_cast<size_t>(4), static_cast<size_t>(outputDoc.bufferViews.Get(normalsAccessor.bufferViewId).byteStride));
+            Assert::AreEqual(static_cast<size_t>(12), static_cast<size_t>(outputDoc.bufferViews.Get(normalsAccessor.bufferViewId).byteLength));
+            Assert::AreEqual(static_cast<size_t>(0), static_cast<size_t>(outputDoc.bufferViews.Get(indicesAccessor.bufferViewId).byteStride));
+
+            const int8_t expectedNormals[] = { 0, 0, 127, 0, 0, -127, 90, 0, 90 };
+            Assert::IsTrue(glbReader.ReadBinaryData<int8_t>(outputDoc, normalsAccessor) == std::vector<int8_t>(std::begin(expectedNormals), std::end(expectedNormals)));
+            Assert::IsTrue(glbReader.ReadBinaryData<uint8_t>(outputDoc, indicesAccessor) == std::vector<uint8_t>(std::begin(indices), std::end(indices)));
+        }
+
+        TEST_METHOD(GLBSerializerTests_Parallel_MatchesSerial)
+        {
+            auto doc = DeserializeJson(ReadLocalJson(c_waterBottleJson));
+            TestStreamReader streamReader(TestUtils::GetAbsolutePath(c_waterBottleJson));
+
+            auto serialize = [&](size_t maxParallelism)
+            {
+                auto stream = std::make_shared<std::stringstream>(std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+                std::unique_ptr<const IStreamFactory> streamFactory = std::make_unique<OutputOnlyStreamFactory>(stream);
+                SerializeBinary(doc, streamReader, streamFactory, [](const Accessor& accessor)
+                {
+                    return accessor.componentType == COMPONENT_UNSIGNED_SHORT ? COMPONENT_UNSIGNED_INT : accessor.componentType;
+                }, maxParallelism);
+                return stream->str();
+            };
+
+            auto serial = serialize(1);
+            Assert::IsTrue(serial == serialize(4));
+            Assert::IsTrue(serial == serialize(0));
+        }
+
+        TEST_METHOD(GLBSerializerTests_Deduplicate_SharesBufferViews)
+        {
+            // Both halves of the buffer hold the same indices, and the reader serves the same bytes for both images
+            const uint16_t indices[] = { 0, 1, 2, 2, 1, 3, 0, 1, 2, 2, 1, 3 };
+            std::string bufferData(reinterpret_cast<const char*>(indices), sizeof(indices));
+
+            const char* json = R"({
+                "asset": { "version": "2.0" },
+                "buffers": [ { "uri": "data.bin", "byteLength": 24 } ],
+                "bufferViews": [
+                    { "buffer": 0, "byteOffset": 0, "byteLength": 12, "target": 34963 },
+                    { "buffer": 0, "byteOffset": 12, "byteLength": 12, "target": 34963 }
+                ],
+                "accessors": [
+                    { "bufferView": 0, "componentType": 5123, "count": 6, "type": "SCALAR" },
+                    { "bufferView": 1, "componentType": 5123, "count": 6, "type": "SCALAR" }
+                ],
+                "images": [ { "uri": "a.png" }, { "uri": "b.png" } ]
+            })";
+            auto doc = DeserializeJson(json);
+            InMemoryStreamReader streamReader(bufferData);
+
+            auto serialize = [&](bool deduplicate, std::shared_ptr<std::stringstream> stream)
+            {
+                std::unique_ptr<const IStreamFactory> streamFactory = std::make_unique<OutputOnlyStreamFactory>(stream);
+                SerializeBinary(doc, streamReader, streamFactory, nullptr, 1, deduplicate);
+            };
+
+            auto plainStream = std::make_shared<std::stringstream>(std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+            serialize(false, plainStream);
+            auto stream = std::make_shared<std::stringstream>(std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+            serialize(true, stream);
+
+            GLBResourceReader glbReader(streamReader, stream);
+            auto outputDoc = DeserializeJson(glbReader.GetJson());
+
+            // One bufferView for the indices and one for the images
+            Assert::AreEqual(static_cast<size_t>(2), outputDoc.bufferViews.Size());
+            Assert::AreEqual(outputDoc.accessors.Get("0").bufferViewId, outputDoc.accessors.Get("1").bufferViewId);
+            Assert::AreEqual(outputDoc.images.Get("0").bufferViewId, outputDoc.images.Get("1").bufferViewId);
+            Assert::IsTrue(stream->str().size() < plainStream->str().size());
+
+            for (const auto& accessor : outputDoc.accessors.Elements())
+            {
+                Assert::IsTrue(glbReader.ReadBinaryData<uint16_t>(outputDoc, accessor) == std::vector<uint16_t>(indices, indices + 6));
+            }
+
+            auto image = glbReader.ReadBinaryData(outputDoc, outputDoc.images.Get("1"));
+            Assert::IsTrue(std::string(image.begin(), image.end()) == bufferData);
+        }
+
+        TEST_METHOD(GLBSerializerTests_CoarsestLODFirst)
+        {
+            // Node 0 draws the first mesh, and has node 1, which draws the second, as its coarser LOD. Both meshes share their positions.
+            const uint16_t indices[] = { 0, 1, 2, 0, 2, 3, 2, 1, 0, 0 };
+            const float positions[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+            std::string bufferData(reinterpret_cast<const char*>(indices), sizeof(indices));
+            bufferData.append(reinterpret_cast<const char*>(positions), sizeof(positions));
+
+            const char* json = R"({
+                "asset": { "version": "2.0" },
+                "extensionsUsed": [ "MSFT_lod" ],
+                "buffers": [ { "uri": "lods.bin", "byteLength": 68 } ],
+                "bufferViews": [
+                    { "buffer": 0, "byteOffset": 0, "byteLength": 12, "target": 34963 },
+                    { "buffer": 0, "byteOffset": 12, "byteLength": 6, "target": 34963 },
+                    { "buffer": 0, "byteOffset": 20, "byteLength": 48, "target": 34962 }
+                ],
+                "accessors": [
+                    { "bufferView": 0, "componentType": 5123, "count": 6, "type": "SCALAR" },
+                    { "bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR" },
+                    { "bufferView": 2, "componentType": 5126, "count": 4, "type": "VEC3" }
+                ],
+                "meshes": [
+                    { "primitives": [ { "attributes": { "POSITION": 2 }, "indices": 0 } ] },
+                    { "primitives": [ { "attributes": { "POSITION": 2 }, "indices": 1 } ] }
+                ],
+                "nodes": [
+                    { "mesh": 0, "extensions": { "MSFT_lod": { "ids": [ 1 ] } } },
+                    { "mesh": 1 }
+                ],
+                "scenes": [ { "nodes": [ 0 ] } ],
+                "scene": 0
+            })";
+            auto doc = DeserializeJson(json);
+            InMemoryStreamReader streamReader(bufferData);
+
+            auto serialize = [&](BinaryLayout layout)
+            {
+                auto stream = std::make_shared<std::stringstream>(std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+                std::unique_ptr<const IStreamFactory> streamFactory = std::make_unique<OutputOnlyStreamFactory>(stream);
+                SerializeBinary(doc, streamReader, streamFactory, nullptr, 1, false, MeshCompression::None, layout);
+                return stream;
+            };
+
+            for (auto layout : { BinaryLayout::DocumentOrder, BinaryLayout::CoarsestLODFirst })
+            {
+                auto stream = serialize(layout);
+                GLBResourceReader glbReader(streamReader, stream);
+                auto outputDoc = DeserializeJson(glbReader.GetJson());
+
+                // The accessors keep their order, and only their data moves
+                const auto& fineAccessor = outputDoc.accessors.Get("0");
+                const auto& coarseAccessor = outputDoc.accessors.Get("1");
+                Assert::IsTrue(glbReader.ReadBinaryData<uint16_t>(outputDoc, fineAccessor) == std::vector<uint16_t>(indices, indices + 6));
+                Assert::IsTrue(glbReader.ReadBinaryData<uint16_t>(outputDoc, coarseAccessor) == std::vector<uint16_t>(indices + 6, indices + 9));
+
+                const size_t fineOffset = outputDoc.bufferViews.Get(fineAccessor.bufferViewId).byteOffset;
+                const size_t coarseOffset = outputDoc.bufferViews.Get(coarseAccessor.bufferViewId).byteOffset;
+                const size_t positionsOffset = outputDoc.bufferViews.Get(outputDoc.accessors.Get("2").bufferViewId).byteOffset;
+                Assert::AreEqual(layout == BinaryLayout::CoarsestLODFirst, coarseOffset < fineOffset);
+                Assert::AreEqual(layout == BinaryLayout::CoarsestLODFirst, positionsOffset < fineOffset);
+            }
+        }
+
+        TEST_METHOD(GLBSerializerTests_MeshCompression)
+        {
+            // A quad, drawn as two triangles
+            const float positions[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f };
+            const uint16_t indices[] = { 0, 1, 2, 2, 1, 3 };
+            std::string bufferData(reinterpret_cast<const char*>(positions), sizeof(positions));
+            bufferData.append(reinterpret_cast<const char*>(indices), sizeof(indices));
+
+            const char* json = R"({
+                "asset": { "version": "2.0" },
+                "buffers": [ { "uri": "quad.bin", "byteLength": 60 } ],
+                "bufferViews": [
+                    { "buffer": 0, "byteOffset": 0, "byteLength": 48, "target": 34962 },
+                    { "buffer": 0, "byteOffset": 48, "byteLength": 12, "target": 34963 }
+                ],
+                "accessors": [
+                    { "bufferView": 0, "componentType": 5126, "count": 4, "type": "VEC3" },
+                    { "bufferView": 1, "componentType": 5123, "count": 6, "type": "SCALAR" }
+                ],
+                "meshes": [ { "primitives": [ { "attributes": { "POSITION": 0 }, "indices": 1 } ] } ]
+            })";
+            auto doc = DeserializeJson(json);
+            InMemoryStreamReader streamReader(bufferData);
+
+            auto serialize = [&](MeshCompression compression)
+            {
+                auto stream = std::make_shared<std::stringstream>(std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+                std::unique_ptr<const IStreamFactory> streamFactory = std::make_unique<OutputOnlyStreamFactory>(stream);
+                SerializeBinary(doc, streamReader, streamFactory, nullptr, 1, false, compression);
+                return stream;
+            };
+
+            // Decompresses a bufferView from the binary chunk of the GLB
+            auto decode = [](const std::string& glb, const BufferView& bufferView)
+            {
+                rapidjson::Document extension;
+                extension.Parse(bufferView.extensions.at(EXTENSION_EXT_MESHOPT_COMPRESSION).c_str());
+                Assert::AreEqual(static_cast<uint64_t>(0), extension["buffer"].GetUint64());
+
+                const std::string mode = extension["mode"].GetString();
+                const MeshoptMode meshoptMode = mode == "ATTRIBUTES" ? MeshoptMode::Attributes : mode == "TRIANGLES" ? MeshoptMode::Triangles : MeshoptMode::Indices;
+
+                uint32_t jsonChunkLength = 0;
+                memcpy(&jsonChunkLength, glb.data() + GLB2_HEADER_BYTE_SIZE, sizeof(jsonChunkLength));
+                const char* binaryChunk = glb.data() + GLB2_HEADER_BYTE_SIZE + 8 + jsonChunkLength + 8;
+
+                return GLTFMeshCompressionUtils::Decode(meshoptMode, binaryChunk + extension["byteOffset"].GetUint64(), static_cast<size_t>(extension["byteLength"].GetUint64()),
+                    static_cast<size_t>(extension["count"].GetUint64()), static_cast<size_t>(extension["byteStride"].GetUint64()));
+            };
+
+            {
+                // The uncompressed data is kept, and the compressed data decodes to it
+                auto stream = serialize(MeshCompression::MeshoptWithFallback);
+                GLBResourceReader glbReader(streamReader, stream);
+                auto outputDoc = DeserializeJson(glbReader.GetJson());
+
+                Assert::AreEqual(static_cast<size_t>(1), outputDoc.buffers.Size());
+                Assert::AreEqual(static_cast<size_t>(1), outputDoc.extensionsUsed.count(EXTENSION_EXT_MESHOPT_COMPRESSION));
+                Assert::AreEqual(static_cast<size_t>(0), outputDoc.extensionsRequired.count(EXTENSION_EXT_MESHOPT_COMPRESSION));
+
+                const auto& positionsAccessor = outputDoc.accessors.Get("0");
+                Assert::IsTrue(glbReader.ReadBinaryData<float>(outputDoc, positionsAccessor) == std::vector<float>(std::begin(positions), std::end(positions)));
+
+                auto decodedPositions = decode(stream->str(), outputDoc.bufferViews.Get(positionsAccessor.bufferViewId));
+                Assert::AreEqual(sizeof(positions), decodedPositions.size());
+                Assert::IsTrue(memcmp(positions, decodedPositions.data(), sizeof(positions)) == 0);
+
+                // Each decoded triangle keeps its vertices and winding, but may start from another vertex
+                auto decodedIndices = decode(stream->str(), outputDoc.bufferViews.Get(outputDoc.accessors.Get("1").bufferViewId));
+                Assert::AreEqual(sizeof(indices), decodedIndices.size());
+                for (size_t i = 0; i < 6; i += 3)
+                {
+                    const uint16_t* triangle = reinterpret_cast<const uint16_t*>(decodedIndices.data()) + i;
+                    const size_t rotation = static_cast<size_t>(std::find(triangle, triangle + 3, indices[i]) - triangle);
+                    Assert::IsTrue(rotation < 3);
+                    Assert::AreEqual(indices[i + 1], triangle[(rotation + 1) % 3]);
+                    Assert::AreEqual(indices[i + 2], triangle[(rotation + 2) % 3]);
+                }
+            }
+
+            {
+                // Only the compressed data is stored, and the bufferViews point to a buffer without data
+                auto stream = serialize(MeshCompression::Meshopt);
+                GLBResourceReader glbReader(streamReader, stream);
+                auto outputDoc = DeserializeJson(glbReader.GetJson());
+
+                Assert::AreEqual(static_cast<size_t>(2), outputDoc.buffers.Size());
+                Assert::AreEqual(static_cast<size_t>(1), outputDoc.extensionsRequired.count(EXTENSION_EXT_MESHOPT_COMPRESSION));
+
+                const auto& fallbackBuffer = outputDoc.buffers.Elements()[1];
+                Assert::IsTrue(fallbackBuffer.uri.empty());
+                Assert::AreEqual(static_cast<size_t>(1), fallbackBuffer.extensions.count(EXTENSION_EXT_MESHOPT_COMPRESSION));
+
+                for (const auto& bufferView : outputDoc.bufferViews.Elements())
+                {
+                    Assert::AreEqual(fallbackBuffer.id, bufferView.bufferId);
+                    Assert::IsTrue(bufferView.byteOffset + bufferView.byteLength <= fallbackBuffer.byteLength);
+                }
+
+                auto decodedPositions = decode(stream->str(), outputDoc.bufferViews.Get(outputDoc.accessors.Get("0").bufferViewId));
+                Assert::IsTrue(memcmp(positions, decodedPositions.data(), sizeof(positions)) == 0);
+            }
+        }
     };
 }
\ No newline at end of file
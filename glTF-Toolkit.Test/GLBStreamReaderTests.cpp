@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+#include <CppUnitTest.h>  
+
+#include <GLTFSDK/GLTFDocument.h>
+#include <GLTFSDK/Deserialize.h>
+#include <GLTFSDK/GLTFResourceReader.h>
+#include <GLBStreamReader.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(GLBStreamReaderTests)
+    {
+        static void AppendUInt32(std::string& data, uint32_t value)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                data += static_cast<char>((value >> (i * 8)) & 0xFF);
+            }
+        }
+
+        // Writes a GLB file with one image, stored in bytes 4 to 7 of the binary chunk
+        static void WriteTestGLB(const std::string& path)
+        {
+            std::string json = "{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{\"byteLength\":12}],"
+                "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":4,\"byteLength\":4}],"
+                "\"images\":[{\"bufferView\":0,\"mimeType\":\"image/png\"}]}";
+            while (json.size() % 4 != 0)
+            {
+                json += ' ';
+            }
+
+            std::string bin;
+            for (char i = 0; i < 12; i++)
+            {
+                bin += i;
+            }
+
+            std::string glb = "glTF";
+            AppendUInt32(glb, 2);
+            AppendUInt32(glb, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+            AppendUInt32(glb, static_cast<uint32_t>(json.size()));
+            glb += "JSON";
+            glb += json;
+            AppendUInt32(glb, static_cast<uint32_t>(bin.size()));
+            glb += std::string("BIN\0", 4);
+            glb += bin;
+
+            std::ofstream out(path, std::ios::binary);
+            out.write(glb.data(), glb.size());
+        }
+
+        TEST_METHOD(GLBStreamReader_ReadsJsonAndBuffer)
+        {
+            const std::string path = "GLBStreamReaderTest.glb";
+            WriteTestGLB(path);
+
+            GLBStreamReader streamReader(path);
+            auto doc = DeserializeJson(streamReader.GetJson());
+
+            Assert::AreEqual(static_cast<size_t>(1), doc.images.Size());
+            Assert::AreEqual(static_cast<size_t>(12), streamReader.GetBufferSize());
+
+            // Check that the image is read from the binary chunk
+            GLTFResourceReader resourceReader(streamReader);
+            auto imageData = resourceReader.ReadBinaryData(doc, doc.images[0]);
+            std::vector<uint8_t> expectedImageData = { 4, 5, 6, 7 };
+            Assert::IsTrue(imageData == expectedImageData);
+        }
+
+        TEST_METHOD(GLBStreamReader_InvalidFile)
+        {
+            const std::string path = "GLBStreamReaderInvalidTest.glb";
+            {
+                std::ofstream out(path, std::ios::binary);
+                out << "not a glb file";
+            }
+
+            Assert::ExpectException<GLTFException>([&path]()
+            {
+                GLBStreamReader streamReader(path);
+            });
+        }
+    };
+}
@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>
+
+#include <GLTFSDK/GLTF.h>
+#include "GLBUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(GLBUtilsTests)
+    {
+        static void AppendUInt32(std::string& data, uint32_t value)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                data += static_cast<char>((value >> (i * 8)) & 0xFF);
+            }
+        }
+
+        // A GLB file with the given JSON chunk, and a binary chunk that claims binLength bytes if bin is not empty
+        static std::string MakeGLB(const std::string& json, const std::string& bin, uint32_t binLength)
+        {
+            std::string glb = "glTF";
+            AppendUInt32(glb, GLB_VERSION);
+            AppendUInt32(glb, static_cast<uint32_t>(12 + 8 + json.size() + (bin.empty() ? 0 : 8 + bin.size())));
+            AppendUInt32(glb, static_cast<uint32_t>(json.size()));
+            AppendUInt32(glb, GLB_CHUNK_JSON);
+            glb += json;
+
+            if (!bin.empty())
+            {
+                AppendUInt32(glb, binLength);
+                AppendUInt32(glb, GLB_CHUNK_BIN);
+                glb += bin;
+            }
+
+            return glb;
+        }
+
+        static GLBChunks Parse(const std::string& glb)
+        {
+            return GLBUtils::ParseGLB(reinterpret_cast<const uint8_t*>(glb.data()), glb.size());
+        }
+
+        TEST_METHOD(GLBUtils_ParseGLB_Chunks)
+        {
+            auto glb = MakeGLB("{}  ", "12345678", 8);
+            auto chunks = Parse(glb);
+
+            Assert::AreEqual(std::string("{}  "), chunks.json);
+            Assert::AreEqual(size_t(8), chunks.bufferSize);
+
+            // The binary chunk is not copied
+            Assert::IsTrue(chunks.bufferData == reinterpret_cast<const uint8_t*>(glb.data()) + glb.size() - 8);
+        }
+
+        TEST_METHOD(GLBUtils_ParseGLB_NoBinaryChunk)
+        {
+            auto chunks = Parse(MakeGLB("{}  ", "", 0));
+
+            Assert::AreEqual(std::string("{}  "), chunks.json);
+            Assert::IsTrue(chunks.bufferData == nullptr);
+            Assert::AreEqual(size_t(0), chunks.bufferSize);
+        }
+
+        TEST_METHOD(GLBUtils_ParseGLB_Invalid)
+        {
+            // Not a GLB file
+            Assert::ExpectException<GLTFException>([]() { Parse(std::string(32, 'x')); });
+
+            // The JSON chunk is past the end of the file
+            auto truncatedJson = MakeGLB("{}  ", "", 0);
+            truncatedJson.resize(truncatedJson.size() - 1);
+            Assert::ExpectException<GLTFException>([&truncatedJson]() { Parse(truncatedJson); });
+
+            // The binary chunk is past the end of the file
+            Assert::ExpectException<GLTFException>([]() { Parse(MakeGLB("{}  ", "1234", 8)); });
+        }
+    };
+}
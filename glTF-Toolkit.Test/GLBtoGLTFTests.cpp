@@ -223,5 +223,38 @@ namespace Microsoft::glTF::Toolkit::Test
                 BYTE_OFFSET + 4, BYTE_OFFSET + 5, BYTE_OFFSET + 6, BYTE_OFFSET + 7 };
             Assert::IsTrue(actualData == expectedData, utf8Decode(binBufferString(actualData) + '\n' + binBufferString(expectedData)).c_str());
         }
+
+        TEST_METHOD(GLBtoGLTF_ImageDataInMemoryTest)
+        {
+            auto glbDoc = setupGLBDocument1();
+            std::vector<uint8_t> bufferData(100);
+            std::iota(bufferData.begin(), bufferData.end(), static_cast<uint8_t>(0));
+            auto imageData = GLBToGLTF::GetImagesData(bufferData.data(), bufferData.size(), glbDoc, "test3");
+
+            // these are the offsets and lengths of image0 and image1 in setupGLBDocument1
+            Assert::IsTrue(imageData.size() == 2);
+            Assert::IsTrue(imageData["test3_image0.png"] == std::make_pair(static_cast<const uint8_t*>(bufferData.data() + 32), static_cast<size_t>(4)));
+            Assert::IsTrue(imageData["test3_image1.jpg"] == std::make_pair(static_cast<const uint8_t*>(bufferData.data() + 72), static_cast<size_t>(2)));
+        }
+
+        TEST_METHOD(GLBtoGLTF_MeshDataInMemoryTest)
+        {
+            auto glbDoc = setupGLBDocument1();
+            const size_t BYTE_OFFSET = 12;
+
+            // the stream version reads the buffer at BYTE_OFFSET, the in-memory version is given the buffer directly
+            auto glbStream = setupGLBStream(100);
+            auto expectedData = GLBToGLTF::SaveBin(glbStream, glbDoc, BYTE_OFFSET, 8);
+            delete glbStream;
+
+            std::vector<uint8_t> bufferData(100 - BYTE_OFFSET);
+            std::iota(bufferData.begin(), bufferData.end(), static_cast<uint8_t>(BYTE_OFFSET));
+            std::stringstream output;
+            GLBToGLTF::SaveBin(bufferData.data(), bufferData.size(), glbDoc, output);
+            auto outputString = output.str();
+            std::vector<char> actualData(outputString.begin(), outputString.end());
+
+            Assert::IsTrue(actualData == expectedData, utf8Decode(binBufferString(actualData) + '\n' + binBufferString(expectedData)).c_str());
+        }
     };
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>
+
+#include "GLTFExtensionUtils.h"
+
+#include <GLTFSDK/GLTF.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(GLTFExtensionUtilsTests)
+    {
+        TEST_METHOD(GLTFExtensionUtils_ReadIndices)
+        {
+            const std::string json = R"({"normalTexture":{"index":2,"scale":0.5},"roughnessMetallicOcclusionTexture":{"index":7},"ids":[3,1,4]})";
+
+            auto indices = GLTFExtensionUtils::ReadIndices(json, { { "ids", "[]" }, { "normalTexture", "index" }, { "occlusionRoughnessMetallicTexture", "index" } });
+
+            Assert::AreEqual(size_t(3), indices.size());
+            Assert::IsTrue(std::vector<size_t>({ 3, 1, 4 }) == indices[0]);
+            Assert::IsTrue(std::vector<size_t>({ 2 }) == indices[1]);
+            Assert::IsTrue(indices[2].empty());
+        }
+
+        TEST_METHOD(GLTFExtensionUtils_RemapIndices)
+        {
+            std::string json = R"({"normalTexture":{"index":2,"texCoord":1},"ids":[0,1],"extras":{"index":5}})";
+
+            GLTFExtensionUtils::RemapIndices(json, { { "ids", "[]" }, { "normalTexture", "index" } }, [](size_t index) { return index + 10; });
+
+            // Only the values at the given paths change, and everything else is written back in order
+            Assert::AreEqual(std::string(R"({"normalTexture":{"index":12,"texCoord":1},"ids":[10,11],"extras":{"index":5}})"), json);
+        }
+
+        TEST_METHOD(GLTFExtensionUtils_InvalidJson)
+        {
+            std::string json = R"({"ids":[0,)";
+
+            Assert::ExpectException<GLTFException>([&json]()
+            {
+                GLTFExtensionUtils::ReadIndices(json, { { "ids", "[]" } });
+            });
+        }
+    };
+}
@@ -13,6 +13,8 @@
 #include "GLTFSDK/RapidJsonUtils.h"
 
 #include "GLTFLODUtils.h"
+#include "GLTFTextureCompressionUtils.h"
+#include "GLTFTexturePackingUtils.h"
 
 #include "Helpers/WStringUtils.h"
 #include "Helpers/TestUtils.h"
@@ -200,6 +202,191 @@ namespace Microsoft::glTF::Toolkit::Test
             }
         }
 
+        TEST_METHOD(GLTFLODUtils_GLTFNodeLODMergeManyLevels)
+        {
+            auto input = TestUtils::ReadLocalAsset(TestUtils::GetAbsolutePath(c_cubeAsset3DJson));
+            auto doc = DeserializeJson(std::string(std::istreambuf_iterator<char>(*input), std::istreambuf_iterator<char>()));
+
+            const size_t lodCount = 6;
+            std::vector<GLTFDocument> docs(lodCount, doc);
+
+            auto merged = GLTFLODUtils::MergeDocumentsAsLODs(docs);
+            CheckGLTFLODNodeCountAgainstOriginal(doc, merged, lodCount);
+
+            // Each LOD root is the original root, offset by the nodes of every document merged before it
+            auto rootId = doc.scenes.Elements()[0].nodes[0];
+            auto lods = GLTFLODUtils::ParseDocumentNodeLODs(merged);
+            auto rootLods = lods.at(rootId);
+            Assert::AreEqual(lodCount - 1, rootLods->size());
+            for (size_t i = 1; i < lodCount; i++)
+            {
+                Assert::AreEqual(std::to_string(std::stoi(rootId) + i * doc.nodes.Size()), rootLods->at(i - 1));
+                Assert::AreEqual(std::string("root_lod") + std::to_string(i), merged.nodes.Get(rootLods->at(i - 1)).name);
+            }
+        }
+
+        TEST_METHOD(GLTFLODUtils_GLTFNodeLODMergeMismatchedScenes)
+        {
+            auto input = TestUtils::ReadLocalAsset(TestUtils::GetAbsolutePath(c_cubeAsset3DJson));
+            auto doc = DeserializeJson(std::string(std::istreambuf_iterator<char>(*input), std::istreambuf_iterator<char>()));
+
+            // A LOD with an extra scene can't be matched to the primary
+            GLTFDocument mismatched(doc);
+            Scene extraScene(mismatched.scenes.Elements()[0]);
+            extraScene.id = std::to_string(mismatched.scenes.Size());
+            mismatched.scenes.Append(std::move(extraScene));
+
+            std::vector<GLTFDocument> docs = { doc, doc, mismatched };
+            Assert::ExpectException<std::runtime_error>([&docs]()
+            {
+                GLTFLODUtils::MergeDocumentsAsLODs(docs);
+            });
+        }
+
+        TEST_METHOD(GLTFLODUtils_GLTFNodeLODMergeRemapsExtensions)
+        {
+            const char* json = R"({
+                "asset": { "version": "2.0" },
+                "extensionsUsed": [ "MSFT_texture_dds", "MSFT_packing_occlusionRoughnessMetallic" ],
+                "scene": 0,
+                "scenes": [ { "nodes": [ 0 ] } ],
+                "nodes": [ { "name": "root" } ],
+                "images": [ { "uri": "a.png" }, { "uri": "a.dds" } ],
+                "textures": [ { "source": 0, "extensions": { "MSFT_texture_dds": { "source": 1 } } } ],
+                "materials": [ {
+                    "name": "material",
+                    "extensions": { "MSFT_packing_occlusionRoughnessMetallic": {
+                        "occlusionRoughnessMetallicTexture": { "index": 0 },
+                        "normalTexture": { "index": 0, "scale": 2.5 }
+                    } }
+                } ]
+            })";
+            auto doc = DeserializeJson(json);
+
+            std::vector<GLTFDocument> docs = { doc, doc, doc };
+            auto merged = GLTFLODUtils::MergeDocumentsAsLODs(docs);
+
+            // The third copy of every element starts at index 2 for textures, and 4 for images
+            auto texture = merged.textures.Get("2");
+            Assert::AreEqual(std::string("4"), texture.imageId);
+            auto ddsJson = RapidJsonUtils::CreateDocumentFromString(texture.extensions.at(EXTENSION_MSFT_TEXTURE_DDS));
+            Assert::AreEqual(5, ddsJson["source"].GetInt());
+
+            auto material = merged.materials.Get("2");
+            auto ormJson = RapidJsonUtils::CreateDocumentFromString(material.extensions.at(EXTENSION_MSFT_PACKING_ORM));
+            Assert::AreEqual(2, ormJson["occlusionRoughnessMetallicTexture"]["index"].GetInt());
+            Assert::AreEqual(2, ormJson["normalTexture"]["index"].GetInt());
+            Assert::AreEqual(2.5, ormJson["normalTexture"]["scale"].GetDouble());
+        }
+
+        TEST_METHOD(GLTFLODUtils_GLTFNodeLODMergeSharesResources)
+        {
+            const char* primaryJson = R"({
+                "asset": { "version": "2.0" },
+                "scene": 0,
+                "scenes": [ { "nodes": [ 0 ] } ],
+                "nodes": [ { "name": "root" } ],
+                "images": [ { "uri": "a.png" } ],
+                "samplers": [ { "magFilter": 9729, "wrapS": 33071 } ],
+                "textures": [ { "source": 0, "sampler": 0 } ],
+                "materials": [ { "pbrMetallicRoughness": { "baseColorTexture": { "index": 0 } } } ]
+            })";
+
+            // The LOD has the primary image under another name, and one image of its own
+            const char* lodJson = R"({
+                "asset": { "version": "2.0" },
+                "scene": 0,
+                "scenes": [ { "nodes": [ 0 ] } ],
+                "nodes": [ { "name": "root" } ],
+                "images": [ { "uri": "b.png" }, { "uri": "a_copy.png" } ],
+                "samplers": [ { "magFilter": 9729, "wrapS": 33071 } ],
+                "textures": [ { "source": 0, "sampler": 0 }, { "source": 1, "sampler": 0 } ],
+                "materials": [
+                    { "pbrMetallicRoughness": { "baseColorTexture": { "index": 1 } }, "normalTexture": { "index": 0 } }
+                ]
+            })";
+
+            std::vector<GLTFDocument> docs = { DeserializeJson(primaryJson), DeserializeJson(lodJson) };
+            std::vector<std::shared_ptr<IStreamReader>> streamReaders = {
+                std::make_shared<UriStreamReader>(std::unordered_map<std::string, std::string>{ { "a.png", "image a" } }),
+                std::make_shared<UriStreamReader>(std::unordered_map<std::string, std::string>{ { "b.png", "image b" }, { "a_copy.png", "image a" } })
+            };
+
+            auto merged = GLTFLODUtils::MergeDocumentsAsLODs(docs, std::vector<double>(), streamReaders);
+
+            Assert::AreEqual(size_t(2), merged.images.Size());
+            Assert::AreEqual(size_t(1), merged.samplers.Size());
+            Assert::AreEqual(size_t(2), merged.textures.Size());
+            Assert::AreEqual(size_t(2), merged.materials.Size());
+
+            // The only new texture is appended right after the primary ones, and points to the new image
+            auto texture = merged.textures.Get("1");
+            Assert::AreEqual(std::string("1"), texture.imageId);
+            Assert::AreEqual(std::string("0"), texture.samplerId);
+            Assert::AreEqual(std::string("b.png"), merged.images.Get("1").uri);
+
+            auto material = merged.materials.Get("1");
+            Assert::AreEqual(std::string("0"), material.metallicRoughness.baseColorTextureId);
+            Assert::AreEqual(std::string("1"), material.normalTexture.id);
+        }
+
+        TEST_METHOD(GLTFLODUtils_GLTFNodeLODMergeDropsSharedImageBufferViews)
+        {
+            // GLB documents, whose buffer has no URI, with an image and a position accessor in the binary chunk
+            const char* primaryJson = R"({
+                "asset": { "version": "2.0" },
+                "scene": 0,
+                "scenes": [ { "nodes": [ 0 ] } ],
+                "nodes": [ { "name": "root" } ],
+                "buffers": [ { "byteLength": 16 } ],
+                "bufferViews": [ { "buffer": 0, "byteOffset": 0, "byteLength": 12 }, { "buffer": 0, "byteOffset": 12, "byteLength": 4 } ],
+                "accessors": [ { "bufferView": 0, "componentType": 5126, "count": 1, "type": "VEC3" } ],
+                "images": [ { "bufferView": 1, "mimeType": "image/png" } ],
+                "textures": [ { "source": 0 } ]
+            })";
+
+            // The LOD stores the same image first, so the buffer view of its positions moves down
+            const char* lodJson = R"({
+                "asset": { "version": "2.0" },
+                "scene": 0,
+                "scenes": [ { "nodes": [ 0 ] } ],
+                "nodes": [ { "name": "root" } ],
+                "buffers": [ { "byteLength": 16 } ],
+                "bufferViews": [ { "buffer": 0, "byteOffset": 0, "byteLength": 4 }, { "buffer": 0, "byteOffset": 4, "byteLength": 12 } ],
+                "accessors": [ { "bufferView": 1, "componentType": 5126, "count": 1, "type": "VEC3" } ],
+                "images": [ { "bufferView": 0, "mimeType": "image/png" } ],
+                "textures": [ { "source": 0 } ]
+            })";
+
+            const std::string image = "imga";
+            const std::string positions(12, '\0');
+
+            std::vector<GLTFDocument> docs = { DeserializeJson(primaryJson), DeserializeJson(lodJson) };
+            std::vector<std::shared_ptr<IStreamReader>> streamReaders = {
+                std::make_shared<UriStreamReader>(std::unordered_map<std::string, std::string>{ { "", positions + image } }),
+                std::make_shared<UriStreamReader>(std::unordered_map<std::string, std::string>{ { "", image + positions } })
+            };
+
+            auto merged = GLTFLODUtils::MergeDocumentsAsLODs(docs, std::vector<double>(), streamReaders);
+
+            Assert::AreEqual(size_t(1), merged.images.Size());
+            Assert::AreEqual(size_t(3), merged.bufferViews.Size());
+
+            size_t byteLength = 0;
+            for (const auto& bufferView : merged.bufferViews.Elements())
+            {
+                byteLength += bufferView.byteLength;
+            }
+
+            // The image is stored once, and each LOD keeps its own positions
+            Assert::AreEqual(image.size() + 2 * positions.size(), byteLength);
+
+            auto lodAccessor = merged.accessors.Get("1");
+            Assert::AreEqual(std::string("2"), lodAccessor.bufferViewId);
+            Assert::AreEqual(std::string("1"), merged.bufferViews.Get("2").bufferId);
+            Assert::AreEqual(size_t(4), merged.bufferViews.Get("2").byteOffset);
+        }
+
         TEST_METHOD(GLTFLODUtils_GLTFNodeLODMergeScreenCoverage)
         {
             auto input = TestUtils::ReadLocalAsset(TestUtils::GetAbsolutePath(c_cubeAsset3DJson));
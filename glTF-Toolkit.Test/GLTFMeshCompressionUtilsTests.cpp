@@ -0,0 +1,132 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>
+
+#include "GLTFMeshCompressionUtils.h"
+
+#include <GLTFSDK/GLTF.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(GLTFMeshCompressionUtilsTests)
+    {
+        // The indices of a grid of quads, split in two triangles each
+        static std::vector<uint32_t> GetGridIndices(uint32_t size)
+        {
+            std::vector<uint32_t> indices;
+            for (uint32_t y = 0; y < size; y++)
+            {
+                for (uint32_t x = 0; x < size; x++)
+                {
+                    const uint32_t corner = y * (size + 1) + x;
+                    indices.insert(indices.end(), { corner, corner + size + 1, corner + 1, corner + 1, corner + size + 1, corner + size + 2 });
+                }
+            }
+
+            return indices;
+        }
+
+        // Decoded triangles may start from another of their vertices, but keep their winding
+        static bool AreSameTriangles(const std::vector<uint32_t>& expected, const uint32_t* actual)
+        {
+            for (size_t i = 0; i < expected.size(); i += 3)
+            {
+                const uint32_t* triangle = actual + i;
+                bool found = false;
+                for (size_t rotation = 0; rotation < 3 && !found; rotation++)
+                {
+                    found = triangle[rotation] == expected[i] && triangle[(rotation + 1) % 3] == expected[i + 1] && triangle[(rotation + 2) % 3] == expected[i + 2];
+                }
+
+                if (!found)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        TEST_METHOD(GLTFMeshCompressionUtils_Attributes_RoundTrip)
+        {
+            // Positions on a smooth curve, padded to a 16-byte stride, with more vertices than fit in one block
+            const size_t count = 1000;
+            std::vector<float> vertices(count * 4);
+            for (size_t i = 0; i < count; i++)
+            {
+                vertices[i * 4] = static_cast<float>(i) * 0.01f;
+                vertices[i * 4 + 1] = std::sin(static_cast<float>(i) * 0.01f);
+                vertices[i * 4 + 2] = 1.0f;
+            }
+
+            auto encoded = GLTFMeshCompressionUtils::Encode(MeshoptMode::Attributes, vertices.data(), count, 16);
+            Assert::IsTrue(encoded.size() < vertices.size() * sizeof(float));
+
+            auto decoded = GLTFMeshCompressionUtils::Decode(MeshoptMode::Attributes, encoded.data(), encoded.size(), count, 16);
+            Assert::AreEqual(vertices.size() * sizeof(float), decoded.size());
+            Assert::IsTrue(memcmp(vertices.data(), decoded.data(), decoded.size()) == 0);
+        }
+
+        TEST_METHOD(GLTFMeshCompressionUtils_Triangles_RoundTrip)
+        {
+            auto indices = GetGridIndices(32);
+
+            auto encoded = GLTFMeshCompressionUtils::Encode(MeshoptMode::Triangles, indices.data(), indices.size(), sizeof(uint32_t));
+
+            // Triangles that share edges with recent ones take a few bits each
+            Assert::IsTrue(encoded.size() * 4 < indices.size() * sizeof(uint32_t));
+
+            auto decoded = GLTFMeshCompressionUtils::Decode(MeshoptMode::Triangles, encoded.data(), encoded.size(), indices.size(), sizeof(uint32_t));
+            Assert::AreEqual(indices.size() * sizeof(uint32_t), decoded.size());
+            Assert::IsTrue(AreSameTriangles(indices, reinterpret_cast<const uint32_t*>(decoded.data())));
+        }
+
+        TEST_METHOD(GLTFMeshCompressionUtils_Indices_RoundTrip)
+        {
+            // A line list, which is not made of triangles, so must be kept in order
+            std::vector<uint16_t> indices;
+            for (uint16_t i = 0; i < 500; i++)
+            {
+                indices.push_back(i);
+                indices.push_back(static_cast<uint16_t>((i * 37) % 500));
+            }
+
+            auto encoded = GLTFMeshCompressionUtils::Encode(MeshoptMode::Indices, indices.data(), indices.size(), sizeof(uint16_t));
+            auto decoded = GLTFMeshCompressionUtils::Decode(MeshoptMode::Indices, encoded.data(), encoded.size(), indices.size(), sizeof(uint16_t));
+
+            Assert::AreEqual(indices.size() * sizeof(uint16_t), decoded.size());
+            Assert::IsTrue(memcmp(indices.data(), decoded.data(), decoded.size()) == 0);
+        }
+
+        TEST_METHOD(GLTFMeshCompressionUtils_InvalidStride)
+        {
+            const uint8_t data[12] = {};
+
+            Assert::ExpectException<std::invalid_argument>([&data]()
+            {
+                GLTFMeshCompressionUtils::Encode(MeshoptMode::Attributes, data, 2, 6);
+            });
+
+            Assert::ExpectException<std::invalid_argument>([&data]()
+            {
+                GLTFMeshCompressionUtils::Encode(MeshoptMode::Triangles, data, 3, 1);
+            });
+        }
+
+        TEST_METHOD(GLTFMeshCompressionUtils_TruncatedData)
+        {
+            auto indices = GetGridIndices(4);
+            auto encoded = GLTFMeshCompressionUtils::Encode(MeshoptMode::Triangles, indices.data(), indices.size(), sizeof(uint32_t));
+
+            Assert::ExpectException<GLTFException>([&]()
+            {
+                GLTFMeshCompressionUtils::Decode(MeshoptMode::Triangles, encoded.data(), encoded.size() / 2, indices.size(), sizeof(uint32_t));
+            });
+        }
+    };
+}
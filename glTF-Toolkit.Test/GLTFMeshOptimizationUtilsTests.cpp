@@ -0,0 +1,157 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>
+
+#include <array>
+#include <random>
+
+#include "GLTFMeshOptimizationUtils.h"
+
+#include "Helpers/TestUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(GLTFMeshOptimizationUtilsTests)
+    {
+        // A grid of size x size quads with its triangles in random order
+        static void MakeShuffledGrid(uint32_t size, std::vector<float>& positions, std::vector<uint32_t>& indices)
+        {
+            TestUtils::MakeGrid(size, positions, indices);
+
+            std::vector<std::array<uint32_t, 3>> triangles;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                triangles.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+            }
+
+            std::shuffle(triangles.begin(), triangles.end(), std::mt19937(42));
+            for (size_t i = 0; i < triangles.size(); i++)
+            {
+                std::copy(triangles[i].begin(), triangles[i].end(), indices.begin() + i * 3);
+            }
+        }
+
+        // The triangles of a triangle list, each starting at its smallest index so that the winding is kept
+        static std::vector<std::array<uint32_t, 3>> GetSortedTriangles(const std::vector<uint32_t>& indices)
+        {
+            std::vector<std::array<uint32_t, 3>> triangles;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                std::array<uint32_t, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+                std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+                triangles.push_back(triangle);
+            }
+
+            std::sort(triangles.begin(), triangles.end());
+            return triangles;
+        }
+
+        TEST_METHOD(GLTFMeshOptimizationUtils_OptimizeVertexCache)
+        {
+            std::vector<float> positions;
+            std::vector<uint32_t> indices;
+            MakeShuffledGrid(32, positions, indices);
+
+            auto optimized = GLTFMeshOptimizationUtils::OptimizeVertexCache(indices, positions.size() / 3);
+
+            Assert::IsTrue(GetSortedTriangles(indices) == GetSortedTriangles(optimized));
+            Assert::IsTrue(GLTFMeshOptimizationUtils::GetAverageCacheMissRatio(indices) > 2.5);
+            Assert::IsTrue(GLTFMeshOptimizationUtils::GetAverageCacheMissRatio(optimized) < 0.8);
+        }
+
+        TEST_METHOD(GLTFMeshOptimizationUtils_OptimizeOverdraw)
+        {
+            std::vector<float> positions;
+            std::vector<uint32_t> indices;
+            MakeShuffledGrid(32, positions, indices);
+
+            auto cacheOptimized = GLTFMeshOptimizationUtils::OptimizeVertexCache(indices, positions.size() / 3);
+            auto optimized = GLTFMeshOptimizationUtils::OptimizeOverdraw(positions, cacheOptimized);
+
+            Assert::IsTrue(GetSortedTriangles(indices) == GetSortedTriangles(optimized));
+            Assert::IsTrue(GLTFMeshOptimizationUtils::GetAverageCacheMissRatio(optimized) < 0.8);
+        }
+
+        TEST_METHOD(GLTFMeshOptimizationUtils_OptimizeVertexFetch)
+        {
+            auto remap = GLTFMeshOptimizationUtils::OptimizeVertexFetch({ 5, 2, 7, 2, 7, 0 }, 8);
+
+            std::vector<uint32_t> expected = { 3, UINT32_MAX, 1, UINT32_MAX, UINT32_MAX, 0, UINT32_MAX, 2 };
+            Assert::IsTrue(expected == remap);
+        }
+
+        TEST_METHOD(GLTFMeshOptimizationUtils_OptimizeMeshes)
+        {
+            std::vector<float> positions;
+            std::vector<uint32_t> indices;
+            MakeShuffledGrid(16, positions, indices);
+
+            // One vertex that no triangle uses
+            positions.insert(positions.end(), { -1.0f, -1.0f, 0.0f });
+            const size_t vertexCount = positions.size() / 3;
+
+            std::vector<uint16_t> shortIndices(indices.size());
+            std::transform(indices.begin(), indices.end(), shortIndices.begin(), [](uint32_t index) { return static_cast<uint16_t>(index); });
+
+            TestMeshDocument grid("grid.bin", positions, shortIndices);
+            grid.AddMesh({ grid.MakePrimitive() });
+
+            UriStreamReader streamReader({ { "grid.bin", grid.GetData() } });
+            auto optimizedDoc = GLTFMeshOptimizationUtils::OptimizeMeshes(streamReader, grid.GetDocument(), "", 4);
+
+            const auto& optimizedPrimitive = optimizedDoc.meshes.Get("0").primitives[0];
+            Assert::AreEqual(std::string("0"), optimizedPrimitive.positionsAccessorId);
+            Assert::AreNotEqual(std::string("1"), optimizedPrimitive.indicesAccessorId);
+            Assert::AreEqual(size_t(2), optimizedDoc.buffers.Size());
+
+            // The unused vertex is dropped, and the bounds shrink to the grid
+            const auto& optimizedPositions = optimizedDoc.accessors.Get("0");
+            Assert::AreEqual(vertexCount - 1, optimizedPositions.count);
+            Assert::AreEqual(0.0f, optimizedPositions.min[0]);
+            Assert::AreEqual(16.0f, optimizedPositions.max[1]);
+
+            const auto& optimizedIndices = optimizedDoc.accessors.Get(optimizedPrimitive.indicesAccessorId);
+            Assert::IsTrue(ComponentType::COMPONENT_UNSIGNED_SHORT == optimizedIndices.componentType);
+            Assert::AreEqual(indices.size(), optimizedIndices.count);
+
+            std::ifstream saved(optimizedDoc.buffers.Get("1").uri, std::ios::binary);
+            std::string savedData((std::istreambuf_iterator<char>(saved)), std::istreambuf_iterator<char>());
+            Assert::AreEqual(static_cast<size_t>(optimizedDoc.buffers.Get("1").byteLength), savedData.size());
+
+            // The same triangles, at the same positions
+            const auto& positionsView = optimizedDoc.bufferViews.Get(optimizedPositions.bufferViewId);
+            const auto& indicesView = optimizedDoc.bufferViews.Get(optimizedIndices.bufferViewId);
+            const float* newPositions = reinterpret_cast<const float*>(savedData.data() + positionsView.byteOffset);
+            const uint16_t* newIndices = reinterpret_cast<const uint16_t*>(savedData.data() + indicesView.byteOffset);
+
+            std::vector<std::array<float, 9>> originalTriangles;
+            std::vector<std::array<float, 9>> newTriangles;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                std::array<float, 9> original;
+                std::array<float, 9> optimized;
+                for (size_t k = 0; k < 9; k++)
+                {
+                    original[k] = positions[indices[i + k / 3] * 3 + k % 3];
+                    optimized[k] = newPositions[newIndices[i + k / 3] * 3 + k % 3];
+                }
+
+                originalTriangles.push_back(original);
+                newTriangles.push_back(optimized);
+            }
+
+            std::sort(originalTriangles.begin(), originalTriangles.end());
+            std::sort(newTriangles.begin(), newTriangles.end());
+            Assert::IsTrue(originalTriangles == newTriangles);
+
+            // Vertices are laid out in the order they are first used
+            Assert::AreEqual(uint16_t(0), newIndices[0]);
+            Assert::IsTrue(newIndices[1] <= 2 && newIndices[2] <= 2);
+        }
+    };
+}
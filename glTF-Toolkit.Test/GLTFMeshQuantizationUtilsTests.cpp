@@ -0,0 +1,152 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>
+
+#include "GLTFSDK/GLTFResourceReader.h"
+
+#include "GLTFMeshQuantizationUtils.h"
+
+#include "Helpers/TestUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(GLTFMeshQuantizationUtilsTests)
+    {
+        // A quad in the z = 1 plane, with texture coordinates in [0, 1] for uv0 and tiled for uv1
+        const std::vector<float> c_positions = { -3.0f, 1.0f, 1.0f, 5.0f, 1.0f, 1.0f, 5.0f, 2.0f, 1.0f, -3.0f, 2.0f, 1.0f };
+        const std::vector<float> c_normals = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.6f, 0.8f, 0.0f, -0.6f, 0.8f };
+        const std::vector<float> c_uv0 = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.25f };
+        const std::vector<float> c_uv1 = { 0.0f, 0.0f, 4.0f, 0.0f, 4.0f, 4.0f, 0.0f, 4.0f };
+
+        TestMeshDocument MakeQuadDocument()
+        {
+            TestMeshDocument quad("quad.bin", c_positions, { 0, 1, 2, 0, 2, 3 });
+
+            MeshPrimitive primitive = quad.MakePrimitive();
+            primitive.normalsAccessorId = quad.AddVertexAccessor(c_normals, AccessorType::TYPE_VEC3);
+            primitive.uv0AccessorId = quad.AddVertexAccessor(c_uv0, AccessorType::TYPE_VEC2);
+            primitive.uv1AccessorId = quad.AddVertexAccessor(c_uv1, AccessorType::TYPE_VEC2);
+            quad.AddMesh({ primitive });
+
+            Node node;
+            node.id = "0";
+            node.meshId = "0";
+            quad.GetDocument().nodes.Append(std::move(node));
+
+            return quad;
+        }
+
+        TEST_METHOD(GLTFMeshQuantizationUtils_QuantizeMeshes)
+        {
+            auto quad = MakeQuadDocument();
+            const auto& doc = quad.GetDocument();
+            const auto& data = quad.GetData();
+
+            QuantizationErrorBounds errorBounds;
+            UriStreamReader streamReader({ { "quad.bin", data } });
+            auto quantizedDoc = GLTFMeshQuantizationUtils::QuantizeMeshes(streamReader, doc, errorBounds, "", 4);
+
+            Assert::IsTrue(quantizedDoc.extensionsUsed.count(EXTENSION_KHR_MESH_QUANTIZATION) > 0);
+            Assert::IsTrue(quantizedDoc.extensionsRequired.count(EXTENSION_KHR_MESH_QUANTIZATION) > 0);
+
+            const auto& positions = quantizedDoc.accessors.Get("0");
+            const auto& normals = quantizedDoc.accessors.Get("2");
+            const auto& uv0 = quantizedDoc.accessors.Get("3");
+            const auto& uv1 = quantizedDoc.accessors.Get("4");
+            Assert::IsTrue(ComponentType::COMPONENT_SHORT == positions.componentType && !positions.normalized);
+            Assert::IsTrue(ComponentType::COMPONENT_BYTE == normals.componentType && normals.normalized);
+            Assert::IsTrue(ComponentType::COMPONENT_UNSIGNED_SHORT == uv0.componentType && uv0.normalized);
+            Assert::IsTrue(ComponentType::COMPONENT_FLOAT == uv1.componentType);
+
+            // Each vertex of the narrow attributes starts on a 4-byte boundary
+            Assert::AreEqual(size_t(8), static_cast<size_t>(quantizedDoc.bufferViews.Get(positions.bufferViewId).byteStride));
+            Assert::AreEqual(size_t(4), static_cast<size_t>(quantizedDoc.bufferViews.Get(normals.bufferViewId).byteStride));
+
+            // The mesh is drawn by a new child node, which holds the dequantization transform
+            const auto& node = quantizedDoc.nodes.Get("0");
+            Assert::IsTrue(node.meshId.empty());
+            Assert::AreEqual(size_t(1), node.children.size());
+
+            const auto& meshNode = quantizedDoc.nodes.Get(node.children[0]);
+            Assert::AreEqual(std::string("0"), meshNode.meshId);
+            Assert::AreEqual(1.0f, meshNode.translation.x);
+            Assert::AreEqual(1.5f, meshNode.translation.y);
+            Assert::AreEqual(meshNode.scale.x, meshNode.scale.z);
+
+            const auto& quantizedBuffer = quantizedDoc.buffers.Get("1");
+            std::ifstream saved(quantizedBuffer.uri, std::ios::binary);
+            std::string savedData((std::istreambuf_iterator<char>(saved)), std::istreambuf_iterator<char>());
+            Assert::AreEqual(static_cast<size_t>(quantizedBuffer.byteLength), savedData.size());
+
+            UriStreamReader quantizedReader({ { "quad.bin", data }, { quantizedBuffer.uri, savedData } });
+            GLTFResourceReader reader(quantizedReader);
+
+            // The largest side of the bounding box is 8 units long
+            auto quantizedPositions = reader.ReadBinaryData<int16_t>(quantizedDoc, positions);
+            for (size_t i = 0; i < c_positions.size(); i++)
+            {
+                float translation = i % 3 == 0 ? meshNode.translation.x : (i % 3 == 1 ? meshNode.translation.y : meshNode.translation.z);
+                float position = quantizedPositions[i] * meshNode.scale.x + translation;
+                Assert::AreEqual(c_positions[i], position, static_cast<float>(8.0 * errorBounds.position));
+            }
+
+            auto quantizedNormals = reader.ReadBinaryData<int8_t>(quantizedDoc, normals);
+            for (size_t i = 0; i < c_normals.size(); i++)
+            {
+                Assert::AreEqual(c_normals[i], quantizedNormals[i] / 127.0f, static_cast<float>(errorBounds.normal));
+            }
+
+            auto quantizedUV0 = reader.ReadBinaryData<uint16_t>(quantizedDoc, uv0);
+            for (size_t i = 0; i < c_uv0.size(); i++)
+            {
+                Assert::AreEqual(c_uv0[i], quantizedUV0[i] / 65535.0f, static_cast<float>(errorBounds.texCoord));
+            }
+        }
+
+        TEST_METHOD(GLTFMeshQuantizationUtils_QuantizeMeshes_ErrorBounds)
+        {
+            auto quad = MakeQuadDocument();
+            const auto& doc = quad.GetDocument();
+            const auto& data = quad.GetData();
+
+            // Looser bounds allow 8-bit positions, and tighter ones keep the normals as floats
+            QuantizationErrorBounds errorBounds;
+            errorBounds.position = 1.0 / 256;
+            errorBounds.normal = 1.0 / 100000;
+
+            UriStreamReader streamReader({ { "quad.bin", data } });
+            auto quantizedDoc = GLTFMeshQuantizationUtils::QuantizeMeshes(streamReader, doc, errorBounds, "");
+
+            Assert::IsTrue(ComponentType::COMPONENT_BYTE == quantizedDoc.accessors.Get("0").componentType);
+            Assert::IsTrue(ComponentType::COMPONENT_FLOAT == quantizedDoc.accessors.Get("2").componentType);
+        }
+
+        TEST_METHOD(GLTFMeshQuantizationUtils_PreserveQuantizedAttributes)
+        {
+            auto quad = MakeQuadDocument();
+            const auto& doc = quad.GetDocument();
+            const auto& data = quad.GetData();
+
+            UriStreamReader streamReader({ { "quad.bin", data } });
+            auto quantizedDoc = GLTFMeshQuantizationUtils::QuantizeMeshes(streamReader, doc, QuantizationErrorBounds(), "");
+
+            auto toFloat = [](const Accessor&) { return ComponentType::COMPONENT_FLOAT; };
+            auto conversion = GLTFMeshQuantizationUtils::PreserveQuantizedAttributes(quantizedDoc, toFloat);
+
+            Assert::IsTrue(ComponentType::COMPONENT_SHORT == conversion(quantizedDoc.accessors.Get("0")));
+            Assert::IsTrue(ComponentType::COMPONENT_BYTE == conversion(quantizedDoc.accessors.Get("2")));
+
+            // The indices are not a quantized attribute
+            Assert::IsTrue(ComponentType::COMPONENT_FLOAT == conversion(quantizedDoc.accessors.Get("1")));
+
+            // Documents that aren't quantized keep the strategy as it is
+            auto unchanged = GLTFMeshQuantizationUtils::PreserveQuantizedAttributes(doc, toFloat);
+            Assert::IsTrue(ComponentType::COMPONENT_FLOAT == unchanged(doc.accessors.Get("0")));
+        }
+    };
+}
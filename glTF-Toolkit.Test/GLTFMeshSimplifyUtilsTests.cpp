@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>
+
+#include "GLTFSDK/GLTFResourceReader.h"
+
+#include "GLTFMeshSimplifyUtils.h"
+
+#include "Helpers/TestUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(GLTFMeshSimplifyUtilsTests)
+    {
+        static void CheckFacesUp(const std::vector<float>& positions, const std::vector<uint32_t>& indices)
+        {
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const float* a = &positions[indices[i] * 3];
+                const float* b = &positions[indices[i + 1] * 3];
+                const float* c = &positions[indices[i + 2] * 3];
+
+                float normalZ = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+                Assert::IsTrue(normalZ > 0);
+            }
+        }
+
+        TEST_METHOD(GLTFMeshSimplifyUtils_SimplifyTriangles_FlatGrid)
+        {
+            std::vector<float> positions;
+            std::vector<uint32_t> indices;
+            TestUtils::MakeGrid(16, positions, indices);
+
+            auto simplified = GLTFMeshSimplifyUtils::SimplifyTriangles(positions, indices, indices.size() / 10);
+
+            Assert::IsTrue(simplified.size() <= indices.size() / 10);
+            Assert::IsTrue(simplified.size() > 0);
+            CheckFacesUp(positions, simplified);
+
+            // Border vertices only slide along the border, so the corners stay
+            for (uint32_t corner : { 0u, 16u, 17u * 16u, 17u * 17u - 1u })
+            {
+                Assert::IsTrue(std::find(simplified.begin(), simplified.end(), corner) != simplified.end());
+            }
+        }
+
+        TEST_METHOD(GLTFMeshSimplifyUtils_SimplifyTriangles_KeepsSeams)
+        {
+            std::vector<float> positions;
+            std::vector<uint32_t> indices;
+            TestUtils::MakeGrid(16, positions, indices);
+
+            // Split the grid along x = 8, as if the two halves had different UVs
+            std::vector<uint32_t> seam;
+            for (uint32_t y = 0; y <= 16; y++)
+            {
+                uint32_t vertex = y * 17 + 8;
+                uint32_t copy = static_cast<uint32_t>(positions.size() / 3);
+                positions.insert(positions.end(), { positions[vertex * 3], positions[vertex * 3 + 1], positions[vertex * 3 + 2] });
+
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    bool rightHalf = positions[indices[i] * 3] + positions[indices[i + 1] * 3] + positions[indices[i + 2] * 3] > 24.0f;
+                    for (size_t k = 0; rightHalf && k < 3; k++)
+                    {
+                        if (indices[i + k] == vertex)
+                        {
+                            indices[i + k] = copy;
+                        }
+                    }
+                }
+
+                seam.push_back(vertex);
+                seam.push_back(copy);
+            }
+
+            auto simplified = GLTFMeshSimplifyUtils::SimplifyTriangles(positions, indices, indices.size() / 10);
+
+            Assert::IsTrue(simplified.size() < indices.size() / 2);
+            CheckFacesUp(positions, simplified);
+            for (auto vertex : seam)
+            {
+                Assert::IsTrue(std::find(simplified.begin(), simplified.end(), vertex) != simplified.end());
+            }
+        }
+
+        TEST_METHOD(GLTFMeshSimplifyUtils_SimplifyTriangles_BelowTarget)
+        {
+            std::vector<float> positions;
+            std::vector<uint32_t> indices;
+            TestUtils::MakeGrid(2, positions, indices);
+
+            Assert::IsTrue(indices == GLTFMeshSimplifyUtils::SimplifyTriangles(positions, indices, indices.size()));
+        }
+
+        TEST_METHOD(GLTFMeshSimplifyUtils_GenerateLODs)
+        {
+            std::vector<float> positions;
+            std::vector<uint32_t> indices;
+            TestUtils::MakeGrid(32, positions, indices);
+
+            std::vector<uint16_t> shortIndices(indices.size());
+            std::transform(indices.begin(), indices.end(), shortIndices.begin(), [](uint32_t index) { return static_cast<uint16_t>(index); });
+
+            TestMeshDocument grid("grid.bin", positions, shortIndices);
+            grid.AddMesh({ grid.MakePrimitive() });
+
+            UriStreamReader streamReader({ { "grid.bin", grid.GetData() } });
+            auto lods = GLTFMeshSimplifyUtils::GenerateLODs(streamReader, grid.GetDocument(), { 0.5, 0.1 }, "", 4);
+
+            Assert::AreEqual(size_t(2), lods.size());
+
+            size_t previousCount = indices.size();
+            for (size_t lod = 0; lod < lods.size(); lod++)
+            {
+                const auto& lodDoc = lods[lod];
+                const auto& lodPrimitive = lodDoc.meshes.Get("0").primitives[0];
+
+                // The vertices are shared with the original, only the indices are new
+                Assert::AreEqual(std::string("0"), lodPrimitive.positionsAccessorId);
+                Assert::AreEqual(size_t(2), lodDoc.buffers.Size());
+
+                const auto& lodIndices = lodDoc.accessors.Get(lodPrimitive.indicesAccessorId);
+                Assert::IsTrue(ComponentType::COMPONENT_UNSIGNED_SHORT == lodIndices.componentType);
+                Assert::IsTrue(lodIndices.count < previousCount);
+                previousCount = lodIndices.count;
+
+                const auto& lodBuffer = lodDoc.buffers.Get("1");
+                Assert::AreEqual(lodIndices.count * sizeof(uint16_t), lodBuffer.byteLength);
+
+                std::ifstream saved(lodBuffer.uri, std::ios::binary | std::ios::ate);
+                Assert::AreEqual(static_cast<std::streamoff>(lodBuffer.byteLength), static_cast<std::streamoff>(saved.tellg()));
+            }
+        }
+
+        TEST_METHOD(GLTFMeshSimplifyUtils_GetTriangleRatios)
+        {
+            auto ratios = GLTFMeshSimplifyUtils::GetTriangleRatios({ 0.5, 0.25, 0.05 });
+
+            Assert::AreEqual(size_t(2), ratios.size());
+            Assert::AreEqual(0.5, ratios[0]);
+            Assert::AreEqual(0.1, ratios[1], 1e-9);
+        }
+    };
+}
@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>
+
+#include "GLTFSceneFlatteningUtils.h"
+#include "GLTFLODUtils.h"
+
+#include "Helpers/TestUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(GLTFSceneFlatteningUtilsTests)
+    {
+        // A document with one triangle mesh, drawn by a child node of the scene root for each translation
+        static GLTFDocument MakeScene(const std::vector<Vector3>& translations, std::unordered_map<std::string, std::string>& contents)
+        {
+            TestMeshDocument triangle("triangle.bin", { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f }, { 0, 1, 2 });
+            triangle.AddMesh({ triangle.MakePrimitive("0") });
+
+            auto& doc = triangle.GetDocument();
+
+            Material material;
+            material.id = "0";
+            doc.materials.Append(std::move(material));
+
+            Node root;
+            root.id = "0";
+            root.name = "root";
+
+            for (size_t i = 0; i < translations.size(); i++)
+            {
+                root.children.push_back(std::to_string(i + 1));
+            }
+
+            doc.nodes.Append(std::move(root));
+            for (size_t i = 0; i < translations.size(); i++)
+            {
+                Node node;
+                node.id = std::to_string(i + 1);
+                node.meshId = "0";
+                node.translation = translations[i];
+                doc.nodes.Append(std::move(node));
+            }
+
+            Scene scene;
+            scene.id = "0";
+            scene.nodes.push_back("0");
+            doc.scenes.Append(std::move(scene));
+
+            contents["triangle.bin"] = triangle.GetData();
+            return doc;
+        }
+
+        static std::string ReadFile(const std::string& path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        }
+
+        TEST_METHOD(GLTFSceneFlatteningUtils_FlattenScenes)
+        {
+            std::unordered_map<std::string, std::string> contents;
+            auto doc = MakeScene({ Vector3(0.0f, 0.0f, 0.0f), Vector3(2.0f, 0.0f, 0.0f), Vector3(4.0f, 0.0f, 0.0f) }, contents);
+
+            UriStreamReader streamReader(contents);
+            auto flattenedDoc = GLTFSceneFlatteningUtils::FlattenScenes(streamReader, doc, "", 2);
+
+            // The root draws every triangle with one primitive, and the meshes and accessors it no longer uses are removed
+            Assert::AreEqual(size_t(1), flattenedDoc.nodes.Size());
+            Assert::AreEqual(size_t(1), flattenedDoc.meshes.Size());
+            Assert::AreEqual(size_t(2), flattenedDoc.accessors.Size());
+            Assert::AreEqual(std::string("root"), flattenedDoc.nodes.Get("0").name);
+            Assert::AreEqual(std::string("0"), flattenedDoc.nodes.Get("0").meshId);
+            Assert::IsTrue(flattenedDoc.nodes.Get("0").children.empty());
+
+            const auto& primitives = flattenedDoc.meshes.Get("0").primitives;
+            Assert::AreEqual(size_t(1), primitives.size());
+            Assert::AreEqual(std::string("0"), primitives[0].materialId);
+
+            // The translations are baked into the positions
+            const auto& positions = flattenedDoc.accessors.Get(primitives[0].positionsAccessorId);
+            const auto& indices = flattenedDoc.accessors.Get(primitives[0].indicesAccessorId);
+            Assert::AreEqual(size_t(9), positions.count);
+            Assert::AreEqual(size_t(9), indices.count);
+            Assert::AreEqual(0.0f, positions.min[0]);
+            Assert::AreEqual(5.0f, positions.max[0]);
+
+            auto data = ReadFile(flattenedDoc.buffers.Get("1").uri);
+            const float* newPositions = reinterpret_cast<const float*>(data.data() + flattenedDoc.bufferViews.Get(positions.bufferViewId).byteOffset);
+            const uint16_t* newIndices = reinterpret_cast<const uint16_t*>(data.data() + flattenedDoc.bufferViews.Get(indices.bufferViewId).byteOffset);
+            Assert::AreEqual(2.0f, newPositions[9]);
+            Assert::AreEqual(5.0f, newPositions[21]);
+            Assert::AreEqual(uint16_t(6), newIndices[6]);
+        }
+
+        TEST_METHOD(GLTFSceneFlatteningUtils_FlattenScenes_Mirrored)
+        {
+            std::unordered_map<std::string, std::string> contents;
+            auto doc = MakeScene({ Vector3(0.0f, 0.0f, 0.0f) }, contents);
+
+            auto node = doc.nodes.Get("1");
+            node.scale = Vector3(-1.0f, 1.0f, 1.0f);
+            doc.nodes.Replace(node);
+
+            UriStreamReader streamReader(contents);
+            auto flattenedDoc = GLTFSceneFlatteningUtils::FlattenScenes(streamReader, doc, "");
+
+            // Mirroring the triangle reverses its winding, which is flipped back so that it still faces the same way
+            const auto& primitive = flattenedDoc.meshes.Get("0").primitives[0];
+            const auto& indices = flattenedDoc.accessors.Get(primitive.indicesAccessorId);
+
+            auto data = ReadFile(flattenedDoc.buffers.Get("1").uri);
+            const uint16_t* newIndices = reinterpret_cast<const uint16_t*>(data.data() + flattenedDoc.bufferViews.Get(indices.bufferViewId).byteOffset);
+            Assert::AreEqual(uint16_t(0), newIndices[0]);
+            Assert::AreEqual(uint16_t(2), newIndices[1]);
+            Assert::AreEqual(uint16_t(1), newIndices[2]);
+            Assert::AreEqual(-1.0f, flattenedDoc.accessors.Get(primitive.positionsAccessorId).min[0]);
+        }
+
+        TEST_METHOD(GLTFSceneFlatteningUtils_FlattenScenes_LODs)
+        {
+            std::unordered_map<std::string, std::string> contents;
+            auto doc = MakeScene({ Vector3(0.0f, 0.0f, 0.0f), Vector3(2.0f, 0.0f, 0.0f) }, contents);
+            auto lod = MakeScene({ Vector3(0.0f, 0.0f, 0.0f) }, contents);
+
+            auto merged = GLTFLODUtils::MergeDocumentsAsLODs({ doc, lod });
+
+            UriStreamReader streamReader(contents);
+            auto flattenedDoc = GLTFSceneFlatteningUtils::FlattenScenes(streamReader, merged, "");
+
+            // The root of each level of detail is kept, and the primary root still points to the LOD root by its new index
+            Assert::AreEqual(size_t(2), flattenedDoc.nodes.Size());
+            Assert::AreEqual(size_t(2), flattenedDoc.meshes.Size());
+
+            auto lods = GLTFLODUtils::ParseDocumentNodeLODs(flattenedDoc);
+            Assert::AreEqual(size_t(1), lods.at("0")->size());
+            Assert::AreEqual(std::string("1"), lods.at("0")->at(0));
+            Assert::AreEqual(std::string("root_lod1"), flattenedDoc.nodes.Get("1").name);
+
+            Assert::AreEqual(size_t(6), flattenedDoc.accessors.Get(flattenedDoc.meshes.Get(flattenedDoc.nodes.Get("0").meshId).primitives[0].positionsAccessorId).count);
+            Assert::AreEqual(size_t(3), flattenedDoc.accessors.Get(flattenedDoc.meshes.Get(flattenedDoc.nodes.Get("1").meshId).primitives[0].positionsAccessorId).count);
+        }
+    };
+}
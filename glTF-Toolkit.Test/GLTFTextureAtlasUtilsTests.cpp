@@ -0,0 +1,147 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>
+
+#include <DirectXTex.h>
+
+#include "GLTFTextureAtlasUtils.h"
+
+#include "Helpers/TestUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(GLTFTextureAtlasUtilsTests)
+    {
+        // A PNG of a single color
+        static std::string MakePng(size_t width, size_t height, uint8_t red)
+        {
+            DirectX::ScratchImage image;
+            Assert::IsTrue(SUCCEEDED(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1)));
+            for (size_t i = 0; i < image.GetPixelsSize(); i += 4)
+            {
+                image.GetPixels()[i] = red;
+                image.GetPixels()[i + 1] = 0;
+                image.GetPixels()[i + 2] = 0;
+                image.GetPixels()[i + 3] = 255;
+            }
+
+            DirectX::Blob png;
+            Assert::IsTrue(SUCCEEDED(DirectX::SaveToWICMemory(*image.GetImage(0, 0, 0), DirectX::WIC_FLAGS_NONE, GUID_ContainerFormatPng, png)));
+            return std::string(static_cast<const char*>(png.GetBufferPointer()), png.GetBufferSize());
+        }
+
+        // A mesh with one quad per material, each with its own texture coordinates that span the given range
+        static GLTFDocument MakeQuads(const std::vector<float>& texCoordRanges, std::unordered_map<std::string, std::string>& contents)
+        {
+            TestMeshDocument quads("quads.bin", { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f }, { 0, 1, 2, 0, 2, 3 });
+            auto& doc = quads.GetDocument();
+
+            std::vector<MeshPrimitive> primitives;
+            for (size_t i = 0; i < texCoordRanges.size(); i++)
+            {
+                const float range = texCoordRanges[i];
+
+                Image image;
+                image.id = std::to_string(i);
+                image.uri = "texture" + std::to_string(i) + ".png";
+                contents[image.uri] = MakePng(16, 16, static_cast<uint8_t>(100 + 100 * i));
+
+                Texture texture;
+                texture.id = image.id;
+                texture.imageId = image.id;
+
+                Material material;
+                material.id = image.id;
+                material.name = "material" + image.id;
+                material.metallicRoughness.baseColorTextureId = texture.id;
+
+                MeshPrimitive primitive = quads.MakePrimitive(material.id);
+                primitive.uv0AccessorId = quads.AddVertexAccessor({ 0.0f, 0.0f, range, 0.0f, range, range, 0.0f, range }, AccessorType::TYPE_VEC2);
+                primitives.push_back(std::move(primitive));
+
+                doc.images.Append(std::move(image));
+                doc.textures.Append(std::move(texture));
+                doc.materials.Append(std::move(material));
+            }
+
+            quads.AddMesh(std::move(primitives));
+
+            contents["quads.bin"] = quads.GetData();
+            return doc;
+        }
+
+        TEST_METHOD(GLTFTextureAtlasUtils_AtlasTextures)
+        {
+            std::unordered_map<std::string, std::string> contents;
+            auto doc = MakeQuads({ 1.0f, 1.0f }, contents);
+
+            UriStreamReader streamReader(contents);
+            auto atlasedDoc = GLTFTextureAtlasUtils::AtlasTextures(streamReader, doc, TextureAtlasOptions(), "", 2);
+
+            // Both materials only differed by their texture, so the quads are drawn as one primitive with the first material
+            const auto& primitives = atlasedDoc.meshes.Get("0").primitives;
+            Assert::AreEqual(size_t(1), primitives.size());
+            Assert::AreEqual(std::string("0"), primitives[0].materialId);
+
+            const auto& atlasTexture = atlasedDoc.textures.Get(atlasedDoc.materials.Get("0").metallicRoughness.baseColorTextureId);
+            Assert::AreEqual(size_t(3), atlasedDoc.images.Size());
+            Assert::AreEqual(std::string("image/png"), atlasedDoc.images.Get(atlasTexture.imageId).mimeType);
+
+            // The original images are no longer used, and point to the atlas
+            Assert::AreEqual(atlasedDoc.images.Get(atlasTexture.imageId).uri, atlasedDoc.images.Get("0").uri);
+            Assert::AreEqual(atlasedDoc.images.Get(atlasTexture.imageId).uri, atlasedDoc.images.Get("1").uri);
+
+            const auto& positions = atlasedDoc.accessors.Get(primitives[0].positionsAccessorId);
+            const auto& texCoordsAccessor = atlasedDoc.accessors.Get(primitives[0].uv0AccessorId);
+            const auto& indices = atlasedDoc.accessors.Get(primitives[0].indicesAccessorId);
+            Assert::AreEqual(size_t(8), positions.count);
+            Assert::AreEqual(size_t(8), texCoordsAccessor.count);
+            Assert::AreEqual(size_t(12), indices.count);
+            Assert::AreEqual(1.0f, positions.max[0]);
+
+            // Each quad samples its own part of the atlas, inside its padding
+            std::ifstream saved(atlasedDoc.buffers.Get("1").uri, std::ios::binary);
+            std::string savedData((std::istreambuf_iterator<char>(saved)), std::istreambuf_iterator<char>());
+            const float* texCoords = reinterpret_cast<const float*>(savedData.data() + atlasedDoc.bufferViews.Get(texCoordsAccessor.bufferViewId).byteOffset);
+
+            Assert::IsTrue(texCoords[2] < texCoords[8]);
+            for (size_t i = 0; i < 16; i++)
+            {
+                Assert::IsTrue(texCoords[i] > 0.0f && texCoords[i] < 1.0f);
+            }
+        }
+
+        TEST_METHOD(GLTFTextureAtlasUtils_AtlasTextures_RepeatingTexCoords)
+        {
+            std::unordered_map<std::string, std::string> contents;
+            auto doc = MakeQuads({ 1.0f, 1.0f, 4.0f }, contents);
+
+            UriStreamReader streamReader(contents);
+            auto atlasedDoc = GLTFTextureAtlasUtils::AtlasTextures(streamReader, doc, TextureAtlasOptions(), "");
+
+            // The repeating texture keeps its own texture and primitive
+            const auto& primitives = atlasedDoc.meshes.Get("0").primitives;
+            Assert::AreEqual(size_t(2), primitives.size());
+            Assert::AreEqual(std::string("2"), atlasedDoc.materials.Get("2").metallicRoughness.baseColorTextureId);
+            Assert::AreEqual(std::string("texture2.png"), atlasedDoc.images.Get("2").uri);
+            Assert::IsTrue(doc.accessors.Get("4") == atlasedDoc.accessors.Get("4"));
+        }
+
+        TEST_METHOD(GLTFTextureAtlasUtils_AtlasTextures_SingleMaterial)
+        {
+            std::unordered_map<std::string, std::string> contents;
+            auto doc = MakeQuads({ 1.0f }, contents);
+
+            UriStreamReader streamReader(contents);
+            auto atlasedDoc = GLTFTextureAtlasUtils::AtlasTextures(streamReader, doc, TextureAtlasOptions(), "");
+
+            // An atlas of one texture would not save any draw call
+            Assert::IsTrue(doc == atlasedDoc);
+        }
+    };
+}
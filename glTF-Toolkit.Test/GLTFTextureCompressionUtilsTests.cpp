@@ -11,6 +11,7 @@
 #include "GLTFSDK/GLTFResourceWriter.h"
 
 #include "GLTFTextureCompressionUtils.h"
+#include "DeviceResourcesPool.h"
 
 #include "Helpers/WStringUtils.h"
 #include "Helpers/StreamMock.h"
@@ -57,6 +58,53 @@ namespace Microsoft::glTF::Toolkit::Test
             Assert::IsTrue(memcmp(ddsMip0->pixels, compressedPng.GetPixels(), ddsImageSize), L"ddsImage and compressedPng are not the same");
         }
 
+        TEST_METHOD(GLTFTextureCompressionUtils_CompressImage_DevicePool)
+        {
+            // Load png
+            auto png = TestUtils::ReadLocalAsset(TestUtils::GetAbsolutePath(c_baseColorPng));
+            std::vector<uint8_t> pngData = StreamUtils::ReadBinaryFull<uint8_t>(*png);
+
+            DirectX::TexMetadata info;
+            DirectX::ScratchImage sharedPoolImage;
+            DirectX::LoadFromWICMemory(pngData.data(), pngData.size(), DirectX::WIC_FLAGS_NONE, &info, sharedPoolImage);
+            DirectX::ScratchImage explicitPoolImage;
+            DirectX::LoadFromWICMemory(pngData.data(), pngData.size(), DirectX::WIC_FLAGS_NONE, &info, explicitPoolImage);
+
+            // Compress once with the shared pool and once with a pool that only allows a single device
+            DeviceResourcesPool devicePool(1);
+            GLTFTextureCompressionUtils::CompressImage(sharedPoolImage, TextureCompression::BC3);
+            GLTFTextureCompressionUtils::CompressImage(explicitPoolImage, TextureCompression::BC3, devicePool);
+
+            // The leased device went back to the pool, so it can be leased again
+            {
+                auto lease = devicePool.Acquire();
+            }
+
+            Assert::IsTrue(explicitPoolImage.GetMetadata().format == DXGI_FORMAT_BC3_UNORM);
+            Assert::AreEqual(sharedPoolImage.GetPixelsSize(), explicitPoolImage.GetPixelsSize());
+        }
+
+        TEST_METHOD(GLTFTextureCompressionUtils_CompressImage_Quality)
+        {
+            // Load png
+            auto png = TestUtils::ReadLocalAsset(TestUtils::GetAbsolutePath(c_baseColorPng));
+            std::vector<uint8_t> pngData = StreamUtils::ReadBinaryFull<uint8_t>(*png);
+
+            DirectX::TexMetadata info;
+            DirectX::ScratchImage fastImage;
+            DirectX::LoadFromWICMemory(pngData.data(), pngData.size(), DirectX::WIC_FLAGS_NONE, &info, fastImage);
+            DirectX::ScratchImage maxImage;
+            DirectX::LoadFromWICMemory(pngData.data(), pngData.size(), DirectX::WIC_FLAGS_NONE, &info, maxImage);
+
+            GLTFTextureCompressionUtils::CompressImage(fastImage, TextureCompression::BC7, TextureCompressionQuality::Fast);
+            GLTFTextureCompressionUtils::CompressImage(maxImage, TextureCompression::BC7, TextureCompressionQuality::Max);
+
+            // Every profile produces the same format, only the encoded blocks differ
+            Assert::IsTrue(fastImage.GetMetadata().format == DXGI_FORMAT_BC7_UNORM);
+            Assert::IsTrue(maxImage.GetMetadata().format == DXGI_FORMAT_BC7_UNORM);
+            Assert::AreEqual(fastImage.GetPixelsSize(), maxImage.GetPixelsSize());
+        }
+
         TEST_METHOD(GLTFTextureCompressionUtils_CompressTextureAsDDS_NoCompression)
         {
             // This asset has all textures
@@ -189,6 +237,34 @@ namespace Microsoft::glTF::Toolkit::Test
             });
         }
 
+        TEST_METHOD(GLTFTextureCompressionUtils_CompressTextureAsDDS_TiledMatchesWhole)
+        {
+            // This asset has all textures
+            TestUtils::LoadAndExecuteGLTFTest(c_waterBottleORMJson, [](auto doc, auto path)
+            {
+                CreateDirectoryA("CompressedWhole", NULL);
+                CreateDirectoryA("CompressedTiled", NULL);
+
+                size_t maxTextureSize = 300;
+                auto generateMipMaps = true;
+                auto retainOriginalImages = true;
+                auto wholeDoc = GLTFTextureCompressionUtils::CompressTextureAsDDS(TestStreamReader(path), doc, doc.textures.Get("0"), TextureCompression::BC3, "CompressedWhole", maxTextureSize, generateMipMaps, retainOriginalImages);
+                auto tiledDoc = GLTFTextureCompressionUtils::CompressTextureAsDDS(TestStreamReader(path), doc, doc.textures.Get("0"), TextureCompression::BC3, "CompressedTiled", maxTextureSize, generateMipMaps, retainOriginalImages, "", TextureCompressionQuality::Balanced, 40);
+
+                // Check that compressing a band at a time gives the same file, mip maps included
+                auto readFile = [](const std::string& uri)
+                {
+                    std::ifstream file(uri, std::ios::binary);
+                    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                };
+
+                auto wholeFile = readFile(wholeDoc.images.Elements().back().uri);
+                auto tiledFile = readFile(tiledDoc.images.Elements().back().uri);
+                Assert::IsFalse(wholeFile.empty());
+                Assert::IsTrue(wholeFile == tiledFile);
+            });
+        }
+
         TEST_METHOD(GLTFTextureCompressionUtils_CompressAllTexturesForWindowsMR_Retain)
         {
             // This asset has all textures
@@ -231,5 +307,83 @@ namespace Microsoft::glTF::Toolkit::Test
                 Assert::IsTrue(compressedDoc.images.Get(ddsImageId).uri.compare(9, expectedSuffix.size(), expectedSuffix) == 0); // The emissive texture should have mips and be BC7
             });
         }
+
+        TEST_METHOD(GLTFTextureCompressionUtils_CompressAllTexturesForWindowsMR_Parallel)
+        {
+            // This asset has all textures
+            TestUtils::LoadAndExecuteGLTFTest(c_waterBottleORMJson, [](auto doc, auto path)
+            {
+                auto maxTextureSize = std::numeric_limits<size_t>::max();
+                auto retainOriginalImages = true;
+                auto serialDoc = GLTFTextureCompressionUtils::CompressAllTexturesForWindowsMR(TestStreamReader(path), doc, "", maxTextureSize, retainOriginalImages, 1);
+                auto parallelDoc = GLTFTextureCompressionUtils::CompressAllTexturesForWindowsMR(TestStreamReader(path), doc, "", maxTextureSize, retainOriginalImages, 4);
+
+                // Check that the images were compressed
+                Assert::AreEqual(doc.images.Size() + 4, parallelDoc.images.Size());
+
+                // Check that compressing in parallel results in the same document
+                Assert::IsTrue(serialDoc == parallelDoc);
+            });
+        }
+
+        TEST_METHOD(GLTFTextureCompressionUtils_CompressAllTexturesForWindowsMR_SharedImage)
+        {
+            // This asset has all textures
+            TestUtils::LoadAndExecuteGLTFTest(c_waterBottleORMJson, [](auto doc, auto path)
+            {
+                // Make the emissive texture read the same image as the base color texture
+                Material material(doc.materials.Get("0"));
+                Texture emissiveTexture(doc.textures.Get(material.metallicRoughness.baseColorTextureId));
+                emissiveTexture.id = std::to_string(doc.textures.Size());
+                doc.textures.Append(Texture(emissiveTexture));
+                material.emissiveTextureId = emissiveTexture.id;
+                doc.materials.Replace(material);
+
+                auto compressedDoc = GLTFTextureCompressionUtils::CompressAllTexturesForWindowsMR(TestStreamReader(path), doc, "", std::numeric_limits<size_t>::max(), true);
+
+                auto getDDSImageUri = [&compressedDoc](const std::string& textureId)
+                {
+                    rapidjson::Document ddsJson;
+                    ddsJson.Parse(compressedDoc.textures.Get(textureId).extensions.at(std::string(EXTENSION_MSFT_TEXTURE_DDS)).c_str());
+                    return compressedDoc.images.Get(std::to_string(ddsJson["source"].GetInt())).uri;
+                };
+
+                // Check that both textures point to the same compressed file
+                Assert::IsTrue(getDDSImageUri(material.metallicRoughness.baseColorTextureId) == getDDSImageUri(emissiveTexture.id));
+            });
+        }
+
+        TEST_METHOD(GLTFTextureCompressionUtils_CompressAllTexturesForWindowsMR_Cache)
+        {
+            // This asset has all textures
+            TestUtils::LoadAndExecuteGLTFTest(c_waterBottleORMJson, [](auto doc, auto path)
+            {
+                const std::string cacheDirectory = "TextureCache";
+                CreateDirectoryA(cacheDirectory.c_str(), NULL);
+
+                auto maxTextureSize = std::numeric_limits<size_t>::max();
+                auto retainOriginalImages = true;
+                auto uncachedDoc = GLTFTextureCompressionUtils::CompressAllTexturesForWindowsMR(TestStreamReader(path), doc, "", maxTextureSize, retainOriginalImages, 1, cacheDirectory);
+                auto cachedDoc = GLTFTextureCompressionUtils::CompressAllTexturesForWindowsMR(TestStreamReader(path), doc, "", maxTextureSize, retainOriginalImages, 1, cacheDirectory);
+
+                // Check that one entry was cached for each compressed texture
+                size_t cachedFileCount = 0;
+                WIN32_FIND_DATAA findData;
+                auto findHandle = FindFirstFileA((cacheDirectory + "\\*.dds").c_str(), &findData);
+                if (findHandle != INVALID_HANDLE_VALUE)
+                {
+                    do
+                    {
+                        cachedFileCount++;
+                    } while (FindNextFileA(findHandle, &findData));
+                    FindClose(findHandle);
+                }
+
+                Assert::AreEqual(static_cast<size_t>(4), cachedFileCount);
+
+                // Check that reusing the cached results produces the same document
+                Assert::IsTrue(uncachedDoc == cachedDoc);
+            });
+        }
     };
 }
@@ -0,0 +1,201 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>  
+
+#include "GLTFSDK/GLTFConstants.h"
+#include "GLTFSDK/Deserialize.h"
+
+#include "GLTFTextureLoadingUtils.h"
+
+#include "Helpers/WStringUtils.h"
+#include "Helpers/TestUtils.h"
+
+#include <DirectXTex.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(GLTFTextureLoadingUtilsTests)
+    {
+        const char* c_waterBottleJson = "Resources\\gltf\\WaterBottle\\WaterBottle.gltf";
+
+        TEST_METHOD(GLTFTextureLoadingUtils_LoadTexture_DefaultFormat)
+        {
+            TestUtils::LoadAndExecuteGLTFTest(c_waterBottleJson, [](auto doc, auto path)
+            {
+                auto image = GLTFTextureLoadingUtils::LoadTexture(TestStreamReader(path), doc, doc.textures.Elements()[0].id);
+
+                Assert::IsTrue(image.GetMetadata().format == DXGI_FORMAT_R32G32B32A32_FLOAT);
+            });
+        }
+
+        TEST_METHOD(GLTFTextureLoadingUtils_LoadTexture_RequestedFormat)
+        {
+            TestUtils::LoadAndExecuteGLTFTest(c_waterBottleJson, [](auto doc, auto path)
+            {
+                auto textureId = doc.textures.Elements()[0].id;
+                auto floatImage = GLTFTextureLoadingUtils::LoadTexture(TestStreamReader(path), doc, textureId);
+                auto byteImage = GLTFTextureLoadingUtils::LoadTexture(TestStreamReader(path), doc, textureId, DXGI_FORMAT_R8G8B8A8_UNORM);
+
+                // Check that the texture has the same dimensions with a quarter of the memory
+                Assert::IsTrue(byteImage.GetMetadata().format == DXGI_FORMAT_R8G8B8A8_UNORM);
+                Assert::AreEqual(floatImage.GetMetadata().width, byteImage.GetMetadata().width);
+                Assert::AreEqual(floatImage.GetMetadata().height, byteImage.GetMetadata().height);
+                Assert::AreEqual(floatImage.GetPixelsSize(), byteImage.GetPixelsSize() * 4);
+            });
+        }
+
+        TEST_METHOD(GLTFTextureLoadingUtils_LoadTexture_DecodedFormat)
+        {
+            TestUtils::LoadAndExecuteGLTFTest(c_waterBottleJson, [](auto doc, auto path)
+            {
+                auto image = GLTFTextureLoadingUtils::LoadTexture(TestStreamReader(path), doc, doc.textures.Elements()[0].id, DXGI_FORMAT_UNKNOWN);
+
+                // PNG textures are decoded to 8 bits per channel, and must not be widened
+                Assert::IsTrue(DirectX::BitsPerPixel(image.GetMetadata().format) <= 32);
+            });
+        }
+
+        TEST_METHOD(GLTFTextureLoadingUtils_LoadImageData_Scaled)
+        {
+            // A 300x200 PNG of a single color
+            DirectX::ScratchImage source;
+            Assert::IsTrue(SUCCEEDED(source.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 300, 200, 1, 1)));
+            for (size_t i = 0; i < source.GetPixelsSize(); i += 4)
+            {
+                source.GetPixels()[i] = 200;
+                source.GetPixels()[i + 1] = 100;
+                source.GetPixels()[i + 2] = 50;
+                source.GetPixels()[i + 3] = 255;
+            }
+
+            DirectX::Blob png;
+            Assert::IsTrue(SUCCEEDED(DirectX::SaveToWICMemory(*source.GetImage(0, 0, 0), DirectX::WIC_FLAGS_NONE, GUID_ContainerFormatPng, png)));
+
+            auto image = GLTFTextureLoadingUtils::LoadImageData(static_cast<const uint8_t*>(png.GetBufferPointer()), png.GetBufferSize(), DXGI_FORMAT_R8G8B8A8_UNORM, 128, true);
+
+            // Scaled to fit in 128 pixels, with a full mip chain down to 1x1
+            Assert::IsTrue(image.GetMetadata().format == DXGI_FORMAT_R8G8B8A8_UNORM);
+            Assert::AreEqual(size_t(128), image.GetMetadata().width);
+            Assert::AreEqual(size_t(85), image.GetMetadata().height);
+            Assert::AreEqual(size_t(8), image.GetMetadata().mipLevels);
+
+            // Every level keeps the color, up to rounding
+            for (size_t level = 0; level < image.GetMetadata().mipLevels; level++)
+            {
+                const auto* mip = image.GetImage(level, 0, 0);
+                const uint8_t* lastPixel = mip->pixels + (mip->height - 1) * mip->rowPitch + (mip->width - 1) * 4;
+                Assert::IsTrue(std::abs(lastPixel[0] - 200) <= 1);
+                Assert::IsTrue(std::abs(lastPixel[1] - 100) <= 1);
+                Assert::IsTrue(std::abs(lastPixel[2] - 50) <= 1);
+            }
+
+            // Images that already fit are not resized
+            auto unscaled = GLTFTextureLoadingUtils::LoadImageData(static_cast<const uint8_t*>(png.GetBufferPointer()), png.GetBufferSize(), DXGI_FORMAT_R8G8B8A8_UNORM, 512, false);
+            Assert::AreEqual(size_t(300), unscaled.GetMetadata().width);
+            Assert::AreEqual(size_t(1), unscaled.GetMetadata().mipLevels);
+        }
+
+        TEST_METHOD(GLTFTextureLoadingUtils_LoadImageData_OddSizeMipMaps)
+        {
+            // A 3x3 image whose last row and column are brighter than the rest
+            DirectX::ScratchImage source;
+            Assert::IsTrue(SUCCEEDED(source.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 3, 3, 1, 1)));
+            for (size_t y = 0; y < 3; y++)
+            {
+                for (size_t x = 0; x < 3; x++)
+                {
+                    uint8_t* pixel = source.GetPixels() + y * source.GetImage(0, 0, 0)->rowPitch + x * 4;
+                    pixel[0] = pixel[1] = pixel[2] = static_cast<uint8_t>((x == 2 || y == 2) ? 250 : 100);
+                    pixel[3] = 255;
+                }
+            }
+
+            DirectX::Blob png;
+            Assert::IsTrue(SUCCEEDED(DirectX::SaveToWICMemory(*source.GetImage(0, 0, 0), DirectX::WIC_FLAGS_NONE, GUID_ContainerFormatPng, png)));
+            DirectX::Blob dds;
+            Assert::IsTrue(SUCCEEDED(DirectX::SaveToDDSMemory(*source.GetImage(0, 0, 0), DirectX::DDS_FLAGS_NONE, dds)));
+
+            // Images read by WIC use the 2x2 box filter, which does not sample the last row and column
+            auto boxFiltered = GLTFTextureLoadingUtils::LoadImageData(static_cast<const uint8_t*>(png.GetBufferPointer()), png.GetBufferSize(), DXGI_FORMAT_R8G8B8A8_UNORM, 16, true);
+            Assert::AreEqual(size_t(2), boxFiltered.GetMetadata().mipLevels);
+            const auto* boxLevel = boxFiltered.GetImage(1, 0, 0);
+            Assert::AreEqual(size_t(1), boxLevel->width);
+            Assert::AreEqual(size_t(1), boxLevel->height);
+            Assert::AreEqual(uint8_t(100), boxLevel->pixels[0]);
+
+            // Other images get the same levels from DirectXTex's default filter
+            auto defaultFiltered = GLTFTextureLoadingUtils::LoadImageData(static_cast<const uint8_t*>(dds.GetBufferPointer()), dds.GetBufferSize(), DXGI_FORMAT_R8G8B8A8_UNORM, 16, true);
+            DirectX::ScratchImage expected;
+            Assert::IsTrue(SUCCEEDED(DirectX::GenerateMipMaps(*source.GetImage(0, 0, 0), DirectX::TEX_FILTER_DEFAULT, 0, expected)));
+
+            Assert::AreEqual(size_t(2), defaultFiltered.GetMetadata().mipLevels);
+            const auto* defaultLevel = defaultFiltered.GetImage(1, 0, 0);
+            Assert::AreEqual(size_t(1), defaultLevel->width);
+            Assert::AreEqual(size_t(1), defaultLevel->height);
+            Assert::IsTrue(std::equal(defaultLevel->pixels, defaultLevel->pixels + 4, expected.GetImage(1, 0, 0)->pixels));
+        }
+
+        TEST_METHOD(GLTFTextureLoadingUtils_LoadImageDataTiled)
+        {
+            // A 300x200 PNG of a gradient, so that every band and mip level differs
+            DirectX::ScratchImage source;
+            Assert::IsTrue(SUCCEEDED(source.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 300, 200, 1, 1)));
+            for (size_t y = 0; y < 200; y++)
+            {
+                for (size_t x = 0; x < 300; x++)
+                {
+                    uint8_t* pixel = source.GetPixels() + y * source.GetImage(0, 0, 0)->rowPitch + x * 4;
+                    pixel[0] = static_cast<uint8_t>(x);
+                    pixel[1] = static_cast<uint8_t>(y);
+                    pixel[2] = static_cast<uint8_t>(x * y);
+                    pixel[3] = 255;
+                }
+            }
+
+            DirectX::Blob png;
+            Assert::IsTrue(SUCCEEDED(DirectX::SaveToWICMemory(*source.GetImage(0, 0, 0), DirectX::WIC_FLAGS_NONE, GUID_ContainerFormatPng, png)));
+            auto pngData = static_cast<const uint8_t*>(png.GetBufferPointer());
+
+            auto whole = GLTFTextureLoadingUtils::LoadImageData(pngData, png.GetBufferSize(), DXGI_FORMAT_R8G8B8A8_UNORM, 128, true);
+
+            // Bands of 6 rows are rounded up to 8
+            std::vector<size_t> rowsRead(whole.GetMetadata().mipLevels);
+            bool tiled = GLTFTextureLoadingUtils::LoadImageDataTiled(pngData, png.GetBufferSize(), 128, true, 6,
+                [&](const DirectX::TexMetadata& metadata, size_t mipLevel, size_t firstRow, const DirectX::Image& band)
+            {
+                Assert::AreEqual(whole.GetMetadata().width, metadata.width);
+                Assert::AreEqual(whole.GetMetadata().height, metadata.height);
+                Assert::AreEqual(whole.GetMetadata().mipLevels, metadata.mipLevels);
+
+                // The bands of each level come in order, and have the pixels of the whole image
+                const DirectX::Image* level = whole.GetImage(mipLevel, 0, 0);
+                Assert::AreEqual(rowsRead[mipLevel], firstRow);
+                Assert::AreEqual(level->width, band.width);
+                Assert::IsTrue(band.height <= 8);
+                for (size_t y = 0; y < band.height; y++)
+                {
+                    Assert::AreEqual(0, memcmp(level->pixels + (firstRow + y) * level->rowPitch, band.pixels + y * band.rowPitch, band.width * 4));
+                }
+
+                rowsRead[mipLevel] += band.height;
+            });
+
+            Assert::IsTrue(tiled);
+            for (size_t level = 0; level < rowsRead.size(); level++)
+            {
+                Assert::AreEqual(whole.GetImage(level, 0, 0)->height, rowsRead[level]);
+            }
+
+            // DDS data is not read by WIC
+            DirectX::Blob dds;
+            Assert::IsTrue(SUCCEEDED(DirectX::SaveToDDSMemory(*source.GetImage(0, 0, 0), DirectX::DDS_FLAGS_NONE, dds)));
+            Assert::IsFalse(GLTFTextureLoadingUtils::LoadImageDataTiled(static_cast<const uint8_t*>(dds.GetBufferPointer()), dds.GetBufferSize(), 128, true, 6,
+                [](const DirectX::TexMetadata&, size_t, size_t, const DirectX::Image&) { Assert::Fail(); }));
+        }
+    };
+}
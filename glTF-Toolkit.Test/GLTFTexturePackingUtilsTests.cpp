@@ -166,6 +166,113 @@ namespace Microsoft::glTF::Toolkit::Test
             // Check that they're the same when there's one material
             Assert::IsTrue(*documentPackedSingleTexture == *documentPackedAllTextures);
         }
+
+        TEST_METHOD(GLTFTexturePackingUtils_PackAllInPlace)
+        {
+            // This asset has all textures
+            TestUtils::LoadAndExecuteGLTFTest(c_waterBottleJson, [](auto doc, auto path)
+            {
+                auto packedDoc = GLTFTexturePackingUtils::PackAllMaterialsForWindowsMR(TestStreamReader(path), doc, TexturePacking::OcclusionRoughnessMetallic, "");
+
+                GLTFDocument inPlaceDoc(doc);
+                GLTFTexturePackingUtils::PackAllMaterialsForWindowsMRInPlace(TestStreamReader(path), inPlaceDoc, TexturePacking::OcclusionRoughnessMetallic, "");
+
+                // Check that packing in place changes the document in the same way
+                Assert::IsTrue(doc != inPlaceDoc);
+                Assert::IsTrue(packedDoc == inPlaceDoc);
+            });
+        }
+
+        TEST_METHOD(GLTFTexturePackingUtils_PackAllSharesTexturePairs)
+        {
+            // This asset has all textures
+            TestUtils::LoadAndExecuteGLTFTest(c_waterBottleJson, [](auto doc, auto path)
+            {
+                // Add a second material with the same textures
+                Material duplicateMaterial(doc.materials.Elements()[0]);
+                duplicateMaterial.id = std::to_string(doc.materials.Size());
+                doc.materials.Append(std::move(duplicateMaterial));
+
+                auto packedDoc = GLTFTexturePackingUtils::PackAllMaterialsForWindowsMR(TestStreamReader(path), doc, TexturePacking::RoughnessMetallicOcclusion, "");
+
+                // Check that the texture pair was only packed once
+                Assert::AreEqual(doc.images.Size() + 1, packedDoc.images.Size());
+                Assert::AreEqual(doc.textures.Size() + 1, packedDoc.textures.Size());
+
+                // Check that both materials point to the same packed texture
+                auto firstExtension = packedDoc.materials.Elements()[0].extensions.at(std::string(EXTENSION_MSFT_PACKING_ORM));
+                auto secondExtension = packedDoc.materials.Elements()[1].extensions.at(std::string(EXTENSION_MSFT_PACKING_ORM));
+                Assert::IsTrue(firstExtension == secondExtension);
+            });
+        }
+
+        TEST_METHOD(GLTFTexturePackingUtils_Pack8BitMatchesFloat)
+        {
+            // This asset has all textures
+            TestUtils::LoadAndExecuteGLTFTest(c_waterBottleJson, [](auto doc, auto path)
+            {
+                CreateDirectoryA("PackedFloat", NULL);
+                CreateDirectoryA("Packed8Bit", NULL);
+
+                auto floatDoc = GLTFTexturePackingUtils::PackAllMaterialsForWindowsMR(TestStreamReader(path), doc, TexturePacking::RoughnessMetallicOcclusion, "PackedFloat", DXGI_FORMAT_R32G32B32A32_FLOAT);
+                auto byteDoc = GLTFTexturePackingUtils::PackAllMaterialsForWindowsMR(TestStreamReader(path), doc, TexturePacking::RoughnessMetallicOcclusion, "Packed8Bit", DXGI_FORMAT_R8G8B8A8_UNORM);
+
+                auto floatImageUri = floatDoc.images.Elements().back().uri;
+                auto byteImageUri = byteDoc.images.Elements().back().uri;
+
+                DirectX::ScratchImage floatImage;
+                DirectX::ScratchImage byteImage;
+                Assert::IsTrue(SUCCEEDED(DirectX::LoadFromWICFile(std::wstring(floatImageUri.begin(), floatImageUri.end()).c_str(), DirectX::WIC_FLAGS_NONE, nullptr, floatImage)));
+                Assert::IsTrue(SUCCEEDED(DirectX::LoadFromWICFile(std::wstring(byteImageUri.begin(), byteImageUri.end()).c_str(), DirectX::WIC_FLAGS_NONE, nullptr, byteImage)));
+
+                // Check that packing 8-bit sources directly gives the same pixels, up to rounding
+                Assert::AreEqual(floatImage.GetPixelsSize(), byteImage.GetPixelsSize());
+                auto floatPixels = floatImage.GetPixels();
+                auto bytePixels = byteImage.GetPixels();
+                for (size_t i = 0; i < floatImage.GetPixelsSize(); i++)
+                {
+                    Assert::IsTrue(std::abs(static_cast<int>(floatPixels[i]) - static_cast<int>(bytePixels[i])) <= 1);
+                }
+            });
+        }
+
+        TEST_METHOD(GLTFTexturePackingUtils_PackTiledMatchesWhole)
+        {
+            // This asset has all textures, of the same size
+            TestUtils::LoadAndExecuteGLTFTest(c_waterBottleJson, [](auto doc, auto path)
+            {
+                CreateDirectoryA("PackedWhole", NULL);
+                CreateDirectoryA("PackedTiled", NULL);
+
+                auto wholeDoc = GLTFTexturePackingUtils::PackAllMaterialsForWindowsMR(TestStreamReader(path), doc, (TexturePacking)(TexturePacking::OcclusionRoughnessMetallic | TexturePacking::RoughnessMetallicOcclusion), "PackedWhole", DXGI_FORMAT_R8G8B8A8_UNORM);
+                auto tiledDoc = GLTFTexturePackingUtils::PackAllMaterialsForWindowsMR(TestStreamReader(path), doc, (TexturePacking)(TexturePacking::OcclusionRoughnessMetallic | TexturePacking::RoughnessMetallicOcclusion), "PackedTiled", DXGI_FORMAT_R8G8B8A8_UNORM, 100);
+
+                // Check that the same textures are added
+                Assert::AreEqual(wholeDoc.images.Size(), tiledDoc.images.Size());
+                Assert::IsTrue(wholeDoc.materials.Elements()[0].extensions == tiledDoc.materials.Elements()[0].extensions);
+
+                for (size_t i = doc.images.Size(); i < wholeDoc.images.Size(); i++)
+                {
+                    auto wholeImageUri = wholeDoc.images[i].uri;
+                    auto tiledImageUri = tiledDoc.images[i].uri;
+                    Assert::IsTrue(wholeImageUri != tiledImageUri);
+
+                    DirectX::ScratchImage wholeImage;
+                    DirectX::ScratchImage tiledImage;
+                    Assert::IsTrue(SUCCEEDED(DirectX::LoadFromWICFile(std::wstring(wholeImageUri.begin(), wholeImageUri.end()).c_str(), DirectX::WIC_FLAGS_NONE, nullptr, wholeImage)));
+                    Assert::IsTrue(SUCCEEDED(DirectX::LoadFromWICFile(std::wstring(tiledImageUri.begin(), tiledImageUri.end()).c_str(), DirectX::WIC_FLAGS_NONE, nullptr, tiledImage)));
+
+                    // Check that packing a band at a time gives the same pixels, up to rounding
+                    Assert::AreEqual(wholeImage.GetPixelsSize(), tiledImage.GetPixelsSize());
+                    auto wholePixels = wholeImage.GetPixels();
+                    auto tiledPixels = tiledImage.GetPixels();
+                    for (size_t j = 0; j < wholeImage.GetPixelsSize(); j++)
+                    {
+                        Assert::IsTrue(std::abs(static_cast<int>(wholePixels[j]) - static_cast<int>(tiledPixels[j])) <= 1);
+                    }
+                }
+            });
+        }
     };
 }
 
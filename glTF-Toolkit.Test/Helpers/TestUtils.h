@@ -21,6 +21,9 @@
 #include <algorithm>
 #include <string>
 #include <iostream>
+#include <limits>
+#include <unordered_map>
+#include <vector>
 
 namespace Microsoft::glTF::Toolkit::Test
 {
@@ -114,6 +117,27 @@ namespace Microsoft::glTF::Toolkit::Test
             return tempStream;
         }
 
+        // A flat grid of size x size quads on the z = 0 plane, facing +z
+        static void MakeGrid(uint32_t size, std::vector<float>& positions, std::vector<uint32_t>& indices)
+        {
+            for (uint32_t y = 0; y <= size; y++)
+            {
+                for (uint32_t x = 0; x <= size; x++)
+                {
+                    positions.insert(positions.end(), { static_cast<float>(x), static_cast<float>(y), 0.0f });
+                }
+            }
+
+            for (uint32_t y = 0; y < size; y++)
+            {
+                for (uint32_t x = 0; x < size; x++)
+                {
+                    uint32_t corner = y * (size + 1) + x;
+                    indices.insert(indices.end(), { corner, corner + 1, corner + size + 2, corner, corner + size + 2, corner + size + 1 });
+                }
+            }
+        }
+
         typedef std::function<void(const GLTFDocument& doc, const std::string& gltfAbsolutePath)> GLTFAction;
 
         static void LoadAndExecuteGLTFTest(const char * gltfRelativePath, GLTFAction action)
@@ -159,4 +183,116 @@ namespace Microsoft::glTF::Toolkit::Test
     private:
         const std::string m_basePath;
     };
+
+    // Serves the contents of each URI from memory
+    class UriStreamReader : public IStreamReader
+    {
+    public:
+        UriStreamReader(std::unordered_map<std::string, std::string> contents) :
+            m_contents(std::move(contents))
+        { }
+
+        std::shared_ptr<std::istream> GetInputStream(const std::string& uri) const override
+        {
+            return std::make_shared<std::stringstream>(m_contents.at(uri), std::ios_base::binary | std::ios_base::in);
+        }
+    private:
+        const std::unordered_map<std::string, std::string> m_contents;
+    };
+
+    // Builds a document whose accessors are all packed into one buffer, kept in memory to be served by a UriStreamReader.
+    // The positions and 16-bit indices of a triangle mesh are accessors "0" and "1", over buffer views "0" and "1".
+    class TestMeshDocument
+    {
+    public:
+        TestMeshDocument(const std::string& uri, const std::vector<float>& positions, const std::vector<uint16_t>& indices)
+        {
+            Buffer buffer;
+            buffer.id = "0";
+            buffer.uri = uri;
+            buffer.byteLength = 0;
+            m_doc.buffers.Append(std::move(buffer));
+
+            auto positionsId = AddAccessor(positions, ComponentType::COMPONENT_FLOAT, AccessorType::TYPE_VEC3, BufferViewTarget::ARRAY_BUFFER);
+            AddAccessor(indices, ComponentType::COMPONENT_UNSIGNED_SHORT, AccessorType::TYPE_SCALAR, BufferViewTarget::ELEMENT_ARRAY_BUFFER);
+
+            // Positions require bounds
+            Accessor positionsAccessor(m_doc.accessors.Get(positionsId));
+            positionsAccessor.min.assign(3, std::numeric_limits<float>::max());
+            positionsAccessor.max.assign(3, std::numeric_limits<float>::lowest());
+            for (size_t i = 0; i < positions.size(); i++)
+            {
+                positionsAccessor.min[i % 3] = std::min(positionsAccessor.min[i % 3], positions[i]);
+                positionsAccessor.max[i % 3] = std::max(positionsAccessor.max[i % 3], positions[i]);
+            }
+
+            m_doc.accessors.Replace(positionsAccessor);
+        }
+
+        // Appends the values to the buffer, with a buffer view and an accessor over them, and returns the id of the accessor
+        template <typename T>
+        std::string AddAccessor(const std::vector<T>& values, ComponentType componentType, AccessorType type, BufferViewTarget target)
+        {
+            BufferView bufferView;
+            bufferView.id = std::to_string(m_doc.bufferViews.Size());
+            bufferView.bufferId = "0";
+            bufferView.byteOffset = m_data.size();
+            bufferView.byteLength = values.size() * sizeof(T);
+            bufferView.target = target;
+            m_data.append(reinterpret_cast<const char*>(values.data()), bufferView.byteLength);
+
+            Accessor accessor;
+            accessor.id = std::to_string(m_doc.accessors.Size());
+            accessor.bufferViewId = bufferView.id;
+            accessor.componentType = componentType;
+            accessor.type = type;
+            accessor.count = values.size() / Accessor::GetTypeCount(type);
+
+            Buffer buffer(m_doc.buffers.Get("0"));
+            buffer.byteLength = m_data.size();
+            m_doc.buffers.Replace(buffer);
+
+            auto id = accessor.id;
+            m_doc.bufferViews.Append(std::move(bufferView));
+            m_doc.accessors.Append(std::move(accessor));
+            return id;
+        }
+
+        // Appends a float vertex attribute, and returns the id of its accessor
+        std::string AddVertexAccessor(const std::vector<float>& values, AccessorType type)
+        {
+            return AddAccessor(values, ComponentType::COMPONENT_FLOAT, type, BufferViewTarget::ARRAY_BUFFER);
+        }
+
+        // A triangle list over the positions and indices
+        MeshPrimitive MakePrimitive(const std::string& materialId = std::string()) const
+        {
+            MeshPrimitive primitive;
+            primitive.positionsAccessorId = "0";
+            primitive.indicesAccessorId = "1";
+            primitive.materialId = materialId;
+            primitive.mode = MeshMode::MESH_TRIANGLES;
+            return primitive;
+        }
+
+        // Adds a mesh with the given primitives, and returns its id
+        std::string AddMesh(std::vector<MeshPrimitive> primitives)
+        {
+            Mesh mesh;
+            mesh.id = std::to_string(m_doc.meshes.Size());
+            mesh.primitives = std::move(primitives);
+
+            auto id = mesh.id;
+            m_doc.meshes.Append(std::move(mesh));
+            return id;
+        }
+
+        GLTFDocument& GetDocument() { return m_doc; }
+
+        const std::string& GetData() const { return m_data; }
+
+    private:
+        GLTFDocument m_doc;
+        std::string m_data;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>
+
+#include <rapidjson/document.h>
+
+#include "Instrumentation.h"
+#include "ParallelUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(InstrumentationTests)
+    {
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            Instrumentation::SetEnabled(false);
+            Instrumentation::Clear();
+        }
+
+        TEST_METHOD(Instrumentation_Disabled)
+        {
+            Instrumentation::Clear();
+            {
+                Instrumentation::Stage stage("Stage");
+                stage.AddBytesRead(10);
+            }
+
+            Assert::AreEqual(size_t(0), Instrumentation::GetRecords().size());
+        }
+
+        TEST_METHOD(Instrumentation_NestedStages)
+        {
+            Instrumentation::Clear();
+            Instrumentation::SetEnabled(true);
+
+            {
+                Instrumentation::ContextScope context({ "asset.gltf" });
+                Instrumentation::Stage outer("Outer");
+                outer.AddBytesWritten(42);
+
+                // Stages on helper threads are attached to the stage that started the loop
+                ParallelUtils::ParallelFor(8, 4, [](size_t)
+                {
+                    Instrumentation::Stage inner("Inner");
+                    inner.SetProperty("device", "CPU");
+                });
+            }
+
+            auto records = Instrumentation::GetRecords();
+            Assert::AreEqual(size_t(9), records.size());
+
+            const auto& outer = records[0];
+            Assert::AreEqual(std::string("Outer"), outer.name);
+            Assert::AreEqual(uint64_t(0), outer.parentId);
+            Assert::AreEqual(uint64_t(42), outer.bytesWritten);
+            Assert::IsTrue(outer.peakWorkingSet > 0);
+
+            for (size_t i = 1; i < records.size(); i++)
+            {
+                Assert::AreEqual(std::string("Inner"), records[i].name);
+                Assert::AreEqual(std::string("asset.gltf"), records[i].context);
+                Assert::AreEqual(outer.id, records[i].parentId);
+                Assert::IsTrue(records[i].wallTime <= outer.wallTime);
+            }
+        }
+
+        TEST_METHOD(Instrumentation_Output)
+        {
+            Instrumentation::Clear();
+            Instrumentation::SetEnabled(true);
+
+            {
+                Instrumentation::Stage stage("CompressTextureAsDDS");
+                stage.SetProperty("texture", "0");
+            }
+
+            std::stringstream json;
+            Instrumentation::WriteJson(json);
+
+            rapidjson::Document profile;
+            profile.Parse(json.str().c_str());
+            Assert::IsFalse(profile.HasParseError());
+            Assert::AreEqual(rapidjson::SizeType(1), profile["stages"].Size());
+            Assert::AreEqual("0", profile["stages"][0]["properties"]["texture"].GetString());
+
+            std::stringstream trace;
+            Instrumentation::WriteChromeTrace(trace);
+
+            rapidjson::Document events;
+            events.Parse(trace.str().c_str());
+            Assert::IsFalse(events.HasParseError());
+            Assert::AreEqual("X", events["traceEvents"][0]["ph"].GetString());
+            Assert::AreEqual("CompressTextureAsDDS", events["traceEvents"][0]["name"].GetString());
+        }
+    };
+}
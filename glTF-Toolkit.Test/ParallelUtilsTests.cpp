@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "ParallelUtils.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(ParallelUtilsTests)
+    {
+        TEST_METHOD(ParallelUtils_ParallelFor_Nested)
+        {
+            const size_t outerCount = 8;
+            const size_t innerCount = 50;
+
+            // Nested loops share the pool, and must not wait for each other's helpers
+            std::vector<std::atomic<size_t>> visits(outerCount * innerCount);
+            ParallelUtils::ParallelFor(outerCount, 4, [&](size_t i)
+            {
+                ParallelUtils::ParallelFor(innerCount, 4, [&](size_t j)
+                {
+                    visits[i * innerCount + j]++;
+                });
+            });
+
+            for (const auto& count : visits)
+            {
+                Assert::AreEqual(size_t(1), count.load());
+            }
+        }
+
+        TEST_METHOD(ParallelUtils_ParallelFor_Exception)
+        {
+            std::atomic<size_t> visits(0);
+            Assert::ExpectException<std::runtime_error>([&]()
+            {
+                ParallelUtils::ParallelFor(100, 4, [&](size_t i)
+                {
+                    visits++;
+                    if (i == 10)
+                    {
+                        throw std::runtime_error("Failed");
+                    }
+                });
+            });
+
+            Assert::IsTrue(visits > 0);
+        }
+
+        TEST_METHOD(ParallelUtils_ConcurrencyLimit)
+        {
+            ConcurrencyLimit limit(2);
+
+            std::atomic<size_t> holders(0);
+            std::atomic<size_t> maxHolders(0);
+            ParallelUtils::ParallelFor(32, 8, [&](size_t)
+            {
+                auto lease = limit.Acquire();
+
+                auto current = ++holders;
+                auto previousMax = maxHolders.load();
+                while (current > previousMax && !maxHolders.compare_exchange_weak(previousMax, current))
+                {
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                holders--;
+            });
+
+            Assert::IsTrue(maxHolders <= 2);
+            Assert::AreEqual(size_t(0), holders.load());
+        }
+    };
+}
@@ -0,0 +1,122 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include <CppUnitTest.h>
+
+#include <thread>
+
+#include "ScratchArena.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace Microsoft::glTF::Toolkit::Test
+{
+    TEST_CLASS(ScratchArenaTests)
+    {
+        TEST_METHOD(ScratchArena_ReusesSimilarSizes)
+        {
+            ScratchArena arena;
+
+            uint8_t* first;
+            {
+                auto lease = arena.Acquire(100000);
+                Assert::AreEqual(size_t(100000), lease.size());
+                first = lease.data();
+            }
+
+            // A slightly smaller buffer is in the same size class, so it gets the released one
+            auto lease = arena.Acquire(99000);
+            Assert::IsTrue(first == lease.data());
+
+            auto statistics = arena.GetStatistics();
+            Assert::AreEqual(uint64_t(2), statistics.acquisitions);
+            Assert::AreEqual(uint64_t(1), statistics.reuses);
+            Assert::AreEqual(size_t(0), statistics.bytesIdle);
+            Assert::IsTrue(statistics.bytesInUse >= 99000 && statistics.bytesInUse < 100000 * 5 / 4);
+        }
+
+        TEST_METHOD(ScratchArena_HighWaterMark)
+        {
+            ScratchArena arena;
+
+            {
+                auto first = arena.Acquire(1 << 20);
+                auto second = arena.Acquire(1 << 20);
+            }
+
+            auto statistics = arena.GetStatistics();
+            Assert::AreEqual(size_t(0), statistics.bytesInUse);
+            Assert::AreEqual(size_t(2 << 20), statistics.bytesIdle);
+            Assert::AreEqual(size_t(2 << 20), statistics.peakBytesInUse);
+            Assert::AreEqual(size_t(2 << 20), statistics.peakBytesReserved);
+
+            arena.ResetPeaks();
+            Assert::AreEqual(size_t(0), arena.GetStatistics().peakBytesInUse);
+            Assert::AreEqual(size_t(2 << 20), arena.GetStatistics().peakBytesReserved);
+
+            arena.Trim();
+            Assert::AreEqual(size_t(0), arena.GetStatistics().bytesIdle);
+        }
+
+        TEST_METHOD(ScratchArena_MaxIdleBytes)
+        {
+            ScratchArena arena(1 << 20);
+
+            {
+                auto kept = arena.Acquire(1 << 20);
+                auto freed = arena.Acquire(1 << 20);
+            }
+
+            // Only the buffer that fits under the limit is kept
+            Assert::AreEqual(size_t(1 << 20), arena.GetStatistics().bytesIdle);
+        }
+
+        TEST_METHOD(ScratchArena_EmptyAndMovedLeases)
+        {
+            ScratchArena arena;
+
+            auto empty = arena.Acquire(0);
+            Assert::IsTrue(empty.data() == nullptr);
+            Assert::AreEqual(uint64_t(0), arena.GetStatistics().acquisitions);
+
+            auto lease = arena.Acquire(10);
+            ScratchArena::Lease moved(std::move(lease));
+            Assert::IsTrue(lease.data() == nullptr);
+            Assert::AreEqual(size_t(10), moved.size());
+
+            // Assigning over a lease releases its buffer once
+            moved = arena.Acquire(5000);
+            moved = ScratchArena::Lease();
+            Assert::AreEqual(size_t(0), arena.GetStatistics().bytesInUse);
+        }
+
+        TEST_METHOD(ScratchArena_Threads)
+        {
+            ScratchArena arena;
+
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < 8; t++)
+            {
+                threads.emplace_back([&arena]()
+                {
+                    for (size_t i = 0; i < 1000; i++)
+                    {
+                        auto lease = arena.Acquire(1000 + i * 37);
+                        lease.data()[lease.size() - 1] = 1;
+                    }
+                });
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            auto statistics = arena.GetStatistics();
+            Assert::AreEqual(uint64_t(8000), statistics.acquisitions);
+            Assert::AreEqual(size_t(0), statistics.bytesInUse);
+            Assert::IsTrue(statistics.reuses > 0);
+        }
+    };
+}
@@ -4,11 +4,126 @@
 #pragma once
 
 #include <GLTFSDK/GLTFDocument.h>
+#include <cstring>
+#include <emmintrin.h>
 #include <functional>
+#include <limits>
+#include <type_traits>
 #include <vector>
 
 namespace Microsoft::glTF::Toolkit
 {
+    namespace Detail
+    {
+        constexpr size_t Gcd(size_t a, size_t b)
+        {
+            return b == 0 ? a : Gcd(b, a % b);
+        }
+
+        inline __m128 LoadAsFloat4(const int8_t* source)
+        {
+            int32_t bits;
+            memcpy(&bits, source, sizeof(bits));
+            __m128i v = _mm_cvtsi32_si128(bits);
+            v = _mm_unpacklo_epi8(v, v);
+            v = _mm_unpacklo_epi16(v, v);
+            return _mm_cvtepi32_ps(_mm_srai_epi32(v, 24));
+        }
+
+        inline __m128 LoadAsFloat4(const uint8_t* source)
+        {
+            int32_t bits;
+            memcpy(&bits, source, sizeof(bits));
+            const __m128i zero = _mm_setzero_si128();
+            __m128i v = _mm_cvtsi32_si128(bits);
+            v = _mm_unpacklo_epi8(v, zero);
+            v = _mm_unpacklo_epi16(v, zero);
+            return _mm_cvtepi32_ps(v);
+        }
+
+        inline __m128 LoadAsFloat4(const int16_t* source)
+        {
+            __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+            v = _mm_unpacklo_epi16(v, v);
+            return _mm_cvtepi32_ps(_mm_srai_epi32(v, 16));
+        }
+
+        inline __m128 LoadAsFloat4(const uint16_t* source)
+        {
+            __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+            v = _mm_unpacklo_epi16(v, _mm_setzero_si128());
+            return _mm_cvtepi32_ps(v);
+        }
+
+        inline __m128 LoadAsFloat4(const uint32_t* source)
+        {
+            // Values above INT32_MAX don't survive a signed conversion, so the two halves are converted separately.
+            // hi * 65536 is exact, which leaves the addition as the only rounding step, as in static_cast<float>.
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+            __m128 hi = _mm_cvtepi32_ps(_mm_srli_epi32(v, 16));
+            __m128 lo = _mm_cvtepi32_ps(_mm_and_si128(v, _mm_set1_epi32(0xFFFF)));
+            return _mm_add_ps(_mm_mul_ps(hi, _mm_set1_ps(65536.0f)), lo);
+        }
+
+        inline __m128 LoadAsFloat4(const float* source)
+        {
+            return _mm_loadu_ps(source);
+        }
+
+        // Converts components to float four at a time, keeping min and max per register lane. A block of
+        // lcm(4, TypeCount) components always starts on the first component of an element, so every lane of
+        // every register in the block maps to the same element component. Returns the number of components
+        // converted; the caller handles the remainder.
+        template <typename Source, size_t TypeCount>
+        size_t ConvertToFloatWithMinMax(const Source* source, size_t componentCount, float* destination, float* min, float* max)
+        {
+            constexpr size_t BlockSize = 4 * TypeCount / Gcd(4, TypeCount);
+            constexpr size_t RegisterCount = BlockSize / 4;
+
+            if (componentCount < BlockSize)
+            {
+                return 0;
+            }
+
+            __m128 minLanes[RegisterCount];
+            __m128 maxLanes[RegisterCount];
+            for (size_t r = 0; r < RegisterCount; r++)
+            {
+                minLanes[r] = _mm_setr_ps(min[(4 * r) % TypeCount], min[(4 * r + 1) % TypeCount], min[(4 * r + 2) % TypeCount], min[(4 * r + 3) % TypeCount]);
+                maxLanes[r] = _mm_setr_ps(max[(4 * r) % TypeCount], max[(4 * r + 1) % TypeCount], max[(4 * r + 2) % TypeCount], max[(4 * r + 3) % TypeCount]);
+            }
+
+            size_t i = 0;
+            for (; i + BlockSize <= componentCount; i += BlockSize)
+            {
+                for (size_t r = 0; r < RegisterCount; r++)
+                {
+                    __m128 v = LoadAsFloat4(source + i + 4 * r);
+                    _mm_storeu_ps(destination + i + 4 * r, v);
+                    minLanes[r] = _mm_min_ps(minLanes[r], v);
+                    maxLanes[r] = _mm_max_ps(maxLanes[r], v);
+                }
+            }
+
+            for (size_t r = 0; r < RegisterCount; r++)
+            {
+                alignas(16) float minValues[4];
+                alignas(16) float maxValues[4];
+                _mm_store_ps(minValues, minLanes[r]);
+                _mm_store_ps(maxValues, maxLanes[r]);
+
+                for (size_t lane = 0; lane < 4; lane++)
+                {
+                    auto component = (4 * r + lane) % TypeCount;
+                    min[component] = std::min(min[component], minValues[lane]);
+                    max[component] = std::max(max[component], maxValues[lane]);
+                }
+            }
+
+            return i;
+        }
+    }
+
     /// <summary>
     /// Utilities to manipulate accessors in a glTF asset.
     /// </summary>
@@ -27,33 +142,103 @@ namespace Microsoft::glTF::Toolkit
         static std::pair<std::vector<float>, std::vector<float>> CalculateMinMax(const Accessor& accessor, const std::vector<T>& accessorContents)
         {
             auto typeCount = Accessor::GetTypeCount(accessor.type);
-            auto min = std::vector<float>(typeCount);
-            auto max = std::vector<float>(typeCount);
+            auto min = std::vector<float>();
+            auto max = std::vector<float>();
 
             if (accessorContents.size() < typeCount)
             {
                 throw std::invalid_argument("The accessor must contain data in order to calculate min and max.");
             }
 
-            // Initialize min and max with the first elements of the array
-            for (size_t j = 0; j < typeCount; j++)
+            AccumulateMinMax(accessorContents.data(), accessor.count, typeCount, min, max);
+
+            return std::make_pair(min, max);
+        }
+
+        /// <summary>
+        /// Extends running min and max values with a block of tightly packed accessor elements, so they can be
+        /// calculated without holding the whole accessor in memory.
+        /// <param name="elements">The elements to add, each made of typeCount components.</param>
+        /// <param name="elementCount">The number of elements in the block.</param>
+        /// <param name="typeCount">The number of components per element.</param>
+        /// <param name="min">The running min values. If empty, it is initialized from the first element.</param>
+        /// <param name="max">The running max values. If empty, it is initialized from the first element.</param>
+        /// </summary>
+        template <typename T>
+        static void AccumulateMinMax(const T* elements, size_t elementCount, size_t typeCount, std::vector<float>& min, std::vector<float>& max)
+        {
+            if (elementCount == 0)
             {
-                auto current = static_cast<float>(accessorContents[j]);
-                min[j] = current;
-                max[j] = current;
+                return;
+            }
+
+            size_t first = 0;
+            if (min.empty() || max.empty())
+            {
+                // Initialize min and max with the first elements of the array
+                min.resize(typeCount);
+                max.resize(typeCount);
+                for (size_t j = 0; j < typeCount; j++)
+                {
+                    auto current = static_cast<float>(elements[j]);
+                    min[j] = current;
+                    max[j] = current;
+                }
+
+                first = 1;
             }
 
-            for (size_t i = 1; i < accessor.count; i++)
+            for (size_t i = first; i < elementCount; i++)
             {
                 for (size_t j = 0; j < typeCount; j++)
                 {
-                    auto current = static_cast<float>(accessorContents[i * typeCount + j]);
+                    auto current = static_cast<float>(elements[i * typeCount + j]);
                     min[j] = std::min(min[j], current);
                     max[j] = std::max(max[j], current);
                 }
             }
+        }
 
-            return std::make_pair(min, max);
+        /// <summary>
+        /// Converts tightly packed accessor elements to another component type, extending running min and max
+        /// values of the converted data in the same pass. Conversions to float are vectorized.
+        /// <param name="source">The elements to convert, each made of TypeCount components.</param>
+        /// <param name="elementCount">The number of elements to convert.</param>
+        /// <param name="destination">Receives elementCount * TypeCount converted components.</param>
+        /// <param name="min">The running min values. If empty, it is initialized from the first element.</param>
+        /// <param name="max">The running max values. If empty, it is initialized from the first element.</param>
+        /// </summary>
+        template <typename Source, typename Destination, size_t TypeCount>
+        static void ConvertWithMinMax(const Source* source, size_t elementCount, Destination* destination, std::vector<float>& min, std::vector<float>& max)
+        {
+            if (elementCount == 0)
+            {
+                return;
+            }
+
+            if (min.empty() || max.empty())
+            {
+                min.assign(TypeCount, std::numeric_limits<float>::infinity());
+                max.assign(TypeCount, -std::numeric_limits<float>::infinity());
+            }
+
+            const size_t componentCount = elementCount * TypeCount;
+            size_t i = 0;
+
+            if constexpr (std::is_same_v<Destination, float>)
+            {
+                i = Detail::ConvertToFloatWithMinMax<Source, TypeCount>(source, componentCount, destination, min.data(), max.data());
+            }
+
+            for (; i < componentCount; i++)
+            {
+                destination[i] = static_cast<Destination>(source[i]);
+
+                auto current = static_cast<float>(destination[i]);
+                auto component = i % TypeCount;
+                min[component] = std::min(min[component], current);
+                max[component] = std::max(max[component], current);
+            }
         }
     };
 }
@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <GLTFSDK/GLTFDocument.h>
+#include <array>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Microsoft::glTF
+{
+    class GLTFResourceReader;
+}
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// Appends bufferViews to a single new buffer, which is saved to a file, for the passes that rewrite mesh data.
+    /// </summary>
+    class BufferWriter
+    {
+    public:
+        /// <summary>
+        /// Prepares a buffer that will be written to a file in the output directory. The file is only created once the first bufferView is added.
+        /// </summary>
+        /// <param name="doc">The document to which the bufferViews and the buffer are added.</param>
+        /// <param name="outputDirectory">The directory in which the buffer file is written.</param>
+        /// <param name="fileName">The name of the buffer file.</param>
+        BufferWriter(GLTFDocument& doc, const std::string& outputDirectory, const std::string& fileName);
+
+        BufferWriter(const BufferWriter&) = delete;
+        BufferWriter& operator=(const BufferWriter&) = delete;
+
+        /// <summary>
+        /// Writes data to the buffer, aligned to 4 bytes, and adds a bufferView for it to the document.
+        /// </summary>
+        /// <returns>The identifier of the new bufferView.</returns>
+        std::string AddBufferView(const std::vector<uint8_t>& data, size_t byteStride, BufferViewTarget target);
+
+        /// <summary>
+        /// Closes the file and adds the buffer to the document, if any bufferView was added.
+        /// </summary>
+        void Finish();
+
+    private:
+        GLTFDocument& m_doc;
+        const std::string m_fileName;
+        const std::wstring m_path;
+        const std::string m_bufferId;
+        size_t m_byteLength;
+        std::ofstream m_output;
+    };
+
+    /// <summary>
+    /// The vertex attributes of a primitive, in the order returned by <see cref="BufferUtils::GetAttributeIds" />.
+    /// </summary>
+    enum VertexAttribute : size_t
+    {
+        POSITION_ATTRIBUTE,
+        NORMAL_ATTRIBUTE,
+        TANGENT_ATTRIBUTE,
+        UV0_ATTRIBUTE,
+        UV1_ATTRIBUTE,
+        COLOR0_ATTRIBUTE,
+        JOINTS0_ATTRIBUTE,
+        WEIGHTS0_ATTRIBUTE,
+        ATTRIBUTE_COUNT
+    };
+
+    typedef std::array<std::string, ATTRIBUTE_COUNT> VertexAttributeIds;
+
+    /// <summary>
+    /// The tightly packed elements of one vertex attribute, merged from the vertices of several primitives, and their bounds.
+    /// </summary>
+    struct MergedVertexAttribute
+    {
+        std::vector<uint8_t> elements;
+        std::vector<float> min;
+        std::vector<float> max;
+
+        /// <summary>Whether min and max are the bounds of every element. They are dropped once any merged vertices have none.</summary>
+        bool hasBounds = true;
+    };
+
+    /// <summary>
+    /// Utilities for the passes that rewrite the vertices of primitives into new bufferViews.
+    /// </summary>
+    class BufferUtils
+    {
+    public:
+        /// <summary>
+        /// Gets the accessor ids of the vertex attributes of a primitive, indexed by <see cref="VertexAttribute" />. Attributes that the primitive does not have are empty.
+        /// </summary>
+        static VertexAttributeIds GetAttributeIds(const MeshPrimitive& primitive);
+
+        /// <summary>
+        /// Sets the accessor ids of the vertex attributes of a primitive, indexed by <see cref="VertexAttribute" />.
+        /// </summary>
+        static void SetAttributeIds(MeshPrimitive& primitive, const VertexAttributeIds& ids);
+
+        /// <summary>
+        /// Appends the elements of a vertex accessor to a merged attribute. The merged bounds are those of the appended accessors.
+        /// </summary>
+        static void AppendElements(const GLTFResourceReader& reader, const GLTFDocument& doc, const Accessor& accessor, MergedVertexAttribute& merged);
+
+        /// <summary>
+        /// Appends float elements computed by the caller to a merged attribute, and measures their bounds.
+        /// </summary>
+        /// <param name="typeCount">The number of components of each element.</param>
+        static void AppendFloats(const std::vector<float>& values, size_t typeCount, MergedVertexAttribute& merged);
+
+        /// <summary>
+        /// Gets the byte stride of vertex elements of the given size, which is rounded up so that each element starts on a 4-byte boundary.
+        /// </summary>
+        static size_t GetVertexByteStride(size_t elementSize);
+
+        /// <summary>
+        /// Copies tightly packed vertex elements so that each starts at a multiple of <see cref="GetVertexByteStride" />.
+        /// </summary>
+        static std::vector<uint8_t> PadVertexElements(const void* elements, size_t count, size_t elementSize);
+
+        /// <summary>
+        /// Writes the elements of a merged attribute to a new bufferView, padded to <see cref="GetVertexByteStride" />, and adds an accessor for them.
+        /// </summary>
+        /// <param name="templateAccessor">An accessor of the merged attribute, whose type, component type and other properties are kept.</param>
+        /// <returns>The id of the new accessor.</returns>
+        static std::string AddVertexAccessor(GLTFDocument& doc, BufferWriter& writer, const Accessor& templateAccessor, const MergedVertexAttribute& merged, size_t count);
+    };
+}
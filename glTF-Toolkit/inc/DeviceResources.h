@@ -1,67 +1,67 @@
-// Copyright (c) Microsoft Corporation. All rights reserved.
-// Licensed under the MIT License. See LICENSE in the project root for license information.
-
-#pragma once
-
-namespace DX
-{
-    /// <summary>
-    /// Controls all the DirectX device resources.
-    /// </summary>
-    class DeviceResources
-    {
-    public:
-        DeviceResources(D3D_FEATURE_LEVEL minFeatureLevel = D3D_FEATURE_LEVEL_10_0);
-
-        void CreateDeviceResources();
-        void HandleDeviceLost();
-
-        // Direct3D Accessors.
-        ID3D11Device1*          GetD3DDevice() const                    { return m_d3dDevice.Get(); }
-        ID3D11DeviceContext1*   GetD3DDeviceContext() const             { return m_d3dContext.Get(); }
-        IDXGISwapChain1*        GetSwapChain() const                    { return m_swapChain.Get(); }
-        D3D_FEATURE_LEVEL       GetDeviceFeatureLevel() const           { return m_d3dFeatureLevel; }
-
-    private:
-        void GetHardwareAdapter(IDXGIAdapter1** ppAdapter);
-
-        // Direct3D objects.
-        Microsoft::WRL::ComPtr<ID3D11Device1>               m_d3dDevice;
-        Microsoft::WRL::ComPtr<ID3D11DeviceContext1>        m_d3dContext;
-        Microsoft::WRL::ComPtr<IDXGISwapChain1>             m_swapChain;
-        Microsoft::WRL::ComPtr<ID3DUserDefinedAnnotation>   m_d3dAnnotation;
-
-        // Direct3D properties.
-        D3D_FEATURE_LEVEL                               m_d3dMinFeatureLevel;
-
-        // Cached device properties.
-        D3D_FEATURE_LEVEL                               m_d3dFeatureLevel;
-    };
-
-    // Helper class for COM exceptions
-    class com_exception : public std::exception
-    {
-    public:
-        com_exception(HRESULT hr) : result(hr) {}
-
-        virtual const char* what() const override
-        {
-            static char s_str[64] = { 0 };
-            sprintf_s(s_str, "Failure with HRESULT of %08X", result);
-            return s_str;
-        }
-
-    private:
-        HRESULT result;
-    };
-
-    // Helper utility converts D3D API failures into exceptions.
-    inline void ThrowIfFailed(HRESULT hr)
-    {
-        if (FAILED(hr))
-        {
-            throw com_exception(hr);
-        }
-    }
-
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+namespace DX
+{
+    /// <summary>
+    /// Controls all the DirectX device resources.
+    /// </summary>
+    class DeviceResources
+    {
+    public:
+        DeviceResources(D3D_FEATURE_LEVEL minFeatureLevel = D3D_FEATURE_LEVEL_10_0);
+
+        void CreateDeviceResources();
+        void HandleDeviceLost();
+
+        // Direct3D Accessors.
+        ID3D11Device1*          GetD3DDevice() const                    { return m_d3dDevice.Get(); }
+        ID3D11DeviceContext1*   GetD3DDeviceContext() const             { return m_d3dContext.Get(); }
+        IDXGISwapChain1*        GetSwapChain() const                    { return m_swapChain.Get(); }
+        D3D_FEATURE_LEVEL       GetDeviceFeatureLevel() const           { return m_d3dFeatureLevel; }
+
+    private:
+        void GetHardwareAdapter(IDXGIAdapter1** ppAdapter);
+
+        // Direct3D objects.
+        Microsoft::WRL::ComPtr<ID3D11Device1>               m_d3dDevice;
+        Microsoft::WRL::ComPtr<ID3D11DeviceContext1>        m_d3dContext;
+        Microsoft::WRL::ComPtr<IDXGISwapChain1>             m_swapChain;
+        Microsoft::WRL::ComPtr<ID3DUserDefinedAnnotation>   m_d3dAnnotation;
+
+        // Direct3D properties.
+        D3D_FEATURE_LEVEL                               m_d3dMinFeatureLevel;
+
+        // Cached device properties.
+        D3D_FEATURE_LEVEL                               m_d3dFeatureLevel;
+    };
+
+    // Helper class for COM exceptions
+    class com_exception : public std::exception
+    {
+    public:
+        com_exception(HRESULT hr) : result(hr) {}
+
+        virtual const char* what() const override
+        {
+            static char s_str[64] = { 0 };
+            sprintf_s(s_str, "Failure with HRESULT of %08X", result);
+            return s_str;
+        }
+
+    private:
+        HRESULT result;
+    };
+
+    // Helper utility converts D3D API failures into exceptions.
+    inline void ThrowIfFailed(HRESULT hr)
+    {
+        if (FAILED(hr))
+        {
+            throw com_exception(hr);
+        }
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace DX
+{
+    class DeviceResources;
+}
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// A thread-safe pool of Direct3D 11 devices and immediate contexts for GPU texture compression.
+    /// <para>Devices are created lazily, the first time no idle device is available, and are reused by later callers.
+    /// A device is only ever handed to one caller at a time, since its immediate context is not thread-safe.
+    /// If a device cannot be created (e.g. on a machine with no GPU), the pool stops trying and hands out empty leases.</para>
+    /// </summary>
+    class DeviceResourcesPool
+    {
+    public:
+        /// <summary>
+        /// Exclusive access to one device of the pool. The device goes back to the pool when the lease is destroyed.
+        /// </summary>
+        class Lease
+        {
+        public:
+            Lease(Lease&& other);
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+            ~Lease();
+
+            /// <summary>The leased device resources, or nullptr if no device is available.</summary>
+            DX::DeviceResources* Get() const { return m_resources.get(); }
+            DX::DeviceResources* operator->() const { return m_resources.get(); }
+            explicit operator bool() const { return m_resources != nullptr; }
+
+            /// <summary>
+            /// Recreates the leased device after it was removed or reset, through <see cref="DX::DeviceResources::HandleDeviceLost" />.
+            /// </summary>
+            /// <returns>True if the device was recreated. If false, the lease is now empty and the device is removed from the pool.</returns>
+            bool HandleDeviceLost();
+
+        private:
+            friend class DeviceResourcesPool;
+            Lease(DeviceResourcesPool* pool, std::unique_ptr<DX::DeviceResources> resources);
+
+            DeviceResourcesPool* m_pool;
+            std::unique_ptr<DX::DeviceResources> m_resources;
+        };
+
+        /// <summary>
+        /// Creates an empty pool.
+        /// </summary>
+        /// <param name="maxDevices">The maximum number of devices that can exist at the same time. If 0, the number of devices is only
+        /// bounded by the number of concurrent callers. When the limit is reached, <see cref="Acquire" /> waits for a device to be released.</param>
+        DeviceResourcesPool(size_t maxDevices = 0);
+        ~DeviceResourcesPool();
+
+        /// <summary>
+        /// Leases a device from the pool, creating one if no idle device is available.
+        /// </summary>
+        /// <returns>A lease on a device, which is empty if no Direct3D device can be created on this machine.</returns>
+        Lease Acquire();
+
+        /// <summary>
+        /// Gets the pool shared by all toolkit operations that do not receive one explicitly.
+        /// </summary>
+        static DeviceResourcesPool& GetShared();
+
+    private:
+        void Release(std::unique_ptr<DX::DeviceResources> resources);
+
+        std::mutex m_mutex;
+        std::condition_variable m_deviceReleased;
+        std::vector<std::unique_ptr<DX::DeviceResources>> m_idleDevices;
+        size_t m_maxDevices;
+        size_t m_deviceCount;
+        bool m_deviceCreationFailed;
+    };
+}
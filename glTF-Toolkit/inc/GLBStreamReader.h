@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <GLTFSDK/IStreamReader.h>
+
+#include <memory>
+#include <string>
+
+namespace Microsoft::glTF::Toolkit
+{
+    class MemoryMappedFile;
+
+    /// <summary>
+    /// A stream reader that serves the resources of a glTF-Binary (GLB) file directly from a memory mapping of that file,
+    /// so that a GLB asset can be processed without unpacking it to disk first.
+    /// <para>The GLB binary chunk is returned for the buffer without a URI. Other URIs, such as images written
+    /// by the texture utilities, are opened as files relative to the directory of the GLB file.</para>
+    /// </summary>
+    class GLBStreamReader : public IStreamReader
+    {
+    public:
+        /// <summary>
+        /// Maps and parses the GLB file at the specified path. Throws a GLTFException if the file is not a valid GLB file.
+        /// </summary>
+        /// <param name="glbPath">The path to the GLB file.</param>
+        GLBStreamReader(const std::string& glbPath);
+
+        std::shared_ptr<std::istream> GetInputStream(const std::string& uri) const override;
+
+        /// <summary>The contents of the JSON chunk of the GLB file.</summary>
+        const std::string& GetJson() const { return m_json; }
+
+        /// <summary>The contents of the binary chunk of the GLB file, or nullptr if it has none.</summary>
+        const uint8_t* GetBufferData() const { return m_bufferData; }
+
+        /// <summary>The size of the binary chunk of the GLB file, in bytes.</summary>
+        size_t GetBufferSize() const { return m_bufferSize; }
+
+    private:
+        std::shared_ptr<MemoryMappedFile> m_file;
+        std::wstring m_basePath;
+        std::string m_json;
+        const uint8_t* m_bufferData;
+        size_t m_bufferSize;
+    };
+}
@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Microsoft::glTF::Toolkit
+{
+    const uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+    const uint32_t GLB_VERSION = 2;
+    const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+    const uint32_t GLB_CHUNK_BIN = 0x004E4942; // "BIN\0"
+
+    /// <summary>
+    /// The JSON chunk and the optional binary chunk of a GLB file held in memory.
+    /// </summary>
+    struct GLBChunks
+    {
+        std::string json;
+
+        /// <summary>The start of the binary chunk, inside the parsed data, or null if the file has no binary chunk.</summary>
+        const uint8_t* bufferData = nullptr;
+        size_t bufferSize = 0;
+    };
+
+    /// <summary>
+    /// Utilities to read the container format of glTF-Binary (GLB) files.
+    /// </summary>
+    class GLBUtils
+    {
+    public:
+        /// <summary>
+        /// Parses the header and chunks of a GLB file held in memory. Only the JSON chunk is copied.
+        /// </summary>
+        /// <param name="data">The contents of the GLB file, which must outlive the returned binary chunk.</param>
+        /// <param name="size">The size of the GLB file, in bytes.</param>
+        /// <returns>The JSON chunk and the location of the binary chunk.</returns>
+        static GLBChunks ParseGLB(const uint8_t* data, size_t size);
+    };
+}
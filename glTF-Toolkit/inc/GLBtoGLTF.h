@@ -20,6 +20,8 @@ namespace Microsoft::glTF::Toolkit
         /// <summary>
         /// Unpacks a GLB asset into a GLTF manifest and its 
         /// resources (bin files and images).
+        /// The GLB file is memory mapped, and each resource is written straight from the mapped file,
+        /// so the GLB is never fully loaded into memory.
         /// </summary>
         /// <param name="glbPath">The path to the GLB file to unpack.</param>
         /// <param name="outDirectory">The directory to which the glTF manifest and resources will be unpacked.</param>
@@ -42,6 +44,16 @@ namespace Microsoft::glTF::Toolkit
         /// </returns>
         static std::vector<char> SaveBin(std::istream* in, const Microsoft::glTF::GLTFDocument& glbDoc, const size_t bufferOffset, const size_t newBufferlength);
 
+        /// <summary>
+        /// Writes the contents of all buffer views that are not images from the binary chunk of a GLB file
+        /// to a stream, with the same layout as <see cref="SaveBin" /> but without holding the result in memory.
+        /// </summary>
+        /// <param name="bufferData">The contents of the GLB binary chunk, e.g. in a memory mapped GLB file.</param>
+        /// <param name="bufferSize">The size of the GLB binary chunk, in bytes.</param>
+        /// <param name="glbDoc">The manifest describing the GLB asset.</param>
+        /// <param name="output">The stream to which the bin file contents will be written.</param>
+        static void SaveBin(const uint8_t* bufferData, size_t bufferSize, const Microsoft::glTF::GLTFDocument& glbDoc, std::ostream& output);
+
         /// <summary>
         /// Loads all images in a glTF-Binary (GLB) asset into a map relating each image identifier to the contents of that image.
         /// </summary>
@@ -54,6 +66,18 @@ namespace Microsoft::glTF::Toolkit
         /// </returns>
         static std::unordered_map<std::string, std::vector<char>> GetImagesData(std::istream* in, const Microsoft::glTF::GLTFDocument& glbDoc, const std::string& name, const size_t bufferOffset);
 
+        /// <summary>
+        /// Finds all images in the binary chunk of a GLB file held in memory, without copying them.
+        /// </summary>
+        /// <param name="bufferData">The contents of the GLB binary chunk, e.g. in a memory mapped GLB file.</param>
+        /// <param name="bufferSize">The size of the GLB binary chunk, in bytes.</param>
+        /// <param name="glbDoc">The manifest describing the GLB asset.</param>
+        /// <param name="name">The name that should be used when creating the identifiers for the image files.</param>
+        /// <returns>
+        /// A map relating each image identifier to a pointer to the contents of that image in bufferData and its size.
+        /// </returns>
+        static std::unordered_map<std::string, std::pair<const uint8_t*, size_t>> GetImagesData(const uint8_t* bufferData, size_t bufferSize, const Microsoft::glTF::GLTFDocument& glbDoc, const std::string& name);
+
         /// <summary>
         /// Creates the glTF manifest that represents a GLB file after unpacking.
         /// </summary>
@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// The member paths of the values inside the JSON of an extension, e.g. { "normalTexture", "index" }.
+    /// The elements of an array are matched by the member name "[]", e.g. { "ids", "[]" } for the indices of MSFT_lod.
+    /// </summary>
+    typedef std::vector<std::vector<std::string>> JsonMemberPaths;
+
+    /// <summary>
+    /// Utilities to read and rewrite the indices that glTF extensions use to reference other elements of a document.
+    /// The extension JSON is streamed once from its string, without building a DOM, so that stages that visit the
+    /// extensions of every node, material or texture of large documents do not parse and serialize each of them again.
+    /// </summary>
+    class GLTFExtensionUtils
+    {
+    public:
+        /// <summary>
+        /// Reads the non-negative integers found at the given member paths of extension JSON.
+        /// </summary>
+        /// <param name="json">The JSON of the extension.</param>
+        /// <param name="paths">The member paths of the indices to read.</param>
+        /// <returns>The indices found at each path, in the order of <see name="paths" />, and in document order for each path.</returns>
+        static std::vector<std::vector<size_t>> ReadIndices(const std::string& json, const JsonMemberPaths& paths);
+
+        /// <summary>
+        /// Replaces the non-negative integers found at the given member paths of extension JSON. Every other value is kept as is.
+        /// </summary>
+        /// <param name="json">The JSON of the extension, which is rewritten.</param>
+        /// <param name="paths">The member paths of the indices to replace.</param>
+        /// <param name="remap">Returns the new value of an index.</param>
+        static void RemapIndices(std::string& json, const JsonMemberPaths& paths, const std::function<size_t(size_t)>& remap);
+    };
+}
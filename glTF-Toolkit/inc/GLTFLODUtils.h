@@ -4,6 +4,8 @@
 #pragma once
 
 #include <GLTFSDK/GLTFDocument.h>
+#include <GLTFSDK/IStreamReader.h>
+#include <memory>
 
 namespace Microsoft::glTF::Toolkit
 {
@@ -42,6 +44,20 @@ namespace Microsoft::glTF::Toolkit
         /// vector is larger than the size of <see name="docs" />, lower coverage values will cause the asset to be invisible.</param>
         static GLTFDocument MergeDocumentsAsLODs(const std::vector<GLTFDocument>& docs, const std::vector<double>& screenCoveragePercentages);
 
+        /// <summary>
+        /// Inserts each LOD GLTFDocument as a node LOD (at the root level) of the specified primary GLTF asset,
+        /// reusing the images, samplers and textures that are identical to ones already in the merged asset. Buffer views
+        /// that only hold reused images are dropped.
+        /// Note: Animation is not currently supported.
+        /// </summary>
+        /// <returns>The primary GLTF Document with the inserted LOD node.</returns>
+        /// <param name="docs">A vector of glTF documents to merge as LODs. The first element of the vector is assumed to be the primary LOD.</param>
+        /// <param name="screenCoveragePercentages">A vector with the screen coverage percentages corresponding to each LOD. If the size of this 
+        /// vector is larger than the size of <see name="docs" />, lower coverage values will cause the asset to be invisible.</param>
+        /// <param name="streamReaders">A stream reader for each document in <see name="docs" />, used to compare image contents.
+        /// If empty, every resource of every LOD is appended.</param>
+        static GLTFDocument MergeDocumentsAsLODs(const std::vector<GLTFDocument>& docs, const std::vector<double>& screenCoveragePercentages, const std::vector<std::shared_ptr<IStreamReader>>& streamReaders);
+
         /// <summary>
         /// Determines the highest number of Node LODs for a given glTF asset.
         /// </summary>
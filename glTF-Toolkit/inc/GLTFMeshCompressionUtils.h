@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Microsoft::glTF::Toolkit
+{
+    extern const char* EXTENSION_EXT_MESHOPT_COMPRESSION;
+
+    /// <summary>
+    /// How the vertex and index data of a GLB is stored.
+    /// </summary>
+    enum class MeshCompression
+    {
+        /// <summary>Vertex and index data is stored as is.</summary>
+        None,
+
+        /// <summary>Vertex and index data is compressed with EXT_meshopt_compression, which loaders are required to support.</summary>
+        Meshopt,
+
+        /// <summary>Vertex and index data is compressed with EXT_meshopt_compression, and also stored as is for loaders
+        /// that do not support the extension, so the GLB is larger than its uncompressed version.</summary>
+        MeshoptWithFallback
+    };
+
+    /// <summary>
+    /// The kind of data in a bufferView compressed with EXT_meshopt_compression.
+    /// </summary>
+    enum class MeshoptMode
+    {
+        /// <summary>Vertex attributes, whose elements are compressed byte by byte from the previous element.</summary>
+        Attributes,
+
+        /// <summary>Triangle list indices, compressed from the edges and vertices shared with recent triangles.
+        /// Decoding may rotate the indices of each triangle, which keeps its winding.</summary>
+        Triangles,
+
+        /// <summary>Any other indices, compressed from recent indices.</summary>
+        Indices
+    };
+
+    /// <summary>
+    /// Utilities to compress the vertex and index data of glTF assets with the codecs of the EXT_meshopt_compression extension.
+    /// </summary>
+    class GLTFMeshCompressionUtils
+    {
+    public:
+        /// <summary>
+        /// Compresses the contents of a bufferView.
+        /// </summary>
+        /// <param name="mode">The kind of data in the bufferView.</param>
+        /// <param name="data">The contents of the bufferView, with elements <see name="byteStride" /> bytes apart.</param>
+        /// <param name="count">The number of elements in the bufferView.</param>
+        /// <param name="byteStride">The size of each element, in bytes: a multiple of 4 up to 256 for attributes, and 2 or 4 for indices.</param>
+        /// <returns>The compressed bitstream, as stored in the buffer that the extension references.</returns>
+        static std::vector<uint8_t> Encode(MeshoptMode mode, const void* data, size_t count, size_t byteStride);
+
+        /// <summary>
+        /// Decompresses the contents of a bufferView compressed by <see cref="Encode" /> or another EXT_meshopt_compression encoder.
+        /// </summary>
+        /// <param name="mode">The kind of data in the bufferView.</param>
+        /// <param name="data">The compressed bitstream.</param>
+        /// <param name="size">The size of the compressed bitstream, in bytes.</param>
+        /// <param name="count">The number of elements in the bufferView.</param>
+        /// <param name="byteStride">The size of each element, in bytes.</param>
+        /// <returns>The contents of the bufferView, <see name="count" /> times <see name="byteStride" /> bytes long.</returns>
+        static std::vector<uint8_t> Decode(MeshoptMode mode, const void* data, size_t size, size_t count, size_t byteStride);
+
+        /// <summary>
+        /// Gets the name of a mode, as written in the extension JSON.
+        /// </summary>
+        static const char* GetModeName(MeshoptMode mode);
+    };
+}
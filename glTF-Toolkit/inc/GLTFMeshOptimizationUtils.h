@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <GLTFSDK/GLTFDocument.h>
+#include <GLTFSDK/IStreamReader.h>
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// Utilities to reorder the geometry of a glTF asset for faster rendering.
+    /// </summary>
+    class GLTFMeshOptimizationUtils
+    {
+    public:
+        /// <summary>
+        /// Reorders the triangles of a triangle list so that their vertices are reused from the post-transform vertex cache
+        /// as much as possible, using Tom Forsyth's linear-speed vertex cache optimization.
+        /// </summary>
+        /// <param name="indices">The triangle list to reorder.</param>
+        /// <param name="vertexCount">The number of vertices that the indices refer to.</param>
+        /// <returns>The same triangles, in the new order. The winding of each triangle is kept.</returns>
+        static std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount);
+
+        /// <summary>
+        /// Reorders the clusters of a triangle list that was optimized with <see cref="OptimizeVertexCache" />, so that
+        /// the clusters that face outwards are drawn first and hide the ones behind them from most points of view.
+        /// <para>Clusters start at the triangles that miss the vertex cache with all of their vertices, so the order of the
+        /// triangles within each cluster, and most of the vertex cache efficiency, is kept.</para>
+        /// </summary>
+        /// <param name="positions">The vertex positions, as three floats per vertex.</param>
+        /// <param name="indices">The triangle list to reorder.</param>
+        /// <returns>The same triangles, in the new order.</returns>
+        static std::vector<uint32_t> OptimizeOverdraw(const std::vector<float>& positions, const std::vector<uint32_t>& indices);
+
+        /// <summary>
+        /// Computes a new order for the vertices of a triangle list, in the order in which they are first used, so that
+        /// vertices are fetched from memory sequentially. Vertices that are not used are dropped.
+        /// </summary>
+        /// <param name="indices">The triangle list.</param>
+        /// <param name="vertexCount">The number of vertices that the indices refer to.</param>
+        /// <returns>The new index of each vertex, or UINT32_MAX for vertices that are not used.</returns>
+        static std::vector<uint32_t> OptimizeVertexFetch(const std::vector<uint32_t>& indices, size_t vertexCount);
+
+        /// <summary>
+        /// Simulates a FIFO post-transform vertex cache while drawing a triangle list.
+        /// </summary>
+        /// <param name="indices">The triangle list.</param>
+        /// <param name="cacheSize">The number of vertices the simulated cache holds.</param>
+        /// <returns>The average number of vertices transformed per triangle (ACMR), between 0.5 and 3 for meshes of reasonable size.</returns>
+        static double GetAverageCacheMissRatio(const std::vector<uint32_t>& indices, size_t cacheSize = 16);
+
+        /// <summary>
+        /// Applies <see cref="OptimizeVertexCache" />, <see cref="OptimizeOverdraw" /> and <see cref="OptimizeVertexFetch" />
+        /// to every triangle primitive in the document.
+        /// <para>Primitives that share all of their vertex accessors are optimized together, and their vertex accessors are
+        /// rewritten in the new vertex order without the vertices none of them uses. When a vertex accessor is shared with
+        /// primitives that use other accessors, only the indices are reordered. The new accessor data is saved to a binary
+        /// file in the output directory.</para>
+        /// </summary>
+        /// <param name="streamReader">The stream reader that will be used to get streams to each buffer from its URI.</param>
+        /// <param name="doc">Input glTF document.</param>
+        /// <param name="outputDirectory">The output directory to which the optimized buffer should be saved.</param>
+        /// <param name="maxParallelism">The maximum number of primitives to optimize at the same time. If 0, uses one worker per hardware thread.
+        /// Each worker reads and optimizes the primitives that share one set of vertex accessors, which may call the stream reader from
+        /// several threads at once. Only the calling thread writes the optimized buffer, one group after the other in document order.</param>
+        /// <returns>A new document with the optimized meshes.</returns>
+        static GLTFDocument OptimizeMeshes(const IStreamReader& streamReader, const GLTFDocument& doc, const std::string& outputDirectory, size_t maxParallelism = 1);
+
+        /// <summary>
+        /// Same as <see cref="OptimizeMeshes" />, but changes the input document instead of returning a modified copy of it.
+        /// </summary>
+        static void OptimizeMeshesInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const std::string& outputDirectory, size_t maxParallelism = 1);
+    };
+}
@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <GLTFSDK/GLTFDocument.h>
+#include <GLTFSDK/IStreamReader.h>
+
+#include "SerializeBinary.h"
+
+namespace Microsoft::glTF::Toolkit
+{
+    extern const char* EXTENSION_KHR_MESH_QUANTIZATION;
+
+    /// <summary>
+    /// The largest error that quantization may add to each component of a vertex attribute. Each attribute is stored
+    /// with the narrowest integer type that stays within its bound, or left as floats if none does.
+    /// </summary>
+    struct QuantizationErrorBounds
+    {
+        /// <summary>The position error, as a fraction of the size of the bounding box of the meshes that share the positions.
+        /// 8-bit positions need at least 1/508, and 16-bit positions at least 1/131068.</summary>
+        double position = 1.0 / 16384;
+
+        /// <summary>The error of each component of the unit normals and tangents. 8-bit components need at least 1/254,
+        /// and 16-bit components at least 1/65534.</summary>
+        double normal = 1.0 / 200;
+
+        /// <summary>The error of each texture coordinate, in texture space. Only texture coordinates between 0 and 1 are quantized.
+        /// 8-bit coordinates need at least 1/510, and 16-bit coordinates at least 1/131070.</summary>
+        double texCoord = 1.0 / 16384;
+    };
+
+    /// <summary>
+    /// Utilities to store the vertex attributes of a glTF asset as integers, using the KHR_mesh_quantization extension.
+    /// </summary>
+    class GLTFMeshQuantizationUtils
+    {
+    public:
+        /// <summary>
+        /// Quantizes the positions, normals, tangents and texture coordinates of every mesh in the document.
+        /// <para>Normals and tangents become normalized signed integers, and texture coordinates normalized unsigned integers.
+        /// Positions become signed integers centered on the bounding box of the meshes that use them, with the same scale on
+        /// every axis, and each node that draws those meshes gets a child node whose transform restores the original positions.
+        /// Positions of skinned meshes and of meshes with morph targets are left unchanged, since that transform doesn't apply
+        /// to them. The quantized accessor data is saved to a binary file in the output directory.</para>
+        /// </summary>
+        /// <param name="streamReader">The stream reader that will be used to get streams to each buffer from its URI.</param>
+        /// <param name="doc">Input glTF document.</param>
+        /// <param name="errorBounds">The largest error accepted for each attribute.</param>
+        /// <param name="outputDirectory">The output directory to which the quantized buffer should be saved.</param>
+        /// <param name="maxParallelism">The maximum number of accessors to quantize at the same time. If 0, uses one worker per hardware thread.
+        /// Workers first measure the bounds of the position accessors, then quantize one accessor each, reading from the stream reader
+        /// on several threads at once. The quantized buffer is written afterwards in accessor order, whatever the number of workers.</param>
+        /// <returns>A new document with the quantized meshes, which uses and requires the KHR_mesh_quantization extension
+        /// if anything was quantized.</returns>
+        static GLTFDocument QuantizeMeshes(const IStreamReader& streamReader, const GLTFDocument& doc, const QuantizationErrorBounds& errorBounds, const std::string& outputDirectory, size_t maxParallelism = 1);
+
+        /// <summary>
+        /// Same as <see cref="QuantizeMeshes" />, but changes the input document instead of returning a modified copy of it.
+        /// </summary>
+        static void QuantizeMeshesInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const QuantizationErrorBounds& errorBounds, const std::string& outputDirectory, size_t maxParallelism = 1);
+
+        /// <summary>
+        /// Wraps an accessor conversion strategy so that it doesn't undo quantization when the document is serialized with
+        /// <see cref="SerializeBinary" />: the integer vertex attributes of a document that uses KHR_mesh_quantization keep
+        /// their component type, and every other accessor is converted by the wrapped strategy.
+        /// </summary>
+        /// <param name="doc">The quantized document that will be serialized.</param>
+        /// <param name="accessorConversion">The strategy for the other accessors, or nullptr to keep their component types.</param>
+        /// <returns>The wrapped strategy, which can be called from several threads if the wrapped one can.</returns>
+        static AccessorConversionStrategy PreserveQuantizedAttributes(const GLTFDocument& doc, const AccessorConversionStrategy& accessorConversion);
+    };
+}
@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <GLTFSDK/GLTFDocument.h>
+#include <GLTFSDK/IStreamReader.h>
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// Utilities to generate levels of detail (LOD) for the meshes in a glTF asset by simplifying them.
+    /// </summary>
+    class GLTFMeshSimplifyUtils
+    {
+    public:
+        /// <summary>
+        /// Simplifies a triangle list by collapsing edges onto one of their vertices, cheapest first, where the cost of a
+        /// collapse is the quadric error of the moved vertex.
+        /// <para>Vertices are never moved or created, so the result can be drawn with the original vertex data. Vertices that share
+        /// a position with another vertex (seams between UV or normal islands) and non-manifold vertices are never removed, and
+        /// border vertices only slide along the border. Collapses that would flip a triangle are rejected.</para>
+        /// </summary>
+        /// <param name="positions">The vertex positions, as three floats per vertex.</param>
+        /// <param name="indices">The triangle list to simplify. Every index must be smaller than the number of vertices.</param>
+        /// <param name="targetIndexCount">The number of indices to simplify down to. The result can have more indices
+        /// if the mesh cannot be simplified further without breaking the constraints above.</param>
+        /// <returns>The simplified triangle list, indexing the same vertices.</returns>
+        static std::vector<uint32_t> SimplifyTriangles(const std::vector<float>& positions, const std::vector<uint32_t>& indices, size_t targetIndexCount);
+
+        /// <summary>
+        /// Generates simplified copies of a glTF document, one for each triangle ratio, that can be merged as LODs with
+        /// <see cref="GLTFLODUtils::MergeDocumentsAsLODs" />.
+        /// <para>Each copy only replaces the indices of the triangle primitives, so it keeps pointing to the vertex data,
+        /// materials and textures of the original document. The new indices of each copy are saved to a binary file in the
+        /// output directory. Primitives whose positions are not floats, or that are not triangle lists, are left unchanged.</para>
+        /// </summary>
+        /// <param name="streamReader">The stream reader that will be used to get streams to each buffer from its URI.</param>
+        /// <param name="doc">Input glTF document.</param>
+        /// <param name="triangleRatios">The fraction of the triangles of each primitive to keep in each LOD, in descending order.
+        /// Each LOD is simplified from the previous one.</param>
+        /// <param name="outputDirectory">The output directory to which the new index buffers should be saved.</param>
+        /// <param name="maxParallelism">The maximum number of primitives to simplify at the same time. If 0, uses one worker per hardware thread.
+        /// Each worker reads the positions and indices of one primitive, which may call the stream reader from several threads at once,
+        /// and computes every LOD of it. The LOD buffers are then written in primitive order, so they do not depend on this value.</param>
+        /// <returns>One simplified document for each triangle ratio.</returns>
+        static std::vector<GLTFDocument> GenerateLODs(const IStreamReader& streamReader, const GLTFDocument& doc, const std::vector<double>& triangleRatios, const std::string& outputDirectory, size_t maxParallelism = 1);
+
+        /// <summary>
+        /// Computes the triangle ratio for each LOD from the MSFT_lod screen coverage values, keeping the density of triangles
+        /// on screen the same as for the primary LOD.
+        /// </summary>
+        /// <param name="screenCoveragePercentages">The screen coverage values, starting with the one of the primary LOD.</param>
+        /// <returns>A triangle ratio for each screen coverage value after the first.</returns>
+        static std::vector<double> GetTriangleRatios(const std::vector<double>& screenCoveragePercentages);
+    };
+}
@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <GLTFSDK/GLTFDocument.h>
+#include <GLTFSDK/IStreamReader.h>
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// Utilities to flatten the node hierarchies of static scenes, so that assets exported as thousands of nodes with
+    /// small meshes are drawn with a few large primitives, and have less JSON to parse.
+    /// </summary>
+    class GLTFSceneFlatteningUtils
+    {
+    public:
+        /// <summary>
+        /// Bakes the transforms of static nodes into their vertices, and merges the primitives of each flattened
+        /// hierarchy that use the same material into one primitive.
+        /// <para>Root nodes, including the root nodes of each level of detail referenced by MSFT_lod, are kept with their
+        /// transforms and extensions, so that levels of detail and screen coverage still apply. Nodes with cameras, extensions,
+        /// or meshes that can't be merged (morph targets, skinning, non-triangle or extension primitives) are also kept, as
+        /// is every ancestor of a kept node. Every other node is removed, and its mesh is merged into that of its closest kept
+        /// ancestor. A kept node that has a mesh that can't be merged gets the merged mesh on a new child node.
+        /// The names and extras of removed nodes are lost.</para>
+        /// <para>Documents with animations or skins are returned unchanged, since their nodes are not static.
+        /// Nodes, meshes and accessors that are no longer used are removed, and the remaining ones are renumbered.
+        /// The merged vertices are saved as a binary file in the output directory.</para>
+        /// </summary>
+        /// <param name="streamReader">A stream reader that is capable of accessing the resources used in the glTF asset by URI.</param>
+        /// <param name="doc">Input glTF document.</param>
+        /// <param name="outputDirectory">The output directory to which the merged vertex data should be saved.</param>
+        /// <param name="maxParallelism">The maximum number of hierarchies merged at the same time. If 0, uses one worker per hardware thread.
+        /// Each worker reads and transforms the meshes drawn under one kept node, so the stream reader may be called from several threads
+        /// at once. The merged vertices are written afterwards, in node order, so the output does not depend on this value.</param>
+        /// <returns>A new document with flattened scenes.</returns>
+        static GLTFDocument FlattenScenes(const IStreamReader& streamReader, const GLTFDocument& doc, const std::string& outputDirectory, size_t maxParallelism = 1);
+
+        /// <summary>
+        /// Same as <see cref="FlattenScenes" />, but changes the input document instead of returning a modified copy of it.
+        /// </summary>
+        static void FlattenScenesInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const std::string& outputDirectory, size_t maxParallelism = 1);
+    };
+}
@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <GLTFSDK/GLTFDocument.h>
+#include <GLTFSDK/IStreamReader.h>
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// Which textures are placed in atlases, and how large the atlases may get.
+    /// </summary>
+    struct TextureAtlasOptions
+    {
+        /// <summary>The largest width or height of a texture that is placed in an atlas. Larger textures are left unchanged.</summary>
+        size_t maxTextureSize = 128;
+
+        /// <summary>The largest width or height of an atlas. It should not exceed the maximum size of texture compression,
+        /// which would scale down the atlas and every texture in it.</summary>
+        size_t maxAtlasSize = 512;
+
+        /// <summary>The number of pixels around each texture in an atlas that repeat its edges, so that filtering and
+        /// the first mip levels don't blend it with its neighbors.</summary>
+        size_t padding = 4;
+    };
+
+    /// <summary>
+    /// Utilities to gather the small textures of many materials into shared atlases, so that those materials, and the
+    /// primitives that use them, can be merged and drawn with fewer draw calls and state changes.
+    /// </summary>
+    class GLTFTextureAtlasUtils
+    {
+    public:
+        /// <summary>
+        /// Places the textures of the materials whose textures are all small into atlases, and merges the materials and
+        /// primitives that only differed by their textures.
+        /// <para>A material is atlased if it has no extensions, all its textures are WIC images (e.g. PNG or JPEG) no larger than
+        /// the maximum texture size with the same sampler, and every primitive that uses it has texture coordinates between 0 and 1,
+        /// since repeating textures can't be read from an atlas. Materials with the same textured slots and sampler share atlases,
+        /// one per slot, with the same layout. Their texture coordinates are rewritten to the place of their textures in the atlas.</para>
+        /// <para>Materials of the same atlas whose factors, alpha mode and sides are equal are merged into one, and the triangle
+        /// primitives of a mesh that then use the same material and have the same attributes are merged into one primitive.
+        /// The atlases are saved as PNG images, and the new vertex data as a binary file, in the output directory. Images that
+        /// are only used by atlased materials are pointed to an atlas, so that a deduplicating export doesn't keep them.</para>
+        /// </summary>
+        /// <param name="streamReader">A stream reader that is capable of accessing the resources used in the glTF asset by URI.</param>
+        /// <param name="doc">Input glTF document.</param>
+        /// <param name="options">Which textures are atlased, and the size of the atlases.</param>
+        /// <param name="outputDirectory">The output directory to which the atlases and the vertex data should be saved.</param>
+        /// <param name="maxParallelism">The maximum number of images read or atlases composed at the same time. If 0, uses one worker per hardware thread.
+        /// Workers read the sizes of the source images and the range of the texture coordinates, then compose and save one atlas texture
+        /// each, so the stream reader may be called from several threads at once. All changes to the document are made afterwards.</param>
+        /// <returns>A new document with the atlased materials, or a copy of the input if no atlas would hold more than one material.</returns>
+        static GLTFDocument AtlasTextures(const IStreamReader& streamReader, const GLTFDocument& doc, const TextureAtlasOptions& options, const std::string& outputDirectory, size_t maxParallelism = 1);
+
+        /// <summary>
+        /// Same as <see cref="AtlasTextures" />, but changes the input document instead of returning a modified copy of it.
+        /// </summary>
+        static void AtlasTexturesInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const TextureAtlasOptions& options, const std::string& outputDirectory, size_t maxParallelism = 1);
+    };
+}
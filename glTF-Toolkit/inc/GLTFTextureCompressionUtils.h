@@ -13,6 +13,8 @@ namespace DirectX
 
 namespace Microsoft::glTF::Toolkit
 {
+    class DeviceResourcesPool;
+
     extern const char* EXTENSION_MSFT_TEXTURE_DDS;
 
     /// <summary>Supported compression algorithms for textures.</summary>
@@ -24,6 +26,19 @@ namespace Microsoft::glTF::Toolkit
         BC7,
     };
 
+    /// <summary>Trade-offs between encoding speed and quality for block compression. They mostly affect BC7, which is
+    /// very slow to encode at full quality in software, e.g. on machines with no GPU.</summary>
+    enum class TextureCompressionQuality
+    {
+        /// <summary>Only uses the single-subset BC7 mode, which encodes in seconds what the other profiles take minutes to.
+        /// Intended for iteration builds.</summary>
+        Fast,
+        /// <summary>Uses every BC7 mode but the slowest three-subset ones. This is the default.</summary>
+        Balanced,
+        /// <summary>Searches every BC7 mode. Intended for release builds.</summary>
+        Max,
+    };
+
     /// <summary>
     /// Utilities to compress textures in a glTF asset.
     /// </summary>
@@ -43,6 +58,13 @@ namespace Microsoft::glTF::Toolkit
         /// <param name="generateMipMaps">If true, also generates mip maps when compressing.</param>
         /// <param name="retainOriginalImage">If true, retains the original image on the resulting glTF. If false, 
         /// replaces that image (making the glTF incompatible with most core glTF 2.0 viewers).</param>
+        /// <param name="cacheDirectory">An optional directory in which compressed results are cached, keyed by the contents of the source
+        /// image and the compression parameters. If a matching result exists it is copied to the output directory instead of compressing
+        /// the image again. If empty, no cache is used.</param>
+        /// <param name="quality">The trade-off between encoding speed and quality.</param>
+        /// <param name="tileRows">If not 0, images read by WIC are decoded, given mip maps and compressed a band of this many rows at a time,
+        /// rounded up to a multiple of 4, so that memory is bounded by the size of a band instead of the size of the image. The compressed
+        /// image is the same. Other images, such as DDS, are processed whole.</param>
         /// <returns>Returns a new GLTFDocument that contains a new reference to the compressed dds file added as part 
         /// of the MSFT_texture_dds extension.</returns>
         /// <example>
@@ -84,7 +106,13 @@ namespace Microsoft::glTF::Toolkit
         /// </code>
         /// </example>
         /// </summary>
-        static GLTFDocument CompressTextureAsDDS(const IStreamReader& streamReader, const GLTFDocument & doc, const Texture & texture, TextureCompression compression, const std::string& outputDirectory, size_t maxTextureSize = std::numeric_limits<size_t>::max(), bool generateMipMaps = true, bool retainOriginalImage = true);
+        static GLTFDocument CompressTextureAsDDS(const IStreamReader& streamReader, const GLTFDocument & doc, const Texture & texture, TextureCompression compression, const std::string& outputDirectory, size_t maxTextureSize = std::numeric_limits<size_t>::max(), bool generateMipMaps = true, bool retainOriginalImage = true, const std::string& cacheDirectory = "", TextureCompressionQuality quality = TextureCompressionQuality::Balanced, size_t tileRows = 0);
+
+        /// <summary>
+        /// Same as <see cref="CompressTextureAsDDS" />, but adds the compressed image to the input document instead of 
+        /// returning a modified copy of it. Only the texture and the new (or replaced) image are changed.
+        /// </summary>
+        static void CompressTextureAsDDSInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const Texture& texture, TextureCompression compression, const std::string& outputDirectory, size_t maxTextureSize = std::numeric_limits<size_t>::max(), bool generateMipMaps = true, bool retainOriginalImage = true, const std::string& cacheDirectory = "", TextureCompressionQuality quality = TextureCompressionQuality::Balanced, size_t tileRows = 0);
 
         /// <summary>
         /// Applies <see cref="CompressTextureAsDDS" /> to all textures in the document that are accessible via materials according to the 
@@ -97,16 +125,42 @@ namespace Microsoft::glTF::Toolkit
         /// <param name="generateMipMaps">If true, also generates mip maps when compressing.</param>
         /// <param name="retainOriginalImage">If true, retains the original image on the resulting glTF. If false, 
         /// replaces that image (making the glTF incompatible with most core glTF 2.0 viewers).</param>
+        /// <param name="maxParallelism">The maximum number of textures to compress at the same time. If 0, uses one worker per hardware thread.
+        /// Textures are always added to the resulting document in the same order, regardless of this value. When larger than 1, the stream reader
+        /// may be called from several threads at once. DirectXTex offers no cap on the threads of a software compression, only one thread or every
+        /// hardware thread, so when more than one image is compressed at the same time each one runs on a single thread.</param>
+        /// <param name="cacheDirectory">An optional directory in which compressed results are cached. See <see cref="CompressTextureAsDDS" />.</param>
+        /// <param name="quality">The trade-off between encoding speed and quality.</param>
+        /// <param name="tileRows">If not 0, the number of rows of each image processed at a time. See <see cref="CompressTextureAsDDS" />.</param>
         /// <returns>Returns a new GLTFDocument that contains alternate textures for all applicable materials following the requirements of the Windows
         /// Mixed Reality home using the MSFT_texture_dds extension.</returns>
         /// </summary>
-        static GLTFDocument CompressAllTexturesForWindowsMR(const IStreamReader& streamReader, const GLTFDocument & doc, const std::string& outputDirectory, size_t maxTextureSize = std::numeric_limits<size_t>::max(), bool retainOriginalImages = true);
+        static GLTFDocument CompressAllTexturesForWindowsMR(const IStreamReader& streamReader, const GLTFDocument & doc, const std::string& outputDirectory, size_t maxTextureSize = std::numeric_limits<size_t>::max(), bool retainOriginalImages = true, size_t maxParallelism = 1, const std::string& cacheDirectory = "", TextureCompressionQuality quality = TextureCompressionQuality::Balanced, size_t tileRows = 0);
+
+        /// <summary>
+        /// Same as <see cref="CompressAllTexturesForWindowsMR" />, but adds the compressed images to the input document instead of 
+        /// returning a modified copy of it.
+        /// </summary>
+        static void CompressAllTexturesForWindowsMRInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const std::string& outputDirectory, size_t maxTextureSize = std::numeric_limits<size_t>::max(), bool retainOriginalImages = true, size_t maxParallelism = 1, const std::string& cacheDirectory = "", TextureCompressionQuality quality = TextureCompressionQuality::Balanced, size_t tileRows = 0);
+
+        /// <summary>
+        /// Compresses a DirectX::ScratchImage in place using the specified compression, on a GPU device leased from 
+        /// <see cref="DeviceResourcesPool::GetShared" />.
+        /// </summary>
+        /// <param name="image">The image to compress.</param>
+        /// <param name="compression">The desired compression algorithm.</param>
+        /// <param name="quality">The trade-off between encoding speed and quality.</param>
+        static void CompressImage(DirectX::ScratchImage& image, TextureCompression compression, TextureCompressionQuality quality = TextureCompressionQuality::Balanced);
 
         /// <summary>
-        /// Compresses a DirectX::ScratchImage in place using the specified compression.
+        /// Compresses a DirectX::ScratchImage in place using the specified compression, on a GPU device leased from the specified pool.
+        /// <para>If the pool has no device available, or the device cannot compress the image, falls back to software compression,
+        /// which splits the image across every hardware thread.</para>
         /// </summary>
         /// <param name="image">The image to compress.</param>
         /// <param name="compression">The desired compression algorithm.</param>
-        static void CompressImage(DirectX::ScratchImage& image, TextureCompression compression);
+        /// <param name="devicePool">The pool from which the Direct3D device will be leased.</param>
+        /// <param name="quality">The trade-off between encoding speed and quality.</param>
+        static void CompressImage(DirectX::ScratchImage& image, TextureCompression compression, DeviceResourcesPool& devicePool, TextureCompressionQuality quality = TextureCompressionQuality::Balanced);
     };
 }
\ No newline at end of file
@@ -1,12 +1,65 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
-// Licensed under the MIT License. See LICENSE in the project root for license information.#pragma once
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
 
 #include <GLTFSDK/GLTFDocument.h>
 #include <GLTFSDK/IStreamReader.h>
 #include <DirectXTex.h>
+#include <wrl/client.h>
+
+#include <functional>
+#include <limits>
+#include <memory>
+
+#include "ParallelUtils.h"
+
+struct IWICBitmapSource;
+struct IWICStream;
 
 namespace Microsoft::glTF::Toolkit
 {
+    /// <summary>
+    /// Decodes an image read by WIC as DXGI_FORMAT_R8G8B8A8_UNORM a band of rows at a time, optionally scaled, so that
+    /// the decoded image is never held in memory as a whole. The encoded data is read in place, and must outlive the reader.
+    /// </summary>
+    class TiledImageReader
+    {
+    public:
+        /// <summary>
+        /// Opens an image scaled down so that neither of its sides is larger than maxSize, keeping its aspect ratio.
+        /// </summary>
+        /// <returns>The reader, or null if the data is a DDS or cannot be read by WIC.</returns>
+        static std::unique_ptr<TiledImageReader> Open(const uint8_t* imageData, size_t imageDataSize, size_t maxSize = std::numeric_limits<size_t>::max());
+
+        /// <summary>
+        /// Opens an image scaled to the given size.
+        /// </summary>
+        /// <returns>The reader, or null if the data is a DDS or cannot be read by WIC.</returns>
+        static std::unique_ptr<TiledImageReader> Open(const uint8_t* imageData, size_t imageDataSize, size_t width, size_t height);
+
+        ~TiledImageReader();
+
+        size_t GetWidth() const { return m_width; }
+        size_t GetHeight() const { return m_height; }
+
+        /// <summary>
+        /// Decodes rowCount rows starting at firstRow into pixels, whose rows are rowPitch bytes apart.
+        /// Reading the rows in order lets the decoder stream them instead of seeking.
+        /// </summary>
+        /// <returns>False if the decoder failed.</returns>
+        bool ReadRows(size_t firstRow, size_t rowCount, uint8_t* pixels, size_t rowPitch) const;
+
+    private:
+        TiledImageReader(Microsoft::WRL::ComPtr<IWICStream> stream, Microsoft::WRL::ComPtr<IWICBitmapSource> source, size_t width, size_t height);
+
+        // The stream and the decoder, scaler and converter behind the source must live as long as the reader
+        Microsoft::WRL::ComPtr<IWICStream> m_stream;
+        Microsoft::WRL::ComPtr<IWICBitmapSource> m_source;
+        size_t m_width;
+        size_t m_height;
+    };
+
     /// <summary>
     /// Utilities to load textures from glTF assets.
     /// </summary>
@@ -21,6 +74,73 @@ namespace Microsoft::glTF::Toolkit
         /// <param name="doc">The document from which the texture will be loaded.</param>
         /// <param name="textureId">The identifier of the texture to be loaded.</param>
         static DirectX::ScratchImage LoadTexture(const IStreamReader& streamReader, const GLTFDocument& doc, const std::string& textureId);
+
+        /// <summary>
+        /// Loads a texture into a scratch image in the requested format for in-memory processing.
+        /// </summary>
+        /// <returns>A scratch image containing the loaded texture in the requested format.</returns>
+        /// <param name="streamReader">A stream reader that is capable of accessing the resources used in the glTF asset by URI.</param>
+        /// <param name="doc">The document from which the texture will be loaded.</param>
+        /// <param name="textureId">The identifier of the texture to be loaded.</param>
+        /// <param name="format">The format to which the texture will be converted or decompressed after decoding, if it is not already in that format.
+        /// Lower precision formats such as DXGI_FORMAT_R8G8B8A8_UNORM use less memory than the default DXGI_FORMAT_R32G32B32A32_FLOAT.
+        /// If DXGI_FORMAT_UNKNOWN, the texture is returned in the format in which it was decoded.</param>
+        static DirectX::ScratchImage LoadTexture(const IStreamReader& streamReader, const GLTFDocument& doc, const std::string& textureId, DXGI_FORMAT format);
+
+        /// <summary>
+        /// Decodes an image that has already been read into memory, such as the contents of a DDS or PNG file, into a scratch image
+        /// in the requested format. The data is decoded in place, without copying it first.
+        /// </summary>
+        /// <returns>A scratch image containing the decoded image in the requested format.</returns>
+        /// <param name="imageData">The encoded image data.</param>
+        /// <param name="imageDataSize">The size of the encoded image data, in bytes.</param>
+        /// <param name="format">The format to which the image will be converted or decompressed after decoding. See <see cref="LoadTexture" />.</param>
+        static DirectX::ScratchImage LoadImageData(const uint8_t* imageData, size_t imageDataSize, DXGI_FORMAT format);
+
+        /// <summary>
+        /// Decodes an image that has already been read into memory into a scratch image in the requested format, scaled down so that
+        /// neither of its sides is larger than maxSize, and optionally with a full mip chain.
+        /// <para>When the requested format is DXGI_FORMAT_R8G8B8A8_UNORM, images read by WIC are scaled while they are decoded, so
+        /// that the full size image is never held in memory, and codecs that support it (e.g. JPEG) decode at a reduced size directly.
+        /// The mip chain is then allocated together with the scaled image and generated in place, each level from the one above it,
+        /// with a 2x2 box filter. Levels are half the size of the one above, rounded down, so the last column or row of an odd-sized
+        /// level does not contribute to the next one.
+        /// Other images are decoded at full size, then resized and given mip maps with DirectXTex's default filter, which does weigh
+        /// every pixel, so the lower mip levels of the two paths can differ slightly for odd sizes.</para>
+        /// </summary>
+        /// <returns>A scratch image containing the decoded image in the requested format.</returns>
+        /// <param name="imageData">The encoded image data.</param>
+        /// <param name="imageDataSize">The size of the encoded image data, in bytes.</param>
+        /// <param name="format">The format to which the image will be converted or decompressed after decoding. See <see cref="LoadTexture" />.</param>
+        /// <param name="maxSize">The maximum width and height of the returned image. Larger images are scaled down, keeping their aspect ratio.</param>
+        /// <param name="generateMipMaps">If true, the returned image has a full mip chain.</param>
+        static DirectX::ScratchImage LoadImageData(const uint8_t* imageData, size_t imageDataSize, DXGI_FORMAT format, size_t maxSize, bool generateMipMaps);
+
+        /// <summary>
+        /// Decodes an image read by WIC as DXGI_FORMAT_R8G8B8A8_UNORM, scaled down to fit in maxSize like <see cref="LoadImageData" />,
+        /// and passes it to processBand a band of at most tileRows rows at a time, so that memory is bounded by the size of a band
+        /// instead of the size of the image.
+        /// <para>If generateMipMaps is true, every level of the mip chain is passed too, filtered exactly like the in-memory mip chain
+        /// of <see cref="LoadImageData" />. Each level keeps a single band, which is filtered into the next level when it is full.
+        /// The bands of each level are passed top to bottom, but the bands of different levels are interleaved.</para>
+        /// </summary>
+        /// <returns>False if the data is a DDS or cannot be read by WIC, in which case processBand is never called.</returns>
+        /// <param name="imageData">The encoded image data.</param>
+        /// <param name="imageDataSize">The size of the encoded image data, in bytes.</param>
+        /// <param name="maxSize">The maximum width and height of the top level. Larger images are scaled down, keeping their aspect ratio.</param>
+        /// <param name="generateMipMaps">If true, the bands of a full mip chain are passed after the bands they are filtered from.</param>
+        /// <param name="tileRows">The maximum number of rows in a band. Rounded up to a multiple of 4, so that bands can be block compressed.</param>
+        /// <param name="processBand">Called with the metadata of the whole image, the mip level and first row of the band, and its pixels,
+        /// which are only valid during the call.</param>
+        static bool LoadImageDataTiled(const uint8_t* imageData, size_t imageDataSize, size_t maxSize, bool generateMipMaps, size_t tileRows,
+            const std::function<void(const DirectX::TexMetadata& metadata, size_t mipLevel, size_t firstRow, const DirectX::Image& band)>& processBand);
+
+        /// <summary>
+        /// Gets the limit on the number of texture packing and compression jobs that hold decoded images in memory at the same time,
+        /// across every document processed in the process. Set it to bound the memory used when many textures or assets are
+        /// processed concurrently. There is no limit by default.
+        /// </summary>
+        static ConcurrencyLimit& GetInFlightImageLimit();
     };
 }
 
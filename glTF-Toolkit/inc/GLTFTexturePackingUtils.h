@@ -4,6 +4,7 @@
 #pragma once
 
 #include <GLTFSDK/GLTFDocument.h>
+#include <DirectXTex.h>
 
 namespace Microsoft::glTF::Toolkit
 {
@@ -32,10 +33,29 @@ namespace Microsoft::glTF::Toolkit
         /// <param name="material">The material to be packed.</param>
         /// <param name="packing">The packing scheme that will be used to pick the textures and choose their order.</param>
         /// <param name="outputDirectory">The output directory to which packed textures should be saved.</param>
+        /// <param name="packingFormat">The format in which source textures are loaded and packed. Either DXGI_FORMAT_R32G32B32A32_FLOAT, or
+        /// DXGI_FORMAT_R8G8B8A8_UNORM to pack 8-bit sources without widening them, which uses a quarter of the memory.</param>
+        /// <param name="tileRows">If not 0, sources read by WIC are decoded, packed and saved a band of this many rows at a time, so that memory
+        /// is bounded by the size of a band instead of the size of the textures. Tiled packing is always done in DXGI_FORMAT_R8G8B8A8_UNORM,
+        /// the precision of the saved textures, and scales the occlusion texture while decoding it. Other sources, such as DDS, are packed whole.</param>
         /// <returns>
         /// A new glTF manifest that uses the MSFT_packing_occlusionRoughnessMetallic extension to point to the packed textures.
         /// </returns>
-        static GLTFDocument PackMaterialForWindowsMR(const IStreamReader& streamReader, const GLTFDocument & doc, const Material & material, TexturePacking packing, const std::string& outputDirectory);
+        static GLTFDocument PackMaterialForWindowsMR(const IStreamReader& streamReader, const GLTFDocument & doc, const Material & material, TexturePacking packing, const std::string& outputDirectory, DXGI_FORMAT packingFormat = DXGI_FORMAT_R32G32B32A32_FLOAT, size_t tileRows = 0);
+
+        /// <summary>
+        /// Same as <see cref="PackMaterialForWindowsMR" />, but adds the packed textures to the input document
+        /// instead of returning a modified copy of it. Only the packed material and the new images and textures are changed.
+        /// </summary>
+        /// <param name="streamReader">A stream reader that is capable of accessing the resources used in the glTF asset by URI.</param>
+        /// <param name="doc">The document from which the texture will be loaded, and to which the packed textures will be added.</param>
+        /// <param name="material">The material to be packed.</param>
+        /// <param name="packing">The packing scheme that will be used to pick the textures and choose their order.</param>
+        /// <param name="outputDirectory">The output directory to which packed textures should be saved.</param>
+        /// <param name="packingFormat">The format in which source textures are loaded and packed. Either DXGI_FORMAT_R32G32B32A32_FLOAT, or
+        /// DXGI_FORMAT_R8G8B8A8_UNORM to pack 8-bit sources without widening them, which uses a quarter of the memory.</param>
+        /// <param name="tileRows">If not 0, the number of rows of the textures packed at a time. See <see cref="PackMaterialForWindowsMR" />.</param>
+        static void PackMaterialForWindowsMRInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const Material& material, TexturePacking packing, const std::string& outputDirectory, DXGI_FORMAT packingFormat = DXGI_FORMAT_R32G32B32A32_FLOAT, size_t tileRows = 0);
 
         /// <summary>
         /// Applies <see cref="PackMaterialForWindowsMR" /> to every material in the document, following the same parameter structure as that function.
@@ -44,10 +64,25 @@ namespace Microsoft::glTF::Toolkit
         /// <param name="doc">The document from which the texture will be loaded.</param>
         /// <param name="packing">The packing scheme that will be used to pick the textures and choose their order.</param>
         /// <param name="outputDirectory">The output directory to which packed textures should be saved.</param>
+        /// <param name="packingFormat">The format in which source textures are loaded and packed. Either DXGI_FORMAT_R32G32B32A32_FLOAT, or
+        /// DXGI_FORMAT_R8G8B8A8_UNORM to pack 8-bit sources without widening them, which uses a quarter of the memory.</param>
+        /// <param name="tileRows">If not 0, the number of rows of the textures packed at a time. See <see cref="PackMaterialForWindowsMR" />.</param>
         /// <returns>
         /// A new glTF manifest that uses the MSFT_packing_occlusionRoughnessMetallic extension to point to the packed textures.
         /// </returns>
-        static GLTFDocument PackAllMaterialsForWindowsMR(const IStreamReader& streamReader, const GLTFDocument & doc, TexturePacking packing, const std::string& outputDirectory);
+        static GLTFDocument PackAllMaterialsForWindowsMR(const IStreamReader& streamReader, const GLTFDocument & doc, TexturePacking packing, const std::string& outputDirectory, DXGI_FORMAT packingFormat = DXGI_FORMAT_R32G32B32A32_FLOAT, size_t tileRows = 0);
+
+        /// <summary>
+        /// Applies <see cref="PackMaterialForWindowsMRInPlace" /> to every material in the document, following the same parameter structure as that function.
+        /// </summary>
+        /// <param name="streamReader">A stream reader that is capable of accessing the resources used in the glTF asset by URI.</param>
+        /// <param name="doc">The document from which the texture will be loaded, and to which the packed textures will be added.</param>
+        /// <param name="packing">The packing scheme that will be used to pick the textures and choose their order.</param>
+        /// <param name="outputDirectory">The output directory to which packed textures should be saved.</param>
+        /// <param name="packingFormat">The format in which source textures are loaded and packed. Either DXGI_FORMAT_R32G32B32A32_FLOAT, or
+        /// DXGI_FORMAT_R8G8B8A8_UNORM to pack 8-bit sources without widening them, which uses a quarter of the memory.</param>
+        /// <param name="tileRows">If not 0, the number of rows of the textures packed at a time. See <see cref="PackMaterialForWindowsMR" />.</param>
+        static void PackAllMaterialsForWindowsMRInPlace(const IStreamReader& streamReader, GLTFDocument& doc, TexturePacking packing, const std::string& outputDirectory, DXGI_FORMAT packingFormat = DXGI_FORMAT_R32G32B32A32_FLOAT, size_t tileRows = 0);
     };
 }
 
@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <string>
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// Utilities to compute content hashes of binary data, used to identify resources by their contents.
+    /// </summary>
+    class HashUtils
+    {
+    public:
+        /// <summary>
+        /// Computes the SHA-256 hash of a block of memory.
+        /// </summary>
+        /// <param name="data">A pointer to the data to hash.</param>
+        /// <param name="size">The size of the data, in bytes.</param>
+        /// <returns>The hash as a lowercase hexadecimal string of 64 characters.</returns>
+        static std::string ComputeSHA256(const void* data, size_t size);
+
+        /// <summary>
+        /// Computes a SHA-256 hash incrementally, for data that is produced or read in blocks.
+        /// </summary>
+        class SHA256Hasher
+        {
+        public:
+            SHA256Hasher();
+            ~SHA256Hasher();
+
+            SHA256Hasher(const SHA256Hasher&) = delete;
+            SHA256Hasher& operator=(const SHA256Hasher&) = delete;
+
+            /// <summary>
+            /// Adds a block of memory to the data being hashed.
+            /// </summary>
+            /// <param name="data">A pointer to the data to hash.</param>
+            /// <param name="size">The size of the data, in bytes.</param>
+            void Update(const void* data, size_t size);
+
+            /// <summary>
+            /// Completes the hash. No more data can be added afterwards.
+            /// </summary>
+            /// <returns>The hash as a lowercase hexadecimal string of 64 characters.</returns>
+            std::string Finish();
+
+        private:
+            void* m_hash;
+        };
+    };
+}
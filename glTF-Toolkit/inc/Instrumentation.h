@@ -0,0 +1,154 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// The measurements of one stage of a conversion, such as the packing of a material or the compression of a texture.
+    /// </summary>
+    struct StageRecord
+    {
+        /// <summary>The name of the stage.</summary>
+        std::string name;
+
+        /// <summary>The label of the work that the stage is part of, such as the asset being converted.</summary>
+        std::string context;
+
+        /// <summary>A unique identifier of the stage, starting at 1.</summary>
+        uint64_t id = 0;
+
+        /// <summary>The identifier of the stage that contains this one, or 0 if there is none. The stages run by
+        /// <see cref="ParallelUtils::ParallelFor" /> are contained by the stage that started the loop.</summary>
+        uint64_t parentId = 0;
+
+        /// <summary>The identifier of the thread that ran the stage.</summary>
+        uint32_t threadId = 0;
+
+        /// <summary>When the stage started, in microseconds since instrumentation was enabled.</summary>
+        int64_t startTime = 0;
+
+        /// <summary>The wall time of the stage, in microseconds.</summary>
+        int64_t wallTime = 0;
+
+        /// <summary>The CPU time used by the thread that ran the stage, in microseconds. Work that the stage hands to
+        /// other threads is measured by the stages on those threads.</summary>
+        int64_t cpuTime = 0;
+
+        /// <summary>The peak working set of the process when the stage ended, in bytes.</summary>
+        uint64_t peakWorkingSet = 0;
+
+        /// <summary>The bytes read by the stage itself, not counting the stages it contains.</summary>
+        uint64_t bytesRead = 0;
+
+        /// <summary>The bytes written by the stage itself, not counting the stages it contains.</summary>
+        uint64_t bytesWritten = 0;
+
+        /// <summary>Properties of the stage, such as the texture that was compressed or whether it ran on the GPU.</summary>
+        std::vector<std::pair<std::string, std::string>> properties;
+    };
+
+    /// <summary>
+    /// Records the time, memory and I/O of the stages of a conversion, to find out which assets or stages are slow and why.
+    /// <para>Instrumentation is process-wide and disabled by default, in which case stages cost almost nothing. Once enabled,
+    /// every stage that ends is recorded, from any thread, until the records are cleared.</para>
+    /// </summary>
+    class Instrumentation
+    {
+    public:
+        /// <summary>
+        /// Measures a stage from its construction to its destruction. Stages that are constructed while another one is alive
+        /// on the same thread are contained by it.
+        /// </summary>
+        class Stage
+        {
+        public:
+            Stage(const char* name);
+            Stage(const Stage&) = delete;
+            Stage& operator=(const Stage&) = delete;
+            ~Stage();
+
+            void AddBytesRead(uint64_t byteCount);
+            void AddBytesWritten(uint64_t byteCount);
+
+            /// <summary>
+            /// Adds the size of a file that the stage wrote to the bytes written. The file is only looked up when instrumentation is enabled.
+            /// </summary>
+            void AddFileWritten(const std::wstring& filePath);
+
+            void SetProperty(const std::string& key, const std::string& value);
+
+        private:
+            // Empty when instrumentation is disabled
+            std::unique_ptr<StageRecord> m_record;
+            int64_t m_startCpuTime;
+            int m_uncaughtExceptions;
+        };
+
+        /// <summary>
+        /// The label and the current stage of a thread, which new stages on that thread are attached to.
+        /// </summary>
+        struct Context
+        {
+            std::string label;
+            uint64_t stageId = 0;
+        };
+
+        /// <summary>
+        /// Sets the context of the calling thread until the scope is destroyed, for example to label the stages of each asset of a batch,
+        /// or to attach the work of a helper thread to the stage that handed it over.
+        /// </summary>
+        class ContextScope
+        {
+        public:
+            ContextScope(Context context);
+            ContextScope(const ContextScope&) = delete;
+            ContextScope& operator=(const ContextScope&) = delete;
+            ~ContextScope();
+
+        private:
+            Context m_previousContext;
+        };
+
+        /// <summary>
+        /// Enables or disables the recording of stages. Enabling restarts the clock of <see cref="StageRecord::startTime" />.
+        /// </summary>
+        static void SetEnabled(bool enabled);
+
+        static bool IsEnabled();
+
+        /// <summary>
+        /// Gets the context of the calling thread.
+        /// </summary>
+        static Context GetContext();
+
+        /// <summary>
+        /// Gets the stages recorded so far, in the order in which they started.
+        /// </summary>
+        static std::vector<StageRecord> GetRecords();
+
+        /// <summary>
+        /// Discards the stages recorded so far.
+        /// </summary>
+        static void Clear();
+
+        /// <summary>
+        /// Writes the recorded stages as a JSON object with a "stages" array, which has one object per stage with the fields of <see cref="StageRecord" />.
+        /// </summary>
+        static void WriteJson(std::ostream& output);
+
+        /// <summary>
+        /// Writes the recorded stages in the Chrome trace event format, which can be opened in chrome://tracing or Perfetto.
+        /// Each stage is a complete event on the thread that ran it, with its context as the category.
+        /// </summary>
+        static void WriteChromeTrace(std::ostream& output);
+    };
+}
@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <string>
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// A read-only view of a whole file mapped into memory. Pages are only read from disk when they are accessed,
+    /// so large files can be processed without loading them into memory first.
+    /// </summary>
+    class MemoryMappedFile
+    {
+    public:
+        /// <summary>
+        /// Maps the file at the specified path. Throws a GLTFException if the file cannot be opened or mapped.
+        /// </summary>
+        /// <param name="path">The path to the file to map.</param>
+        MemoryMappedFile(const std::string& path);
+        MemoryMappedFile(const MemoryMappedFile&) = delete;
+        MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+        ~MemoryMappedFile();
+
+        /// <summary>The contents of the file. Empty files are not mapped, and return nullptr.</summary>
+        const uint8_t* GetData() const { return m_data; }
+
+        /// <summary>The size of the file, in bytes.</summary>
+        size_t GetSize() const { return m_size; }
+
+    private:
+        HANDLE m_file;
+        HANDLE m_mapping;
+        const uint8_t* m_data;
+        size_t m_size;
+    };
+}
@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// Utilities to run independent units of work concurrently.
+    /// </summary>
+    class ParallelUtils
+    {
+    public:
+        /// <summary>
+        /// Invokes an action once for each index in [0, count), running up to maxParallelism invocations at the same time.
+        /// <para>The calling thread takes part in the work, and is helped by threads of a worker pool shared by every call in
+        /// the process. Concurrent and nested calls, such as the textures of several assets converted at the same time,
+        /// therefore interleave on the same threads instead of each starting their own: a helper that is busy elsewhere
+        /// joins the loop when it becomes free, if indices are still left. Every worker thread initializes COM so that WIC
+        /// can be used from the action. If an invocation throws, no further indices are started and the first exception
+        /// is rethrown on the calling thread once all workers have finished.</para>
+        /// </summary>
+        /// <param name="count">The number of indices to process.</param>
+        /// <param name="maxParallelism">The maximum number of concurrent invocations. If 0, uses <see cref="GetDefaultParallelism" />.
+        /// If 1, all invocations run in order on the calling thread. The shared pool grows to the largest value requested.</param>
+        /// <param name="action">The action to invoke for each index.</param>
+        static void ParallelFor(size_t count, size_t maxParallelism, const std::function<void(size_t)>& action);
+
+        /// <summary>
+        /// Gets the default number of workers, which is the number of hardware threads available.
+        /// </summary>
+        /// <returns>The number of hardware threads, or 1 if it cannot be determined.</returns>
+        static size_t GetDefaultParallelism();
+    };
+
+    /// <summary>
+    /// A thread-safe counter that bounds how many callers hold a resource at the same time, such as the number of
+    /// decoded images in memory. Callers past the limit wait in <see cref="Acquire" /> until another caller is done.
+    /// </summary>
+    class ConcurrencyLimit
+    {
+    public:
+        /// <summary>
+        /// One unit of the limit. It is given back when the lease is destroyed.
+        /// </summary>
+        class Lease
+        {
+        public:
+            Lease(Lease&& other);
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+            ~Lease();
+
+        private:
+            friend class ConcurrencyLimit;
+            Lease(ConcurrencyLimit* limit);
+
+            ConcurrencyLimit* m_limit;
+        };
+
+        /// <summary>
+        /// Creates a limit.
+        /// </summary>
+        /// <param name="limit">The maximum number of leases that can exist at the same time. If 0, there is no limit.</param>
+        ConcurrencyLimit(size_t limit = 0);
+
+        /// <summary>
+        /// Changes the maximum number of leases. Leases that already exist are kept, and waiting callers are woken up
+        /// if the new limit lets them through.
+        /// </summary>
+        /// <param name="limit">The maximum number of leases that can exist at the same time. If 0, there is no limit.</param>
+        void SetLimit(size_t limit);
+
+        /// <summary>
+        /// Gets the maximum number of leases, or 0 if there is no limit.
+        /// </summary>
+        size_t GetLimit() const;
+
+        /// <summary>
+        /// Takes one unit of the limit, waiting for another caller to release one if all are in use.
+        /// <para>A thread must not wait for a second lease while it holds one, since the two could wait for each other.</para>
+        /// </summary>
+        /// <returns>A lease, which must be destroyed once the resource is no longer used.</returns>
+        Lease Acquire();
+
+    private:
+        void Release();
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_released;
+        size_t m_limit;
+        size_t m_leaseCount;
+    };
+}
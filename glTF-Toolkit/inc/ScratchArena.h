@@ -0,0 +1,139 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Microsoft::glTF::Toolkit
+{
+    /// <summary>
+    /// A thread-safe pool of scratch buffers for the temporary data of conversion stages, such as accessor contents and
+    /// bands of texture rows, so that long runs reuse the same large allocations instead of fragmenting the heap.
+    /// <para>Requested sizes are rounded up to one of four size classes between consecutive powers of two, and a released
+    /// buffer is handed to the next request of its class. Buffers are not initialized, neither when they are created nor when they are reused.</para>
+    /// </summary>
+    class ScratchArena
+    {
+    public:
+        /// <summary>
+        /// Exclusive use of one buffer of the arena. The buffer goes back to the arena when the lease is destroyed.
+        /// </summary>
+        class Lease
+        {
+        public:
+            /// <summary>An empty lease, of no bytes.</summary>
+            Lease();
+            Lease(Lease&& other);
+            Lease& operator=(Lease&& other);
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+            ~Lease();
+
+            uint8_t* data() const { return m_buffer.get(); }
+
+            /// <summary>The size that was requested, in bytes. The buffer may be larger.</summary>
+            size_t size() const { return m_size; }
+
+        private:
+            friend class ScratchArena;
+            Lease(ScratchArena* arena, std::unique_ptr<uint8_t[]> buffer, size_t size, size_t capacity);
+
+            void Release();
+
+            ScratchArena* m_arena;
+            std::unique_ptr<uint8_t[]> m_buffer;
+            size_t m_size;
+            size_t m_capacity;
+        };
+
+        /// <summary>
+        /// The use of an arena since it was created, or since its peaks were last reset.
+        /// </summary>
+        struct Statistics
+        {
+            /// <summary>The number of non-empty buffers that were leased.</summary>
+            uint64_t acquisitions = 0;
+
+            /// <summary>The number of leases that reused a released buffer instead of allocating one.</summary>
+            uint64_t reuses = 0;
+
+            /// <summary>The bytes of the buffers that are leased right now.</summary>
+            size_t bytesInUse = 0;
+
+            /// <summary>The bytes of the released buffers that the arena keeps for reuse.</summary>
+            size_t bytesIdle = 0;
+
+            /// <summary>The highest number of bytes leased at the same time: the scratch memory that the stages needed.</summary>
+            size_t peakBytesInUse = 0;
+
+            /// <summary>The highest number of bytes held by the arena at the same time, leased or idle: the scratch memory that the process used.</summary>
+            size_t peakBytesReserved = 0;
+        };
+
+        /// <summary>
+        /// Creates an empty arena.
+        /// </summary>
+        /// <param name="maxIdleBytes">The maximum number of bytes of released buffers kept for reuse. Buffers released past that are freed.</param>
+        ScratchArena(size_t maxIdleBytes = DEFAULT_MAX_IDLE_BYTES);
+        ~ScratchArena();
+
+        /// <summary>
+        /// Leases a buffer of at least the given size, reusing a released one of the same size class if there is one.
+        /// </summary>
+        Lease Acquire(size_t byteLength);
+
+        Statistics GetStatistics() const;
+
+        /// <summary>
+        /// Restarts the peaks of <see cref="GetStatistics" /> from the current use, e.g. to measure each asset of a batch on its own.
+        /// </summary>
+        void ResetPeaks();
+
+        /// <summary>
+        /// Frees the released buffers kept for reuse.
+        /// </summary>
+        void Trim();
+
+        /// <summary>
+        /// Gets the arena shared by all toolkit operations.
+        /// </summary>
+        static ScratchArena& GetShared();
+
+        static const size_t DEFAULT_MAX_IDLE_BYTES = 512 * 1024 * 1024;
+
+    private:
+        void Release(std::unique_ptr<uint8_t[]> buffer, size_t capacity);
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<size_t, std::vector<std::unique_ptr<uint8_t[]>>> m_idleBuffers;
+        size_t m_maxIdleBytes;
+        Statistics m_statistics;
+    };
+
+    /// <summary>
+    /// An array of elements in a buffer leased from the shared <see cref="ScratchArena" />, for the scratch data that would
+    /// otherwise be in a std::vector. The elements are not initialized.
+    /// </summary>
+    template <typename T>
+    class ScratchArray
+    {
+    public:
+        ScratchArray(size_t size) :
+            m_lease(ScratchArena::GetShared().Acquire(size * sizeof(T))),
+            m_size(size)
+        { }
+
+        T* data() const { return reinterpret_cast<T*>(m_lease.data()); }
+        size_t size() const { return m_size; }
+        T& operator[](size_t index) const { return data()[index]; }
+
+    private:
+        ScratchArena::Lease m_lease;
+        size_t m_size;
+    };
+}
@@ -10,6 +10,7 @@
 #include <rapidjson/document.h>
 
 #include "AccessorUtils.h"
+#include "GLTFMeshCompressionUtils.h"
 
 namespace Microsoft::glTF::Toolkit
 {
@@ -19,12 +20,39 @@ namespace Microsoft::glTF::Toolkit
     /// </summary>
     typedef std::function<ComponentType(const Accessor&)> AccessorConversionStrategy;
 
+    /// <summary>
+    /// The order in which accessor and image data is laid out in the binary chunk of a GLB.
+    /// </summary>
+    enum class BinaryLayout
+    {
+        /// <summary>Accessors in document order, followed by images in document order.</summary>
+        DocumentOrder,
+
+        /// <summary>The accessors and images drawn by the coarsest MSFT_lod level first, and those drawn only by finer levels after,
+        /// so that a loader streaming the GLB can draw the coarsest LOD from a prefix of the file. Data that is not part of an LOD,
+        /// and data shared by several levels, is laid out with the coarsest level that needs it. Each level is in document order.</summary>
+        CoarsestLODFirst
+    };
+
     /// <summary>
     /// Serializes a glTF asset as a glTF binary (GLB) file.
     /// </summary>
     /// <param name="gltfDocument">The glTF asset manifest to be serialized.</param>
     /// <param name="inputStreamReader">A stream reader that is capable of accessing the resources used in the glTF asset by URI.</param>
-    /// <param name="outputStreamFactory">A stream factory that is capable of creating an output stream where the GLB will be saved, and a temporary stream for 
-    /// use during the serialization process.</param>
-    void SerializeBinary(const GLTFDocument& gltfDocument, const IStreamReader& inputStreamReader, std::unique_ptr<const IStreamFactory>& outputStreamFactory, const AccessorConversionStrategy& accessorConversion = nullptr);
+    /// <param name="outputStreamFactory">A stream factory that is capable of creating an output stream where the GLB will be saved.
+    /// The GLB is written to that stream in a single pass, so no temporary stream is requested.</param>
+    /// <param name="accessorConversion">An optional function that chooses the component type each accessor is saved as.</param>
+    /// <param name="maxParallelism">The maximum number of accessors to read, convert and measure at the same time. If 0, uses one worker
+    /// per hardware thread. When greater than 1, the input stream reader and accessorConversion must be safe to call from several threads.
+    /// The output is the same for every value.</param>
+    /// <param name="deduplicate">If true, accessors and images whose bytes are identical share a single bufferView in the GLB.</param>
+    /// <param name="compression">How vertex attribute and index bufferViews are compressed with EXT_meshopt_compression, if at all.
+    /// Triangle list indices that are decompressed may have the vertices of each triangle rotated, which keeps their winding.</param>
+    /// <param name="layout">The order of accessor and image data in the binary chunk. Every layout describes the same asset, with bufferViews in layout order.</param>
+    /// <remarks>
+    /// The layout of the binary chunk is computed before anything is written, and accessor and image data is read
+    /// back from the input when its turn comes, so the whole binary chunk is never held in memory.
+    /// Elements of accessors in vertex attribute (ARRAY_BUFFER) bufferViews are padded to a multiple of 4 bytes.
+    /// </remarks>
+    void SerializeBinary(const GLTFDocument& gltfDocument, const IStreamReader& inputStreamReader, std::unique_ptr<const IStreamFactory>& outputStreamFactory, const AccessorConversionStrategy& accessorConversion = nullptr, size_t maxParallelism = 1, bool deduplicate = false, MeshCompression compression = MeshCompression::None, BinaryLayout layout = BinaryLayout::DocumentOrder);
 }
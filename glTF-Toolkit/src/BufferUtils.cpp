@@ -0,0 +1,206 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "BufferUtils.h"
+
+#include "AccessorUtils.h"
+
+#include "GLTFSDK/GLTF.h"
+#include "GLTFSDK/GLTFResourceReader.h"
+
+#include <cstring>
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    std::wstring CombinePath(const std::string& directory, const std::string& fileName)
+    {
+        std::wstring directoryW(directory.begin(), directory.end());
+        std::wstring fileNameW(fileName.begin(), fileName.end());
+
+        wchar_t fullPath[MAX_PATH];
+
+        if (FAILED(::PathCchCombine(fullPath, ARRAYSIZE(fullPath), directoryW.c_str(), fileNameW.c_str())))
+        {
+            throw GLTFException("Failed to compose output file path.");
+        }
+
+        return fullPath;
+    }
+
+    template <typename T>
+    void AppendValues(const GLTFResourceReader& reader, const GLTFDocument& doc, const Accessor& accessor, std::vector<uint8_t>& data)
+    {
+        auto values = reader.ReadBinaryData<T>(doc, accessor);
+        auto bytes = reinterpret_cast<const uint8_t*>(values.data());
+        data.insert(data.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+}
+
+BufferWriter::BufferWriter(GLTFDocument& doc, const std::string& outputDirectory, const std::string& fileName) :
+    m_doc(doc),
+    m_fileName(fileName),
+    m_path(CombinePath(outputDirectory, fileName)),
+    m_bufferId(std::to_string(doc.buffers.Size())),
+    m_byteLength(0)
+{
+}
+
+std::string BufferWriter::AddBufferView(const std::vector<uint8_t>& data, size_t byteStride, BufferViewTarget target)
+{
+    if (!m_output.is_open())
+    {
+        m_output.open(m_path, std::ios::binary);
+    }
+
+    static const char padding[4] = {};
+    size_t byteOffset = (m_byteLength + 3) & ~static_cast<size_t>(3);
+    m_output.write(padding, byteOffset - m_byteLength);
+    m_output.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+    BufferView bufferView;
+    bufferView.id = std::to_string(m_doc.bufferViews.Size());
+    bufferView.bufferId = m_bufferId;
+    bufferView.byteOffset = byteOffset;
+    bufferView.byteLength = data.size();
+    bufferView.byteStride = byteStride;
+    bufferView.target = target;
+
+    m_byteLength = byteOffset + data.size();
+
+    auto id = bufferView.id;
+    m_doc.bufferViews.Append(std::move(bufferView));
+    return id;
+}
+
+void BufferWriter::Finish()
+{
+    if (!m_output.is_open())
+    {
+        return;
+    }
+
+    m_output.close();
+    if (m_output.fail())
+    {
+        throw GLTFException("Failed to write " + m_fileName);
+    }
+
+    Buffer buffer;
+    buffer.id = m_bufferId;
+    buffer.uri = std::string(m_path.begin(), m_path.end());
+    buffer.byteLength = m_byteLength;
+    m_doc.buffers.Append(std::move(buffer));
+}
+
+VertexAttributeIds BufferUtils::GetAttributeIds(const MeshPrimitive& primitive)
+{
+    return {
+        primitive.positionsAccessorId, primitive.normalsAccessorId, primitive.tangentsAccessorId,
+        primitive.uv0AccessorId, primitive.uv1AccessorId, primitive.color0AccessorId,
+        primitive.joints0AccessorId, primitive.weights0AccessorId };
+}
+
+void BufferUtils::SetAttributeIds(MeshPrimitive& primitive, const VertexAttributeIds& ids)
+{
+    primitive.positionsAccessorId = ids[POSITION_ATTRIBUTE];
+    primitive.normalsAccessorId = ids[NORMAL_ATTRIBUTE];
+    primitive.tangentsAccessorId = ids[TANGENT_ATTRIBUTE];
+    primitive.uv0AccessorId = ids[UV0_ATTRIBUTE];
+    primitive.uv1AccessorId = ids[UV1_ATTRIBUTE];
+    primitive.color0AccessorId = ids[COLOR0_ATTRIBUTE];
+    primitive.joints0AccessorId = ids[JOINTS0_ATTRIBUTE];
+    primitive.weights0AccessorId = ids[WEIGHTS0_ATTRIBUTE];
+}
+
+void BufferUtils::AppendElements(const GLTFResourceReader& reader, const GLTFDocument& doc, const Accessor& accessor, MergedVertexAttribute& merged)
+{
+    switch (accessor.componentType)
+    {
+    case ComponentType::COMPONENT_BYTE:
+        AppendValues<int8_t>(reader, doc, accessor, merged.elements);
+        break;
+    case ComponentType::COMPONENT_UNSIGNED_BYTE:
+        AppendValues<uint8_t>(reader, doc, accessor, merged.elements);
+        break;
+    case ComponentType::COMPONENT_SHORT:
+        AppendValues<int16_t>(reader, doc, accessor, merged.elements);
+        break;
+    case ComponentType::COMPONENT_UNSIGNED_SHORT:
+        AppendValues<uint16_t>(reader, doc, accessor, merged.elements);
+        break;
+    case ComponentType::COMPONENT_UNSIGNED_INT:
+        AppendValues<uint32_t>(reader, doc, accessor, merged.elements);
+        break;
+    case ComponentType::COMPONENT_FLOAT:
+        AppendValues<float>(reader, doc, accessor, merged.elements);
+        break;
+    default:
+        throw GLTFException("Invalid component type in accessor " + accessor.id);
+    }
+
+    if (accessor.min.empty() || accessor.max.empty())
+    {
+        merged.hasBounds = false;
+    }
+    else if (merged.hasBounds)
+    {
+        AccessorUtils::AccumulateMinMax(accessor.min.data(), 1, accessor.min.size(), merged.min, merged.max);
+        AccessorUtils::AccumulateMinMax(accessor.max.data(), 1, accessor.max.size(), merged.min, merged.max);
+    }
+}
+
+void BufferUtils::AppendFloats(const std::vector<float>& values, size_t typeCount, MergedVertexAttribute& merged)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(values.data());
+    merged.elements.insert(merged.elements.end(), bytes, bytes + values.size() * sizeof(float));
+
+    if (merged.hasBounds)
+    {
+        AccessorUtils::AccumulateMinMax(values.data(), values.size() / typeCount, typeCount, merged.min, merged.max);
+    }
+}
+
+size_t BufferUtils::GetVertexByteStride(size_t elementSize)
+{
+    return (elementSize + 3) & ~static_cast<size_t>(3);
+}
+
+std::vector<uint8_t> BufferUtils::PadVertexElements(const void* elements, size_t count, size_t elementSize)
+{
+    const size_t byteStride = GetVertexByteStride(elementSize);
+    auto source = static_cast<const uint8_t*>(elements);
+
+    std::vector<uint8_t> data(count * byteStride);
+    for (size_t i = 0; i < count; i++)
+    {
+        std::memcpy(&data[i * byteStride], source + i * elementSize, elementSize);
+    }
+
+    return data;
+}
+
+std::string BufferUtils::AddVertexAccessor(GLTFDocument& doc, BufferWriter& writer, const Accessor& templateAccessor, const MergedVertexAttribute& merged, size_t count)
+{
+    const size_t elementSize = Accessor::GetTypeCount(templateAccessor.type) * Accessor::GetComponentTypeSize(templateAccessor.componentType);
+    if (merged.elements.size() != count * elementSize)
+    {
+        throw GLTFException("The merged vertices of accessor " + templateAccessor.id + " do not match the vertex count.");
+    }
+
+    Accessor accessor(templateAccessor);
+    accessor.id = std::to_string(doc.accessors.Size());
+    accessor.bufferViewId = writer.AddBufferView(PadVertexElements(merged.elements.data(), count, elementSize), GetVertexByteStride(elementSize), BufferViewTarget::ARRAY_BUFFER);
+    accessor.byteOffset = 0;
+    accessor.count = count;
+    accessor.min = merged.hasBounds ? merged.min : std::vector<float>();
+    accessor.max = merged.hasBounds ? merged.max : std::vector<float>();
+
+    auto id = accessor.id;
+    doc.accessors.Append(std::move(accessor));
+    return id;
+}
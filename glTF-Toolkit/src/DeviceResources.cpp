@@ -1,222 +1,222 @@
-// Copyright (c) Microsoft Corporation. All rights reserved.
-// Licensed under the MIT License. See LICENSE in the project root for license information.
-
-#include "pch.h"
-
-#include "DeviceResources.h"
-
-using namespace DirectX;
-using namespace DX;
-
-using Microsoft::WRL::ComPtr;
-
-namespace
-{
-#if defined(_DEBUG)
-    // Check for SDK Layer support.
-    inline bool SdkLayersAvailable()
-    {
-        HRESULT hr = D3D11CreateDevice(
-            nullptr,
-            D3D_DRIVER_TYPE_NULL,       // There is no need to create a real hardware device.
-            0,
-            D3D11_CREATE_DEVICE_DEBUG,  // Check for the SDK layers.
-            nullptr,                    // Any feature level will do.
-            0,
-            D3D11_SDK_VERSION,
-            nullptr,                    // No need to keep the D3D device reference.
-            nullptr,                    // No need to know the feature level.
-            nullptr                     // No need to keep the D3D device context reference.
-            );
-
-        return SUCCEEDED(hr);
-    }
-#endif
-};
-
-// Constructor for DeviceResources.
-DeviceResources::DeviceResources(D3D_FEATURE_LEVEL minFeatureLevel) :
-    m_d3dMinFeatureLevel(minFeatureLevel),
-    m_d3dFeatureLevel(D3D_FEATURE_LEVEL_9_1)
-{
-}
-
-// Configures the Direct3D device, and stores handles to it and the device context.
-void DeviceResources::CreateDeviceResources() 
-{
-    UINT creationFlags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
-
-#if defined(_DEBUG)
-    if (SdkLayersAvailable())
-    {
-        // If the project is in a debug build, enable debugging via SDK Layers with this flag.
-        creationFlags |= D3D11_CREATE_DEVICE_DEBUG;
-    }
-    else
-    {
-        OutputDebugStringA("WARNING: Direct3D Debug Device is not available\n");
-    }
-#endif
-
-    // Determine DirectX hardware feature levels this app will support.
-    static const D3D_FEATURE_LEVEL s_featureLevels[] =
-    {
-        D3D_FEATURE_LEVEL_11_1,
-        D3D_FEATURE_LEVEL_11_0,
-        D3D_FEATURE_LEVEL_10_1,
-        D3D_FEATURE_LEVEL_10_0,
-        D3D_FEATURE_LEVEL_9_3,
-        D3D_FEATURE_LEVEL_9_2,
-        D3D_FEATURE_LEVEL_9_1,
-    };
-
-    UINT featLevelCount = 0;
-    for (; featLevelCount < _countof(s_featureLevels); ++featLevelCount)
-    {
-        if (s_featureLevels[featLevelCount] < m_d3dMinFeatureLevel)
-            break;
-    }
-
-    if (!featLevelCount)
-    {
-        throw std::out_of_range("minFeatureLevel too high");
-    }
-
-    ComPtr<IDXGIAdapter1> adapter;
-    GetHardwareAdapter(adapter.GetAddressOf());
-
-    // Create the Direct3D 11 API device object and a corresponding context.
-    ComPtr<ID3D11Device> device;
-    ComPtr<ID3D11DeviceContext> context;
-
-    HRESULT hr = E_FAIL;
-    if (adapter)
-    {
-        hr = D3D11CreateDevice(
-            adapter.Get(),
-            D3D_DRIVER_TYPE_UNKNOWN,
-            0,
-            creationFlags,
-            s_featureLevels,
-            featLevelCount,
-            D3D11_SDK_VERSION,
-            device.GetAddressOf(),      // Returns the Direct3D device created.
-            &m_d3dFeatureLevel,         // Returns feature level of device created.
-            context.GetAddressOf()      // Returns the device immediate context.
-            );
-    }
-#if defined(NDEBUG)
-    else
-    {
-        throw std::exception("No Direct3D hardware device found");
-    }
-#else
-    if (FAILED(hr))
-    {
-        // If the initialization fails, fall back to the WARP device.
-        // For more information on WARP, see: 
-        // http://go.microsoft.com/fwlink/?LinkId=286690
-        hr = D3D11CreateDevice(
-            nullptr,
-            D3D_DRIVER_TYPE_WARP, // Create a WARP device instead of a hardware device.
-            0,
-            creationFlags,
-            s_featureLevels,
-            featLevelCount,
-            D3D11_SDK_VERSION,
-            device.GetAddressOf(),
-            &m_d3dFeatureLevel,
-            context.GetAddressOf()
-            );
-
-        if (SUCCEEDED(hr))
-        {
-            OutputDebugStringA("Direct3D Adapter - WARP\n");
-        }
-    }
-#endif
-
-    ThrowIfFailed(hr);
-
-#ifndef NDEBUG
-    ComPtr<ID3D11Debug> d3dDebug;
-    if (SUCCEEDED(device.As(&d3dDebug)))
-    {
-        ComPtr<ID3D11InfoQueue> d3dInfoQueue;
-        if (SUCCEEDED(d3dDebug.As(&d3dInfoQueue)))
-        {
-#ifdef _DEBUG
-            d3dInfoQueue->SetBreakOnSeverity(D3D11_MESSAGE_SEVERITY_CORRUPTION, true);
-            d3dInfoQueue->SetBreakOnSeverity(D3D11_MESSAGE_SEVERITY_ERROR, true);
-#endif
-            D3D11_MESSAGE_ID hide [] =
-            {
-                D3D11_MESSAGE_ID_SETPRIVATEDATA_CHANGINGPARAMS,
-            };
-            D3D11_INFO_QUEUE_FILTER filter = {};
-            filter.DenyList.NumIDs = _countof(hide);
-            filter.DenyList.pIDList = hide;
-            d3dInfoQueue->AddStorageFilterEntries(&filter);
-        }
-    }
-#endif
-
-    ThrowIfFailed(device.As(&m_d3dDevice));
-    ThrowIfFailed(context.As(&m_d3dContext));
-    ThrowIfFailed(context.As(&m_d3dAnnotation));
-}
-
-// Recreate all device resources and set them back to the current state.
-void DeviceResources::HandleDeviceLost()
-{
-    m_swapChain.Reset();
-    m_d3dContext.Reset();
-    m_d3dAnnotation.Reset();
-
-#ifdef _DEBUG
-    {
-        ComPtr<ID3D11Debug> d3dDebug;
-        if (SUCCEEDED(m_d3dDevice.As(&d3dDebug)))
-        {
-            d3dDebug->ReportLiveDeviceObjects(D3D11_RLDO_SUMMARY);
-        }
-    }
-#endif
-
-    m_d3dDevice.Reset();
-
-    CreateDeviceResources();
-}
-
-// This method acquires the first available hardware adapter.
-// If no such adapter can be found, *ppAdapter will be set to nullptr.
-void DeviceResources::GetHardwareAdapter(IDXGIAdapter1** ppAdapter)
-{
-    *ppAdapter = nullptr;
-
-    ComPtr<IDXGIFactory1> dxgiFactory;
-    ThrowIfFailed(CreateDXGIFactory1(IID_PPV_ARGS(dxgiFactory.GetAddressOf())));
-
-    ComPtr<IDXGIAdapter1> adapter;
-    for (UINT adapterIndex = 0; DXGI_ERROR_NOT_FOUND != dxgiFactory->EnumAdapters1(adapterIndex, adapter.ReleaseAndGetAddressOf()); adapterIndex++)
-    {
-        DXGI_ADAPTER_DESC1 desc;
-        adapter->GetDesc1(&desc);
-
-        if (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE)
-        {
-            // Don't select the Basic Render Driver adapter.
-            continue;
-        }
-
-#ifdef _DEBUG
-        wchar_t buff[256] = {};
-        swprintf_s(buff, L"Direct3D Adapter (%u): VID:%04X, PID:%04X - %ls\n", adapterIndex, desc.VendorId, desc.DeviceId, desc.Description);
-        OutputDebugStringW(buff);
-#endif
-
-        break;
-    }
-
-    *ppAdapter = adapter.Detach();
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "DeviceResources.h"
+
+using namespace DirectX;
+using namespace DX;
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+#if defined(_DEBUG)
+    // Check for SDK Layer support.
+    inline bool SdkLayersAvailable()
+    {
+        HRESULT hr = D3D11CreateDevice(
+            nullptr,
+            D3D_DRIVER_TYPE_NULL,       // There is no need to create a real hardware device.
+            0,
+            D3D11_CREATE_DEVICE_DEBUG,  // Check for the SDK layers.
+            nullptr,                    // Any feature level will do.
+            0,
+            D3D11_SDK_VERSION,
+            nullptr,                    // No need to keep the D3D device reference.
+            nullptr,                    // No need to know the feature level.
+            nullptr                     // No need to keep the D3D device context reference.
+            );
+
+        return SUCCEEDED(hr);
+    }
+#endif
+};
+
+// Constructor for DeviceResources.
+DeviceResources::DeviceResources(D3D_FEATURE_LEVEL minFeatureLevel) :
+    m_d3dMinFeatureLevel(minFeatureLevel),
+    m_d3dFeatureLevel(D3D_FEATURE_LEVEL_9_1)
+{
+}
+
+// Configures the Direct3D device, and stores handles to it and the device context.
+void DeviceResources::CreateDeviceResources() 
+{
+    UINT creationFlags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
+
+#if defined(_DEBUG)
+    if (SdkLayersAvailable())
+    {
+        // If the project is in a debug build, enable debugging via SDK Layers with this flag.
+        creationFlags |= D3D11_CREATE_DEVICE_DEBUG;
+    }
+    else
+    {
+        OutputDebugStringA("WARNING: Direct3D Debug Device is not available\n");
+    }
+#endif
+
+    // Determine DirectX hardware feature levels this app will support.
+    static const D3D_FEATURE_LEVEL s_featureLevels[] =
+    {
+        D3D_FEATURE_LEVEL_11_1,
+        D3D_FEATURE_LEVEL_11_0,
+        D3D_FEATURE_LEVEL_10_1,
+        D3D_FEATURE_LEVEL_10_0,
+        D3D_FEATURE_LEVEL_9_3,
+        D3D_FEATURE_LEVEL_9_2,
+        D3D_FEATURE_LEVEL_9_1,
+    };
+
+    UINT featLevelCount = 0;
+    for (; featLevelCount < _countof(s_featureLevels); ++featLevelCount)
+    {
+        if (s_featureLevels[featLevelCount] < m_d3dMinFeatureLevel)
+            break;
+    }
+
+    if (!featLevelCount)
+    {
+        throw std::out_of_range("minFeatureLevel too high");
+    }
+
+    ComPtr<IDXGIAdapter1> adapter;
+    GetHardwareAdapter(adapter.GetAddressOf());
+
+    // Create the Direct3D 11 API device object and a corresponding context.
+    ComPtr<ID3D11Device> device;
+    ComPtr<ID3D11DeviceContext> context;
+
+    HRESULT hr = E_FAIL;
+    if (adapter)
+    {
+        hr = D3D11CreateDevice(
+            adapter.Get(),
+            D3D_DRIVER_TYPE_UNKNOWN,
+            0,
+            creationFlags,
+            s_featureLevels,
+            featLevelCount,
+            D3D11_SDK_VERSION,
+            device.GetAddressOf(),      // Returns the Direct3D device created.
+            &m_d3dFeatureLevel,         // Returns feature level of device created.
+            context.GetAddressOf()      // Returns the device immediate context.
+            );
+    }
+#if defined(NDEBUG)
+    else
+    {
+        throw std::exception("No Direct3D hardware device found");
+    }
+#else
+    if (FAILED(hr))
+    {
+        // If the initialization fails, fall back to the WARP device.
+        // For more information on WARP, see: 
+        // http://go.microsoft.com/fwlink/?LinkId=286690
+        hr = D3D11CreateDevice(
+            nullptr,
+            D3D_DRIVER_TYPE_WARP, // Create a WARP device instead of a hardware device.
+            0,
+            creationFlags,
+            s_featureLevels,
+            featLevelCount,
+            D3D11_SDK_VERSION,
+            device.GetAddressOf(),
+            &m_d3dFeatureLevel,
+            context.GetAddressOf()
+            );
+
+        if (SUCCEEDED(hr))
+        {
+            OutputDebugStringA("Direct3D Adapter - WARP\n");
+        }
+    }
+#endif
+
+    ThrowIfFailed(hr);
+
+#ifndef NDEBUG
+    ComPtr<ID3D11Debug> d3dDebug;
+    if (SUCCEEDED(device.As(&d3dDebug)))
+    {
+        ComPtr<ID3D11InfoQueue> d3dInfoQueue;
+        if (SUCCEEDED(d3dDebug.As(&d3dInfoQueue)))
+        {
+#ifdef _DEBUG
+            d3dInfoQueue->SetBreakOnSeverity(D3D11_MESSAGE_SEVERITY_CORRUPTION, true);
+            d3dInfoQueue->SetBreakOnSeverity(D3D11_MESSAGE_SEVERITY_ERROR, true);
+#endif
+            D3D11_MESSAGE_ID hide [] =
+            {
+                D3D11_MESSAGE_ID_SETPRIVATEDATA_CHANGINGPARAMS,
+            };
+            D3D11_INFO_QUEUE_FILTER filter = {};
+            filter.DenyList.NumIDs = _countof(hide);
+            filter.DenyList.pIDList = hide;
+            d3dInfoQueue->AddStorageFilterEntries(&filter);
+        }
+    }
+#endif
+
+    ThrowIfFailed(device.As(&m_d3dDevice));
+    ThrowIfFailed(context.As(&m_d3dContext));
+    ThrowIfFailed(context.As(&m_d3dAnnotation));
+}
+
+// Recreate all device resources and set them back to the current state.
+void DeviceResources::HandleDeviceLost()
+{
+    m_swapChain.Reset();
+    m_d3dContext.Reset();
+    m_d3dAnnotation.Reset();
+
+#ifdef _DEBUG
+    {
+        ComPtr<ID3D11Debug> d3dDebug;
+        if (SUCCEEDED(m_d3dDevice.As(&d3dDebug)))
+        {
+            d3dDebug->ReportLiveDeviceObjects(D3D11_RLDO_SUMMARY);
+        }
+    }
+#endif
+
+    m_d3dDevice.Reset();
+
+    CreateDeviceResources();
+}
+
+// This method acquires the first available hardware adapter.
+// If no such adapter can be found, *ppAdapter will be set to nullptr.
+void DeviceResources::GetHardwareAdapter(IDXGIAdapter1** ppAdapter)
+{
+    *ppAdapter = nullptr;
+
+    ComPtr<IDXGIFactory1> dxgiFactory;
+    ThrowIfFailed(CreateDXGIFactory1(IID_PPV_ARGS(dxgiFactory.GetAddressOf())));
+
+    ComPtr<IDXGIAdapter1> adapter;
+    for (UINT adapterIndex = 0; DXGI_ERROR_NOT_FOUND != dxgiFactory->EnumAdapters1(adapterIndex, adapter.ReleaseAndGetAddressOf()); adapterIndex++)
+    {
+        DXGI_ADAPTER_DESC1 desc;
+        adapter->GetDesc1(&desc);
+
+        if (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE)
+        {
+            // Don't select the Basic Render Driver adapter.
+            continue;
+        }
+
+#ifdef _DEBUG
+        wchar_t buff[256] = {};
+        swprintf_s(buff, L"Direct3D Adapter (%u): VID:%04X, PID:%04X - %ls\n", adapterIndex, desc.VendorId, desc.DeviceId, desc.Description);
+        OutputDebugStringW(buff);
+#endif
+
+        break;
+    }
+
+    *ppAdapter = adapter.Detach();
 }
\ No newline at end of file
@@ -0,0 +1,132 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "DeviceResources.h"
+#include "DeviceResourcesPool.h"
+
+using namespace Microsoft::glTF::Toolkit;
+
+DeviceResourcesPool::Lease::Lease(DeviceResourcesPool* pool, std::unique_ptr<DX::DeviceResources> resources) :
+    m_pool(pool),
+    m_resources(std::move(resources))
+{
+}
+
+DeviceResourcesPool::Lease::Lease(Lease&& other) :
+    m_pool(other.m_pool),
+    m_resources(std::move(other.m_resources))
+{
+    other.m_pool = nullptr;
+}
+
+DeviceResourcesPool::Lease::~Lease()
+{
+    if (m_pool != nullptr)
+    {
+        m_pool->Release(std::move(m_resources));
+    }
+}
+
+bool DeviceResourcesPool::Lease::HandleDeviceLost()
+{
+    if (m_resources == nullptr)
+    {
+        return false;
+    }
+
+    try
+    {
+        m_resources->HandleDeviceLost();
+    }
+    catch (const std::exception&)
+    {
+        // The device could not be recreated, so it will not go back to the pool
+        m_resources.reset();
+    }
+
+    return m_resources != nullptr && m_resources->GetD3DDevice() != nullptr;
+}
+
+DeviceResourcesPool::DeviceResourcesPool(size_t maxDevices) :
+    m_maxDevices(maxDevices),
+    m_deviceCount(0),
+    m_deviceCreationFailed(false)
+{
+}
+
+DeviceResourcesPool::~DeviceResourcesPool() = default;
+
+DeviceResourcesPool::Lease DeviceResourcesPool::Acquire()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_deviceReleased.wait(lock, [this]()
+    {
+        return !m_idleDevices.empty() || m_deviceCreationFailed || m_maxDevices == 0 || m_deviceCount < m_maxDevices;
+    });
+
+    if (!m_idleDevices.empty())
+    {
+        auto resources = std::move(m_idleDevices.back());
+        m_idleDevices.pop_back();
+        return Lease(this, std::move(resources));
+    }
+
+    if (m_deviceCreationFailed)
+    {
+        return Lease(nullptr, nullptr);
+    }
+
+    // Create the device outside the lock, since adapter enumeration and device creation are slow
+    m_deviceCount++;
+    lock.unlock();
+
+    try
+    {
+        auto resources = std::make_unique<DX::DeviceResources>();
+        resources->CreateDeviceResources();
+
+        if (resources->GetD3DDevice() != nullptr)
+        {
+            return Lease(this, std::move(resources));
+        }
+    }
+    catch (const std::exception&)
+    {
+        // No usable device on this machine, callers will fall back to the CPU
+    }
+
+    lock.lock();
+    m_deviceCount--;
+    m_deviceCreationFailed = true;
+    m_deviceReleased.notify_all();
+
+    return Lease(nullptr, nullptr);
+}
+
+DeviceResourcesPool& DeviceResourcesPool::GetShared()
+{
+    static DeviceResourcesPool sharedPool;
+    return sharedPool;
+}
+
+void DeviceResourcesPool::Release(std::unique_ptr<DX::DeviceResources> resources)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (resources != nullptr)
+        {
+            m_idleDevices.push_back(std::move(resources));
+        }
+        else
+        {
+            // The device was lost and could not be recreated
+            m_deviceCount--;
+        }
+    }
+
+    m_deviceReleased.notify_one();
+}
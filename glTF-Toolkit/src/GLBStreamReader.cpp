@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "GLBStreamReader.h"
+#include "GLBUtils.h"
+#include "MemoryMappedFile.h"
+
+#include <GLTFSDK/GLTF.h>
+#include <GLTFSDK/GLBResourceReader.h>
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    // A read-only stream buffer over a block of memory, which is not copied
+    class MemoryStreamBuffer : public std::streambuf
+    {
+    public:
+        MemoryStreamBuffer(const uint8_t* data, size_t size)
+        {
+            auto begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+            setg(begin, begin, begin + size);
+        }
+
+    protected:
+        pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override
+        {
+            if (!(which & std::ios_base::in))
+            {
+                return pos_type(off_type(-1));
+            }
+
+            off_type base = 0;
+            switch (direction)
+            {
+            case std::ios_base::beg:
+                base = 0;
+                break;
+            case std::ios_base::cur:
+                base = gptr() - eback();
+                break;
+            case std::ios_base::end:
+                base = egptr() - eback();
+                break;
+            default:
+                return pos_type(off_type(-1));
+            }
+
+            off_type position = base + offset;
+            if (position < 0 || position > egptr() - eback())
+            {
+                return pos_type(off_type(-1));
+            }
+
+            setg(eback(), eback() + position, egptr());
+            return pos_type(position);
+        }
+
+        pos_type seekpos(pos_type position, std::ios_base::openmode which) override
+        {
+            return seekoff(off_type(position), std::ios_base::beg, which);
+        }
+    };
+
+    // An input stream over the binary chunk, which keeps the mapping alive while it is in use
+    class MappedBufferStream : public std::istream
+    {
+    public:
+        MappedBufferStream(std::shared_ptr<MemoryMappedFile> file, const uint8_t* data, size_t size) :
+            std::istream(nullptr),
+            m_file(std::move(file)),
+            m_buffer(data, size)
+        {
+            rdbuf(&m_buffer);
+        }
+
+    private:
+        std::shared_ptr<MemoryMappedFile> m_file;
+        MemoryStreamBuffer m_buffer;
+    };
+}
+
+GLBStreamReader::GLBStreamReader(const std::string& glbPath) :
+    m_file(std::make_shared<MemoryMappedFile>(glbPath)),
+    m_bufferData(nullptr),
+    m_bufferSize(0)
+{
+    auto chunks = GLBUtils::ParseGLB(m_file->GetData(), m_file->GetSize());
+    m_json = std::move(chunks.json);
+    m_bufferData = chunks.bufferData;
+    m_bufferSize = chunks.bufferSize;
+
+    // Other resources are relative to the directory of the GLB file
+    std::wstring glbPathW(glbPath.begin(), glbPath.end());
+    wchar_t basePath[MAX_PATH];
+    if (wcscpy_s(basePath, ARRAYSIZE(basePath), glbPathW.c_str()) != 0 || FAILED(PathCchRemoveFileSpec(basePath, ARRAYSIZE(basePath))))
+    {
+        throw GLTFException("Failed to get the directory of " + glbPath + ".");
+    }
+
+    m_basePath = basePath;
+}
+
+std::shared_ptr<std::istream> GLBStreamReader::GetInputStream(const std::string& uri) const
+{
+    if (uri.empty() || uri == GLB_BUFFER_ID)
+    {
+        return std::make_shared<MappedBufferStream>(m_file, m_bufferData, m_bufferSize);
+    }
+
+    std::wstring uriW(uri.begin(), uri.end());
+
+    wchar_t uriAbsolute[MAX_PATH];
+    // Note: PathCchCombine will return the last argument if it's an absolute path
+    if (FAILED(::PathCchCombine(uriAbsolute, ARRAYSIZE(uriAbsolute), m_basePath.c_str(), uriW.c_str())))
+    {
+        throw GLTFException("Failed to compose the path of " + uri + ".");
+    }
+
+    return std::make_shared<std::ifstream>(uriAbsolute, std::ios::binary);
+}
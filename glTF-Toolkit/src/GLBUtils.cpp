@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "GLBUtils.h"
+
+#include <GLTFSDK/GLTF.h>
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    uint32_t ReadUInt32(const uint8_t* data)
+    {
+        return static_cast<uint32_t>(data[0]) |
+            (static_cast<uint32_t>(data[1]) << 8) |
+            (static_cast<uint32_t>(data[2]) << 16) |
+            (static_cast<uint32_t>(data[3]) << 24);
+    }
+}
+
+GLBChunks GLBUtils::ParseGLB(const uint8_t* data, size_t size)
+{
+    const size_t chunkHeaderSize = GLB_CHUNK_TYPE_SIZE * 2;
+
+    if (size < GLB2_HEADER_BYTE_SIZE + chunkHeaderSize || ReadUInt32(data) != GLB_MAGIC || ReadUInt32(data + 4) != GLB_VERSION)
+    {
+        throw GLTFException("Invalid GLB header.");
+    }
+
+    size_t jsonChunkOffset = GLB2_HEADER_BYTE_SIZE;
+    size_t jsonLength = ReadUInt32(data + jsonChunkOffset);
+    if (ReadUInt32(data + jsonChunkOffset + GLB_CHUNK_TYPE_SIZE) != GLB_CHUNK_JSON || jsonLength > size - jsonChunkOffset - chunkHeaderSize)
+    {
+        throw GLTFException("Invalid GLB JSON chunk.");
+    }
+
+    GLBChunks chunks;
+    chunks.json.assign(reinterpret_cast<const char*>(data + jsonChunkOffset + chunkHeaderSize), jsonLength);
+
+    // The binary chunk is optional
+    size_t binChunkOffset = jsonChunkOffset + chunkHeaderSize + jsonLength;
+    if (binChunkOffset + chunkHeaderSize <= size && ReadUInt32(data + binChunkOffset + GLB_CHUNK_TYPE_SIZE) == GLB_CHUNK_BIN)
+    {
+        size_t binLength = ReadUInt32(data + binChunkOffset);
+        if (binLength > size - binChunkOffset - chunkHeaderSize)
+        {
+            throw GLTFException("Invalid GLB binary chunk.");
+        }
+
+        chunks.bufferData = data + binChunkOffset + chunkHeaderSize;
+        chunks.bufferSize = binLength;
+    }
+
+    return chunks;
+}
@@ -3,41 +3,36 @@
 
 #include "pch.h"
 #include "GLBtoGLTF.h"
+#include "GLBStreamReader.h"
+#include "Instrumentation.h"
 
 using namespace Microsoft::glTF;
 using namespace Microsoft::glTF::Toolkit;
 
 namespace
 {
-    class StreamMock : public IStreamReader
+    std::string GetImageFileName(const Image& image, const std::string& name, size_t imageIndex)
     {
-    public:
-        StreamMock() : m_stream(std::make_shared<std::stringstream>(std::ios_base::app | std::ios_base::binary | std::ios_base::in | std::ios_base::out))
+        auto fileName = name + "_image" + std::to_string(imageIndex);
+        if (image.mimeType == MIMETYPE_PNG)
         {
+            fileName += std::string(".") + FILE_EXT_PNG;
         }
-
-        std::shared_ptr<std::istream> GetInputStream(const std::string&) const override
+        else if (image.mimeType == MIMETYPE_JPEG)
         {
-            return m_stream;
+            fileName += std::string(".") + FILE_EXT_JPEG;
         }
 
-    private:
-        std::shared_ptr<std::stringstream> m_stream;
-    };
+        // unknown mimetypes have no extension
+        return fileName;
+    }
 
-    size_t GetGLBBufferChunkOffset(std::ifstream* input)
+    void CheckBufferViewRange(const BufferView& bufferView, size_t bufferSize)
     {
-        // get offset from beginning of glb binary to beginning of buffer chunk
-        input->seekg(GLB2_HEADER_BYTE_SIZE, std::ios::beg);
-        uint32_t length = 0;
-        for (int i = 0; i < GLB_CHUNK_TYPE_SIZE*CHAR_BIT; i += CHAR_BIT)
+        if (bufferView.byteOffset > bufferSize || bufferView.byteLength > bufferSize - bufferView.byteOffset)
         {
-            uint8_t c = static_cast<uint8_t>(input->get());
-            length |= ((uint16_t)c << i);
+            throw GLTFException("Buffer view " + bufferView.id + " is out of the range of the GLB binary chunk.");
         }
-        // 28 is total length of non-json blocks from start of glb blob
-        // 28 = (GLB2_HEADER_BYTE_SIZE = 12bytes) + (uint32 = 4bytes) * 4
-        return length + GLB2_HEADER_BYTE_SIZE + GLB_CHUNK_TYPE_SIZE * 4;
     }
 }
 
@@ -177,6 +172,64 @@ std::unordered_map<std::string, std::vector<char>> GLBToGLTF::GetImagesData(std:
     return imageStream;
 }
 
+void GLBToGLTF::SaveBin(const uint8_t* bufferData, size_t bufferSize, const GLTFDocument& glbDoc, std::ostream& output)
+{
+    std::unordered_set<std::string> imagesBufferViews;
+    for (const auto& im : glbDoc.images.Elements())
+    {
+        imagesBufferViews.insert(im.bufferViewId);
+    }
+
+    // gather all non-image bufferViews, sorted by offset, as in CreateGLTFDocument
+    std::vector<BufferView> usedBufferViews;
+    for (const auto& bufferView : glbDoc.bufferViews.Elements())
+    {
+        if (imagesBufferViews.count(bufferView.id) == 0)
+        {
+            usedBufferViews.push_back(bufferView);
+        }
+    }
+
+    sort(usedBufferViews.begin(), usedBufferViews.end(), [](const BufferView& a, const BufferView& b)
+    {
+        return a.byteOffset < b.byteOffset;
+    });
+
+    const char padding[GLB_BUFFER_OFFSET_ALIGNMENT] = {};
+    size_t outputPosition = 0;
+    for (const auto& bufferView : usedBufferViews)
+    {
+        CheckBufferViewRange(bufferView, bufferSize);
+
+        if (outputPosition % GLB_BUFFER_OFFSET_ALIGNMENT != 0)
+        {
+            auto paddingLength = GLB_BUFFER_OFFSET_ALIGNMENT - (outputPosition % GLB_BUFFER_OFFSET_ALIGNMENT);
+            output.write(padding, paddingLength);
+            outputPosition += paddingLength;
+        }
+
+        output.write(reinterpret_cast<const char*>(bufferData + bufferView.byteOffset), bufferView.byteLength);
+        outputPosition += bufferView.byteLength;
+    }
+}
+
+std::unordered_map<std::string, std::pair<const uint8_t*, size_t>> GLBToGLTF::GetImagesData(const uint8_t* bufferData, size_t bufferSize, const GLTFDocument& glbDoc, const std::string& name)
+{
+    std::unordered_map<std::string, std::pair<const uint8_t*, size_t>> imagesData;
+
+    size_t imageIndex = 0;
+    for (const auto& image : glbDoc.images.Elements())
+    {
+        const auto& bufferView = glbDoc.bufferViews.Get(image.bufferViewId);
+        CheckBufferViewRange(bufferView, bufferSize);
+
+        imagesData[GetImageFileName(image, name, imageIndex)] = std::make_pair(bufferData + bufferView.byteOffset, bufferView.byteLength);
+        imageIndex++;
+    }
+
+    return imagesData;
+}
+
 // Create modified gltf from original by removing image buffer segments and updating
 // images, bufferViews and accessors fields accordingly
 GLTFDocument GLBToGLTF::CreateGLTFDocument(const GLTFDocument& glbDoc, const std::string& name)
@@ -289,14 +342,15 @@ GLTFDocument GLBToGLTF::CreateGLTFDocument(const GLTFDocument& glbDoc, const std
 
 void GLBToGLTF::UnpackGLB(std::string glbPath, std::string outDirectory, std::string gltfName)
 {
-    // read glb file into json
-    auto glbStream = std::make_shared<std::ifstream>(glbPath, std::ios::binary);
-    auto streamReader = std::make_unique<StreamMock>();
-    GLBResourceReader reader(*streamReader, glbStream);
+    Instrumentation::Stage stage("UnpackGLB");
+    stage.SetProperty("glb", glbPath);
+
+    // map the glb file, so that resources are written straight from the file without being loaded first
+    GLBStreamReader glbReader(glbPath);
+    stage.AddBytesRead(glbReader.GetJson().length() + glbReader.GetBufferSize());
 
     // get original json
-    auto json = reader.GetJson();
-    auto doc = DeserializeJson(json);
+    auto doc = DeserializeJson(glbReader.GetJson());
 
     // create new modified json
     auto gltfDoc = GLBToGLTF::CreateGLTFDocument(doc, gltfName);
@@ -306,21 +360,21 @@ void GLBToGLTF::UnpackGLB(std::string glbPath, std::string outDirectory, std::st
     std::ofstream outputStream(outDirectory + gltfName + "." + GLTF_EXTENSION);
     outputStream << gltfJson;
     outputStream.flush();
+    stage.AddBytesWritten(gltfJson.length());
 
     // write images
-    size_t bufferOffset = GetGLBBufferChunkOffset(glbStream.get());
-    for (auto image : GLBToGLTF::GetImagesData(glbStream.get(), doc, gltfName, bufferOffset))
+    for (const auto& image : GLBToGLTF::GetImagesData(glbReader.GetBufferData(), glbReader.GetBufferSize(), doc, gltfName))
     {
         std::ofstream out(outDirectory + image.first, std::ios::binary);
-        out.write(&image.second[0], image.second.size());
+        out.write(reinterpret_cast<const char*>(image.second.first), image.second.second);
+        stage.AddBytesWritten(image.second.second);
     }
 
-    // get new buffer size and write new buffer
-    if (gltfDoc.buffers.Size() != 0)
+    // write new buffer
+    if (gltfDoc.buffers.Size() != 0 && gltfDoc.buffers[0].byteLength != 0)
     {
-        size_t newBufferSize = gltfDoc.buffers[0].byteLength;
-        auto binFileData = GLBToGLTF::SaveBin(glbStream.get(), doc, bufferOffset, newBufferSize);
         std::ofstream out(outDirectory + gltfName + "." + BUFFER_EXTENSION, std::ios::binary);
-        out.write(&binFileData[0], binFileData.size());
+        GLBToGLTF::SaveBin(glbReader.GetBufferData(), glbReader.GetBufferSize(), doc, out);
+        stage.AddBytesWritten(gltfDoc.buffers[0].byteLength);
     }
 }
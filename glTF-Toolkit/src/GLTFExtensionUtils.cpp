@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "GLTFExtensionUtils.h"
+
+#include <GLTFSDK/GLTF.h>
+
+#include <rapidjson/reader.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    typedef std::function<uint64_t(size_t, uint64_t)> IndexCallback;
+
+    // Tracks the member path of the SAX events of extension JSON, and passes the integers found at the given paths to a
+    // callback. With a writer, the JSON is streamed to it with those integers replaced by the values the callback returns.
+    class IndexHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, IndexHandler>
+    {
+    public:
+        IndexHandler(const JsonMemberPaths& paths, const IndexCallback& onIndex, rapidjson::Writer<rapidjson::StringBuffer>* writer) :
+            m_paths(paths),
+            m_onIndex(onIndex),
+            m_writer(writer)
+        { }
+
+        bool Null() { return !m_writer || m_writer->Null(); }
+        bool Bool(bool b) { return !m_writer || m_writer->Bool(b); }
+        bool Int(int i) { return i >= 0 ? Index(static_cast<uint64_t>(i)) : !m_writer || m_writer->Int(i); }
+        bool Uint(unsigned u) { return Index(u); }
+        bool Int64(int64_t i) { return i >= 0 ? Index(static_cast<uint64_t>(i)) : !m_writer || m_writer->Int64(i); }
+        bool Uint64(uint64_t u) { return Index(u); }
+        bool Double(double d) { return !m_writer || m_writer->Double(d); }
+        bool String(const char* str, rapidjson::SizeType length, bool copy) { return !m_writer || m_writer->String(str, length, copy); }
+
+        bool StartObject()
+        {
+            m_path.emplace_back();
+            return !m_writer || m_writer->StartObject();
+        }
+
+        bool Key(const char* str, rapidjson::SizeType length, bool copy)
+        {
+            m_path.back().assign(str, length);
+            return !m_writer || m_writer->Key(str, length, copy);
+        }
+
+        bool EndObject(rapidjson::SizeType memberCount)
+        {
+            m_path.pop_back();
+            return !m_writer || m_writer->EndObject(memberCount);
+        }
+
+        bool StartArray()
+        {
+            m_path.emplace_back("[]");
+            return !m_writer || m_writer->StartArray();
+        }
+
+        bool EndArray(rapidjson::SizeType elementCount)
+        {
+            m_path.pop_back();
+            return !m_writer || m_writer->EndArray(elementCount);
+        }
+
+    private:
+        bool Index(uint64_t index)
+        {
+            auto path = std::find(m_paths.begin(), m_paths.end(), m_path);
+            if (path != m_paths.end())
+            {
+                index = m_onIndex(static_cast<size_t>(path - m_paths.begin()), index);
+            }
+
+            return !m_writer || m_writer->Uint64(index);
+        }
+
+        const JsonMemberPaths& m_paths;
+        const IndexCallback& m_onIndex;
+        rapidjson::Writer<rapidjson::StringBuffer>* m_writer;
+        std::vector<std::string> m_path;
+    };
+
+    void ParseIndices(const std::string& json, const JsonMemberPaths& paths, const IndexCallback& onIndex, rapidjson::Writer<rapidjson::StringBuffer>* writer)
+    {
+        IndexHandler handler(paths, onIndex, writer);
+
+        rapidjson::Reader reader;
+        rapidjson::StringStream stream(json.c_str());
+        if (reader.Parse(stream, handler).IsError())
+        {
+            throw GLTFException("Could not parse extension JSON: " + json);
+        }
+    }
+}
+
+std::vector<std::vector<size_t>> GLTFExtensionUtils::ReadIndices(const std::string& json, const JsonMemberPaths& paths)
+{
+    std::vector<std::vector<size_t>> indices(paths.size());
+
+    ParseIndices(json, paths, [&indices](size_t path, uint64_t index)
+    {
+        indices[path].push_back(static_cast<size_t>(index));
+        return index;
+    }, nullptr);
+
+    return indices;
+}
+
+void GLTFExtensionUtils::RemapIndices(std::string& json, const JsonMemberPaths& paths, const std::function<size_t(size_t)>& remap)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+    ParseIndices(json, paths, [&remap](size_t, uint64_t index)
+    {
+        return static_cast<uint64_t>(remap(static_cast<size_t>(index)));
+    }, &writer);
+
+    json = buffer.GetString();
+}
@@ -4,18 +4,26 @@
 #include "pch.h"
 
 #include "GLTFTextureCompressionUtils.h"
+#include "GLTFExtensionUtils.h"
 #include "GLTFTexturePackingUtils.h"
 #include "GLTFLODUtils.h"
+#include "HashUtils.h"
+#include "Instrumentation.h"
 
 #include "GLTFSDK/GLTF.h"
 #include "GLTFSDK/GLTFConstants.h"
 #include "GLTFSDK/Deserialize.h"
+#include "GLTFSDK/GLTFResourceReader.h"
 #include "GLTFSDK/RapidJsonUtils.h"
 #include "GLTFSDK/Schema.h"
 
 #include <algorithm>
 #include <iostream>
+#include <map>
+#include <limits>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace Microsoft::glTF;
 using namespace Microsoft::glTF::Toolkit;
@@ -25,23 +33,338 @@ const char* Microsoft::glTF::Toolkit::MSFT_LOD_IDS_KEY = "ids";
 
 namespace
 {
-    inline void AddIndexOffset(std::string& id, size_t offset)
+    // The indices at which the contents of one LOD document start in the merged document
+    struct LODOffsets
     {
-        // an empty id string indicates that the id is not inuse and therefore should not be updated
-        id = (id.empty()) ? "" : std::to_string(std::stoi(id) + offset);
+        size_t buffers;
+        size_t samplers;
+        size_t bufferViews;
+        size_t accessors;
+        size_t images;
+        size_t textures;
+        size_t materials;
+        size_t meshes;
+        size_t nodes;
+    };
+
+    // Maps the ids of one collection in a LOD document to their ids in the merged document. Ids are resolved to
+    // integers without allocating, and the merged ids are formatted once per element rather than once per reference.
+    // An element can also be mapped onto one already in the merged document, or dropped, in which case it is not appended.
+    class IdTable
+    {
+    public:
+        // The merged index of an element that is dropped, which nothing in the merged document may reference
+        static constexpr size_t DROPPED = std::numeric_limits<size_t>::max();
+
+        IdTable(size_t offset, size_t count)
+        {
+            m_indices.reserve(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                m_indices.push_back(offset + i);
+            }
+
+            m_skipped.assign(count, false);
+            FormatIds();
+        }
+
+        IdTable(std::vector<size_t> mergedIndices, std::vector<bool> skipped) :
+            m_indices(std::move(mergedIndices)),
+            m_skipped(std::move(skipped))
+        {
+            FormatIds();
+        }
+
+        void Remap(std::string& id) const
+        {
+            // an empty id string indicates that the id is not inuse and therefore should not be updated
+            if (!id.empty())
+            {
+                const auto& mergedId = m_ids[ParseIndex(id)];
+                if (mergedId.empty())
+                {
+                    throw GLTFException("LOD element " + id + " was dropped but is still referenced");
+                }
+
+                id = mergedId;
+            }
+        }
+
+        size_t GetMergedIndex(uint64_t index) const
+        {
+            return m_indices[CheckIndex(index)];
+        }
+
+        // Whether the element is not appended, because it reuses one that is already in the merged document or is dropped
+        bool IsSkipped(const std::string& id) const
+        {
+            return m_skipped[ParseIndex(id)];
+        }
+
+    private:
+        void FormatIds()
+        {
+            m_ids.reserve(m_indices.size());
+            for (auto index : m_indices)
+            {
+                m_ids.push_back(index == DROPPED ? std::string() : std::to_string(index));
+            }
+        }
+
+        size_t CheckIndex(uint64_t index) const
+        {
+            if (index >= m_indices.size())
+            {
+                throw GLTFException("LOD index " + std::to_string(index) + " is out of range");
+            }
+
+            return static_cast<size_t>(index);
+        }
+
+        size_t ParseIndex(const std::string& id) const
+        {
+            uint64_t index = 0;
+            for (char c : id)
+            {
+                if (c < '0' || c > '9')
+                {
+                    throw GLTFException("LOD merge requires index ids, found " + id);
+                }
+
+                index = index * 10 + static_cast<uint64_t>(c - '0');
+            }
+
+            return CheckIndex(index);
+        }
+
+        std::vector<size_t> m_indices;
+        std::vector<bool> m_skipped;
+        std::vector<std::string> m_ids;
+    };
+
+    // The id tables for every collection of one LOD document
+    struct LODIdTables
+    {
+        LODIdTables(const GLTFDocument& lod, const LODOffsets& offsets) :
+            buffers(offsets.buffers, lod.buffers.Size()),
+            samplers(offsets.samplers, lod.samplers.Size()),
+            bufferViews(offsets.bufferViews, lod.bufferViews.Size()),
+            accessors(offsets.accessors, lod.accessors.Size()),
+            images(offsets.images, lod.images.Size()),
+            textures(offsets.textures, lod.textures.Size()),
+            materials(offsets.materials, lod.materials.Size()),
+            meshes(offsets.meshes, lod.meshes.Size()),
+            nodes(offsets.nodes, lod.nodes.Size())
+        { }
+
+        IdTable buffers;
+        IdTable samplers;
+        IdTable bufferViews;
+        IdTable accessors;
+        IdTable images;
+        IdTable textures;
+        IdTable materials;
+        IdTable meshes;
+        IdTable nodes;
+    };
+
+    void RemapExtensionIndices(std::string& json, const JsonMemberPaths& paths, const IdTable& table)
+    {
+        GLTFExtensionUtils::RemapIndices(json, paths, [&table](size_t index) { return table.GetMergedIndex(index); });
+    }
+
+    const JsonMemberPaths MSFT_TEXTURE_DDS_INDEX_PATHS = { { "source" } };
+    const JsonMemberPaths MSFT_PACKING_ORM_INDEX_PATHS =
+    {
+        { "occlusionRoughnessMetallicTexture", "index" },
+        { "roughnessMetallicOcclusionTexture", "index" },
+        { "normalTexture", "index" }
+    };
+    const JsonMemberPaths MSFT_LOD_INDEX_PATHS = { { Toolkit::MSFT_LOD_IDS_KEY, "[]" } };
+
+    void RemapTextureReferences(Texture& texture, const LODIdTables& ids)
+    {
+        ids.samplers.Remap(texture.samplerId);
+        ids.images.Remap(texture.imageId);
+
+        // MSFT_texture_dds extension
+        auto ddsExtensionIt = texture.extensions.find(EXTENSION_MSFT_TEXTURE_DDS);
+        if (ddsExtensionIt != texture.extensions.end() && !ddsExtensionIt->second.empty())
+        {
+            RemapExtensionIndices(ddsExtensionIt->second, MSFT_TEXTURE_DDS_INDEX_PATHS, ids.images);
+        }
+    }
+
+    // Remaps every accessor a primitive can reference, including its morph targets
+    void RemapPrimitiveReferences(MeshPrimitive& primitive, const LODIdTables& ids)
+    {
+        for (auto accessorId : {
+            &primitive.positionsAccessorId, &primitive.normalsAccessorId, &primitive.tangentsAccessorId,
+            &primitive.uv0AccessorId, &primitive.uv1AccessorId, &primitive.color0AccessorId,
+            &primitive.joints0AccessorId, &primitive.weights0AccessorId, &primitive.indicesAccessorId })
+        {
+            ids.accessors.Remap(*accessorId);
+        }
+
+        for (auto& target : primitive.targets)
+        {
+            ids.accessors.Remap(target.positionsAccessorId);
+            ids.accessors.Remap(target.normalsAccessorId);
+            ids.accessors.Remap(target.tangentsAccessorId);
+        }
+
+        ids.materials.Remap(primitive.materialId);
+    }
+
+    // Extensions are stored unordered, so they are sorted to compare them
+    std::string GetExtensionsKey(const Texture& texture)
+    {
+        std::map<std::string, std::string> extensions(texture.extensions.begin(), texture.extensions.end());
+
+        std::string key;
+        for (const auto& extension : extensions)
+        {
+            key += extension.first + "=" + extension.second + ";";
+        }
+
+        return key;
+    }
+
+    std::string GetTextureKey(const Texture& texture)
+    {
+        return texture.imageId + "|" + texture.samplerId + "|" + GetExtensionsKey(texture) + "|" + texture.extras;
     }
 
-    inline void AddIndexOffsetPacked(rapidjson::Value& json, const char* textureId, size_t offset)
+    std::string GetSamplerKey(const Sampler& sampler)
     {
-        if (json.HasMember(textureId))
+        return std::to_string(static_cast<int>(sampler.magFilter)) + "|" + std::to_string(static_cast<int>(sampler.minFilter)) + "|" +
+            std::to_string(static_cast<int>(sampler.wrapS)) + "|" + std::to_string(static_cast<int>(sampler.wrapT)) + "|" + sampler.extras;
+    }
+
+    std::string GetImageKey(const GLTFDocument& doc, const Image& image, const IStreamReader& streamReader)
+    {
+        GLTFResourceReader reader(streamReader);
+        auto data = reader.ReadBinaryData(doc, image);
+
+        return HashUtils::ComputeSHA256(data.data(), data.size()) + "|" + image.mimeType;
+    }
+
+    // Tracks the images, samplers and textures of the merged document, so that identical ones in later LODs can
+    // point to them instead of being appended again. Images are compared by the hash of their contents.
+    class SharedResources
+    {
+    public:
+        SharedResources(const GLTFDocument& primary, const IStreamReader& primaryReader)
         {
-            if (json[textureId].HasMember("index"))
+            for (const auto& image : primary.images.Elements())
             {
-                auto index = json[textureId]["index"].GetInt();
-                json[textureId]["index"] = index + offset;
+                m_images.emplace(GetImageKey(primary, image, primaryReader), primary.images.GetIndex(image.id));
+            }
+
+            for (const auto& sampler : primary.samplers.Elements())
+            {
+                m_samplers.emplace(GetSamplerKey(sampler), primary.samplers.GetIndex(sampler.id));
+            }
+
+            for (const auto& texture : primary.textures.Elements())
+            {
+                m_textures.emplace(GetTextureKey(texture), primary.textures.GetIndex(texture.id));
             }
         }
-    }
+
+        // Replaces the image, sampler and texture tables with ones that reuse existing elements where possible, and the
+        // buffer view table with one that drops the buffer views of reused images. Textures are compared after their own
+        // references have been remapped.
+        void MapLOD(const GLTFDocument& lod, const IStreamReader& lodReader, const LODOffsets& offsets, LODIdTables& ids)
+        {
+            ids.images = MapCollection(lod.images.Elements(), offsets.images, m_images, [&](const Image& image)
+            {
+                return GetImageKey(lod, image, lodReader);
+            });
+
+            ids.bufferViews = MapBufferViews(lod, offsets.bufferViews, ids.images);
+
+            ids.samplers = MapCollection(lod.samplers.Elements(), offsets.samplers, m_samplers, GetSamplerKey);
+
+            ids.textures = MapCollection(lod.textures.Elements(), offsets.textures, m_textures, [&](Texture texture)
+            {
+                RemapTextureReferences(texture, ids);
+                return GetTextureKey(texture);
+            });
+        }
+
+    private:
+        typedef std::unordered_map<std::string, size_t> IndexByKey;
+
+        // Drops the buffer views that are only referenced by images which are not appended
+        static IdTable MapBufferViews(const GLTFDocument& lod, size_t offset, const IdTable& images)
+        {
+            std::unordered_set<std::string> dropped;
+            for (const auto& image : lod.images.Elements())
+            {
+                if (!image.bufferViewId.empty() && images.IsSkipped(image.id))
+                {
+                    dropped.insert(image.bufferViewId);
+                }
+            }
+
+            for (const auto& image : lod.images.Elements())
+            {
+                if (!images.IsSkipped(image.id))
+                {
+                    dropped.erase(image.bufferViewId);
+                }
+            }
+
+            for (const auto& accessor : lod.accessors.Elements())
+            {
+                dropped.erase(accessor.bufferViewId);
+            }
+
+            std::vector<size_t> mergedIndices;
+            std::vector<bool> skipped;
+            mergedIndices.reserve(lod.bufferViews.Size());
+            skipped.reserve(lod.bufferViews.Size());
+
+            size_t next = offset;
+            for (const auto& bufferView : lod.bufferViews.Elements())
+            {
+                const bool isDropped = dropped.count(bufferView.id) > 0;
+                mergedIndices.push_back(isDropped ? IdTable::DROPPED : next++);
+                skipped.push_back(isDropped);
+            }
+
+            return IdTable(std::move(mergedIndices), std::move(skipped));
+        }
+
+        template <typename T, typename GetKey>
+        static IdTable MapCollection(const std::vector<T>& elements, size_t offset, IndexByKey& indexByKey, GetKey getKey)
+        {
+            std::vector<size_t> mergedIndices;
+            std::vector<bool> skipped;
+            mergedIndices.reserve(elements.size());
+            skipped.reserve(elements.size());
+
+            size_t next = offset;
+            for (const auto& element : elements)
+            {
+                auto inserted = indexByKey.emplace(getKey(element), next);
+                mergedIndices.push_back(inserted.first->second);
+                skipped.push_back(!inserted.second);
+
+                if (inserted.second)
+                {
+                    next++;
+                }
+            }
+
+            return IdTable(std::move(mergedIndices), std::move(skipped));
+        }
+
+        IndexByKey m_images;
+        IndexByKey m_samplers;
+        IndexByKey m_textures;
+    };
 
     std::vector<std::string> ParseExtensionMSFTLod(const Node& node)
     {
@@ -50,15 +373,12 @@ namespace
         auto lodExtension = node.extensions.find(Toolkit::EXTENSION_MSFT_LOD);
         if (lodExtension != node.extensions.end())
         {
-            auto json = RapidJsonUtils::CreateDocumentFromString(lodExtension->second);
+            auto indices = GLTFExtensionUtils::ReadIndices(lodExtension->second, MSFT_LOD_INDEX_PATHS);
 
-            auto idIt = json.FindMember(Toolkit::MSFT_LOD_IDS_KEY);
-            if (idIt != json.MemberEnd())
+            lodIds.reserve(indices[0].size());
+            for (auto index : indices[0])
             {
-                for (rapidjson::Value::ConstValueIterator ait = idIt->value.Begin(); ait != idIt->value.End(); ++ait)
-                {
-                    lodIds.push_back(std::to_string(ait->GetInt()));
-                }
+                lodIds.push_back(std::to_string(index));
             }
         }
 
@@ -108,246 +428,223 @@ namespace
         return stringBuffer.GetString();
     }
 
-    GLTFDocument AddGLTFNodeLOD(const GLTFDocument& primary, LODMap& primaryLods, const GLTFDocument& lod)
+    // Both GLTF must have equivalent number and order of scenes and root nodes per scene otherwise merge will not be possible
+    void ValidateLODScenes(const GLTFDocument& primary, const GLTFDocument& lod)
     {
-        Microsoft::glTF::GLTFDocument gltfLod(primary);
-
-        auto primaryScenes = primary.scenes.Elements();
-        auto lodScenes = lod.scenes.Elements();
+        const auto& primaryScenes = primary.scenes.Elements();
+        const auto& lodScenes = lod.scenes.Elements();
 
-        size_t MaxLODLevel = 0;
-
-        // Both GLTF must have equivalent number and order of scenes and root nodes per scene otherwise merge will not be possible
-        bool sceneNodeMatch = false;
-        if (primaryScenes.size() == lodScenes.size())
+        bool sceneNodeMatch = !primaryScenes.empty() && primaryScenes.size() == lodScenes.size();
+        for (size_t sceneIdx = 0; sceneNodeMatch && sceneIdx < primaryScenes.size(); sceneIdx++)
         {
-            for (size_t sceneIdx = 0; sceneIdx < primaryScenes.size(); sceneIdx++)
-            {
+            sceneNodeMatch = (primaryScenes[sceneIdx].nodes.size() == lodScenes[sceneIdx].nodes.size()) &&
+                (lodScenes[sceneIdx].nodes.size() == 1 ||
+                    std::equal(primaryScenes[sceneIdx].nodes.begin(), primaryScenes[sceneIdx].nodes.end(), lodScenes[sceneIdx].nodes.begin()));
+        }
 
-                if ((primaryScenes[sceneIdx].nodes.size() == lodScenes[sceneIdx].nodes.size()) &&
-                    (lodScenes[sceneIdx].nodes.size() == 1 ||
-                        std::equal(primaryScenes[sceneIdx].nodes.begin(), primaryScenes[sceneIdx].nodes.end(), lodScenes[sceneIdx].nodes.begin()))
-                    )
-                {
-                    sceneNodeMatch = true;
-                    auto primaryRootNode = gltfLod.nodes.Get(primaryScenes[sceneIdx].nodes[0]);
-                    MaxLODLevel = std::max(MaxLODLevel, primaryLods.at(primaryRootNode.id)->size());
-                }
-                else
-                {
-                    sceneNodeMatch = false;
-                    break;
-                }
-            }
+        if (!sceneNodeMatch)
+        {
+            // Mis-match or empty scene; either way cannot merge Lod in
+            throw std::runtime_error("Primary Scene either empty or does not match scene node count of LOD gltf");
         }
+    }
 
-        MaxLODLevel++;
+    // Computes where every LOD will be appended, so that all of them can be merged in a single pass
+    std::vector<LODOffsets> ComputeLODOffsets(const std::vector<GLTFDocument>& docs)
+    {
+        std::vector<LODOffsets> offsets;
+        offsets.reserve(docs.size());
 
-        if (!sceneNodeMatch || primaryScenes.empty())
+        LODOffsets next = {};
+        for (const auto& doc : docs)
         {
-            // Mis-match or empty scene; either way cannot merge Lod in
-            throw new std::runtime_error("Primary Scene either empty or does not match scene node count of LOD gltf");
+            offsets.push_back(next);
+
+            next.buffers += doc.buffers.Size();
+            next.samplers += doc.samplers.Size();
+            next.bufferViews += doc.bufferViews.Size();
+            next.accessors += doc.accessors.Size();
+            next.images += doc.images.Size();
+            next.textures += doc.textures.Size();
+            next.materials += doc.materials.Size();
+            next.meshes += doc.meshes.Size();
+            next.nodes += doc.nodes.Size();
         }
 
-        std::string nodeLodLabel = "_lod" + std::to_string(MaxLODLevel);
+        return offsets;
+    }
+
+    // The offsets at which a LOD starts when appended to the merged document as it currently is
+    LODOffsets GetMergedSizes(const GLTFDocument& merged)
+    {
+        LODOffsets offsets;
+        offsets.buffers = merged.buffers.Size();
+        offsets.samplers = merged.samplers.Size();
+        offsets.bufferViews = merged.bufferViews.Size();
+        offsets.accessors = merged.accessors.Size();
+        offsets.images = merged.images.Size();
+        offsets.textures = merged.textures.Size();
+        offsets.materials = merged.materials.Size();
+        offsets.meshes = merged.meshes.Size();
+        offsets.nodes = merged.nodes.Size();
+        return offsets;
+    }
+
+    // Appends the contents of the lod document to the merged document, at the given offsets, and records the
+    // new LOD root nodes in primaryLods
+    void AddGLTFNodeLOD(GLTFDocument& gltfLod, LODMap& primaryLods, const GLTFDocument& lod, const LODIdTables& ids, size_t lodLevel)
+    {
+        std::string nodeLodLabel = "_lod" + std::to_string(lodLevel);
 
         // lod merge is performed from the lowest reference back upwards
         // e.g. buffers/samplers/extensions do not reference any other part of the gltf manifest    
-        size_t buffersOffset = gltfLod.buffers.Size();
-        size_t samplersOffset = gltfLod.samplers.Size();
+        for (Buffer buffer : lod.buffers.Elements())
         {
-            auto lodBuffers = lod.buffers.Elements();
-            for (auto buffer : lodBuffers)
-            {
-                AddIndexOffset(buffer.id, buffersOffset);
-                gltfLod.buffers.Append(std::move(buffer));
-            }
+            ids.buffers.Remap(buffer.id);
+            gltfLod.buffers.Append(std::move(buffer));
+        }
 
-            auto lodSamplers = lod.samplers.Elements();
-            for (auto sampler : lodSamplers)
+        for (Sampler sampler : lod.samplers.Elements())
+        {
+            if (ids.samplers.IsSkipped(sampler.id))
             {
-                AddIndexOffset(sampler.id, samplersOffset);
-                gltfLod.samplers.Append(std::move(sampler));
+                continue;
             }
 
-            for (const auto& extension : lod.extensionsUsed)
-            {
-                gltfLod.extensionsUsed.insert(extension);
-            }
-            // ensure that MSFT_LOD extension is specified as being used
-            gltfLod.extensionsUsed.insert(Toolkit::EXTENSION_MSFT_LOD);
+            ids.samplers.Remap(sampler.id);
+            gltfLod.samplers.Append(std::move(sampler));
         }
 
-        size_t accessorOffset = gltfLod.accessors.Size();
-        size_t texturesOffset = gltfLod.textures.Size();
+        for (const auto& extension : lod.extensionsUsed)
         {
-            // Buffer Views depend upon Buffers
-            size_t bufferViewsOffset = gltfLod.bufferViews.Size();
-            auto lodBufferViews = lod.bufferViews.Elements();
-            for (auto bufferView : lodBufferViews)
-            {
-                AddIndexOffset(bufferView.id, bufferViewsOffset);
-                AddIndexOffset(bufferView.bufferId, buffersOffset);
-                gltfLod.bufferViews.Append(std::move(bufferView));
-            }
+            gltfLod.extensionsUsed.insert(extension);
+        }
 
-            // Accessors depend upon Buffer views        
-            auto lodAccessors = lod.accessors.Elements();
-            for (auto accessor : lodAccessors)
+        // Buffer Views depend upon Buffers
+        for (BufferView bufferView : lod.bufferViews.Elements())
+        {
+            if (ids.bufferViews.IsSkipped(bufferView.id))
             {
-                AddIndexOffset(accessor.id, accessorOffset);
-                AddIndexOffset(accessor.bufferViewId, bufferViewsOffset);
-                gltfLod.accessors.Append(std::move(accessor));
+                continue;
             }
 
-            // Images depend upon Buffer views
-            size_t imageOffset = gltfLod.images.Size();
-            auto lodImages = lod.images.Elements();
-            for (auto image : lodImages)
-            {
-                AddIndexOffset(image.id, imageOffset);
-                AddIndexOffset(image.bufferViewId, bufferViewsOffset);
-                gltfLod.images.Append(std::move(image));
-            }
+            ids.bufferViews.Remap(bufferView.id);
+            ids.buffers.Remap(bufferView.bufferId);
+            gltfLod.bufferViews.Append(std::move(bufferView));
+        }
 
-            // Textures depend upon Samplers and Images
-            auto lodTextures = lod.textures.Elements();
-            for (auto texture : lodTextures)
-            {
-                AddIndexOffset(texture.id, texturesOffset);
-                AddIndexOffset(texture.samplerId, samplersOffset);
-                AddIndexOffset(texture.imageId, imageOffset);
+        // Accessors depend upon Buffer views        
+        for (Accessor accessor : lod.accessors.Elements())
+        {
+            ids.accessors.Remap(accessor.id);
+            ids.bufferViews.Remap(accessor.bufferViewId);
+            gltfLod.accessors.Append(std::move(accessor));
+        }
 
-                // MSFT_texture_dds extension
-                auto ddsExtensionIt = texture.extensions.find(EXTENSION_MSFT_TEXTURE_DDS);
-                if (ddsExtensionIt != texture.extensions.end() && !ddsExtensionIt->second.empty())
-                {
-                    rapidjson::Document ddsJson = RapidJsonUtils::CreateDocumentFromString(ddsExtensionIt->second);
+        // Images depend upon Buffer views
+        for (Image image : lod.images.Elements())
+        {
+            if (ids.images.IsSkipped(image.id))
+            {
+                continue;
+            }
 
-                    if (ddsJson.HasMember("source"))
-                    {
-                        auto index = ddsJson["source"].GetInt();
-                        ddsJson["source"] = index + imageOffset;
-                    }
+            ids.images.Remap(image.id);
+            ids.bufferViews.Remap(image.bufferViewId);
+            gltfLod.images.Append(std::move(image));
+        }
 
-                    rapidjson::StringBuffer buffer;
-                    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-                    ddsJson.Accept(writer);
+        // Textures depend upon Samplers and Images
+        for (Texture texture : lod.textures.Elements())
+        {
+            if (ids.textures.IsSkipped(texture.id))
+            {
+                continue;
+            }
 
-                    ddsExtensionIt->second = buffer.GetString();
-                }
+            ids.textures.Remap(texture.id);
+            RemapTextureReferences(texture, ids);
 
-                gltfLod.textures.Append(std::move(texture));
-            }
+            gltfLod.textures.Append(std::move(texture));
         }
 
         // Material Merge
         // Note the extension KHR_materials_pbrSpecularGlossiness will be also updated
         // Materials depend upon textures
-        size_t materialOffset = gltfLod.materials.Size();
+        for (Material material : lod.materials.Elements())
         {
-            auto lodMaterials = lod.materials.Elements();
-            for (auto material : lodMaterials)
-            {
-                // post-fix with lod level indication; 
-                // no functional reason other than making it easier to natively read gltf files with lods
-                material.name += nodeLodLabel;
-                AddIndexOffset(material.id, materialOffset);
-
-                AddIndexOffset(material.normalTexture.id, texturesOffset);
-                AddIndexOffset(material.occlusionTexture.id, texturesOffset);
-                AddIndexOffset(material.emissiveTextureId, texturesOffset);
+            // post-fix with lod level indication; 
+            // no functional reason other than making it easier to natively read gltf files with lods
+            material.name += nodeLodLabel;
+            ids.materials.Remap(material.id);
 
-                AddIndexOffset(material.metallicRoughness.baseColorTextureId, texturesOffset);
-                AddIndexOffset(material.metallicRoughness.metallicRoughnessTextureId, texturesOffset);
+            ids.textures.Remap(material.normalTexture.id);
+            ids.textures.Remap(material.occlusionTexture.id);
+            ids.textures.Remap(material.emissiveTextureId);
 
-                AddIndexOffset(material.specularGlossiness.diffuseTextureId, texturesOffset);
-                AddIndexOffset(material.specularGlossiness.specularGlossinessTextureId, texturesOffset);
+            ids.textures.Remap(material.metallicRoughness.baseColorTextureId);
+            ids.textures.Remap(material.metallicRoughness.metallicRoughnessTextureId);
 
-                // MSFT_packing_occlusionRoughnessMetallic packed textures
-                auto ormExtensionIt = material.extensions.find(EXTENSION_MSFT_PACKING_ORM);
-                if (ormExtensionIt != material.extensions.end() && !ormExtensionIt->second.empty())
-                {
-                    rapidjson::Document ormJson = RapidJsonUtils::CreateDocumentFromString(ormExtensionIt->second);
+            ids.textures.Remap(material.specularGlossiness.diffuseTextureId);
+            ids.textures.Remap(material.specularGlossiness.specularGlossinessTextureId);
 
-                    AddIndexOffsetPacked(ormJson, "occlusionRoughnessMetallicTexture", texturesOffset);
-                    AddIndexOffsetPacked(ormJson, "roughnessMetallicOcclusionTexture", texturesOffset);
-                    AddIndexOffsetPacked(ormJson, "normalTexture", texturesOffset);
-
-                    rapidjson::StringBuffer buffer;
-                    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-                    ormJson.Accept(writer);
-
-                    ormExtensionIt->second = buffer.GetString();
-                }
-
-                gltfLod.materials.Append(std::move(material));
+            // MSFT_packing_occlusionRoughnessMetallic packed textures
+            auto ormExtensionIt = material.extensions.find(EXTENSION_MSFT_PACKING_ORM);
+            if (ormExtensionIt != material.extensions.end() && !ormExtensionIt->second.empty())
+            {
+                RemapExtensionIndices(ormExtensionIt->second, MSFT_PACKING_ORM_INDEX_PATHS, ids.textures);
             }
+
+            gltfLod.materials.Append(std::move(material));
         }
 
         // Meshs depend upon Accessors and Materials
-        size_t meshOffset = gltfLod.meshes.Size();
+        for (Mesh mesh : lod.meshes.Elements())
         {
-            auto lodMeshes = lod.meshes.Elements();
-            for (auto mesh : lodMeshes)
-            {
-                // post-fix with lod level indication; 
-                // no functional reason other than making it easier to natively read gltf files with lods
-                mesh.name += nodeLodLabel;
-                AddIndexOffset(mesh.id, meshOffset);
+            // post-fix with lod level indication; 
+            // no functional reason other than making it easier to natively read gltf files with lods
+            mesh.name += nodeLodLabel;
+            ids.meshes.Remap(mesh.id);
 
-                for (auto Itr = mesh.primitives.begin(); Itr != mesh.primitives.end(); Itr++)
-                {
-                    AddIndexOffset(Itr->positionsAccessorId, accessorOffset);
-                    AddIndexOffset(Itr->normalsAccessorId, accessorOffset);
-                    AddIndexOffset(Itr->indicesAccessorId, accessorOffset);
-                    AddIndexOffset(Itr->uv0AccessorId, accessorOffset);
-                    AddIndexOffset(Itr->uv1AccessorId, accessorOffset);
-                    AddIndexOffset(Itr->color0AccessorId, accessorOffset);
-
-                    AddIndexOffset(Itr->materialId, materialOffset);
-                }
-
-                gltfLod.meshes.Append(std::move(mesh));
+            for (auto& primitive : mesh.primitives)
+            {
+                RemapPrimitiveReferences(primitive, ids);
             }
+
+            gltfLod.meshes.Append(std::move(mesh));
         }
 
         // Nodes depend upon Nodes and Meshes
-        size_t nodeOffset = gltfLod.nodes.Size();
+        for (Node node : lod.nodes.Elements())
         {
-            auto nodes = lod.nodes.Elements();
-            for (auto node : nodes)
-            {
-                // post-fix with lod level indication; 
-                // no functional reason other than making it easier to natively read gltf files with lods
-                node.name += nodeLodLabel;
-                AddIndexOffset(node.id, nodeOffset);
-                AddIndexOffset(node.meshId, meshOffset);
+            // post-fix with lod level indication; 
+            // no functional reason other than making it easier to natively read gltf files with lods
+            node.name += nodeLodLabel;
+            ids.nodes.Remap(node.id);
+            ids.meshes.Remap(node.meshId);
 
-                for (auto Itr = node.children.begin(); Itr != node.children.end(); Itr++)
-                {
-                    AddIndexOffset(*Itr, nodeOffset);
-                }
+            for (auto Itr = node.children.begin(); Itr != node.children.end(); Itr++)
+            {
+                ids.nodes.Remap(*Itr);
+            }
 
-                gltfLod.nodes.Append(std::move(node));
-            };
+            gltfLod.nodes.Append(std::move(node));
         }
 
         // update the primary GLTF root nodes lod extension to reference the new lod root node
         // N.B. new lods are always added to the back
+        const auto& primaryScenes = gltfLod.scenes.Elements();
+        const auto& lodScenes = lod.scenes.Elements();
         for (size_t sceneIdx = 0; sceneIdx < primaryScenes.size(); sceneIdx++)
         {
             for (size_t rootNodeIdx = 0; rootNodeIdx < primaryScenes[sceneIdx].nodes.size(); rootNodeIdx++)
             {
-                auto idx = primaryScenes[sceneIdx].nodes[rootNodeIdx];
-                Node nodeWithLods(gltfLod.nodes.Get(idx));
-                int lodRootIdx = std::stoi(lodScenes[sceneIdx].nodes[rootNodeIdx]) + static_cast<int>(nodeOffset);
-                auto primaryNodeLod = primaryLods.at(nodeWithLods.id);
-                primaryNodeLod->emplace_back(std::to_string(lodRootIdx));
+                const auto& rootNodeId = primaryScenes[sceneIdx].nodes[rootNodeIdx];
+                auto lodRootId = lodScenes[sceneIdx].nodes[rootNodeIdx];
+                ids.nodes.Remap(lodRootId);
+                primaryLods.at(rootNodeId)->emplace_back(std::move(lodRootId));
             }
         }
-
-        return gltfLod;
     }
 }
 
@@ -355,9 +652,11 @@ LODMap GLTFLODUtils::ParseDocumentNodeLODs(const GLTFDocument& doc)
 {
     LODMap lodMap;
 
-    for (auto node : doc.nodes.Elements())
+    lodMap.reserve(doc.nodes.Size());
+
+    for (const auto& node : doc.nodes.Elements())
     {
-        lodMap.emplace(node.id, std::move(std::make_shared<std::vector<std::string>>(ParseExtensionMSFTLod(node))));
+        lodMap.emplace(node.id, std::make_shared<std::vector<std::string>>(ParseExtensionMSFTLod(node)));
     }
 
     return lodMap;
@@ -365,17 +664,74 @@ LODMap GLTFLODUtils::ParseDocumentNodeLODs(const GLTFDocument& doc)
 
 GLTFDocument GLTFLODUtils::MergeDocumentsAsLODs(const std::vector<GLTFDocument>& docs)
 {
+    return MergeDocumentsAsLODs(docs, std::vector<double>());
+}
+
+GLTFDocument GLTFLODUtils::MergeDocumentsAsLODs(const std::vector<GLTFDocument>& docs, const std::vector<double>& screenCoveragePercentages)
+{
+    return MergeDocumentsAsLODs(docs, screenCoveragePercentages, std::vector<std::shared_ptr<IStreamReader>>());
+}
+
+GLTFDocument GLTFLODUtils::MergeDocumentsAsLODs(const std::vector<GLTFDocument>& docs, const std::vector<double>& screenCoveragePercentages, const std::vector<std::shared_ptr<IStreamReader>>& streamReaders)
+{
+    Instrumentation::Stage stage("MergeDocumentsAsLODs");
+    stage.SetProperty("documents", std::to_string(docs.size()));
+
     if (docs.empty())
     {
         throw std::invalid_argument("MergeDocumentsAsLODs passed empty vector");
     }
 
+    if (!streamReaders.empty() && streamReaders.size() != docs.size())
+    {
+        throw std::invalid_argument("MergeDocumentsAsLODs requires one stream reader per document");
+    }
+
+    // Check every LOD before merging any of them
+    for (size_t i = 1; i < docs.size(); i++)
+    {
+        ValidateLODScenes(docs[0], docs[i]);
+    }
+
     GLTFDocument gltfPrimary(docs[0]);
     LODMap lods = ParseDocumentNodeLODs(gltfPrimary);
 
-    for (size_t i = 1; i < docs.size(); i++)
+    if (docs.size() > 1)
     {
-        gltfPrimary = AddGLTFNodeLOD(gltfPrimary, lods, docs[i]);
+        // LODs are numbered after the ones the primary root nodes may already have
+        size_t existingLODLevels = 0;
+        for (const auto& scene : gltfPrimary.scenes.Elements())
+        {
+            if (!scene.nodes.empty())
+            {
+                existingLODLevels = std::max(existingLODLevels, lods.at(scene.nodes[0])->size());
+            }
+        }
+
+        // ensure that MSFT_LOD extension is specified as being used
+        gltfPrimary.extensionsUsed.insert(Toolkit::EXTENSION_MSFT_LOD);
+
+        if (streamReaders.empty())
+        {
+            auto offsets = ComputeLODOffsets(docs);
+            for (size_t i = 1; i < docs.size(); i++)
+            {
+                AddGLTFNodeLOD(gltfPrimary, lods, docs[i], LODIdTables(docs[i], offsets[i]), existingLODLevels + i);
+            }
+        }
+        else
+        {
+            // LODs that share resources with earlier ones add fewer elements, so each LOD starts where the merged document ends
+            SharedResources shared(docs[0], *streamReaders[0]);
+            for (size_t i = 1; i < docs.size(); i++)
+            {
+                auto offsets = GetMergedSizes(gltfPrimary);
+                LODIdTables ids(docs[i], offsets);
+                shared.MapLOD(docs[i], *streamReaders[i], offsets, ids);
+
+                AddGLTFNodeLOD(gltfPrimary, lods, docs[i], ids, existingLODLevels + i);
+            }
+        }
     }
 
     for (auto lod : lods)
@@ -390,28 +746,21 @@ GLTFDocument GLTFLODUtils::MergeDocumentsAsLODs(const std::vector<GLTFDocument>&
         auto lodExtensionValue = SerializeExtensionMSFTLod<Node>(node, *lod.second, gltfPrimary);
         if (!lodExtensionValue.empty())
         {
-            node.extensions.emplace(EXTENSION_MSFT_LOD, lodExtensionValue);
+            node.extensions[EXTENSION_MSFT_LOD] = lodExtensionValue;
             gltfPrimary.nodes.Replace(node);
         }
     }
 
-    return gltfPrimary;
-}
-
-GLTFDocument GLTFLODUtils::MergeDocumentsAsLODs(const std::vector<GLTFDocument>& docs, const std::vector<double>& screenCoveragePercentages)
-{
-    GLTFDocument merged = MergeDocumentsAsLODs(docs);
-
     if (screenCoveragePercentages.size() == 0)
     {
-        return merged;
+        return gltfPrimary;
     }
 
-    for (auto scene : merged.scenes.Elements())
+    for (auto scene : gltfPrimary.scenes.Elements())
     {
         for (auto rootNodeIndex : scene.nodes)
         {
-            auto primaryRootNode = merged.nodes.Get(rootNodeIndex);
+            auto primaryRootNode = gltfPrimary.nodes.Get(rootNodeIndex);
 
             rapidjson::Document extrasJson(rapidjson::kObjectType);
             if (!primaryRootNode.extras.empty())
@@ -430,11 +779,11 @@ GLTFDocument GLTFLODUtils::MergeDocumentsAsLODs(const std::vector<GLTFDocument>&
 
             primaryRootNode.extras = buffer.GetString();
 
-            merged.nodes.Replace(primaryRootNode);
+            gltfPrimary.nodes.Replace(primaryRootNode);
         }
     }
 
-    return merged;
+    return gltfPrimary;
 }
 
 uint32_t GLTFLODUtils::NumberOfNodeLODLevels(const GLTFDocument& doc, const LODMap& lods)
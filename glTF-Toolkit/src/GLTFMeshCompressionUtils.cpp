@@ -0,0 +1,916 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "GLTFMeshCompressionUtils.h"
+
+#include <GLTFSDK/GLTF.h>
+
+#include <cstring>
+#include <limits>
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+const char* Microsoft::glTF::Toolkit::EXTENSION_EXT_MESHOPT_COMPRESSION = "EXT_meshopt_compression";
+
+namespace
+{
+    const uint8_t ATTRIBUTES_HEADER = 0xa0;
+    const uint8_t TRIANGLES_HEADER = 0xe1;
+    const uint8_t INDICES_HEADER = 0xd1;
+
+    const size_t VERTEX_BLOCK_SIZE_BYTES = 8192;
+    const size_t VERTEX_BLOCK_MAX_SIZE = 256;
+    const size_t VERTEX_MAX_SIZE = 256;
+    const size_t VERTEX_TAIL_MIN_SIZE = 32;
+    const size_t BYTE_GROUP_SIZE = 16;
+
+    // The number of bits used for each value of a group of bytes, by the 2-bit code of the group in its block header:
+    // the group is all zeros, packs 2 or 4 bits per value with larger values stored after it, or is stored as is
+    const size_t GROUP_BITS[] = { 0, 2, 4, 8 };
+
+    const size_t FIFO_SIZE = 16;
+    const size_t EDGE_FIFO_CODES = 15; // Code 15 is a triangle whose edges are all new
+    const uint32_t VERTEX_FIFO_CODES = 13; // Codes 13 and 14 of the third vertex of a triangle are the last free index -1 and +1
+    const uint32_t FREE_INDEX_CODE = 15;
+    const size_t INDICES_TAIL_SIZE = 4;
+
+    // The rotations of a triangle, which keep its winding
+    const size_t TRIANGLE_ROTATIONS[3][3] = { { 0, 1, 2 }, { 1, 2, 0 }, { 2, 0, 1 } };
+
+    // Pairs of vertex codes common enough for triangles with new edges to be written as a single byte. The table is
+    // written at the end of the stream, where the decoder reads it, and where it also pads the stream.
+    const uint8_t CODEAUX_TABLE[FIFO_SIZE] = { 0x00, 0x76, 0x87, 0x56, 0x67, 0x78, 0xa9, 0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00 };
+    const size_t CODEAUX_TABLE_CODES = 14; // The two last codes mark a triangle whose vertex codes are written in a separate byte
+
+    size_t Align(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    void ThrowInvalidData()
+    {
+        throw GLTFException("Invalid EXT_meshopt_compression data");
+    }
+
+    // Reads a compressed stream, checking every read against its end
+    class StreamReader
+    {
+    public:
+        StreamReader(const uint8_t* data, size_t size) :
+            m_data(data),
+            m_position(0),
+            m_end(size)
+        { }
+
+        uint8_t ReadByte()
+        {
+            if (m_position >= m_end)
+            {
+                ThrowInvalidData();
+            }
+
+            return m_data[m_position++];
+        }
+
+        const uint8_t* Read(size_t size)
+        {
+            if (m_end - m_position < size)
+            {
+                ThrowInvalidData();
+            }
+
+            m_position += size;
+            return m_data + m_position - size;
+        }
+
+        // Reads a 32-bit value stored in groups of 7 bits, lowest first, the top bit of each byte telling whether another one follows
+        uint32_t ReadVByte()
+        {
+            uint32_t value = 0;
+            for (uint32_t shift = 0; shift < 35; shift += 7)
+            {
+                uint8_t byte = ReadByte();
+                value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return value;
+                }
+            }
+
+            ThrowInvalidData();
+            return value;
+        }
+
+        // Moves the end of the stream before its tail, which is read separately
+        void Truncate(size_t tailSize)
+        {
+            if (m_end - m_position < tailSize)
+            {
+                ThrowInvalidData();
+            }
+
+            m_end -= tailSize;
+        }
+
+        bool IsAtEnd() const
+        {
+            return m_position == m_end;
+        }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_position;
+        size_t m_end;
+    };
+
+    void WriteVByte(std::vector<uint8_t>& output, uint32_t value)
+    {
+        do
+        {
+            output.push_back(static_cast<uint8_t>((value & 0x7F) | (value > 0x7F ? 0x80 : 0)));
+            value >>= 7;
+        } while (value != 0);
+    }
+
+    // Signed differences are stored with their sign in the lowest bit, so that small negative ones stay small
+    uint8_t ZigZag(uint8_t delta)
+    {
+        return static_cast<uint8_t>((delta << 1) ^ (0 - (delta >> 7)));
+    }
+
+    uint8_t UnZigZag(uint8_t value)
+    {
+        return static_cast<uint8_t>((value >> 1) ^ (0 - (value & 1)));
+    }
+
+    uint32_t ZigZag(uint32_t delta)
+    {
+        return (delta << 1) ^ (0 - (delta >> 31));
+    }
+
+    uint32_t UnZigZag(uint32_t value)
+    {
+        return (value >> 1) ^ (0 - (value & 1));
+    }
+
+    // Attributes
+
+    size_t GetVertexBlockSize(size_t vertexSize)
+    {
+        return std::min((VERTEX_BLOCK_SIZE_BYTES / vertexSize) & ~(BYTE_GROUP_SIZE - 1), VERTEX_BLOCK_MAX_SIZE);
+    }
+
+    size_t MeasureGroup(const uint8_t* group, size_t bits)
+    {
+        if (bits == 0)
+        {
+            return std::all_of(group, group + BYTE_GROUP_SIZE, [](uint8_t value) { return value == 0; }) ? 0 : std::numeric_limits<size_t>::max();
+        }
+
+        if (bits == 8)
+        {
+            return BYTE_GROUP_SIZE;
+        }
+
+        const size_t sentinel = (size_t(1) << bits) - 1;
+
+        size_t size = BYTE_GROUP_SIZE * bits / 8;
+        for (size_t i = 0; i < BYTE_GROUP_SIZE; i++)
+        {
+            size += group[i] >= sentinel ? 1 : 0;
+        }
+
+        return size;
+    }
+
+    void EncodeGroup(std::vector<uint8_t>& output, const uint8_t* group, size_t bits)
+    {
+        if (bits == 0)
+        {
+            return;
+        }
+
+        if (bits == 8)
+        {
+            output.insert(output.end(), group, group + BYTE_GROUP_SIZE);
+            return;
+        }
+
+        // The values are packed first to last from the highest bits, and the ones that don't fit are marked with
+        // all bits set and stored in full after the packed bits
+        const size_t valuesPerByte = 8 / bits;
+        const uint8_t sentinel = static_cast<uint8_t>((1 << bits) - 1);
+
+        for (size_t i = 0; i < BYTE_GROUP_SIZE; i += valuesPerByte)
+        {
+            uint8_t byte = 0;
+            for (size_t k = 0; k < valuesPerByte; k++)
+            {
+                byte = static_cast<uint8_t>((byte << bits) | std::min(group[i + k], sentinel));
+            }
+
+            output.push_back(byte);
+        }
+
+        for (size_t i = 0; i < BYTE_GROUP_SIZE; i++)
+        {
+            if (group[i] >= sentinel)
+            {
+                output.push_back(group[i]);
+            }
+        }
+    }
+
+    void DecodeGroup(StreamReader& input, uint8_t* group, size_t bits)
+    {
+        if (bits == 0)
+        {
+            memset(group, 0, BYTE_GROUP_SIZE);
+            return;
+        }
+
+        if (bits == 8)
+        {
+            memcpy(group, input.Read(BYTE_GROUP_SIZE), BYTE_GROUP_SIZE);
+            return;
+        }
+
+        const size_t valuesPerByte = 8 / bits;
+        const uint8_t sentinel = static_cast<uint8_t>((1 << bits) - 1);
+        const uint8_t* packed = input.Read(BYTE_GROUP_SIZE / valuesPerByte);
+
+        for (size_t i = 0; i < BYTE_GROUP_SIZE; i++)
+        {
+            const size_t shift = 8 - bits * (i % valuesPerByte + 1);
+            const uint8_t value = static_cast<uint8_t>((packed[i / valuesPerByte] >> shift) & sentinel);
+            group[i] = value == sentinel ? input.ReadByte() : value;
+        }
+    }
+
+    // Writes a run of bytes as groups of 16, each with the fewest bits per value, after a header of their 2-bit codes
+    void EncodeBytes(std::vector<uint8_t>& output, const uint8_t* bytes, size_t count)
+    {
+        const size_t groupCount = count / BYTE_GROUP_SIZE;
+        const size_t headerOffset = output.size();
+        output.resize(output.size() + (groupCount + 3) / 4, 0);
+
+        for (size_t group = 0; group < groupCount; group++)
+        {
+            const uint8_t* groupBytes = bytes + group * BYTE_GROUP_SIZE;
+
+            size_t bestCode = 3;
+            size_t bestSize = BYTE_GROUP_SIZE;
+            for (size_t code = 0; code < 3; code++)
+            {
+                size_t size = MeasureGroup(groupBytes, GROUP_BITS[code]);
+                if (size < bestSize)
+                {
+                    bestCode = code;
+                    bestSize = size;
+                }
+            }
+
+            output[headerOffset + group / 4] |= static_cast<uint8_t>(bestCode << ((group % 4) * 2));
+            EncodeGroup(output, groupBytes, GROUP_BITS[bestCode]);
+        }
+    }
+
+    void DecodeBytes(StreamReader& input, uint8_t* bytes, size_t count)
+    {
+        const size_t groupCount = count / BYTE_GROUP_SIZE;
+        const uint8_t* header = input.Read((groupCount + 3) / 4);
+
+        for (size_t group = 0; group < groupCount; group++)
+        {
+            const size_t code = (header[group / 4] >> ((group % 4) * 2)) & 3;
+            DecodeGroup(input, bytes + group * BYTE_GROUP_SIZE, GROUP_BITS[code]);
+        }
+    }
+
+    // Vertices are compressed in blocks, one byte of the vertex at a time, as the differences from the same byte of
+    // the previous vertex. Attributes usually change slowly from one vertex to the next, so most differences are small.
+    std::vector<uint8_t> EncodeAttributes(const uint8_t* vertices, size_t vertexCount, size_t vertexSize)
+    {
+        std::vector<uint8_t> output;
+        output.reserve(1 + vertexCount * vertexSize / 2 + VERTEX_TAIL_MIN_SIZE + vertexSize);
+        output.push_back(ATTRIBUTES_HEADER);
+
+        std::vector<uint8_t> firstVertex(vertexSize, 0);
+        if (vertexCount > 0)
+        {
+            memcpy(firstVertex.data(), vertices, vertexSize);
+        }
+
+        std::vector<uint8_t> lastVertex(firstVertex);
+        std::vector<uint8_t> deltas(VERTEX_BLOCK_MAX_SIZE);
+
+        const size_t blockSize = GetVertexBlockSize(vertexSize);
+        for (size_t first = 0; first < vertexCount; first += blockSize)
+        {
+            const size_t count = std::min(blockSize, vertexCount - first);
+            const size_t alignedCount = Align(count, BYTE_GROUP_SIZE);
+            const uint8_t* block = vertices + first * vertexSize;
+
+            for (size_t k = 0; k < vertexSize; k++)
+            {
+                uint8_t previous = lastVertex[k];
+                for (size_t i = 0; i < count; i++)
+                {
+                    const uint8_t value = block[i * vertexSize + k];
+                    deltas[i] = ZigZag(static_cast<uint8_t>(value - previous));
+                    previous = value;
+                }
+
+                std::fill(deltas.begin() + count, deltas.begin() + alignedCount, deltas[count - 1]);
+                EncodeBytes(output, deltas.data(), alignedCount);
+            }
+
+            memcpy(lastVertex.data(), block + (count - 1) * vertexSize, vertexSize);
+        }
+
+        // The first vertex, which the first block is compressed from, ends the stream, padded to a minimum size
+        if (vertexSize < VERTEX_TAIL_MIN_SIZE)
+        {
+            output.resize(output.size() + VERTEX_TAIL_MIN_SIZE - vertexSize, 0);
+        }
+
+        output.insert(output.end(), firstVertex.begin(), firstVertex.end());
+        return output;
+    }
+
+    std::vector<uint8_t> DecodeAttributes(const uint8_t* data, size_t size, size_t vertexCount, size_t vertexSize)
+    {
+        StreamReader input(data, size);
+        if (input.ReadByte() != ATTRIBUTES_HEADER)
+        {
+            ThrowInvalidData();
+        }
+
+        input.Truncate(std::max(vertexSize, VERTEX_TAIL_MIN_SIZE));
+
+        std::vector<uint8_t> lastVertex(data + size - vertexSize, data + size);
+        std::vector<uint8_t> deltas(VERTEX_BLOCK_MAX_SIZE);
+        std::vector<uint8_t> vertices(vertexCount * vertexSize);
+
+        const size_t blockSize = GetVertexBlockSize(vertexSize);
+        for (size_t first = 0; first < vertexCount; first += blockSize)
+        {
+            const size_t count = std::min(blockSize, vertexCount - first);
+            uint8_t* block = vertices.data() + first * vertexSize;
+
+            for (size_t k = 0; k < vertexSize; k++)
+            {
+                DecodeBytes(input, deltas.data(), Align(count, BYTE_GROUP_SIZE));
+
+                uint8_t previous = lastVertex[k];
+                for (size_t i = 0; i < count; i++)
+                {
+                    previous = static_cast<uint8_t>(previous + UnZigZag(deltas[i]));
+                    block[i * vertexSize + k] = previous;
+                }
+            }
+
+            memcpy(lastVertex.data(), block + (count - 1) * vertexSize, vertexSize);
+        }
+
+        if (!input.IsAtEnd())
+        {
+            ThrowInvalidData();
+        }
+
+        return vertices;
+    }
+
+    // Triangles
+
+    // The edges and vertices of the last triangles, most recent first
+    class EdgeFifo
+    {
+    public:
+        EdgeFifo() : m_offset(0)
+        {
+            for (auto& edge : m_edges)
+            {
+                edge[0] = edge[1] = std::numeric_limits<uint32_t>::max();
+            }
+        }
+
+        // Finds an edge of the triangle, returning its position in the FIFO and which edge of the triangle it is
+        bool Find(uint32_t a, uint32_t b, uint32_t c, size_t& position, size_t& rotation) const
+        {
+            for (size_t i = 0; i < FIFO_SIZE; i++)
+            {
+                const auto& edge = m_edges[(m_offset - 1 - i) & (FIFO_SIZE - 1)];
+                for (rotation = 0; rotation < 3; rotation++)
+                {
+                    const uint32_t triangle[] = { a, b, c };
+                    if (edge[0] == triangle[TRIANGLE_ROTATIONS[rotation][0]] && edge[1] == triangle[TRIANGLE_ROTATIONS[rotation][1]])
+                    {
+                        position = i;
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        void Get(size_t position, uint32_t& a, uint32_t& b) const
+        {
+            const auto& edge = m_edges[(m_offset - 1 - position) & (FIFO_SIZE - 1)];
+            a = edge[0];
+            b = edge[1];
+        }
+
+        void Push(uint32_t a, uint32_t b)
+        {
+            m_edges[m_offset][0] = a;
+            m_edges[m_offset][1] = b;
+            m_offset = (m_offset + 1) & (FIFO_SIZE - 1);
+        }
+
+    private:
+        uint32_t m_edges[FIFO_SIZE][2];
+        size_t m_offset;
+    };
+
+    class VertexFifo
+    {
+    public:
+        VertexFifo() : m_offset(0)
+        {
+            std::fill(std::begin(m_vertices), std::end(m_vertices), std::numeric_limits<uint32_t>::max());
+        }
+
+        // The position of a vertex in the FIFO, or FIFO_SIZE if it isn't there
+        uint32_t Find(uint32_t vertex) const
+        {
+            for (uint32_t i = 0; i < FIFO_SIZE; i++)
+            {
+                if (m_vertices[(m_offset - 1 - i) & (FIFO_SIZE - 1)] == vertex)
+                {
+                    return i;
+                }
+            }
+
+            return static_cast<uint32_t>(FIFO_SIZE);
+        }
+
+        uint32_t Get(uint32_t position) const
+        {
+            return m_vertices[(m_offset - 1 - position) & (FIFO_SIZE - 1)];
+        }
+
+        void Push(uint32_t vertex)
+        {
+            m_vertices[m_offset] = vertex;
+            m_offset = (m_offset + 1) & (FIFO_SIZE - 1);
+        }
+
+    private:
+        uint32_t m_vertices[FIFO_SIZE];
+        size_t m_offset;
+    };
+
+    void WriteFreeIndex(std::vector<uint8_t>& output, uint32_t index, uint32_t& last)
+    {
+        WriteVByte(output, ZigZag(index - last));
+        last = index;
+    }
+
+    uint32_t ReadFreeIndex(StreamReader& input, uint32_t& last)
+    {
+        last += UnZigZag(input.ReadVByte());
+        return last;
+    }
+
+    // Each triangle is written as a code byte, and the indices that can't be coded follow the codes. A triangle that shares
+    // an edge with a recent triangle, as most do in a mesh optimized for the vertex cache, is coded from that edge and one more
+    // vertex. The vertex, like those of triangles with new edges, is coded as the next vertex never referenced before, a recent
+    // vertex, or written as the difference from the last index written.
+    std::vector<uint8_t> EncodeTriangles(const std::vector<uint32_t>& indices)
+    {
+        const size_t triangleCount = indices.size() / 3;
+
+        std::vector<uint8_t> codes;
+        std::vector<uint8_t> data;
+        codes.reserve(triangleCount);
+        data.reserve(triangleCount);
+
+        EdgeFifo edges;
+        VertexFifo vertices;
+        uint32_t next = 0;
+        uint32_t last = 0;
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            size_t edge, rotation;
+            if (edges.Find(indices[i], indices[i + 1], indices[i + 2], edge, rotation) && edge < EDGE_FIFO_CODES)
+            {
+                const uint32_t a = indices[i + TRIANGLE_ROTATIONS[rotation][0]];
+                const uint32_t b = indices[i + TRIANGLE_ROTATIONS[rotation][1]];
+                const uint32_t c = indices[i + TRIANGLE_ROTATIONS[rotation][2]];
+
+                const uint32_t position = vertices.Find(c);
+                uint32_t code;
+                if (position >= 1 && position < VERTEX_FIFO_CODES)
+                {
+                    code = position;
+                }
+                else if (c == next)
+                {
+                    code = 0;
+                    next++;
+                }
+                else
+                {
+                    code = FREE_INDEX_CODE;
+                    WriteFreeIndex(data, c, last);
+                }
+
+                codes.push_back(static_cast<uint8_t>((edge << 4) | code));
+
+                if (code == 0 || code >= VERTEX_FIFO_CODES)
+                {
+                    vertices.Push(c);
+                }
+
+                // The shared edge is already in the FIFO
+                edges.Push(c, b);
+                edges.Push(a, c);
+            }
+            else
+            {
+                // The first vertex is usually the next one, so it is rotated first to avoid coding it
+                const size_t newRotation = indices[i + 1] == next ? 1 : indices[i + 2] == next ? 2 : 0;
+                const uint32_t a = indices[i + TRIANGLE_ROTATIONS[newRotation][0]];
+                const uint32_t b = indices[i + TRIANGLE_ROTATIONS[newRotation][1]];
+                const uint32_t c = indices[i + TRIANGLE_ROTATIONS[newRotation][2]];
+
+                const uint32_t positionB = vertices.Find(b);
+                const uint32_t positionC = vertices.Find(c);
+
+                auto getCode = [&next](uint32_t vertex, uint32_t position)
+                {
+                    if (position < FIFO_SIZE - 2)
+                    {
+                        return position + 1;
+                    }
+
+                    if (vertex == next)
+                    {
+                        next++;
+                        return uint32_t(0);
+                    }
+
+                    return FREE_INDEX_CODE;
+                };
+
+                uint32_t codeA = FREE_INDEX_CODE;
+                if (a == next)
+                {
+                    codeA = 0;
+                    next++;
+                }
+
+                const uint32_t codeB = getCode(b, positionB);
+                const uint32_t codeC = getCode(c, positionC);
+
+                const uint8_t codeaux = static_cast<uint8_t>((codeB << 4) | codeC);
+                const size_t tableIndex = std::find(CODEAUX_TABLE, CODEAUX_TABLE + CODEAUX_TABLE_CODES, codeaux) - CODEAUX_TABLE;
+
+                // A zero auxiliary byte after a code byte would mean a restart of the vertex numbering, which is never
+                // written, so a triangle of three next vertices always uses the first table entry
+                if (codeA == 0 && tableIndex < CODEAUX_TABLE_CODES)
+                {
+                    codes.push_back(static_cast<uint8_t>((EDGE_FIFO_CODES << 4) | tableIndex));
+                }
+                else
+                {
+                    codes.push_back(static_cast<uint8_t>((EDGE_FIFO_CODES << 4) | (codeA == 0 ? 14 : 15)));
+                    data.push_back(codeaux);
+                }
+
+                if (codeA == FREE_INDEX_CODE)
+                {
+                    WriteFreeIndex(data, a, last);
+                }
+
+                if (codeB == FREE_INDEX_CODE)
+                {
+                    WriteFreeIndex(data, b, last);
+                }
+
+                if (codeC == FREE_INDEX_CODE)
+                {
+                    WriteFreeIndex(data, c, last);
+                }
+
+                vertices.Push(a);
+
+                if (codeB == 0 || codeB == FREE_INDEX_CODE)
+                {
+                    vertices.Push(b);
+                }
+
+                if (codeC == 0 || codeC == FREE_INDEX_CODE)
+                {
+                    vertices.Push(c);
+                }
+
+                edges.Push(b, a);
+                edges.Push(c, b);
+                edges.Push(a, c);
+            }
+        }
+
+        std::vector<uint8_t> output;
+        output.reserve(1 + codes.size() + data.size() + FIFO_SIZE);
+        output.push_back(TRIANGLES_HEADER);
+        output.insert(output.end(), codes.begin(), codes.end());
+        output.insert(output.end(), data.begin(), data.end());
+        output.insert(output.end(), std::begin(CODEAUX_TABLE), std::end(CODEAUX_TABLE));
+        return output;
+    }
+
+    std::vector<uint32_t> DecodeTriangles(const uint8_t* data, size_t size, size_t indexCount)
+    {
+        if (indexCount % 3 != 0)
+        {
+            ThrowInvalidData();
+        }
+
+        StreamReader input(data, size);
+        if (input.ReadByte() != TRIANGLES_HEADER)
+        {
+            ThrowInvalidData();
+        }
+
+        input.Truncate(FIFO_SIZE);
+        const uint8_t* codeauxTable = data + size - FIFO_SIZE;
+        const uint8_t* codes = input.Read(indexCount / 3);
+
+        std::vector<uint32_t> indices;
+        indices.reserve(indexCount);
+
+        EdgeFifo edges;
+        VertexFifo vertices;
+        uint32_t next = 0;
+        uint32_t last = 0;
+
+        for (size_t i = 0; i < indexCount / 3; i++)
+        {
+            const uint32_t edge = codes[i] >> 4;
+            const uint32_t code = codes[i] & 15;
+
+            uint32_t a, b, c;
+            if (edge < EDGE_FIFO_CODES)
+            {
+                edges.Get(edge, a, b);
+
+                if (code == 0)
+                {
+                    c = next++;
+                }
+                else if (code < VERTEX_FIFO_CODES)
+                {
+                    c = vertices.Get(code);
+                }
+                else if (code == FREE_INDEX_CODE)
+                {
+                    c = ReadFreeIndex(input, last);
+                }
+                else
+                {
+                    c = last = code == 13 ? last - 1 : last + 1;
+                }
+
+                if (code == 0 || code >= VERTEX_FIFO_CODES)
+                {
+                    vertices.Push(c);
+                }
+
+                edges.Push(c, b);
+                edges.Push(a, c);
+            }
+            else
+            {
+                uint8_t codeaux;
+                bool freeA = false;
+                if (code < CODEAUX_TABLE_CODES)
+                {
+                    codeaux = codeauxTable[code];
+                }
+                else
+                {
+                    codeaux = input.ReadByte();
+                    freeA = code == 15;
+
+                    // Restarts the vertex numbering
+                    if (codeaux == 0)
+                    {
+                        next = 0;
+                    }
+                }
+
+                const uint32_t codeB = codeaux >> 4;
+                const uint32_t codeC = codeaux & 15;
+
+                a = freeA ? 0 : next++;
+                b = codeB == 0 ? next++ : codeB < FREE_INDEX_CODE ? vertices.Get(codeB - 1) : 0;
+                c = codeC == 0 ? next++ : codeC < FREE_INDEX_CODE ? vertices.Get(codeC - 1) : 0;
+
+                if (freeA)
+                {
+                    a = ReadFreeIndex(input, last);
+                }
+
+                if (codeB == FREE_INDEX_CODE)
+                {
+                    b = ReadFreeIndex(input, last);
+                }
+
+                if (codeC == FREE_INDEX_CODE)
+                {
+                    c = ReadFreeIndex(input, last);
+                }
+
+                vertices.Push(a);
+
+                if (codeB == 0 || codeB == FREE_INDEX_CODE)
+                {
+                    vertices.Push(b);
+                }
+
+                if (codeC == 0 || codeC == FREE_INDEX_CODE)
+                {
+                    vertices.Push(c);
+                }
+
+                edges.Push(b, a);
+                edges.Push(c, b);
+                edges.Push(a, c);
+            }
+
+            indices.push_back(a);
+            indices.push_back(b);
+            indices.push_back(c);
+        }
+
+        if (!input.IsAtEnd())
+        {
+            ThrowInvalidData();
+        }
+
+        return indices;
+    }
+
+    // Indices
+
+    // Each index is written as the difference from one of the two last indices, which follow separate runs of
+    // indices. The lowest bit of each value tells which one.
+    std::vector<uint8_t> EncodeIndices(const std::vector<uint32_t>& indices)
+    {
+        std::vector<uint8_t> output;
+        output.reserve(1 + indices.size() + INDICES_TAIL_SIZE);
+        output.push_back(INDICES_HEADER);
+
+        uint32_t last[2] = { 0, 0 };
+        uint32_t current = 0;
+
+        for (auto index : indices)
+        {
+            // Switch to the other run when the difference does not fit in a byte
+            const int32_t difference = static_cast<int32_t>(index - last[current]);
+            if (difference >= 30 || difference <= -30)
+            {
+                current ^= 1;
+            }
+
+            WriteVByte(output, (ZigZag(index - last[current]) << 1) | current);
+            last[current] = index;
+        }
+
+        output.resize(output.size() + INDICES_TAIL_SIZE, 0);
+        return output;
+    }
+
+    std::vector<uint32_t> DecodeIndices(const uint8_t* data, size_t size, size_t indexCount)
+    {
+        StreamReader input(data, size);
+        if (input.ReadByte() != INDICES_HEADER)
+        {
+            ThrowInvalidData();
+        }
+
+        input.Truncate(INDICES_TAIL_SIZE);
+
+        std::vector<uint32_t> indices;
+        indices.reserve(indexCount);
+
+        uint32_t last[2] = { 0, 0 };
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            const uint32_t value = input.ReadVByte();
+            const uint32_t current = value & 1;
+
+            last[current] += UnZigZag(value >> 1);
+            indices.push_back(last[current]);
+        }
+
+        if (!input.IsAtEnd())
+        {
+            ThrowInvalidData();
+        }
+
+        return indices;
+    }
+
+    void CheckStride(MeshoptMode mode, size_t byteStride)
+    {
+        if (mode == MeshoptMode::Attributes ? (byteStride == 0 || byteStride > VERTEX_MAX_SIZE || byteStride % 4 != 0) : (byteStride != 2 && byteStride != 4))
+        {
+            throw std::invalid_argument("Invalid byte stride for EXT_meshopt_compression mode " + std::string(GLTFMeshCompressionUtils::GetModeName(mode)));
+        }
+    }
+}
+
+std::vector<uint8_t> GLTFMeshCompressionUtils::Encode(MeshoptMode mode, const void* data, size_t count, size_t byteStride)
+{
+    CheckStride(mode, byteStride);
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (mode == MeshoptMode::Attributes)
+    {
+        return EncodeAttributes(bytes, count, byteStride);
+    }
+
+    if (mode == MeshoptMode::Triangles && count % 3 != 0)
+    {
+        throw std::invalid_argument("The number of triangle indices must be a multiple of 3");
+    }
+
+    std::vector<uint32_t> indices(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (byteStride == 2)
+        {
+            uint16_t index;
+            memcpy(&index, bytes + i * byteStride, sizeof(index));
+            indices[i] = index;
+        }
+        else
+        {
+            memcpy(&indices[i], bytes + i * byteStride, sizeof(uint32_t));
+        }
+    }
+
+    return mode == MeshoptMode::Triangles ? EncodeTriangles(indices) : EncodeIndices(indices);
+}
+
+std::vector<uint8_t> GLTFMeshCompressionUtils::Decode(MeshoptMode mode, const void* data, size_t size, size_t count, size_t byteStride)
+{
+    CheckStride(mode, byteStride);
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (mode == MeshoptMode::Attributes)
+    {
+        return DecodeAttributes(bytes, size, count, byteStride);
+    }
+
+    auto indices = mode == MeshoptMode::Triangles ? DecodeTriangles(bytes, size, count) : DecodeIndices(bytes, size, count);
+
+    std::vector<uint8_t> output(count * byteStride);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (byteStride == 2)
+        {
+            const uint16_t index = static_cast<uint16_t>(indices[i]);
+            memcpy(output.data() + i * byteStride, &index, sizeof(index));
+        }
+        else
+        {
+            memcpy(output.data() + i * byteStride, &indices[i], sizeof(uint32_t));
+        }
+    }
+
+    return output;
+}
+
+const char* GLTFMeshCompressionUtils::GetModeName(MeshoptMode mode)
+{
+    switch (mode)
+    {
+    case MeshoptMode::Attributes:
+        return "ATTRIBUTES";
+    case MeshoptMode::Triangles:
+        return "TRIANGLES";
+    case MeshoptMode::Indices:
+        return "INDICES";
+    default:
+        throw std::invalid_argument("Unknown EXT_meshopt_compression mode");
+    }
+}
@@ -0,0 +1,760 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "GLTFMeshOptimizationUtils.h"
+#include "AccessorUtils.h"
+#include "BufferUtils.h"
+#include "ParallelUtils.h"
+
+#include "GLTFSDK/GLTF.h"
+#include "GLTFSDK/GLTFResourceReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    // Parameters of the vertex cache optimization, from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+    const size_t FORSYTH_CACHE_SIZE = 32;
+    const double FORSYTH_CACHE_DECAY_POWER = 1.5;
+    const double FORSYTH_LAST_TRIANGLE_SCORE = 0.75;
+    const double FORSYTH_VALENCE_BOOST_SCALE = 2.0;
+    const double FORSYTH_VALENCE_BOOST_POWER = 0.5;
+    const uint32_t FORSYTH_MAX_VALENCE = 64;
+
+    // The cache size that overdraw clusters are measured against, which is typical of current GPUs
+    const size_t OVERDRAW_CACHE_SIZE = 16;
+
+    const uint32_t UNUSED_VERTEX = std::numeric_limits<uint32_t>::max();
+    const uint32_t NO_TRIANGLE = std::numeric_limits<uint32_t>::max();
+
+    // The scores of a vertex by its position in the cache, and by the number of triangles left to draw that use it,
+    // which are the same for every mesh
+    struct VertexScoreTables
+    {
+        VertexScoreTables()
+        {
+            for (size_t position = 0; position < FORSYTH_CACHE_SIZE; position++)
+            {
+                cache[position] = position < 3 ? FORSYTH_LAST_TRIANGLE_SCORE :
+                    std::pow(1.0 - static_cast<double>(position - 3) / static_cast<double>(FORSYTH_CACHE_SIZE - 3), FORSYTH_CACHE_DECAY_POWER);
+            }
+
+            valence[0] = 0;
+            for (uint32_t remaining = 1; remaining <= FORSYTH_MAX_VALENCE; remaining++)
+            {
+                valence[remaining] = FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<double>(remaining), -FORSYTH_VALENCE_BOOST_POWER);
+            }
+        }
+
+        double GetScore(int cachePosition, uint32_t remainingTriangles) const
+        {
+            if (remainingTriangles == 0)
+            {
+                return -1.0;
+            }
+
+            double score = cachePosition < 0 ? 0.0 : cache[cachePosition];
+            return score + valence[std::min(remainingTriangles, FORSYTH_MAX_VALENCE)];
+        }
+
+        double cache[FORSYTH_CACHE_SIZE];
+        double valence[FORSYTH_MAX_VALENCE + 1];
+    };
+
+    struct Point3
+    {
+        double x;
+        double y;
+        double z;
+    };
+
+    Point3 GetPosition(const std::vector<float>& positions, uint32_t vertex)
+    {
+        return { positions[vertex * 3], positions[vertex * 3 + 1], positions[vertex * 3 + 2] };
+    }
+
+    // The vertex accessors of a primitive, including its morph targets, which all follow the same vertex order
+    std::vector<std::string> GetVertexAccessorIds(const MeshPrimitive& primitive)
+    {
+        std::vector<std::string> ids;
+        for (const auto& id : {
+            primitive.positionsAccessorId, primitive.normalsAccessorId, primitive.tangentsAccessorId,
+            primitive.uv0AccessorId, primitive.uv1AccessorId, primitive.color0AccessorId,
+            primitive.joints0AccessorId, primitive.weights0AccessorId })
+        {
+            if (!id.empty())
+            {
+                ids.push_back(id);
+            }
+        }
+
+        for (const auto& target : primitive.targets)
+        {
+            for (const auto& id : { target.positionsAccessorId, target.normalsAccessorId, target.tangentsAccessorId })
+            {
+                if (!id.empty())
+                {
+                    ids.push_back(id);
+                }
+            }
+        }
+
+        return ids;
+    }
+
+    bool CanOptimize(const MeshPrimitive& primitive)
+    {
+        return primitive.mode == MeshMode::MESH_TRIANGLES && !primitive.positionsAccessorId.empty();
+    }
+
+    template <typename T>
+    std::vector<uint32_t> ReadIndices(const GLTFResourceReader& reader, const GLTFDocument& doc, const Accessor& accessor)
+    {
+        auto data = reader.ReadBinaryData<T>(doc, accessor);
+        return std::vector<uint32_t>(data.begin(), data.end());
+    }
+
+    std::vector<uint32_t> ReadIndices(const GLTFResourceReader& reader, const GLTFDocument& doc, const MeshPrimitive& primitive, size_t vertexCount)
+    {
+        if (primitive.indicesAccessorId.empty())
+        {
+            std::vector<uint32_t> indices(vertexCount);
+            std::iota(indices.begin(), indices.end(), 0);
+            return indices;
+        }
+
+        const auto& accessor = doc.accessors.Get(primitive.indicesAccessorId);
+        switch (accessor.componentType)
+        {
+        case ComponentType::COMPONENT_UNSIGNED_BYTE:
+            return ReadIndices<uint8_t>(reader, doc, accessor);
+        case ComponentType::COMPONENT_UNSIGNED_SHORT:
+            return ReadIndices<uint16_t>(reader, doc, accessor);
+        case ComponentType::COMPONENT_UNSIGNED_INT:
+            return ReadIndices<uint32_t>(reader, doc, accessor);
+        default:
+            throw GLTFException("Invalid index component type in accessor " + accessor.id);
+        }
+    }
+
+    // The contents of a vertex accessor in the new vertex order, with each element padded to the stride
+    struct AccessorContents
+    {
+        std::vector<uint8_t> data;
+        size_t byteStride;
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+
+    template <typename T>
+    AccessorContents ReorderVertices(const GLTFResourceReader& reader, const GLTFDocument& doc, const Accessor& accessor, const std::vector<uint32_t>& remap, size_t vertexCount)
+    {
+        const auto typeCount = Accessor::GetTypeCount(accessor.type);
+        const auto elementSize = typeCount * sizeof(T);
+
+        auto source = reader.ReadBinaryData<T>(doc, accessor);
+        std::vector<T> reordered(vertexCount * typeCount);
+        for (size_t vertex = 0; vertex < accessor.count; vertex++)
+        {
+            if (remap[vertex] != UNUSED_VERTEX)
+            {
+                std::copy_n(&source[vertex * typeCount], typeCount, &reordered[remap[vertex] * typeCount]);
+            }
+        }
+
+        AccessorContents contents;
+        contents.byteStride = BufferUtils::GetVertexByteStride(elementSize);
+        contents.data = BufferUtils::PadVertexElements(reordered.data(), vertexCount, elementSize);
+
+        if (!accessor.min.empty() || !accessor.max.empty())
+        {
+            Accessor reorderedAccessor(accessor);
+            reorderedAccessor.count = vertexCount;
+
+            auto minMax = AccessorUtils::CalculateMinMax(reorderedAccessor, reordered);
+            contents.min = std::move(minMax.first);
+            contents.max = std::move(minMax.second);
+        }
+
+        return contents;
+    }
+
+    AccessorContents ReorderVertices(const GLTFResourceReader& reader, const GLTFDocument& doc, const Accessor& accessor, const std::vector<uint32_t>& remap, size_t vertexCount)
+    {
+        switch (accessor.componentType)
+        {
+        case ComponentType::COMPONENT_BYTE:
+            return ReorderVertices<int8_t>(reader, doc, accessor, remap, vertexCount);
+        case ComponentType::COMPONENT_UNSIGNED_BYTE:
+            return ReorderVertices<uint8_t>(reader, doc, accessor, remap, vertexCount);
+        case ComponentType::COMPONENT_SHORT:
+            return ReorderVertices<int16_t>(reader, doc, accessor, remap, vertexCount);
+        case ComponentType::COMPONENT_UNSIGNED_SHORT:
+            return ReorderVertices<uint16_t>(reader, doc, accessor, remap, vertexCount);
+        case ComponentType::COMPONENT_UNSIGNED_INT:
+            return ReorderVertices<uint32_t>(reader, doc, accessor, remap, vertexCount);
+        case ComponentType::COMPONENT_FLOAT:
+            return ReorderVertices<float>(reader, doc, accessor, remap, vertexCount);
+        default:
+            throw GLTFException("Invalid component type in accessor " + accessor.id);
+        }
+    }
+
+    struct PrimitiveLocation
+    {
+        std::string meshId;
+        size_t primitiveIndex;
+    };
+
+    // The primitives that use the same vertex accessors, which are optimized together
+    struct VertexGroup
+    {
+        std::vector<std::string> accessorIds;
+        std::vector<PrimitiveLocation> primitives;
+        bool reorderVertices;
+
+        // The optimized indices of each primitive, and the reordered contents of each accessor
+        std::vector<std::vector<uint32_t>> indices;
+        size_t vertexCount;
+        std::vector<AccessorContents> vertices;
+    };
+
+    std::vector<VertexGroup> GetVertexGroups(const GLTFDocument& doc)
+    {
+        std::vector<VertexGroup> groups;
+        std::unordered_map<std::string, size_t> groupsByKey;
+
+        // Accessors used by primitives with different vertex accessors, or by primitives that are not
+        // optimized, must keep their vertex order
+        std::unordered_map<std::string, std::string> keysByAccessor;
+        std::unordered_set<std::string> sharedAccessors;
+
+        for (const auto& mesh : doc.meshes.Elements())
+        {
+            for (size_t i = 0; i < mesh.primitives.size(); i++)
+            {
+                const auto& primitive = mesh.primitives[i];
+                auto accessorIds = GetVertexAccessorIds(primitive);
+
+                std::string key;
+                for (const auto& id : accessorIds)
+                {
+                    key += id + ",";
+                }
+
+                for (const auto& id : accessorIds)
+                {
+                    auto inserted = keysByAccessor.emplace(id, key);
+                    if (!CanOptimize(primitive) || inserted.first->second != key)
+                    {
+                        sharedAccessors.insert(id);
+                    }
+                }
+
+                if (!CanOptimize(primitive))
+                {
+                    continue;
+                }
+
+                auto inserted = groupsByKey.emplace(key, groups.size());
+                if (inserted.second)
+                {
+                    groups.push_back({ accessorIds, {}, true, {}, 0, {} });
+                }
+
+                groups[inserted.first->second].primitives.push_back({ mesh.id, i });
+            }
+        }
+
+        for (auto& group : groups)
+        {
+            const auto vertexCount = doc.accessors.Get(group.accessorIds[0]).count;
+            for (const auto& id : group.accessorIds)
+            {
+                const auto& accessor = doc.accessors.Get(id);
+                if (sharedAccessors.count(id) > 0 || accessor.bufferViewId.empty() || accessor.count != vertexCount)
+                {
+                    group.reorderVertices = false;
+                }
+            }
+        }
+
+        return groups;
+    }
+
+    void OptimizeVertexGroup(const IStreamReader& streamReader, const GLTFDocument& doc, VertexGroup& group)
+    {
+        GLTFResourceReader reader(streamReader);
+
+        const auto& positionsAccessor = doc.accessors.Get(group.accessorIds[0]);
+        group.vertexCount = positionsAccessor.count;
+
+        std::vector<float> positions;
+        if (positionsAccessor.componentType == ComponentType::COMPONENT_FLOAT && positionsAccessor.type == AccessorType::TYPE_VEC3 && !positionsAccessor.bufferViewId.empty())
+        {
+            positions = reader.ReadBinaryData<float>(doc, positionsAccessor);
+        }
+
+        std::vector<uint32_t> allIndices;
+        for (const auto& location : group.primitives)
+        {
+            const auto& primitive = doc.meshes.Get(location.meshId).primitives[location.primitiveIndex];
+
+            auto indices = GLTFMeshOptimizationUtils::OptimizeVertexCache(ReadIndices(reader, doc, primitive, group.vertexCount), group.vertexCount);
+            if (!positions.empty())
+            {
+                indices = GLTFMeshOptimizationUtils::OptimizeOverdraw(positions, indices);
+            }
+
+            allIndices.insert(allIndices.end(), indices.begin(), indices.end());
+            group.indices.push_back(std::move(indices));
+        }
+
+        if (!group.reorderVertices)
+        {
+            return;
+        }
+
+        // The primitives are drawn in order, so the vertices are laid out in the order the primitives first use them
+        auto remap = GLTFMeshOptimizationUtils::OptimizeVertexFetch(allIndices, group.vertexCount);
+        group.vertexCount = static_cast<size_t>(std::count_if(remap.begin(), remap.end(), [](uint32_t vertex) { return vertex != UNUSED_VERTEX; }));
+
+        for (auto& indices : group.indices)
+        {
+            for (auto& index : indices)
+            {
+                index = remap[index];
+            }
+        }
+
+        for (const auto& id : group.accessorIds)
+        {
+            group.vertices.push_back(ReorderVertices(reader, doc, doc.accessors.Get(id), remap, group.vertexCount));
+        }
+    }
+
+    template <typename T>
+    std::vector<uint8_t> GetIndexData(const std::vector<uint32_t>& indices)
+    {
+        std::vector<uint8_t> data(indices.size() * sizeof(T));
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            T index = static_cast<T>(indices[i]);
+            std::memcpy(&data[i * sizeof(T)], &index, sizeof(T));
+        }
+
+        return data;
+    }
+
+    void AddOptimizedGroup(GLTFDocument& doc, const VertexGroup& group, BufferWriter& writer)
+    {
+        // The vertex accessors are only used by this group, so they are changed in place
+        for (size_t i = 0; i < group.vertices.size(); i++)
+        {
+            const auto& contents = group.vertices[i];
+
+            Accessor accessor(doc.accessors.Get(group.accessorIds[i]));
+            accessor.bufferViewId = writer.AddBufferView(contents.data, contents.byteStride, BufferViewTarget::ARRAY_BUFFER);
+            accessor.byteOffset = 0;
+            accessor.count = group.vertexCount;
+            if (!contents.min.empty())
+            {
+                accessor.min = contents.min;
+                accessor.max = contents.max;
+            }
+
+            doc.accessors.Replace(accessor);
+        }
+
+        // Index accessors can be shared with primitives that are drawn in another order, so new ones are added
+        for (size_t i = 0; i < group.primitives.size(); i++)
+        {
+            const auto& location = group.primitives[i];
+            const auto& indices = group.indices[i];
+
+            auto mesh = doc.meshes.Get(location.meshId);
+            auto& primitive = mesh.primitives[location.primitiveIndex];
+
+            ComponentType componentType = group.vertexCount <= std::numeric_limits<uint16_t>::max() ? ComponentType::COMPONENT_UNSIGNED_SHORT : ComponentType::COMPONENT_UNSIGNED_INT;
+            if (!primitive.indicesAccessorId.empty())
+            {
+                componentType = doc.accessors.Get(primitive.indicesAccessorId).componentType;
+            }
+
+            std::vector<uint8_t> data;
+            switch (componentType)
+            {
+            case ComponentType::COMPONENT_UNSIGNED_BYTE:
+                data = GetIndexData<uint8_t>(indices);
+                break;
+            case ComponentType::COMPONENT_UNSIGNED_SHORT:
+                data = GetIndexData<uint16_t>(indices);
+                break;
+            default:
+                data = GetIndexData<uint32_t>(indices);
+                break;
+            }
+
+            Accessor accessor;
+            accessor.id = std::to_string(doc.accessors.Size());
+            accessor.bufferViewId = writer.AddBufferView(data, 0, BufferViewTarget::ELEMENT_ARRAY_BUFFER);
+            accessor.byteOffset = 0;
+            accessor.componentType = componentType;
+            accessor.type = AccessorType::TYPE_SCALAR;
+            accessor.count = indices.size();
+
+            primitive.indicesAccessorId = accessor.id;
+            doc.accessors.Append(std::move(accessor));
+            doc.meshes.Replace(mesh);
+        }
+    }
+}
+
+std::vector<uint32_t> GLTFMeshOptimizationUtils::OptimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+    if (indices.size() % 3 != 0)
+    {
+        throw std::invalid_argument("OptimizeVertexCache requires three indices per triangle");
+    }
+
+    if (std::any_of(indices.begin(), indices.end(), [vertexCount](uint32_t index) { return index >= vertexCount; }))
+    {
+        throw std::invalid_argument("OptimizeVertexCache passed an index out of range");
+    }
+
+    static const VertexScoreTables scoreTables;
+    const size_t triangleCount = indices.size() / 3;
+
+    // The triangles that still have to be drawn around each vertex, in compressed rows
+    std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+    for (auto index : indices)
+    {
+        remainingTriangles[index]++;
+    }
+
+    std::vector<size_t> triangleOffsets(vertexCount + 1, 0);
+    std::partial_sum(remainingTriangles.begin(), remainingTriangles.end(), triangleOffsets.begin() + 1);
+
+    std::vector<uint32_t> vertexTriangles(indices.size());
+    {
+        std::vector<size_t> next(triangleOffsets.begin(), triangleOffsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            vertexTriangles[next[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<double> vertexScores(vertexCount);
+    for (size_t vertex = 0; vertex < vertexCount; vertex++)
+    {
+        vertexScores[vertex] = scoreTables.GetScore(-1, remainingTriangles[vertex]);
+    }
+
+    std::vector<double> triangleScores(triangleCount);
+    for (size_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+    }
+
+    std::vector<bool> drawn(triangleCount, false);
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> nextCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    uint32_t bestTriangle = triangleCount > 0 ? static_cast<uint32_t>(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin()) : NO_TRIANGLE;
+    size_t nextUndrawn = 0;
+
+    for (size_t step = 0; step < triangleCount; step++)
+    {
+        if (bestTriangle == NO_TRIANGLE)
+        {
+            // Nothing in the cache has triangles left, so start again from the first triangle not drawn yet
+            while (drawn[nextUndrawn])
+            {
+                nextUndrawn++;
+            }
+
+            bestTriangle = static_cast<uint32_t>(nextUndrawn);
+        }
+
+        drawn[bestTriangle] = true;
+        const uint32_t* triangle = &indices[bestTriangle * 3];
+        output.insert(output.end(), triangle, triangle + 3);
+
+        // The vertices of the triangle move to the front of the cache, and no longer have it to draw
+        nextCache.assign(triangle, triangle + 3);
+        for (size_t k = 0; k < 3; k++)
+        {
+            auto vertex = triangle[k];
+            auto begin = vertexTriangles.begin() + triangleOffsets[vertex];
+            auto end = begin + remainingTriangles[vertex];
+            auto found = std::find(begin, end, bestTriangle);
+            if (found != end)
+            {
+                std::iter_swap(found, end - 1);
+                remainingTriangles[vertex]--;
+            }
+        }
+
+        for (auto vertex : cache)
+        {
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+            {
+                nextCache.push_back(vertex);
+            }
+        }
+
+        for (size_t position = 0; position < nextCache.size(); position++)
+        {
+            cachePositions[nextCache[position]] = position < FORSYTH_CACHE_SIZE ? static_cast<int>(position) : -1;
+        }
+
+        // Rescore the vertices whose cache position changed, including the ones that were pushed out, and
+        // pick the best triangle around the vertices that are still cached
+        bestTriangle = NO_TRIANGLE;
+        double bestScore = -1.0;
+        for (auto vertex : nextCache)
+        {
+            double score = scoreTables.GetScore(cachePositions[vertex], remainingTriangles[vertex]);
+            double delta = score - vertexScores[vertex];
+            vertexScores[vertex] = score;
+
+            auto begin = triangleOffsets[vertex];
+            auto end = begin + remainingTriangles[vertex];
+            for (auto t = begin; t < end; t++)
+            {
+                auto adjacentTriangle = vertexTriangles[t];
+                triangleScores[adjacentTriangle] += delta;
+
+                if (cachePositions[vertex] >= 0 && triangleScores[adjacentTriangle] > bestScore)
+                {
+                    bestScore = triangleScores[adjacentTriangle];
+                    bestTriangle = adjacentTriangle;
+                }
+            }
+        }
+
+        if (nextCache.size() > FORSYTH_CACHE_SIZE)
+        {
+            nextCache.resize(FORSYTH_CACHE_SIZE);
+        }
+
+        std::swap(cache, nextCache);
+    }
+
+    return output;
+}
+
+std::vector<uint32_t> GLTFMeshOptimizationUtils::OptimizeOverdraw(const std::vector<float>& positions, const std::vector<uint32_t>& indices)
+{
+    if (positions.size() % 3 != 0 || indices.size() % 3 != 0)
+    {
+        throw std::invalid_argument("OptimizeOverdraw requires three floats per position and three indices per triangle");
+    }
+
+    const size_t vertexCount = positions.size() / 3;
+    if (std::any_of(indices.begin(), indices.end(), [vertexCount](uint32_t index) { return index >= vertexCount; }))
+    {
+        throw std::invalid_argument("OptimizeOverdraw passed an index out of range");
+    }
+
+    const size_t triangleCount = indices.size() / 3;
+
+    // Split the triangles into clusters where the cache has none of the vertices of a triangle
+    std::vector<size_t> clusterStarts;
+    {
+        std::vector<size_t> cacheTimestamps(vertexCount, 0);
+        size_t time = OVERDRAW_CACHE_SIZE + 1;
+        for (size_t triangle = 0; triangle < triangleCount; triangle++)
+        {
+            size_t misses = 0;
+            for (size_t k = 0; k < 3; k++)
+            {
+                auto vertex = indices[triangle * 3 + k];
+                if (time - cacheTimestamps[vertex] > OVERDRAW_CACHE_SIZE)
+                {
+                    cacheTimestamps[vertex] = time++;
+                    misses++;
+                }
+            }
+
+            if (triangle == 0 || misses == 3)
+            {
+                clusterStarts.push_back(triangle);
+            }
+        }
+
+        clusterStarts.push_back(triangleCount);
+    }
+
+    const size_t clusterCount = clusterStarts.size() - 1;
+    if (clusterCount <= 1)
+    {
+        return indices;
+    }
+
+    // Area-weighted centroid and normal of each cluster, and of the mesh
+    std::vector<Point3> clusterCentroids(clusterCount, { 0, 0, 0 });
+    std::vector<Point3> clusterNormals(clusterCount, { 0, 0, 0 });
+    Point3 meshCentroid = { 0, 0, 0 };
+    double meshArea = 0;
+
+    for (size_t cluster = 0; cluster < clusterCount; cluster++)
+    {
+        double clusterArea = 0;
+        for (size_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; triangle++)
+        {
+            auto a = GetPosition(positions, indices[triangle * 3]);
+            auto b = GetPosition(positions, indices[triangle * 3 + 1]);
+            auto c = GetPosition(positions, indices[triangle * 3 + 2]);
+
+            Point3 ab = { b.x - a.x, b.y - a.y, b.z - a.z };
+            Point3 ac = { c.x - a.x, c.y - a.y, c.z - a.z };
+            Point3 normal = { ab.y * ac.z - ab.z * ac.y, ab.z * ac.x - ab.x * ac.z, ab.x * ac.y - ab.y * ac.x };
+            double area = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+
+            Point3 centroid = { (a.x + b.x + c.x) / 3, (a.y + b.y + c.y) / 3, (a.z + b.z + c.z) / 3 };
+
+            auto& clusterCentroid = clusterCentroids[cluster];
+            clusterCentroid = { clusterCentroid.x + centroid.x * area, clusterCentroid.y + centroid.y * area, clusterCentroid.z + centroid.z * area };
+
+            auto& clusterNormal = clusterNormals[cluster];
+            clusterNormal = { clusterNormal.x + normal.x, clusterNormal.y + normal.y, clusterNormal.z + normal.z };
+
+            clusterArea += area;
+        }
+
+        meshCentroid = { meshCentroid.x + clusterCentroids[cluster].x, meshCentroid.y + clusterCentroids[cluster].y, meshCentroid.z + clusterCentroids[cluster].z };
+        meshArea += clusterArea;
+
+        if (clusterArea > 0)
+        {
+            auto& clusterCentroid = clusterCentroids[cluster];
+            clusterCentroid = { clusterCentroid.x / clusterArea, clusterCentroid.y / clusterArea, clusterCentroid.z / clusterArea };
+        }
+    }
+
+    if (meshArea > 0)
+    {
+        meshCentroid = { meshCentroid.x / meshArea, meshCentroid.y / meshArea, meshCentroid.z / meshArea };
+    }
+
+    // Clusters that face away from the center of the mesh are drawn first, since they occlude the others from most views
+    std::vector<double> sortKeys(clusterCount);
+    for (size_t cluster = 0; cluster < clusterCount; cluster++)
+    {
+        const auto& centroid = clusterCentroids[cluster];
+        const auto& normal = clusterNormals[cluster];
+        double length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+
+        sortKeys[cluster] = length > 0 ?
+            ((centroid.x - meshCentroid.x) * normal.x + (centroid.y - meshCentroid.y) * normal.y + (centroid.z - meshCentroid.z) * normal.z) / length : 0;
+    }
+
+    std::vector<size_t> clusterOrder(clusterCount);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (auto cluster : clusterOrder)
+    {
+        output.insert(output.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + clusterStarts[cluster + 1] * 3);
+    }
+
+    return output;
+}
+
+std::vector<uint32_t> GLTFMeshOptimizationUtils::OptimizeVertexFetch(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+    std::vector<uint32_t> remap(vertexCount, UNUSED_VERTEX);
+
+    uint32_t nextVertex = 0;
+    for (auto index : indices)
+    {
+        if (index >= vertexCount)
+        {
+            throw std::invalid_argument("OptimizeVertexFetch passed an index out of range");
+        }
+
+        if (remap[index] == UNUSED_VERTEX)
+        {
+            remap[index] = nextVertex++;
+        }
+    }
+
+    return remap;
+}
+
+double GLTFMeshOptimizationUtils::GetAverageCacheMissRatio(const std::vector<uint32_t>& indices, size_t cacheSize)
+{
+    if (indices.size() < 3)
+    {
+        return 0;
+    }
+
+    std::vector<uint32_t> cache;
+    size_t misses = 0;
+    for (auto index : indices)
+    {
+        if (std::find(cache.begin(), cache.end(), index) == cache.end())
+        {
+            misses++;
+            cache.insert(cache.begin(), index);
+            if (cache.size() > cacheSize)
+            {
+                cache.pop_back();
+            }
+        }
+    }
+
+    return static_cast<double>(misses) / static_cast<double>(indices.size() / 3);
+}
+
+GLTFDocument GLTFMeshOptimizationUtils::OptimizeMeshes(const IStreamReader& streamReader, const GLTFDocument& doc, const std::string& outputDirectory, size_t maxParallelism)
+{
+    GLTFDocument outputDoc(doc);
+
+    OptimizeMeshesInPlace(streamReader, outputDoc, outputDirectory, maxParallelism);
+
+    return outputDoc;
+}
+
+void GLTFMeshOptimizationUtils::OptimizeMeshesInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const std::string& outputDirectory, size_t maxParallelism)
+{
+    auto groups = GetVertexGroups(doc);
+    if (groups.empty())
+    {
+        return;
+    }
+
+    ParallelUtils::ParallelFor(groups.size(), maxParallelism, [&](size_t groupIndex)
+    {
+        OptimizeVertexGroup(streamReader, doc, groups[groupIndex]);
+    });
+
+    // The document is only changed once every group has been read, in the same order for any parallelism
+    BufferWriter writer(doc, outputDirectory, "optimized_meshes.bin");
+    for (const auto& group : groups)
+    {
+        AddOptimizedGroup(doc, group, writer);
+    }
+
+    writer.Finish();
+}
@@ -0,0 +1,528 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "GLTFMeshQuantizationUtils.h"
+#include "AccessorUtils.h"
+#include "BufferUtils.h"
+#include "ParallelUtils.h"
+
+#include "GLTFSDK/GLTF.h"
+#include "GLTFSDK/GLTFResourceReader.h"
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+const char* Microsoft::glTF::Toolkit::EXTENSION_KHR_MESH_QUANTIZATION = "KHR_mesh_quantization";
+
+namespace
+{
+    enum class AttributeSemantic
+    {
+        Position,
+        Normal,
+        Tangent,
+        TexCoord,
+        Other
+    };
+
+    // How each accessor is used by the meshes. Accessors used in more than one way, or by skinned meshes and morph
+    // targets, are marked as Other and keep their data.
+    std::unordered_map<std::string, AttributeSemantic> GetAttributeSemantics(const GLTFDocument& doc)
+    {
+        std::unordered_map<std::string, AttributeSemantic> semantics;
+        auto addAccessor = [&semantics](const std::string& id, AttributeSemantic semantic)
+        {
+            if (!id.empty())
+            {
+                auto inserted = semantics.emplace(id, semantic);
+                if (inserted.first->second != semantic)
+                {
+                    inserted.first->second = AttributeSemantic::Other;
+                }
+            }
+        };
+
+        for (const auto& mesh : doc.meshes.Elements())
+        {
+            // The dequantization transform of the positions is ignored by skinning, and it would also have to apply to
+            // the morph target offsets
+            bool transformable = true;
+            for (const auto& primitive : mesh.primitives)
+            {
+                transformable = transformable && primitive.joints0AccessorId.empty() && primitive.targets.empty();
+            }
+
+            for (const auto& primitive : mesh.primitives)
+            {
+                addAccessor(primitive.positionsAccessorId, transformable ? AttributeSemantic::Position : AttributeSemantic::Other);
+                addAccessor(primitive.normalsAccessorId, AttributeSemantic::Normal);
+                addAccessor(primitive.tangentsAccessorId, AttributeSemantic::Tangent);
+                addAccessor(primitive.uv0AccessorId, AttributeSemantic::TexCoord);
+                addAccessor(primitive.uv1AccessorId, AttributeSemantic::TexCoord);
+                addAccessor(primitive.color0AccessorId, AttributeSemantic::Other);
+                addAccessor(primitive.joints0AccessorId, AttributeSemantic::Other);
+                addAccessor(primitive.weights0AccessorId, AttributeSemantic::Other);
+                addAccessor(primitive.indicesAccessorId, AttributeSemantic::Other);
+
+                for (const auto& target : primitive.targets)
+                {
+                    addAccessor(target.positionsAccessorId, AttributeSemantic::Other);
+                    addAccessor(target.normalsAccessorId, AttributeSemantic::Other);
+                    addAccessor(target.tangentsAccessorId, AttributeSemantic::Other);
+                }
+            }
+        }
+
+        return semantics;
+    }
+
+    // How an accessor is quantized. Positions are stored as round((position - offset) / scale).
+    struct QuantizationPlan
+    {
+        std::string accessorId;
+        AttributeSemantic semantic;
+        ComponentType componentType;
+        double offset[3];
+        double scale;
+    };
+
+    // The quantized contents of an accessor, with each element padded to the stride
+    struct QuantizedContents
+    {
+        std::vector<uint8_t> data;
+        size_t byteStride;
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+
+    // The meshes whose positions are quantized with the same transform, because they share position accessors
+    struct PositionGroup
+    {
+        std::vector<std::string> accessorIds;
+        std::unordered_set<std::string> meshIds;
+        bool quantizable;
+        double min[3];
+        double max[3];
+    };
+
+    class DisjointSets
+    {
+    public:
+        size_t Add()
+        {
+            m_parents.push_back(m_parents.size());
+            return m_parents.size() - 1;
+        }
+
+        size_t Find(size_t element)
+        {
+            while (m_parents[element] != element)
+            {
+                m_parents[element] = m_parents[m_parents[element]];
+                element = m_parents[element];
+            }
+
+            return element;
+        }
+
+        void Union(size_t a, size_t b)
+        {
+            m_parents[Find(a)] = Find(b);
+        }
+
+    private:
+        std::vector<size_t> m_parents;
+    };
+
+    bool IsFloatAttribute(const Accessor& accessor, AccessorType type)
+    {
+        return accessor.componentType == ComponentType::COMPONENT_FLOAT && accessor.type == type && !accessor.bufferViewId.empty() && accessor.count > 0;
+    }
+
+    std::vector<PositionGroup> GetPositionGroups(const GLTFDocument& doc, const std::unordered_map<std::string, AttributeSemantic>& semantics)
+    {
+        DisjointSets sets;
+        std::unordered_map<std::string, size_t> setsByAccessor;
+        std::vector<std::string> accessorIds;
+
+        for (const auto& mesh : doc.meshes.Elements())
+        {
+            std::optional<size_t> meshSet;
+            for (const auto& primitive : mesh.primitives)
+            {
+                if (primitive.positionsAccessorId.empty())
+                {
+                    continue;
+                }
+
+                auto inserted = setsByAccessor.emplace(primitive.positionsAccessorId, 0);
+                if (inserted.second)
+                {
+                    inserted.first->second = sets.Add();
+                    accessorIds.push_back(primitive.positionsAccessorId);
+                }
+
+                if (meshSet)
+                {
+                    sets.Union(inserted.first->second, *meshSet);
+                }
+
+                meshSet = inserted.first->second;
+            }
+        }
+
+        std::vector<PositionGroup> groups;
+        std::unordered_map<size_t, size_t> groupsBySet;
+        for (const auto& id : accessorIds)
+        {
+            auto inserted = groupsBySet.emplace(sets.Find(setsByAccessor[id]), groups.size());
+            if (inserted.second)
+            {
+                const double infinity = std::numeric_limits<double>::infinity();
+                groups.push_back({ {}, {}, true, { infinity, infinity, infinity }, { -infinity, -infinity, -infinity } });
+            }
+
+            auto& group = groups[inserted.first->second];
+            group.accessorIds.push_back(id);
+            group.quantizable = group.quantizable && semantics.at(id) == AttributeSemantic::Position && IsFloatAttribute(doc.accessors.Get(id), AccessorType::TYPE_VEC3);
+        }
+
+        for (const auto& mesh : doc.meshes.Elements())
+        {
+            for (const auto& primitive : mesh.primitives)
+            {
+                if (!primitive.positionsAccessorId.empty())
+                {
+                    groups[groupsBySet[sets.Find(setsByAccessor[primitive.positionsAccessorId])]].meshIds.insert(mesh.id);
+                    break;
+                }
+            }
+        }
+
+        return groups;
+    }
+
+    // The narrowest integer type whose quantization error stays within the bound, given the error of 8-bit and 16-bit values
+    std::optional<ComponentType> ChooseComponentType(double errorBound, double byteError, double shortError, bool isSigned)
+    {
+        if (errorBound >= byteError)
+        {
+            return isSigned ? ComponentType::COMPONENT_BYTE : ComponentType::COMPONENT_UNSIGNED_BYTE;
+        }
+
+        if (errorBound >= shortError)
+        {
+            return isSigned ? ComponentType::COMPONENT_SHORT : ComponentType::COMPONENT_UNSIGNED_SHORT;
+        }
+
+        return std::nullopt;
+    }
+
+    template <typename T>
+    std::optional<QuantizedContents> Quantize(const std::vector<float>& values, size_t typeCount, const QuantizationPlan& plan)
+    {
+        const double maxValue = static_cast<double>(std::numeric_limits<T>::max());
+        const double minValue = std::is_signed_v<T> ? -maxValue : 0.0;
+
+        std::vector<T> quantized(values.size());
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            double value = values[i];
+            if (plan.semantic == AttributeSemantic::Position)
+            {
+                value = (value - plan.offset[i % 3]) / plan.scale;
+            }
+            else if (plan.semantic == AttributeSemantic::TexCoord)
+            {
+                // Texture coordinates outside of [0, 1] would need a texture transform to be restored
+                if (value < 0.0 || value > 1.0)
+                {
+                    return std::nullopt;
+                }
+
+                value *= maxValue;
+            }
+            else
+            {
+                value = std::max(-1.0, std::min(1.0, value)) * maxValue;
+            }
+
+            quantized[i] = static_cast<T>(std::lround(std::max(minValue, std::min(maxValue, value))));
+        }
+
+        QuantizedContents contents;
+
+        const size_t elementCount = values.size() / typeCount;
+        AccessorUtils::AccumulateMinMax(quantized.data(), elementCount, typeCount, contents.min, contents.max);
+
+        const size_t elementSize = typeCount * sizeof(T);
+        contents.byteStride = BufferUtils::GetVertexByteStride(elementSize);
+        contents.data = BufferUtils::PadVertexElements(quantized.data(), elementCount, elementSize);
+
+        return contents;
+    }
+
+    std::optional<QuantizedContents> Quantize(const IStreamReader& streamReader, const GLTFDocument& doc, const QuantizationPlan& plan)
+    {
+        GLTFResourceReader reader(streamReader);
+        const auto& accessor = doc.accessors.Get(plan.accessorId);
+        auto values = reader.ReadBinaryData<float>(doc, accessor);
+        const auto typeCount = Accessor::GetTypeCount(accessor.type);
+
+        switch (plan.componentType)
+        {
+        case ComponentType::COMPONENT_BYTE:
+            return Quantize<int8_t>(values, typeCount, plan);
+        case ComponentType::COMPONENT_UNSIGNED_BYTE:
+            return Quantize<uint8_t>(values, typeCount, plan);
+        case ComponentType::COMPONENT_SHORT:
+            return Quantize<int16_t>(values, typeCount, plan);
+        case ComponentType::COMPONENT_UNSIGNED_SHORT:
+            return Quantize<uint16_t>(values, typeCount, plan);
+        default:
+            throw GLTFException("Unsupported quantized component type");
+        }
+    }
+
+    void AddDequantizationNodes(GLTFDocument& doc, const PositionGroup& group, const QuantizationPlan& plan)
+    {
+        // Each node that draws the meshes keeps its transform for its children, and draws them through a new child
+        // node instead, which scales and moves the quantized positions back into place
+        std::vector<Node> nodes(doc.nodes.Elements().begin(), doc.nodes.Elements().end());
+        for (auto& node : nodes)
+        {
+            if (node.meshId.empty() || group.meshIds.count(node.meshId) == 0)
+            {
+                continue;
+            }
+
+            Node meshNode;
+            meshNode.id = std::to_string(doc.nodes.Size());
+            meshNode.meshId = node.meshId;
+            meshNode.translation = Vector3(static_cast<float>(plan.offset[0]), static_cast<float>(plan.offset[1]), static_cast<float>(plan.offset[2]));
+            meshNode.scale = Vector3(static_cast<float>(plan.scale), static_cast<float>(plan.scale), static_cast<float>(plan.scale));
+
+            node.meshId.clear();
+            node.children.push_back(meshNode.id);
+
+            doc.nodes.Replace(node);
+            doc.nodes.Append(std::move(meshNode));
+        }
+    }
+}
+
+GLTFDocument GLTFMeshQuantizationUtils::QuantizeMeshes(const IStreamReader& streamReader, const GLTFDocument& doc, const QuantizationErrorBounds& errorBounds, const std::string& outputDirectory, size_t maxParallelism)
+{
+    GLTFDocument outputDoc(doc);
+
+    QuantizeMeshesInPlace(streamReader, outputDoc, errorBounds, outputDirectory, maxParallelism);
+
+    return outputDoc;
+}
+
+void GLTFMeshQuantizationUtils::QuantizeMeshesInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const QuantizationErrorBounds& errorBounds, const std::string& outputDirectory, size_t maxParallelism)
+{
+    const auto semantics = GetAttributeSemantics(doc);
+    auto positionGroups = GetPositionGroups(doc, semantics);
+
+    // The bounds of the positions decide the transform of each group, so they are read first
+    std::vector<std::pair<size_t, std::string>> positionAccessors;
+    for (size_t i = 0; i < positionGroups.size(); i++)
+    {
+        if (positionGroups[i].quantizable)
+        {
+            for (const auto& id : positionGroups[i].accessorIds)
+            {
+                positionAccessors.emplace_back(i, id);
+            }
+        }
+    }
+
+    std::vector<std::pair<std::vector<float>, std::vector<float>>> positionBounds(positionAccessors.size());
+    ParallelUtils::ParallelFor(positionAccessors.size(), maxParallelism, [&](size_t i)
+    {
+        GLTFResourceReader reader(streamReader);
+        const auto& accessor = doc.accessors.Get(positionAccessors[i].second);
+        positionBounds[i] = AccessorUtils::CalculateMinMax(accessor, reader.ReadBinaryData<float>(doc, accessor));
+    });
+
+    for (size_t i = 0; i < positionAccessors.size(); i++)
+    {
+        auto& group = positionGroups[positionAccessors[i].first];
+        for (size_t axis = 0; axis < 3; axis++)
+        {
+            group.min[axis] = std::min(group.min[axis], static_cast<double>(positionBounds[i].first[axis]));
+            group.max[axis] = std::max(group.max[axis], static_cast<double>(positionBounds[i].second[axis]));
+        }
+    }
+
+    std::vector<QuantizationPlan> plans;
+    std::vector<std::optional<size_t>> groupPlans(positionGroups.size());
+
+    for (size_t i = 0; i < positionGroups.size(); i++)
+    {
+        const auto& group = positionGroups[i];
+
+        // The signed range is symmetric, so the largest side spans 2 * maxValue steps, with an error of half a step
+        auto componentType = ChooseComponentType(errorBounds.position, 1.0 / (4 * 127), 1.0 / (4 * 32767), true);
+        if (!group.quantizable || !componentType)
+        {
+            continue;
+        }
+
+        const double maxValue = *componentType == ComponentType::COMPONENT_BYTE ? 127.0 : 32767.0;
+        double halfExtent = 0;
+        QuantizationPlan plan { {}, AttributeSemantic::Position, *componentType, {}, 1.0 };
+        for (size_t axis = 0; axis < 3; axis++)
+        {
+            plan.offset[axis] = (group.min[axis] + group.max[axis]) / 2;
+            halfExtent = std::max(halfExtent, (group.max[axis] - group.min[axis]) / 2);
+        }
+
+        if (halfExtent > 0)
+        {
+            plan.scale = halfExtent / maxValue;
+        }
+
+        groupPlans[i] = plans.size();
+        for (const auto& id : group.accessorIds)
+        {
+            plan.accessorId = id;
+            plans.push_back(plan);
+        }
+    }
+
+    for (const auto& accessor : doc.accessors.Elements())
+    {
+        auto semantic = semantics.find(accessor.id);
+        if (semantic == semantics.end())
+        {
+            continue;
+        }
+
+        std::optional<ComponentType> componentType;
+        switch (semantic->second)
+        {
+        case AttributeSemantic::Normal:
+            componentType = IsFloatAttribute(accessor, AccessorType::TYPE_VEC3) ? ChooseComponentType(errorBounds.normal, 1.0 / 254, 1.0 / 65534, true) : std::nullopt;
+            break;
+        case AttributeSemantic::Tangent:
+            componentType = IsFloatAttribute(accessor, AccessorType::TYPE_VEC4) ? ChooseComponentType(errorBounds.normal, 1.0 / 254, 1.0 / 65534, true) : std::nullopt;
+            break;
+        case AttributeSemantic::TexCoord:
+            componentType = IsFloatAttribute(accessor, AccessorType::TYPE_VEC2) ? ChooseComponentType(errorBounds.texCoord, 1.0 / 510, 1.0 / 131070, false) : std::nullopt;
+            break;
+        default:
+            break;
+        }
+
+        if (componentType)
+        {
+            plans.push_back({ accessor.id, semantic->second, *componentType, {}, 1.0 });
+        }
+    }
+
+    if (plans.empty())
+    {
+        return;
+    }
+
+    std::vector<std::optional<QuantizedContents>> contents(plans.size());
+    ParallelUtils::ParallelFor(plans.size(), maxParallelism, [&](size_t i)
+    {
+        contents[i] = Quantize(streamReader, doc, plans[i]);
+    });
+
+    if (std::none_of(contents.begin(), contents.end(), [](const std::optional<QuantizedContents>& quantized) { return quantized.has_value(); }))
+    {
+        return;
+    }
+
+    // The document is only changed once every accessor has been read, in the same order for any parallelism
+    BufferWriter writer(doc, outputDirectory, "quantized_meshes.bin");
+
+    for (size_t i = 0; i < plans.size(); i++)
+    {
+        if (!contents[i])
+        {
+            continue;
+        }
+
+        const auto& quantized = *contents[i];
+
+        Accessor accessor(doc.accessors.Get(plans[i].accessorId));
+        accessor.bufferViewId = writer.AddBufferView(quantized.data, quantized.byteStride, BufferViewTarget::ARRAY_BUFFER);
+        accessor.byteOffset = 0;
+        accessor.componentType = plans[i].componentType;
+        accessor.normalized = plans[i].semantic != AttributeSemantic::Position;
+        if (!accessor.min.empty() || plans[i].semantic == AttributeSemantic::Position)
+        {
+            accessor.min = quantized.min;
+            accessor.max = quantized.max;
+        }
+
+        doc.accessors.Replace(accessor);
+    }
+
+    writer.Finish();
+
+    for (size_t i = 0; i < positionGroups.size(); i++)
+    {
+        // Position accessors are always quantized, since they don't depend on the range of the data
+        if (groupPlans[i])
+        {
+            AddDequantizationNodes(doc, positionGroups[i], plans[*groupPlans[i]]);
+        }
+    }
+
+    doc.extensionsUsed.insert(EXTENSION_KHR_MESH_QUANTIZATION);
+    doc.extensionsRequired.insert(EXTENSION_KHR_MESH_QUANTIZATION);
+}
+
+AccessorConversionStrategy GLTFMeshQuantizationUtils::PreserveQuantizedAttributes(const GLTFDocument& doc, const AccessorConversionStrategy& accessorConversion)
+{
+    if (doc.extensionsUsed.count(EXTENSION_KHR_MESH_QUANTIZATION) == 0)
+    {
+        return accessorConversion;
+    }
+
+    std::unordered_set<std::string> quantizedAccessors;
+    for (const auto& mesh : doc.meshes.Elements())
+    {
+        for (const auto& primitive : mesh.primitives)
+        {
+            std::vector<std::string> ids = { primitive.positionsAccessorId, primitive.normalsAccessorId, primitive.tangentsAccessorId, primitive.uv0AccessorId, primitive.uv1AccessorId };
+            for (const auto& target : primitive.targets)
+            {
+                ids.insert(ids.end(), { target.positionsAccessorId, target.normalsAccessorId, target.tangentsAccessorId });
+            }
+
+            for (const auto& id : ids)
+            {
+                if (!id.empty() && doc.accessors.Get(id).componentType != ComponentType::COMPONENT_FLOAT)
+                {
+                    quantizedAccessors.insert(id);
+                }
+            }
+        }
+    }
+
+    return [quantizedAccessors = std::move(quantizedAccessors), accessorConversion](const Accessor& accessor)
+    {
+        if (accessorConversion == nullptr || quantizedAccessors.count(accessor.id) > 0)
+        {
+            return accessor.componentType;
+        }
+
+        return accessorConversion(accessor);
+    };
+}
@@ -0,0 +1,745 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "GLTFMeshSimplifyUtils.h"
+#include "ParallelUtils.h"
+
+#include "GLTFSDK/GLTF.h"
+#include "GLTFSDK/GLTFResourceReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    // Border edges are kept in place by planes perpendicular to their triangles, weighted above the triangle planes
+    const double BORDER_WEIGHT = 10.0;
+
+    // A collapse pass only performs collapses up to this factor of the error at which it would reach its target
+    const double PASS_ERROR_FACTOR = 1.5;
+
+    enum class VertexKind
+    {
+        Manifold,
+        Border,
+        Locked
+    };
+
+    struct Vector3
+    {
+        double x;
+        double y;
+        double z;
+    };
+
+    Vector3 GetPosition(const std::vector<float>& positions, uint32_t vertex)
+    {
+        return { positions[vertex * 3], positions[vertex * 3 + 1], positions[vertex * 3 + 2] };
+    }
+
+    Vector3 Subtract(const Vector3& a, const Vector3& b)
+    {
+        return { a.x - b.x, a.y - b.y, a.z - b.z };
+    }
+
+    Vector3 Cross(const Vector3& a, const Vector3& b)
+    {
+        return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    }
+
+    double Dot(const Vector3& a, const Vector3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    // The sum of the squared distances to a set of weighted planes, stored as the upper half of a symmetric 4x4 matrix
+    struct Quadric
+    {
+        double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+        double ab = 0, ac = 0, ad = 0, bc = 0, bd = 0, cd = 0;
+
+        // Adds the plane with the given unit normal that goes through the point
+        void AddPlane(const Vector3& normal, const Vector3& point, double weight)
+        {
+            double a = normal.x, b = normal.y, c = normal.z;
+            double d = -Dot(normal, point);
+
+            a2 += a * a * weight; b2 += b * b * weight; c2 += c * c * weight; d2 += d * d * weight;
+            ab += a * b * weight; ac += a * c * weight; ad += a * d * weight;
+            bc += b * c * weight; bd += b * d * weight; cd += c * d * weight;
+        }
+
+        void Add(const Quadric& other)
+        {
+            a2 += other.a2; b2 += other.b2; c2 += other.c2; d2 += other.d2;
+            ab += other.ab; ac += other.ac; ad += other.ad;
+            bc += other.bc; bd += other.bd; cd += other.cd;
+        }
+
+        double Evaluate(const Vector3& p) const
+        {
+            double error = a2 * p.x * p.x + b2 * p.y * p.y + c2 * p.z * p.z + d2 +
+                2 * (ab * p.x * p.y + ac * p.x * p.z + bc * p.y * p.z + ad * p.x + bd * p.y + cd * p.z);
+
+            // Rounding can make the error of points on every plane slightly negative
+            return std::max(error, 0.0);
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    uint64_t GetEdgeKey(uint32_t a, uint32_t b)
+    {
+        return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+    }
+
+    // Maps each vertex to the first vertex with the same position, so that seams can be told apart from borders.
+    // Positions are compared bit by bit, which gives a strict order even for NaNs.
+    std::vector<uint32_t> GetPositionRepresentatives(const std::vector<float>& positions, size_t vertexCount)
+    {
+        auto getBits = [&positions](uint32_t vertex, size_t component)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &positions[vertex * 3 + component], sizeof(bits));
+            return bits;
+        };
+
+        auto lessByPosition = [&getBits](uint32_t a, uint32_t b)
+        {
+            for (size_t component = 0; component < 3; component++)
+            {
+                auto bitsA = getBits(a, component);
+                auto bitsB = getBits(b, component);
+                if (bitsA != bitsB)
+                {
+                    return bitsA < bitsB;
+                }
+            }
+
+            return a < b;
+        };
+
+        std::vector<uint32_t> order(vertexCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), lessByPosition);
+
+        std::vector<uint32_t> representatives(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            bool samePosition = i > 0 && std::memcmp(&positions[order[i] * 3], &positions[order[i - 1] * 3], sizeof(float) * 3) == 0;
+            representatives[order[i]] = samePosition ? representatives[order[i - 1]] : order[i];
+        }
+
+        return representatives;
+    }
+
+    // The triangles around each vertex, in compressed rows
+    struct VertexTriangles
+    {
+        VertexTriangles(const std::vector<uint32_t>& indices, size_t vertexCount) :
+            offsets(vertexCount + 1, 0),
+            triangles(indices.size())
+        {
+            for (auto index : indices)
+            {
+                offsets[index + 1]++;
+            }
+
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+            std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                triangles[next[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        std::vector<size_t> offsets;
+        std::vector<uint32_t> triangles;
+    };
+
+    class Simplifier
+    {
+    public:
+        Simplifier(const std::vector<float>& positions, std::vector<uint32_t> indices) :
+            m_positions(positions),
+            m_indices(std::move(indices)),
+            m_vertexCount(positions.size() / 3),
+            m_representatives(GetPositionRepresentatives(positions, m_vertexCount)),
+            m_quadrics(m_vertexCount)
+        {
+            // Vertices that share their position with another are on a seam
+            std::vector<uint32_t> positionUses(m_vertexCount, 0);
+            for (size_t vertex = 0; vertex < m_vertexCount; vertex++)
+            {
+                positionUses[m_representatives[vertex]]++;
+            }
+
+            m_onSeam.resize(m_vertexCount);
+            for (size_t vertex = 0; vertex < m_vertexCount; vertex++)
+            {
+                m_onSeam[vertex] = positionUses[m_representatives[vertex]] > 1;
+            }
+
+            UpdateTopology();
+            InitializeQuadrics();
+        }
+
+        std::vector<uint32_t> Simplify(size_t targetIndexCount)
+        {
+            while (m_indices.size() > targetIndexCount && CollapsePass(targetIndexCount / 3))
+            {
+                UpdateTopology();
+            }
+
+            return std::move(m_indices);
+        }
+
+    private:
+        // Counts the triangles on each edge, and classifies the vertices from it
+        void UpdateTopology()
+        {
+            m_edgeTriangles.clear();
+            m_edgeTriangles.reserve(m_indices.size());
+            for (size_t i = 0; i < m_indices.size(); i += 3)
+            {
+                for (size_t k = 0; k < 3; k++)
+                {
+                    m_edgeTriangles[GetEdgeKey(m_representatives[m_indices[i + k]], m_representatives[m_indices[i + (k + 1) % 3]])]++;
+                }
+            }
+
+            std::vector<uint32_t> borderEdges(m_vertexCount, 0);
+            std::vector<bool> nonManifold(m_vertexCount, false);
+            for (const auto& edge : m_edgeTriangles)
+            {
+                auto a = static_cast<uint32_t>(edge.first >> 32);
+                auto b = static_cast<uint32_t>(edge.first & 0xFFFFFFFF);
+                if (edge.second == 1)
+                {
+                    borderEdges[a]++;
+                    borderEdges[b]++;
+                }
+                else if (edge.second > 2)
+                {
+                    nonManifold[a] = true;
+                    nonManifold[b] = true;
+                }
+            }
+
+            m_kinds.assign(m_vertexCount, VertexKind::Manifold);
+            for (size_t vertex = 0; vertex < m_vertexCount; vertex++)
+            {
+                auto representative = m_representatives[vertex];
+                if (m_onSeam[vertex] || nonManifold[representative] || (borderEdges[representative] != 0 && borderEdges[representative] != 2))
+                {
+                    m_kinds[vertex] = VertexKind::Locked;
+                }
+                else if (borderEdges[representative] == 2)
+                {
+                    m_kinds[vertex] = VertexKind::Border;
+                }
+            }
+        }
+
+        // Quadrics are accumulated per position, so that the vertices of a seam share theirs
+        void InitializeQuadrics()
+        {
+            for (size_t i = 0; i < m_indices.size(); i += 3)
+            {
+                uint32_t triangle[3] = { m_representatives[m_indices[i]], m_representatives[m_indices[i + 1]], m_representatives[m_indices[i + 2]] };
+                Vector3 points[3] = { GetPosition(m_positions, triangle[0]), GetPosition(m_positions, triangle[1]), GetPosition(m_positions, triangle[2]) };
+
+                auto normal = Cross(Subtract(points[1], points[0]), Subtract(points[2], points[0]));
+                auto doubleArea = std::sqrt(Dot(normal, normal));
+                if (doubleArea == 0)
+                {
+                    continue;
+                }
+
+                Vector3 unitNormal = { normal.x / doubleArea, normal.y / doubleArea, normal.z / doubleArea };
+                for (size_t k = 0; k < 3; k++)
+                {
+                    m_quadrics[triangle[k]].AddPlane(unitNormal, points[0], doubleArea * 0.5);
+                }
+
+                for (size_t k = 0; k < 3; k++)
+                {
+                    auto a = triangle[k];
+                    auto b = triangle[(k + 1) % 3];
+                    if (m_edgeTriangles[GetEdgeKey(a, b)] != 1)
+                    {
+                        continue;
+                    }
+
+                    auto edge = Subtract(points[(k + 1) % 3], points[k]);
+                    auto borderNormal = Cross(edge, unitNormal);
+                    auto length = std::sqrt(Dot(borderNormal, borderNormal));
+                    if (length == 0)
+                    {
+                        continue;
+                    }
+
+                    Vector3 unitBorderNormal = { borderNormal.x / length, borderNormal.y / length, borderNormal.z / length };
+                    m_quadrics[a].AddPlane(unitBorderNormal, points[k], length * length * BORDER_WEIGHT);
+                    m_quadrics[b].AddPlane(unitBorderNormal, points[k], length * length * BORDER_WEIGHT);
+                }
+            }
+        }
+
+        bool CanCollapse(uint32_t from, uint32_t to) const
+        {
+            if (m_representatives[from] == m_representatives[to])
+            {
+                return false;
+            }
+
+            switch (m_kinds[from])
+            {
+            case VertexKind::Manifold:
+                return true;
+            case VertexKind::Border:
+                return m_edgeTriangles.at(GetEdgeKey(m_representatives[from], m_representatives[to])) == 1;
+            default:
+                return false;
+            }
+        }
+
+        // Checks that moving a vertex keeps the surface around it intact, and returns the number of triangles it removes, or 0
+        size_t GetRemovedTriangles(const VertexTriangles& adjacency, const Collapse& collapse) const
+        {
+            auto target = GetPosition(m_positions, collapse.to);
+            auto targetPosition = m_representatives[collapse.to];
+
+            size_t removed = 0;
+            std::vector<uint32_t> fromNeighbors;
+            for (size_t t = adjacency.offsets[collapse.from]; t < adjacency.offsets[collapse.from + 1]; t++)
+            {
+                const uint32_t* triangle = &m_indices[adjacency.triangles[t] * 3];
+                size_t k = triangle[0] == collapse.from ? 0 : (triangle[1] == collapse.from ? 1 : 2);
+                auto b = triangle[(k + 1) % 3];
+                auto c = triangle[(k + 2) % 3];
+
+                if (b == collapse.to || c == collapse.to)
+                {
+                    fromNeighbors.push_back(m_representatives[b == collapse.to ? c : b]);
+                    removed++;
+                    continue;
+                }
+
+                // Pulling a vertex across a seam would stretch the attributes of the other side
+                if (m_representatives[b] == targetPosition || m_representatives[c] == targetPosition)
+                {
+                    return 0;
+                }
+
+                auto pointB = GetPosition(m_positions, b);
+                auto pointC = GetPosition(m_positions, c);
+                auto before = Cross(Subtract(pointB, GetPosition(m_positions, collapse.from)), Subtract(pointC, GetPosition(m_positions, collapse.from)));
+                auto after = Cross(Subtract(pointB, target), Subtract(pointC, target));
+                if (Dot(before, after) <= 0)
+                {
+                    return 0;
+                }
+
+                fromNeighbors.push_back(m_representatives[b]);
+                fromNeighbors.push_back(m_representatives[c]);
+            }
+
+            // The vertices can only share the neighbors opposite to the removed triangles (the link condition),
+            // otherwise the collapse would fold the surface onto itself
+            std::vector<uint32_t> toNeighbors;
+            for (size_t t = adjacency.offsets[collapse.to]; t < adjacency.offsets[collapse.to + 1]; t++)
+            {
+                const uint32_t* triangle = &m_indices[adjacency.triangles[t] * 3];
+                for (size_t k = 0; k < 3; k++)
+                {
+                    if (triangle[k] != collapse.to && triangle[k] != collapse.from)
+                    {
+                        toNeighbors.push_back(m_representatives[triangle[k]]);
+                    }
+                }
+            }
+
+            std::sort(fromNeighbors.begin(), fromNeighbors.end());
+            fromNeighbors.erase(std::unique(fromNeighbors.begin(), fromNeighbors.end()), fromNeighbors.end());
+            std::sort(toNeighbors.begin(), toNeighbors.end());
+            toNeighbors.erase(std::unique(toNeighbors.begin(), toNeighbors.end()), toNeighbors.end());
+
+            std::vector<uint32_t> sharedNeighbors;
+            std::set_intersection(fromNeighbors.begin(), fromNeighbors.end(), toNeighbors.begin(), toNeighbors.end(), std::back_inserter(sharedNeighbors));
+
+            return sharedNeighbors.size() == removed ? removed : 0;
+        }
+
+        // Performs as many independent collapses as possible, cheapest first, and returns whether any was performed
+        bool CollapsePass(size_t targetTriangleCount)
+        {
+            std::vector<Collapse> candidates;
+            candidates.reserve(m_indices.size() * 2);
+            for (size_t i = 0; i < m_indices.size(); i += 3)
+            {
+                for (size_t k = 0; k < 3; k++)
+                {
+                    auto a = m_indices[i + k];
+                    auto b = m_indices[i + (k + 1) % 3];
+
+                    if (CanCollapse(a, b))
+                    {
+                        candidates.push_back({ a, b, m_quadrics[m_representatives[a]].Evaluate(GetPosition(m_positions, b)) });
+                    }
+
+                    if (CanCollapse(b, a))
+                    {
+                        candidates.push_back({ b, a, m_quadrics[m_representatives[b]].Evaluate(GetPosition(m_positions, a)) });
+                    }
+                }
+            }
+
+            if (candidates.empty())
+            {
+                return false;
+            }
+
+            std::stable_sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+            // Each collapse removes up to two triangles, so only the cheapest collapses that reach the target are considered
+            size_t triangleCount = m_indices.size() / 3;
+            size_t goal = std::min(candidates.size() - 1, (triangleCount - targetTriangleCount) / 2);
+            double errorLimit = candidates[goal].cost * PASS_ERROR_FACTOR;
+
+            VertexTriangles adjacency(m_indices, m_vertexCount);
+            std::vector<uint32_t> remap(m_vertexCount);
+            std::iota(remap.begin(), remap.end(), 0);
+            std::vector<bool> touched(m_vertexCount, false);
+
+            bool collapsed = false;
+            for (const auto& collapse : candidates)
+            {
+                if (collapse.cost > errorLimit || triangleCount <= targetTriangleCount)
+                {
+                    break;
+                }
+
+                if (touched[collapse.from] || touched[collapse.to])
+                {
+                    continue;
+                }
+
+                size_t removed = GetRemovedTriangles(adjacency, collapse);
+                if (removed == 0)
+                {
+                    continue;
+                }
+
+                remap[collapse.from] = collapse.to;
+                m_quadrics[m_representatives[collapse.to]].Add(m_quadrics[m_representatives[collapse.from]]);
+                triangleCount -= std::min(removed, triangleCount);
+                collapsed = true;
+
+                // The triangles around the moved vertex change, so none of their vertices can collapse again in this pass
+                for (size_t t = adjacency.offsets[collapse.from]; t < adjacency.offsets[collapse.from + 1]; t++)
+                {
+                    const uint32_t* triangle = &m_indices[adjacency.triangles[t] * 3];
+                    touched[triangle[0]] = true;
+                    touched[triangle[1]] = true;
+                    touched[triangle[2]] = true;
+                }
+            }
+
+            if (!collapsed)
+            {
+                return false;
+            }
+
+            size_t outputSize = 0;
+            for (size_t i = 0; i < m_indices.size(); i += 3)
+            {
+                auto a = remap[m_indices[i]];
+                auto b = remap[m_indices[i + 1]];
+                auto c = remap[m_indices[i + 2]];
+
+                if (a != b && b != c && a != c)
+                {
+                    m_indices[outputSize++] = a;
+                    m_indices[outputSize++] = b;
+                    m_indices[outputSize++] = c;
+                }
+            }
+
+            m_indices.resize(outputSize);
+            return true;
+        }
+
+        const std::vector<float>& m_positions;
+        std::vector<uint32_t> m_indices;
+        const size_t m_vertexCount;
+        const std::vector<uint32_t> m_representatives;
+        std::vector<bool> m_onSeam;
+        std::vector<Quadric> m_quadrics;
+        std::vector<VertexKind> m_kinds;
+        std::unordered_map<uint64_t, uint32_t> m_edgeTriangles;
+    };
+
+    template <typename T>
+    std::vector<uint32_t> ReadIndices(const GLTFResourceReader& reader, const GLTFDocument& doc, const Accessor& accessor)
+    {
+        auto data = reader.ReadBinaryData<T>(doc, accessor);
+        return std::vector<uint32_t>(data.begin(), data.end());
+    }
+
+    std::vector<uint32_t> ReadIndices(const GLTFResourceReader& reader, const GLTFDocument& doc, const MeshPrimitive& primitive, size_t vertexCount)
+    {
+        if (primitive.indicesAccessorId.empty())
+        {
+            std::vector<uint32_t> indices(vertexCount);
+            std::iota(indices.begin(), indices.end(), 0);
+            return indices;
+        }
+
+        const auto& accessor = doc.accessors.Get(primitive.indicesAccessorId);
+        switch (accessor.componentType)
+        {
+        case ComponentType::COMPONENT_UNSIGNED_BYTE:
+            return ReadIndices<uint8_t>(reader, doc, accessor);
+        case ComponentType::COMPONENT_UNSIGNED_SHORT:
+            return ReadIndices<uint16_t>(reader, doc, accessor);
+        case ComponentType::COMPONENT_UNSIGNED_INT:
+            return ReadIndices<uint32_t>(reader, doc, accessor);
+        default:
+            throw GLTFException("Invalid index component type in accessor " + accessor.id);
+        }
+    }
+
+    bool CanSimplify(const GLTFDocument& doc, const MeshPrimitive& primitive)
+    {
+        if (primitive.mode != MeshMode::MESH_TRIANGLES || primitive.positionsAccessorId.empty())
+        {
+            return false;
+        }
+
+        const auto& positions = doc.accessors.Get(primitive.positionsAccessorId);
+        return positions.componentType == ComponentType::COMPONENT_FLOAT && positions.type == AccessorType::TYPE_VEC3 && !positions.bufferViewId.empty();
+    }
+
+    // The simplified indices of one primitive, for each LOD
+    struct SimplifiedPrimitive
+    {
+        std::string meshId;
+        size_t primitiveIndex;
+        size_t vertexCount;
+        size_t indexCount;
+        std::vector<std::vector<uint32_t>> lods;
+    };
+
+    std::wstring CombinePath(const std::string& directory, const std::string& fileName)
+    {
+        std::wstring directoryW(directory.begin(), directory.end());
+        std::wstring fileNameW(fileName.begin(), fileName.end());
+
+        wchar_t fullPath[MAX_PATH];
+
+        if (FAILED(::PathCchCombine(fullPath, ARRAYSIZE(fullPath), directoryW.c_str(), fileNameW.c_str())))
+        {
+            throw GLTFException("Failed to compose output file path.");
+        }
+
+        return fullPath;
+    }
+
+    template <typename T>
+    void WriteIndices(std::ostream& output, const std::vector<uint32_t>& indices)
+    {
+        std::vector<T> data(indices.size());
+        std::transform(indices.begin(), indices.end(), data.begin(), [](uint32_t index) { return static_cast<T>(index); });
+        output.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+    }
+
+    // Writes each simplified primitive of one LOD to a new buffer, and points the primitives to it
+    void AddSimplifiedIndices(GLTFDocument& lodDoc, const std::vector<SimplifiedPrimitive>& primitives, size_t lod, const std::string& outputDirectory, const std::string& fileName)
+    {
+        auto bufferPath = CombinePath(outputDirectory, fileName);
+        std::ofstream output;
+
+        Buffer buffer;
+        buffer.id = std::to_string(lodDoc.buffers.Size());
+        buffer.byteLength = 0;
+
+        for (const auto& primitive : primitives)
+        {
+            const auto& indices = primitive.lods[lod];
+            if (indices.size() == primitive.indexCount)
+            {
+                continue;
+            }
+
+            auto mesh = lodDoc.meshes.Get(primitive.meshId);
+            auto& meshPrimitive = mesh.primitives[primitive.primitiveIndex];
+
+            // Keep the smallest index type that the original indices allowed
+            ComponentType componentType = primitive.vertexCount <= std::numeric_limits<uint16_t>::max() ? ComponentType::COMPONENT_UNSIGNED_SHORT : ComponentType::COMPONENT_UNSIGNED_INT;
+            if (!meshPrimitive.indicesAccessorId.empty())
+            {
+                componentType = lodDoc.accessors.Get(meshPrimitive.indicesAccessorId).componentType;
+            }
+
+            if (!output.is_open())
+            {
+                output.open(bufferPath, std::ios::binary);
+            }
+
+            size_t byteOffset = (buffer.byteLength + 3) & ~static_cast<size_t>(3);
+            static const char padding[4] = {};
+            output.write(padding, byteOffset - buffer.byteLength);
+
+            switch (componentType)
+            {
+            case ComponentType::COMPONENT_UNSIGNED_BYTE:
+                WriteIndices<uint8_t>(output, indices);
+                break;
+            case ComponentType::COMPONENT_UNSIGNED_SHORT:
+                WriteIndices<uint16_t>(output, indices);
+                break;
+            default:
+                WriteIndices<uint32_t>(output, indices);
+                break;
+            }
+
+            BufferView bufferView;
+            bufferView.id = std::to_string(lodDoc.bufferViews.Size());
+            bufferView.bufferId = buffer.id;
+            bufferView.byteOffset = byteOffset;
+            bufferView.byteLength = indices.size() * Accessor::GetComponentTypeSize(componentType);
+            bufferView.target = BufferViewTarget::ELEMENT_ARRAY_BUFFER;
+
+            Accessor accessor;
+            accessor.id = std::to_string(lodDoc.accessors.Size());
+            accessor.bufferViewId = bufferView.id;
+            accessor.byteOffset = 0;
+            accessor.componentType = componentType;
+            accessor.type = AccessorType::TYPE_SCALAR;
+            accessor.count = indices.size();
+
+            meshPrimitive.indicesAccessorId = accessor.id;
+            buffer.byteLength = bufferView.byteOffset + bufferView.byteLength;
+
+            lodDoc.bufferViews.Append(std::move(bufferView));
+            lodDoc.accessors.Append(std::move(accessor));
+            lodDoc.meshes.Replace(mesh);
+        }
+
+        if (!output.is_open())
+        {
+            return;
+        }
+
+        output.close();
+        if (output.fail())
+        {
+            throw GLTFException("Failed to write " + fileName);
+        }
+
+        buffer.uri = std::string(bufferPath.begin(), bufferPath.end());
+        lodDoc.buffers.Append(std::move(buffer));
+    }
+}
+
+std::vector<uint32_t> GLTFMeshSimplifyUtils::SimplifyTriangles(const std::vector<float>& positions, const std::vector<uint32_t>& indices, size_t targetIndexCount)
+{
+    if (positions.size() % 3 != 0 || indices.size() % 3 != 0)
+    {
+        throw std::invalid_argument("SimplifyTriangles requires three floats per position and three indices per triangle");
+    }
+
+    size_t vertexCount = positions.size() / 3;
+    if (std::any_of(indices.begin(), indices.end(), [vertexCount](uint32_t index) { return index >= vertexCount; }))
+    {
+        throw std::invalid_argument("SimplifyTriangles passed an index out of range");
+    }
+
+    if (indices.size() <= targetIndexCount)
+    {
+        return indices;
+    }
+
+    return Simplifier(positions, indices).Simplify(targetIndexCount);
+}
+
+std::vector<GLTFDocument> GLTFMeshSimplifyUtils::GenerateLODs(const IStreamReader& streamReader, const GLTFDocument& doc, const std::vector<double>& triangleRatios, const std::string& outputDirectory, size_t maxParallelism)
+{
+    std::vector<SimplifiedPrimitive> primitives;
+    for (const auto& mesh : doc.meshes.Elements())
+    {
+        for (size_t i = 0; i < mesh.primitives.size(); i++)
+        {
+            if (CanSimplify(doc, mesh.primitives[i]))
+            {
+                primitives.push_back({ mesh.id, i, 0, 0, {} });
+            }
+        }
+    }
+
+    // Decimation is the expensive part, so each primitive is simplified on its own worker
+    ParallelUtils::ParallelFor(primitives.size(), maxParallelism, [&](size_t primitiveIndex)
+    {
+        auto& primitive = primitives[primitiveIndex];
+        const auto& meshPrimitive = doc.meshes.Get(primitive.meshId).primitives[primitive.primitiveIndex];
+
+        GLTFResourceReader reader(streamReader);
+        auto positions = reader.ReadBinaryData<float>(doc, doc.accessors.Get(meshPrimitive.positionsAccessorId));
+        primitive.vertexCount = positions.size() / 3;
+
+        auto indices = ReadIndices(reader, doc, meshPrimitive, primitive.vertexCount);
+        primitive.indexCount = indices.size();
+        auto triangleCount = static_cast<double>(indices.size() / 3);
+
+        for (auto ratio : triangleRatios)
+        {
+            auto targetIndexCount = static_cast<size_t>(std::max(ratio, 0.0) * triangleCount) * 3;
+            indices = SimplifyTriangles(positions, indices, targetIndexCount);
+            primitive.lods.push_back(indices);
+        }
+    });
+
+    std::vector<GLTFDocument> lodDocs;
+    lodDocs.reserve(triangleRatios.size());
+    for (size_t lod = 0; lod < triangleRatios.size(); lod++)
+    {
+        GLTFDocument lodDoc(doc);
+        AddSimplifiedIndices(lodDoc, primitives, lod, outputDirectory, "simplified_lod" + std::to_string(lod + 1) + ".bin");
+        lodDocs.push_back(std::move(lodDoc));
+    }
+
+    return lodDocs;
+}
+
+std::vector<double> GLTFMeshSimplifyUtils::GetTriangleRatios(const std::vector<double>& screenCoveragePercentages)
+{
+    std::vector<double> ratios;
+    if (screenCoveragePercentages.empty() || screenCoveragePercentages[0] <= 0)
+    {
+        return ratios;
+    }
+
+    for (size_t i = 1; i < screenCoveragePercentages.size(); i++)
+    {
+        ratios.push_back(std::min(screenCoveragePercentages[i] / screenCoveragePercentages[0], 1.0));
+    }
+
+    return ratios;
+}
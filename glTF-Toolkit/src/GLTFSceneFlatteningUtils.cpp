@@ -0,0 +1,818 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "GLTFSceneFlatteningUtils.h"
+#include "GLTFExtensionUtils.h"
+#include "GLTFLODUtils.h"
+#include "BufferUtils.h"
+#include "Instrumentation.h"
+#include "ParallelUtils.h"
+
+#include "GLTFSDK/GLTF.h"
+#include "GLTFSDK/GLTFResourceReader.h"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    // A 4x4 transform, in column-major order like glTF
+    typedef std::array<double, 16> Transform;
+
+    const Transform IDENTITY_TRANSFORM = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+    Transform Multiply(const Transform& a, const Transform& b)
+    {
+        Transform result = {};
+        for (size_t column = 0; column < 4; column++)
+        {
+            for (size_t row = 0; row < 4; row++)
+            {
+                for (size_t k = 0; k < 4; k++)
+                {
+                    result[column * 4 + row] += a[k * 4 + row] * b[column * 4 + k];
+                }
+            }
+        }
+
+        return result;
+    }
+
+    Transform GetLocalTransform(const Node& node)
+    {
+        Transform transform;
+        if (node.GetTransformationType() == TransformationType::TRANSFORMATION_MATRIX)
+        {
+            std::copy(node.matrix.values.begin(), node.matrix.values.end(), transform.begin());
+            return transform;
+        }
+
+        // translation * rotation * scale
+        const double x = node.rotation.x;
+        const double y = node.rotation.y;
+        const double z = node.rotation.z;
+        const double w = node.rotation.w;
+
+        transform =
+        {
+            (1 - 2 * (y * y + z * z)) * node.scale.x, 2 * (x * y + z * w) * node.scale.x, 2 * (x * z - y * w) * node.scale.x, 0,
+            2 * (x * y - z * w) * node.scale.y, (1 - 2 * (x * x + z * z)) * node.scale.y, 2 * (y * z + x * w) * node.scale.y, 0,
+            2 * (x * z + y * w) * node.scale.z, 2 * (y * z - x * w) * node.scale.z, (1 - 2 * (x * x + y * y)) * node.scale.z, 0,
+            node.translation.x, node.translation.y, node.translation.z, 1
+        };
+
+        return transform;
+    }
+
+    double GetDeterminant(const Transform& m)
+    {
+        return m[0] * (m[5] * m[10] - m[9] * m[6]) - m[4] * (m[1] * m[10] - m[9] * m[2]) + m[8] * (m[1] * m[6] - m[5] * m[2]);
+    }
+
+    // The matrix that transforms normals: the inverse transpose of the linear part, up to a positive scale, since
+    // normals are normalized after being transformed
+    std::array<double, 9> GetNormalTransform(const Transform& m)
+    {
+        const double sign = GetDeterminant(m) < 0 ? -1.0 : 1.0;
+        return {
+            sign * (m[5] * m[10] - m[6] * m[9]), sign * (m[6] * m[8] - m[4] * m[10]), sign * (m[4] * m[9] - m[5] * m[8]),
+            sign * (m[9] * m[2] - m[10] * m[1]), sign * (m[10] * m[0] - m[8] * m[2]), sign * (m[8] * m[1] - m[9] * m[0]),
+            sign * (m[1] * m[6] - m[2] * m[5]), sign * (m[2] * m[4] - m[0] * m[6]), sign * (m[0] * m[5] - m[1] * m[4]) };
+    }
+
+    void Normalize(float* vector)
+    {
+        const double length = std::sqrt(static_cast<double>(vector[0]) * vector[0] + static_cast<double>(vector[1]) * vector[1] + static_cast<double>(vector[2]) * vector[2]);
+        if (length > 0)
+        {
+            for (size_t i = 0; i < 3; i++)
+            {
+                vector[i] = static_cast<float>(vector[i] / length);
+            }
+        }
+    }
+
+    bool IsFloatAccessor(const GLTFDocument& doc, const std::string& accessorId, AccessorType type)
+    {
+        const auto& accessor = doc.accessors.Get(accessorId);
+        return accessor.componentType == ComponentType::COMPONENT_FLOAT && accessor.type == type;
+    }
+
+    // Whether the vertices of the mesh can be transformed and merged: triangles with float positions, normals and tangents,
+    // without morph targets, skinning or extensions, which could depend on the vertices or their order
+    bool IsMergeable(const GLTFDocument& doc, const Mesh& mesh)
+    {
+        if (!mesh.extensions.empty())
+        {
+            return false;
+        }
+
+        for (const auto& primitive : mesh.primitives)
+        {
+            if (primitive.mode != MeshMode::MESH_TRIANGLES || !primitive.targets.empty() || !primitive.extensions.empty() ||
+                primitive.positionsAccessorId.empty() || !primitive.joints0AccessorId.empty() || !primitive.weights0AccessorId.empty())
+            {
+                return false;
+            }
+
+            for (const auto& id : BufferUtils::GetAttributeIds(primitive))
+            {
+                if (!id.empty() && doc.accessors.Get(id).bufferViewId.empty())
+                {
+                    return false;
+                }
+            }
+
+            if (!IsFloatAccessor(doc, primitive.positionsAccessorId, AccessorType::TYPE_VEC3) ||
+                (!primitive.normalsAccessorId.empty() && !IsFloatAccessor(doc, primitive.normalsAccessorId, AccessorType::TYPE_VEC3)) ||
+                (!primitive.tangentsAccessorId.empty() && !IsFloatAccessor(doc, primitive.tangentsAccessorId, AccessorType::TYPE_VEC4)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Primitives are merged if they use the same material and have the same attribute types
+    std::string GetMergeKey(const GLTFDocument& doc, const MeshPrimitive& primitive)
+    {
+        std::string key = primitive.materialId;
+        for (const auto& id : BufferUtils::GetAttributeIds(primitive))
+        {
+            key += "|";
+            if (!id.empty())
+            {
+                const auto& accessor = doc.accessors.Get(id);
+                key += std::to_string(static_cast<int>(accessor.type)) + "," + std::to_string(static_cast<int>(accessor.componentType)) + "," + (accessor.normalized ? "n" : "");
+            }
+        }
+
+        return key;
+    }
+
+    template <typename T>
+    std::vector<uint32_t> ReadIndices(const GLTFResourceReader& reader, const GLTFDocument& doc, const Accessor& accessor)
+    {
+        auto data = reader.ReadBinaryData<T>(doc, accessor);
+        return std::vector<uint32_t>(data.begin(), data.end());
+    }
+
+    std::vector<uint32_t> ReadIndices(const GLTFResourceReader& reader, const GLTFDocument& doc, const MeshPrimitive& primitive, size_t vertexCount)
+    {
+        if (primitive.indicesAccessorId.empty())
+        {
+            std::vector<uint32_t> indices(vertexCount);
+            std::iota(indices.begin(), indices.end(), 0);
+            return indices;
+        }
+
+        const auto& accessor = doc.accessors.Get(primitive.indicesAccessorId);
+        switch (accessor.componentType)
+        {
+        case ComponentType::COMPONENT_UNSIGNED_BYTE:
+            return ReadIndices<uint8_t>(reader, doc, accessor);
+        case ComponentType::COMPONENT_UNSIGNED_SHORT:
+            return ReadIndices<uint16_t>(reader, doc, accessor);
+        case ComponentType::COMPONENT_UNSIGNED_INT:
+            return ReadIndices<uint32_t>(reader, doc, accessor);
+        default:
+            throw GLTFException("Invalid index component type in accessor " + accessor.id);
+        }
+    }
+
+    template <typename T>
+    std::vector<uint8_t> GetIndexData(const std::vector<uint32_t>& indices)
+    {
+        std::vector<uint8_t> data(indices.size() * sizeof(T));
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            T index = static_cast<T>(indices[i]);
+            std::memcpy(&data[i * sizeof(T)], &index, sizeof(T));
+        }
+
+        return data;
+    }
+
+    // A mesh drawn by a removed node, in the space of the kept node it is merged into
+    struct MeshInstance
+    {
+        std::string meshId;
+        Transform transform;
+    };
+
+    // The vertices and indices of the primitives of one material, from every mesh instance of a kept node
+    struct MergedPrimitive
+    {
+        MeshPrimitive primitive;
+        std::array<MergedVertexAttribute, ATTRIBUTE_COUNT> attributes;
+        size_t vertexCount;
+        std::vector<uint32_t> indices;
+    };
+
+    // Appends the vertices of a primitive, transformed, to the merged primitive
+    void AppendPrimitive(const GLTFResourceReader& reader, const GLTFDocument& doc, const MeshPrimitive& primitive, const Transform& transform, MergedPrimitive& merged)
+    {
+        const auto attributeIds = BufferUtils::GetAttributeIds(primitive);
+        const auto vertexCount = doc.accessors.Get(primitive.positionsAccessorId).count;
+
+        for (size_t attribute = 0; attribute < ATTRIBUTE_COUNT; attribute++)
+        {
+            if (attributeIds[attribute].empty())
+            {
+                continue;
+            }
+
+            const auto& accessor = doc.accessors.Get(attributeIds[attribute]);
+            if (accessor.count != vertexCount)
+            {
+                throw GLTFException("The vertex accessors of a primitive have different counts.");
+            }
+
+            if (attribute == POSITION_ATTRIBUTE)
+            {
+                auto positions = reader.ReadBinaryData<float>(doc, accessor);
+                for (size_t i = 0; i + 2 < positions.size(); i += 3)
+                {
+                    const double p[3] = { positions[i], positions[i + 1], positions[i + 2] };
+                    for (size_t row = 0; row < 3; row++)
+                    {
+                        positions[i + row] = static_cast<float>(transform[row] * p[0] + transform[4 + row] * p[1] + transform[8 + row] * p[2] + transform[12 + row]);
+                    }
+                }
+
+                BufferUtils::AppendFloats(positions, 3, merged.attributes[attribute]);
+            }
+            else if (attribute == NORMAL_ATTRIBUTE || attribute == TANGENT_ATTRIBUTE)
+            {
+                // Normals transform with the inverse transpose, tangents with the transform itself. The handedness of tangents
+                // flips with a mirroring transform, like the winding of the triangles.
+                const size_t typeCount = attribute == NORMAL_ATTRIBUTE ? 3 : 4;
+                std::array<double, 9> linear;
+                if (attribute == NORMAL_ATTRIBUTE)
+                {
+                    linear = GetNormalTransform(transform);
+                }
+                else
+                {
+                    linear = { transform[0], transform[1], transform[2], transform[4], transform[5], transform[6], transform[8], transform[9], transform[10] };
+                }
+
+                const bool mirrored = GetDeterminant(transform) < 0;
+
+                auto vectors = reader.ReadBinaryData<float>(doc, accessor);
+                for (size_t i = 0; i + typeCount - 1 < vectors.size(); i += typeCount)
+                {
+                    const double v[3] = { vectors[i], vectors[i + 1], vectors[i + 2] };
+                    for (size_t row = 0; row < 3; row++)
+                    {
+                        vectors[i + row] = static_cast<float>(linear[row] * v[0] + linear[3 + row] * v[1] + linear[6 + row] * v[2]);
+                    }
+
+                    Normalize(&vectors[i]);
+
+                    if (typeCount == 4 && mirrored)
+                    {
+                        vectors[i + 3] = -vectors[i + 3];
+                    }
+                }
+
+                // The bounds of directions are optional, and would have to be measured again
+                merged.attributes[attribute].hasBounds = false;
+                BufferUtils::AppendFloats(vectors, typeCount, merged.attributes[attribute]);
+            }
+            else
+            {
+                BufferUtils::AppendElements(reader, doc, accessor, merged.attributes[attribute]);
+            }
+        }
+
+        const bool mirrored = GetDeterminant(transform) < 0;
+        const auto firstVertex = static_cast<uint32_t>(merged.vertexCount);
+
+        auto indices = ReadIndices(reader, doc, primitive, vertexCount);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            merged.indices.push_back(firstVertex + indices[i]);
+            merged.indices.push_back(firstVertex + indices[mirrored ? i + 2 : i + 1]);
+            merged.indices.push_back(firstVertex + indices[mirrored ? i + 1 : i + 2]);
+        }
+
+        merged.vertexCount += vertexCount;
+    }
+
+    // Merges the primitives of every mesh instance of a kept node by material, in the order they are first drawn
+    std::vector<MergedPrimitive> MergeInstances(const IStreamReader& streamReader, const GLTFDocument& doc, const std::vector<MeshInstance>& instances)
+    {
+        GLTFResourceReader reader(streamReader);
+
+        std::vector<MergedPrimitive> mergedPrimitives;
+        std::unordered_map<std::string, size_t> mergedIndices;
+        for (const auto& instance : instances)
+        {
+            for (const auto& primitive : doc.meshes.Get(instance.meshId).primitives)
+            {
+                auto inserted = mergedIndices.emplace(GetMergeKey(doc, primitive), mergedPrimitives.size());
+                if (inserted.second)
+                {
+                    MergedPrimitive merged;
+                    merged.primitive = primitive;
+                    merged.vertexCount = 0;
+                    mergedPrimitives.push_back(std::move(merged));
+                }
+
+                AppendPrimitive(reader, doc, primitive, instance.transform, mergedPrimitives[inserted.first->second]);
+            }
+        }
+
+        return mergedPrimitives;
+    }
+
+    std::string AddMergedMesh(GLTFDocument& doc, BufferWriter& writer, std::vector<MergedPrimitive>& mergedPrimitives, const std::string& name)
+    {
+        Mesh mesh;
+        mesh.id = std::to_string(doc.meshes.Size());
+        mesh.name = name;
+
+        for (auto& merged : mergedPrimitives)
+        {
+            auto attributeIds = BufferUtils::GetAttributeIds(merged.primitive);
+            for (size_t attribute = 0; attribute < ATTRIBUTE_COUNT; attribute++)
+            {
+                if (attributeIds[attribute].empty())
+                {
+                    continue;
+                }
+
+                attributeIds[attribute] = BufferUtils::AddVertexAccessor(doc, writer, doc.accessors.Get(attributeIds[attribute]), merged.attributes[attribute], merged.vertexCount);
+
+                // The vertices are in the file, and no longer needed in memory
+                std::vector<uint8_t>().swap(merged.attributes[attribute].elements);
+            }
+
+            MeshPrimitive primitive(merged.primitive);
+            BufferUtils::SetAttributeIds(primitive, attributeIds);
+
+            const bool shortIndices = merged.vertexCount <= std::numeric_limits<uint16_t>::max();
+
+            Accessor indicesAccessor;
+            indicesAccessor.id = std::to_string(doc.accessors.Size());
+            indicesAccessor.bufferViewId = writer.AddBufferView(shortIndices ? GetIndexData<uint16_t>(merged.indices) : GetIndexData<uint32_t>(merged.indices), 0, BufferViewTarget::ELEMENT_ARRAY_BUFFER);
+            indicesAccessor.byteOffset = 0;
+            indicesAccessor.componentType = shortIndices ? ComponentType::COMPONENT_UNSIGNED_SHORT : ComponentType::COMPONENT_UNSIGNED_INT;
+            indicesAccessor.type = AccessorType::TYPE_SCALAR;
+            indicesAccessor.count = merged.indices.size();
+
+            primitive.indicesAccessorId = indicesAccessor.id;
+            doc.accessors.Append(std::move(indicesAccessor));
+
+            mesh.primitives.push_back(std::move(primitive));
+        }
+
+        auto id = mesh.id;
+        doc.meshes.Append(std::move(mesh));
+        return id;
+    }
+
+    // Maps the ids of the elements that are kept to their new, consecutive indices
+    class Renumbering
+    {
+    public:
+        explicit Renumbering(const std::vector<bool>& kept)
+        {
+            m_ids.resize(kept.size());
+
+            size_t next = 0;
+            for (size_t i = 0; i < kept.size(); i++)
+            {
+                if (kept[i])
+                {
+                    m_ids[i] = std::to_string(next++);
+                }
+            }
+        }
+
+        void Remap(std::string& id) const
+        {
+            if (!id.empty())
+            {
+                id = m_ids[std::stoul(id)];
+            }
+        }
+
+        size_t GetIndex(size_t index) const
+        {
+            return std::stoul(m_ids[index]);
+        }
+
+    private:
+        std::vector<std::string> m_ids;
+    };
+
+    // Rewrites the node indices of an MSFT_lod extension
+    void RemapLODIds(std::string& json, const Renumbering& nodes)
+    {
+        GLTFExtensionUtils::RemapIndices(json, { { MSFT_LOD_IDS_KEY, "[]" } }, [&nodes](size_t index) { return nodes.GetIndex(index); });
+    }
+
+    // Removes the nodes that were merged away, and the meshes and accessors that are no longer used, and renumbers the rest
+    void RemoveUnused(GLTFDocument& doc, const std::vector<bool>& keptNodes)
+    {
+        const Renumbering nodeIds(keptNodes);
+
+        std::vector<Node> nodes;
+        std::vector<bool> usedMeshes(doc.meshes.Size(), false);
+        for (const auto& element : doc.nodes.Elements())
+        {
+            if (!keptNodes[std::stoul(element.id)])
+            {
+                continue;
+            }
+
+            Node node(element);
+            nodeIds.Remap(node.id);
+            for (auto& child : node.children)
+            {
+                nodeIds.Remap(child);
+            }
+
+            auto lodExtension = node.extensions.find(EXTENSION_MSFT_LOD);
+            if (lodExtension != node.extensions.end())
+            {
+                RemapLODIds(lodExtension->second, nodeIds);
+            }
+
+            if (!node.meshId.empty())
+            {
+                usedMeshes[std::stoul(node.meshId)] = true;
+            }
+
+            nodes.push_back(std::move(node));
+        }
+
+        std::vector<Scene> scenes(doc.scenes.Elements().begin(), doc.scenes.Elements().end());
+        for (auto& scene : scenes)
+        {
+            for (auto& nodeId : scene.nodes)
+            {
+                nodeIds.Remap(nodeId);
+            }
+        }
+
+        const Renumbering meshIds(usedMeshes);
+
+        std::vector<Mesh> meshes;
+        std::vector<bool> usedAccessors(doc.accessors.Size(), false);
+        bool hasExtensions = false;
+        for (const auto& element : doc.meshes.Elements())
+        {
+            if (!usedMeshes[std::stoul(element.id)])
+            {
+                continue;
+            }
+
+            Mesh mesh(element);
+            meshIds.Remap(mesh.id);
+            hasExtensions = hasExtensions || !mesh.extensions.empty();
+
+            for (const auto& primitive : mesh.primitives)
+            {
+                hasExtensions = hasExtensions || !primitive.extensions.empty();
+
+                for (const auto& id : BufferUtils::GetAttributeIds(primitive))
+                {
+                    if (!id.empty())
+                    {
+                        usedAccessors[std::stoul(id)] = true;
+                    }
+                }
+
+                if (!primitive.indicesAccessorId.empty())
+                {
+                    usedAccessors[std::stoul(primitive.indicesAccessorId)] = true;
+                }
+
+                for (const auto& target : primitive.targets)
+                {
+                    for (const auto& id : { target.positionsAccessorId, target.normalsAccessorId, target.tangentsAccessorId })
+                    {
+                        if (!id.empty())
+                        {
+                            usedAccessors[std::stoul(id)] = true;
+                        }
+                    }
+                }
+            }
+
+            meshes.push_back(std::move(mesh));
+        }
+
+        for (auto& node : nodes)
+        {
+            meshIds.Remap(node.meshId);
+        }
+
+        doc.nodes.Clear();
+        for (auto& node : nodes)
+        {
+            doc.nodes.Append(std::move(node));
+        }
+
+        doc.scenes.Clear();
+        for (auto& scene : scenes)
+        {
+            doc.scenes.Append(std::move(scene));
+        }
+
+        // Extensions of meshes can reference accessors in ways that are not known here, in which case every accessor is kept
+        if (hasExtensions)
+        {
+            usedAccessors.assign(usedAccessors.size(), true);
+        }
+
+        const Renumbering accessorIds(usedAccessors);
+
+        for (auto& mesh : meshes)
+        {
+            for (auto& primitive : mesh.primitives)
+            {
+                auto attributeIds = BufferUtils::GetAttributeIds(primitive);
+                for (auto& id : attributeIds)
+                {
+                    accessorIds.Remap(id);
+                }
+
+                BufferUtils::SetAttributeIds(primitive, attributeIds);
+                accessorIds.Remap(primitive.indicesAccessorId);
+
+                for (auto& target : primitive.targets)
+                {
+                    accessorIds.Remap(target.positionsAccessorId);
+                    accessorIds.Remap(target.normalsAccessorId);
+                    accessorIds.Remap(target.tangentsAccessorId);
+                }
+            }
+        }
+
+        doc.meshes.Clear();
+        for (auto& mesh : meshes)
+        {
+            doc.meshes.Append(std::move(mesh));
+        }
+
+        std::vector<Accessor> accessors;
+        for (const auto& element : doc.accessors.Elements())
+        {
+            if (usedAccessors[std::stoul(element.id)])
+            {
+                Accessor accessor(element);
+                accessorIds.Remap(accessor.id);
+                accessors.push_back(std::move(accessor));
+            }
+        }
+
+        doc.accessors.Clear();
+        for (auto& accessor : accessors)
+        {
+            doc.accessors.Append(std::move(accessor));
+        }
+    }
+}
+
+GLTFDocument GLTFSceneFlatteningUtils::FlattenScenes(const IStreamReader& streamReader, const GLTFDocument& doc, const std::string& outputDirectory, size_t maxParallelism)
+{
+    GLTFDocument outputDoc(doc);
+
+    FlattenScenesInPlace(streamReader, outputDoc, outputDirectory, maxParallelism);
+
+    return outputDoc;
+}
+
+void GLTFSceneFlatteningUtils::FlattenScenesInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const std::string& outputDirectory, size_t maxParallelism)
+{
+    Instrumentation::Stage stage("FlattenScenes");
+    stage.SetProperty("nodes", std::to_string(doc.nodes.Size()));
+
+    // Animated and skinned nodes move every vertex below them, so their documents are left unchanged
+    if (doc.animations.Size() > 0 || doc.skins.Size() > 0 || doc.nodes.Size() == 0)
+    {
+        return;
+    }
+
+    const auto& nodes = doc.nodes.Elements();
+    const size_t nodeCount = nodes.size();
+
+    // 1. Find the root nodes: the roots of the scenes, the roots of the levels of detail referenced by MSFT_lod, and any
+    // other node without a parent
+    std::vector<bool> isRoot(nodeCount, true);
+    for (const auto& node : nodes)
+    {
+        for (const auto& child : node.children)
+        {
+            isRoot[doc.nodes.GetIndex(child)] = false;
+        }
+    }
+
+    for (const auto& lod : GLTFLODUtils::ParseDocumentNodeLODs(doc))
+    {
+        for (const auto& lodId : *lod.second)
+        {
+            isRoot[doc.nodes.GetIndex(lodId)] = true;
+        }
+    }
+
+    // 2. Keep the nodes that can't be merged into their parent, and their ancestors
+    std::unordered_map<std::string, bool> mergeableMeshes;
+    for (const auto& mesh : doc.meshes.Elements())
+    {
+        mergeableMeshes.emplace(mesh.id, IsMergeable(doc, mesh));
+    }
+
+    std::vector<size_t> order;
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < nodeCount; i++)
+    {
+        if (isRoot[i])
+        {
+            pending.push_back(i);
+        }
+    }
+
+    std::vector<bool> visited(nodeCount, false);
+    while (!pending.empty())
+    {
+        auto index = pending.back();
+        pending.pop_back();
+        if (visited[index])
+        {
+            continue;
+        }
+
+        visited[index] = true;
+        order.push_back(index);
+        for (const auto& child : nodes[index].children)
+        {
+            pending.push_back(doc.nodes.GetIndex(child));
+        }
+    }
+
+    std::vector<bool> kept(nodeCount, true);
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+    {
+        const auto& node = nodes[*it];
+        bool keep = isRoot[*it] || !node.extensions.empty() || !node.cameraId.empty() || !node.skinId.empty() ||
+            (!node.meshId.empty() && !mergeableMeshes.at(node.meshId));
+
+        for (const auto& child : node.children)
+        {
+            keep = keep || kept[doc.nodes.GetIndex(child)];
+        }
+
+        kept[*it] = keep;
+    }
+
+    // 3. Gather the meshes of the removed nodes below each kept node, with their transforms relative to it
+    std::vector<size_t> flattenedNodes;
+    std::vector<std::vector<MeshInstance>> instances;
+    for (size_t i = 0; i < nodeCount; i++)
+    {
+        if (!kept[i])
+        {
+            continue;
+        }
+
+        const auto& node = nodes[i];
+
+        std::vector<MeshInstance> nodeInstances;
+        if (!node.meshId.empty() && mergeableMeshes.at(node.meshId))
+        {
+            nodeInstances.push_back({ node.meshId, IDENTITY_TRANSFORM });
+        }
+
+        bool hasRemovedChildren = false;
+        bool hasRemovedMeshes = false;
+        std::vector<std::pair<size_t, Transform>> removed;
+        for (auto it = node.children.rbegin(); it != node.children.rend(); ++it)
+        {
+            auto child = doc.nodes.GetIndex(*it);
+            if (!kept[child])
+            {
+                removed.emplace_back(child, GetLocalTransform(nodes[child]));
+                hasRemovedChildren = true;
+            }
+        }
+
+        // Depth first, so that the meshes are drawn in the order of the hierarchy
+        while (!removed.empty())
+        {
+            auto current = removed.back();
+            removed.pop_back();
+
+            const auto& removedNode = nodes[current.first];
+            if (!removedNode.meshId.empty())
+            {
+                nodeInstances.push_back({ removedNode.meshId, current.second });
+                hasRemovedMeshes = true;
+            }
+
+            for (auto it = removedNode.children.rbegin(); it != removedNode.children.rend(); ++it)
+            {
+                auto child = doc.nodes.GetIndex(*it);
+                removed.emplace_back(child, Multiply(current.second, GetLocalTransform(nodes[child])));
+            }
+        }
+
+        if (hasRemovedChildren)
+        {
+            // Without meshes to merge, the node keeps its own mesh as it is
+            if (!hasRemovedMeshes)
+            {
+                nodeInstances.clear();
+            }
+
+            flattenedNodes.push_back(i);
+            instances.push_back(std::move(nodeInstances));
+        }
+    }
+
+    // 4. Merge the meshes of each kept node. The merged vertices of all nodes are written once they are all read.
+    std::vector<std::vector<MergedPrimitive>> mergedMeshes(flattenedNodes.size());
+    ParallelUtils::ParallelFor(flattenedNodes.size(), maxParallelism, [&](size_t i)
+    {
+        mergedMeshes[i] = MergeInstances(streamReader, doc, instances[i]);
+    });
+
+    std::vector<Node> updatedNodes;
+    std::vector<Node> newNodes;
+    size_t mergedPrimitiveCount = 0;
+    {
+        BufferWriter writer(doc, outputDirectory, "flattened_meshes.bin");
+        for (size_t i = 0; i < flattenedNodes.size(); i++)
+        {
+            Node node(nodes[flattenedNodes[i]]);
+
+            // The removed children are merged, and the kept ones stay where they are
+            std::vector<std::string> children;
+            for (const auto& child : node.children)
+            {
+                if (kept[doc.nodes.GetIndex(child)])
+                {
+                    children.push_back(child);
+                }
+            }
+
+            node.children = std::move(children);
+
+            if (!mergedMeshes[i].empty())
+            {
+                mergedPrimitiveCount += mergedMeshes[i].size();
+                auto meshId = AddMergedMesh(doc, writer, mergedMeshes[i], node.name);
+
+                if (node.meshId.empty() || mergeableMeshes.at(node.meshId))
+                {
+                    node.meshId = meshId;
+                }
+                else
+                {
+                    // The node keeps the mesh that can't be merged, and draws the merged one through a new child
+                    Node meshNode;
+                    meshNode.id = std::to_string(nodeCount + newNodes.size());
+                    meshNode.meshId = meshId;
+                    node.children.push_back(meshNode.id);
+                    newNodes.push_back(std::move(meshNode));
+                }
+            }
+
+            updatedNodes.push_back(std::move(node));
+        }
+
+        writer.Finish();
+    }
+
+    for (auto& node : updatedNodes)
+    {
+        doc.nodes.Replace(node);
+    }
+
+    for (auto& node : newNodes)
+    {
+        doc.nodes.Append(std::move(node));
+    }
+
+    kept.resize(doc.nodes.Size(), true);
+
+    // 5. Remove the merged nodes, and the meshes and accessors that only they used
+    RemoveUnused(doc, kept);
+
+    stage.SetProperty("flattened_nodes", std::to_string(doc.nodes.Size()));
+    stage.SetProperty("merged_primitives", std::to_string(mergedPrimitiveCount));
+}
@@ -0,0 +1,906 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include <DirectXTex.h>
+
+#include "GLTFTextureAtlasUtils.h"
+#include "GLTFTextureLoadingUtils.h"
+#include "BufferUtils.h"
+#include "Instrumentation.h"
+#include "ParallelUtils.h"
+
+#include "GLTFSDK/GLTF.h"
+#include "GLTFSDK/GLTFResourceReader.h"
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    // The texture slots of a material, each of which gets its own atlas
+    enum TextureSlot
+    {
+        BaseColor,
+        MetallicRoughness,
+        Normal,
+        Occlusion,
+        Emissive,
+        SlotCount
+    };
+
+    const char* SLOT_NAMES[SlotCount] = { "basecolor", "metallicroughness", "normal", "occlusion", "emissive" };
+
+    const std::string& GetTextureId(const Material& material, size_t slot)
+    {
+        switch (slot)
+        {
+        case BaseColor:
+            return material.metallicRoughness.baseColorTextureId;
+        case MetallicRoughness:
+            return material.metallicRoughness.metallicRoughnessTextureId;
+        case Normal:
+            return material.normalTexture.id;
+        case Occlusion:
+            return material.occlusionTexture.id;
+        default:
+            return material.emissiveTextureId;
+        }
+    }
+
+    void SetTextureId(Material& material, size_t slot, const std::string& textureId)
+    {
+        switch (slot)
+        {
+        case BaseColor:
+            material.metallicRoughness.baseColorTextureId = textureId;
+            break;
+        case MetallicRoughness:
+            material.metallicRoughness.metallicRoughnessTextureId = textureId;
+            break;
+        case Normal:
+            material.normalTexture.id = textureId;
+            break;
+        case Occlusion:
+            material.occlusionTexture.id = textureId;
+            break;
+        default:
+            material.emissiveTextureId = textureId;
+            break;
+        }
+    }
+
+    // Rounds a size in pixels up to whole 4x4 blocks, so that block compression of the atlas does not mix cells
+    size_t RoundUpToBlock(size_t value)
+    {
+        return (value + 3) & ~static_cast<size_t>(3);
+    }
+
+    // A material whose textures can be placed in an atlas, and the size of its place in the atlas
+    struct AtlasCandidate
+    {
+        std::string materialId;
+        std::string groupKey;
+        std::string samplerId;
+        std::array<bool, SlotCount> slots;
+        bool occlusionSharesMetallicRoughness;
+        size_t width;
+        size_t height;
+
+        // The page of the atlas that holds the textures, and the position of the textures in it, without the padding
+        size_t pageIndex;
+        size_t x;
+        size_t y;
+    };
+
+    struct AtlasPage
+    {
+        std::vector<size_t> candidates;
+        size_t width;
+        size_t height;
+
+        // The ids of the atlas texture of each slot, once they have been added to the document
+        std::array<std::string, SlotCount> textureIds;
+    };
+
+    // The size of an image, read from its header, if it can be placed in an atlas: it must be decoded by WIC, since
+    // DDS images are already compressed, and fit in the maximum size
+    std::optional<std::pair<size_t, size_t>> GetAtlasImageSize(const IStreamReader& streamReader, const GLTFDocument& doc, const Image& image, size_t maxTextureSize)
+    {
+        GLTFResourceReader reader(streamReader);
+        auto data = reader.ReadBinaryData(doc, image);
+
+        const char ddsMagic[] = { 'D', 'D', 'S', ' ' };
+        if (data.size() < sizeof(ddsMagic) || std::memcmp(data.data(), ddsMagic, sizeof(ddsMagic)) == 0)
+        {
+            return std::nullopt;
+        }
+
+        DirectX::TexMetadata metadata;
+        if (FAILED(DirectX::GetMetadataFromWICMemory(data.data(), data.size(), DirectX::WIC_FLAGS_NONE, metadata)) ||
+            metadata.width > maxTextureSize || metadata.height > maxTextureSize)
+        {
+            return std::nullopt;
+        }
+
+        return std::make_pair(metadata.width, metadata.height);
+    }
+
+    // Whether every texture coordinate of the accessor is between 0 and 1, so that it can be moved into an atlas
+    bool HasAtlasTexCoords(const IStreamReader& streamReader, const GLTFDocument& doc, const Accessor& accessor)
+    {
+        if (accessor.componentType != ComponentType::COMPONENT_FLOAT || accessor.type != AccessorType::TYPE_VEC2 || accessor.bufferViewId.empty())
+        {
+            return false;
+        }
+
+        GLTFResourceReader reader(streamReader);
+        auto texCoords = reader.ReadBinaryData<float>(doc, accessor);
+        return std::all_of(texCoords.begin(), texCoords.end(), [](float texCoord) { return texCoord >= 0.0f && texCoord <= 1.0f; });
+    }
+
+    // Packs the candidates of one group into pages with shelves of decreasing height. Every position is a multiple of 4,
+    // so that each texture starts on a block of the compressed atlas.
+    void PackGroup(std::vector<AtlasCandidate>& candidates, const std::vector<size_t>& group, const TextureAtlasOptions& options, std::vector<AtlasPage>& pages)
+    {
+        auto cellWidth = [&](size_t i) { return RoundUpToBlock(candidates[i].width + 2 * options.padding); };
+        auto cellHeight = [&](size_t i) { return RoundUpToBlock(candidates[i].height + 2 * options.padding); };
+
+        std::vector<size_t> order;
+        size_t area = 0;
+        size_t widestCell = 0;
+        for (auto i : group)
+        {
+            if (cellWidth(i) <= options.maxAtlasSize && cellHeight(i) <= options.maxAtlasSize)
+            {
+                order.push_back(i);
+                area += cellWidth(i) * cellHeight(i);
+                widestCell = std::max(widestCell, cellWidth(i));
+            }
+        }
+
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+        {
+            return cellHeight(a) != cellHeight(b) ? cellHeight(a) > cellHeight(b) : cellWidth(a) > cellWidth(b);
+        });
+
+        // The narrowest power of two that could hold every cell in a square
+        size_t pageWidth = 4;
+        while (pageWidth < options.maxAtlasSize && (pageWidth < widestCell || pageWidth * pageWidth < area))
+        {
+            pageWidth *= 2;
+        }
+
+        pageWidth = std::min(pageWidth, RoundUpToBlock(options.maxAtlasSize));
+
+        const size_t firstPage = pages.size();
+        size_t x = 0;
+        size_t y = 0;
+        size_t shelfHeight = 0;
+        for (auto i : order)
+        {
+            if (x + cellWidth(i) > pageWidth)
+            {
+                x = 0;
+                y += shelfHeight;
+                shelfHeight = 0;
+            }
+
+            if (pages.size() == firstPage || y + cellHeight(i) > options.maxAtlasSize)
+            {
+                pages.push_back({ {}, pageWidth, 0, {} });
+                x = 0;
+                y = 0;
+                shelfHeight = 0;
+            }
+
+            auto& candidate = candidates[i];
+            candidate.pageIndex = pages.size() - 1;
+            candidate.x = x + options.padding;
+            candidate.y = y + options.padding;
+
+            auto& page = pages.back();
+            page.candidates.push_back(i);
+            page.height = std::max(page.height, y + cellHeight(i));
+
+            x += cellWidth(i);
+            shelfHeight = std::max(shelfHeight, cellHeight(i));
+        }
+    }
+
+    // Copies an image into the atlas at (x, y), and repeats its edge pixels over the padding around it
+    void CopyWithPadding(const DirectX::Image& source, const DirectX::Image& atlas, size_t x, size_t y, size_t padding)
+    {
+        const ptrdiff_t pad = static_cast<ptrdiff_t>(padding);
+        const ptrdiff_t width = static_cast<ptrdiff_t>(source.width);
+        const ptrdiff_t height = static_cast<ptrdiff_t>(source.height);
+
+        for (ptrdiff_t row = -pad; row < height + pad; row++)
+        {
+            const ptrdiff_t sourceRow = std::max<ptrdiff_t>(0, std::min(height - 1, row));
+            auto sourcePixels = reinterpret_cast<const uint32_t*>(source.pixels + sourceRow * source.rowPitch);
+            auto atlasPixels = reinterpret_cast<uint32_t*>(atlas.pixels + (static_cast<ptrdiff_t>(y) + row) * static_cast<ptrdiff_t>(atlas.rowPitch)) + x;
+
+            for (ptrdiff_t column = -pad; column < 0; column++)
+            {
+                atlasPixels[column] = sourcePixels[0];
+            }
+
+            std::memcpy(atlasPixels, sourcePixels, source.width * sizeof(uint32_t));
+
+            for (ptrdiff_t column = width; column < width + pad; column++)
+            {
+                atlasPixels[column] = sourcePixels[width - 1];
+            }
+        }
+    }
+
+    std::wstring CombinePath(const std::string& directory, const std::string& fileName)
+    {
+        std::wstring directoryW(directory.begin(), directory.end());
+        std::wstring fileNameW(fileName.begin(), fileName.end());
+
+        wchar_t fullPath[MAX_PATH];
+
+        if (FAILED(::PathCchCombine(fullPath, ARRAYSIZE(fullPath), directoryW.c_str(), fileNameW.c_str())))
+        {
+            throw GLTFException("Failed to compose output file path.");
+        }
+
+        return fullPath;
+    }
+
+    // Composes the atlas of one slot of a page, and saves it as a PNG in the output directory
+    std::string SaveAtlas(const IStreamReader& streamReader, const GLTFDocument& doc, const std::vector<AtlasCandidate>& candidates, const AtlasPage& page,
+        size_t pageIndex, size_t slot, const TextureAtlasOptions& options, const std::string& outputDirectory)
+    {
+        Instrumentation::Stage stage("SaveAtlas");
+        stage.SetProperty("slot", SLOT_NAMES[slot]);
+
+        // The atlas and one source are in memory at a time
+        auto imageLease = GLTFTextureLoadingUtils::GetInFlightImageLimit().Acquire();
+
+        DirectX::ScratchImage atlas;
+        if (FAILED(atlas.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, page.width, page.height, 1, 1)))
+        {
+            throw GLTFException("Failed to create an atlas.");
+        }
+
+        std::memset(atlas.GetPixels(), 0, atlas.GetPixelsSize());
+
+        for (auto i : page.candidates)
+        {
+            const auto& candidate = candidates[i];
+            const auto& material = doc.materials.Get(candidate.materialId);
+
+            auto image = GLTFTextureLoadingUtils::LoadTexture(streamReader, doc, GetTextureId(material, slot), DXGI_FORMAT_R8G8B8A8_UNORM);
+
+            // The textures of a material share one place, with the size of the largest of them
+            const DirectX::Image* source = image.GetImage(0, 0, 0);
+            DirectX::ScratchImage resized;
+            if (source->width != candidate.width || source->height != candidate.height)
+            {
+                if (FAILED(DirectX::Resize(*source, candidate.width, candidate.height, DirectX::TEX_FILTER_DEFAULT, resized)))
+                {
+                    throw GLTFException("Failed to resize a texture for an atlas.");
+                }
+
+                source = resized.GetImage(0, 0, 0);
+            }
+
+            CopyWithPadding(*source, *atlas.GetImage(0, 0, 0), candidate.x, candidate.y, options.padding);
+        }
+
+        auto outputImageFullPath = CombinePath(outputDirectory, "atlas_" + std::to_string(pageIndex) + "_" + SLOT_NAMES[slot] + ".png");
+        if (FAILED(DirectX::SaveToWICFile(*atlas.GetImage(0, 0, 0), DirectX::WIC_FLAGS_NONE, GUID_ContainerFormatPng, outputImageFullPath.c_str())))
+        {
+            throw GLTFException("Failed to save file.");
+        }
+
+        stage.AddFileWritten(outputImageFullPath);
+
+        return std::string(outputImageFullPath.begin(), outputImageFullPath.end());
+    }
+
+    template <typename T>
+    std::vector<uint32_t> ReadIndices(const GLTFResourceReader& reader, const GLTFDocument& doc, const Accessor& accessor)
+    {
+        auto data = reader.ReadBinaryData<T>(doc, accessor);
+        return std::vector<uint32_t>(data.begin(), data.end());
+    }
+
+    std::vector<uint32_t> ReadIndices(const GLTFResourceReader& reader, const GLTFDocument& doc, const MeshPrimitive& primitive, size_t vertexCount)
+    {
+        if (primitive.indicesAccessorId.empty())
+        {
+            std::vector<uint32_t> indices(vertexCount);
+            std::iota(indices.begin(), indices.end(), 0);
+            return indices;
+        }
+
+        const auto& accessor = doc.accessors.Get(primitive.indicesAccessorId);
+        switch (accessor.componentType)
+        {
+        case ComponentType::COMPONENT_UNSIGNED_BYTE:
+            return ReadIndices<uint8_t>(reader, doc, accessor);
+        case ComponentType::COMPONENT_UNSIGNED_SHORT:
+            return ReadIndices<uint16_t>(reader, doc, accessor);
+        case ComponentType::COMPONENT_UNSIGNED_INT:
+            return ReadIndices<uint32_t>(reader, doc, accessor);
+        default:
+            throw GLTFException("Invalid index component type in accessor " + accessor.id);
+        }
+    }
+
+    template <typename T>
+    std::vector<uint8_t> GetIndexData(const std::vector<uint32_t>& indices)
+    {
+        std::vector<uint8_t> data(indices.size() * sizeof(T));
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            T index = static_cast<T>(indices[i]);
+            std::memcpy(&data[i * sizeof(T)], &index, sizeof(T));
+        }
+
+        return data;
+    }
+
+    // Primitives can be merged if they are triangles without morph targets, with the same material and attribute types
+    std::optional<std::string> GetMergeKey(const GLTFDocument& doc, const MeshPrimitive& primitive)
+    {
+        if (primitive.mode != MeshMode::MESH_TRIANGLES || !primitive.targets.empty() || primitive.positionsAccessorId.empty())
+        {
+            return std::nullopt;
+        }
+
+        std::string key = primitive.materialId;
+        for (const auto& id : BufferUtils::GetAttributeIds(primitive))
+        {
+            key += "|";
+            if (id.empty())
+            {
+                continue;
+            }
+
+            const auto& accessor = doc.accessors.Get(id);
+            if (accessor.bufferViewId.empty())
+            {
+                return std::nullopt;
+            }
+
+            key += std::to_string(static_cast<int>(accessor.type)) + "," + std::to_string(static_cast<int>(accessor.componentType)) + "," + (accessor.normalized ? "n" : "");
+        }
+
+        return key;
+    }
+}
+
+GLTFDocument GLTFTextureAtlasUtils::AtlasTextures(const IStreamReader& streamReader, const GLTFDocument& doc, const TextureAtlasOptions& options, const std::string& outputDirectory, size_t maxParallelism)
+{
+    GLTFDocument outputDoc(doc);
+
+    AtlasTexturesInPlace(streamReader, outputDoc, options, outputDirectory, maxParallelism);
+
+    return outputDoc;
+}
+
+void GLTFTextureAtlasUtils::AtlasTexturesInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const TextureAtlasOptions& options, const std::string& outputDirectory, size_t maxParallelism)
+{
+    Instrumentation::Stage stage("AtlasTextures");
+
+    // 1. Read the size of the images and the texture coordinates that the materials could use from an atlas
+    std::vector<std::string> imageIds;
+    std::unordered_map<std::string, size_t> imageIndices;
+    for (const auto& material : doc.materials.Elements())
+    {
+        for (size_t slot = 0; slot < SlotCount; slot++)
+        {
+            const auto& textureId = GetTextureId(material, slot);
+            if (!textureId.empty() && imageIndices.emplace(doc.textures.Get(textureId).imageId, imageIds.size()).second)
+            {
+                imageIds.push_back(doc.textures.Get(textureId).imageId);
+            }
+        }
+    }
+
+    std::vector<std::optional<std::pair<size_t, size_t>>> imageSizes(imageIds.size());
+    ParallelUtils::ParallelFor(imageIds.size(), maxParallelism, [&](size_t i)
+    {
+        imageSizes[i] = GetAtlasImageSize(streamReader, doc, doc.images.Get(imageIds[i]), options.maxTextureSize);
+    });
+
+    std::unordered_map<std::string, std::vector<std::string>> texCoordsByMaterial;
+    std::vector<std::string> texCoordIds;
+    std::unordered_map<std::string, size_t> texCoordIndices;
+    for (const auto& mesh : doc.meshes.Elements())
+    {
+        for (const auto& primitive : mesh.primitives)
+        {
+            if (!primitive.materialId.empty())
+            {
+                texCoordsByMaterial[primitive.materialId].push_back(primitive.uv0AccessorId);
+                if (!primitive.uv0AccessorId.empty() && texCoordIndices.emplace(primitive.uv0AccessorId, texCoordIds.size()).second)
+                {
+                    texCoordIds.push_back(primitive.uv0AccessorId);
+                }
+            }
+        }
+    }
+
+    std::vector<uint8_t> texCoordsInRange(texCoordIds.size());
+    ParallelUtils::ParallelFor(texCoordIds.size(), maxParallelism, [&](size_t i)
+    {
+        texCoordsInRange[i] = HasAtlasTexCoords(streamReader, doc, doc.accessors.Get(texCoordIds[i])) ? 1 : 0;
+    });
+
+    // 2. Find the materials that can be atlased, grouped by their textured slots and sampler
+    std::vector<AtlasCandidate> candidates;
+    std::vector<std::string> groupKeys;
+    std::unordered_map<std::string, std::vector<size_t>> groups;
+    for (const auto& material : doc.materials.Elements())
+    {
+        auto usedTexCoords = texCoordsByMaterial.find(material.id);
+        if (!material.extensions.empty() || usedTexCoords == texCoordsByMaterial.end())
+        {
+            continue;
+        }
+
+        bool inRange = std::all_of(usedTexCoords->second.begin(), usedTexCoords->second.end(), [&](const std::string& id)
+        {
+            return !id.empty() && texCoordsInRange[texCoordIndices.at(id)] != 0;
+        });
+
+        AtlasCandidate candidate = { material.id, "", "", {}, false, 0, 0, 0, 0, 0 };
+        bool atlasable = inRange;
+        bool hasTexture = false;
+        for (size_t slot = 0; slot < SlotCount && atlasable; slot++)
+        {
+            const auto& textureId = GetTextureId(material, slot);
+            candidate.slots[slot] = !textureId.empty();
+            if (textureId.empty())
+            {
+                continue;
+            }
+
+            const auto& texture = doc.textures.Get(textureId);
+            const auto& size = imageSizes[imageIndices.at(texture.imageId)];
+            if (!texture.extensions.empty() || !size || (hasTexture && texture.samplerId != candidate.samplerId))
+            {
+                atlasable = false;
+                break;
+            }
+
+            candidate.samplerId = texture.samplerId;
+            candidate.width = std::max(candidate.width, size->first);
+            candidate.height = std::max(candidate.height, size->second);
+            hasTexture = true;
+        }
+
+        if (!atlasable || !hasTexture)
+        {
+            continue;
+        }
+
+        // An occlusion texture that is the red channel of the metallic roughness texture keeps pointing to the same texture,
+        // which lets packing tell that it is already packed
+        candidate.occlusionSharesMetallicRoughness = candidate.slots[Occlusion] && material.occlusionTexture.id == material.metallicRoughness.metallicRoughnessTextureId;
+
+        candidate.groupKey = candidate.samplerId + "|" + (candidate.occlusionSharesMetallicRoughness ? "s" : "");
+        for (size_t slot = 0; slot < SlotCount; slot++)
+        {
+            candidate.groupKey += candidate.slots[slot] ? "1" : "0";
+        }
+
+        auto inserted = groups.emplace(candidate.groupKey, std::vector<size_t>());
+        if (inserted.second)
+        {
+            groupKeys.push_back(candidate.groupKey);
+        }
+
+        inserted.first->second.push_back(candidates.size());
+        candidates.push_back(std::move(candidate));
+    }
+
+    // 3. Lay out the pages of each group. A page that holds a single material would only add padding to its textures.
+    std::vector<AtlasPage> allPages;
+    for (const auto& groupKey : groupKeys)
+    {
+        PackGroup(candidates, groups[groupKey], options, allPages);
+    }
+
+    std::vector<AtlasPage> pages;
+    for (auto& page : allPages)
+    {
+        if (page.candidates.size() > 1)
+        {
+            for (auto i : page.candidates)
+            {
+                candidates[i].pageIndex = pages.size();
+            }
+
+            pages.push_back(std::move(page));
+        }
+    }
+
+    stage.SetProperty("atlases", std::to_string(pages.size()));
+    if (pages.empty())
+    {
+        return;
+    }
+
+    // 4. Compose and save the atlas of each slot of each page
+    std::vector<std::pair<size_t, size_t>> atlasJobs;
+    for (size_t pageIndex = 0; pageIndex < pages.size(); pageIndex++)
+    {
+        const auto& first = candidates[pages[pageIndex].candidates[0]];
+        for (size_t slot = 0; slot < SlotCount; slot++)
+        {
+            if (first.slots[slot] && !(slot == Occlusion && first.occlusionSharesMetallicRoughness))
+            {
+                atlasJobs.emplace_back(pageIndex, slot);
+            }
+        }
+    }
+
+    std::vector<std::string> atlasPaths(atlasJobs.size());
+    ParallelUtils::ParallelFor(atlasJobs.size(), maxParallelism, [&](size_t i)
+    {
+        atlasPaths[i] = SaveAtlas(streamReader, doc, candidates, pages[atlasJobs[i].first], atlasJobs[i].first, atlasJobs[i].second, options, outputDirectory);
+    });
+
+    // 5. Rewrite the texture coordinates of each primitive that uses an atlased material, before the document changes
+    std::unordered_map<std::string, size_t> candidatesByMaterial;
+    for (const auto& page : pages)
+    {
+        for (auto i : page.candidates)
+        {
+            candidatesByMaterial.emplace(candidates[i].materialId, i);
+        }
+    }
+
+    // The same accessor can be used by materials in different places of the atlases, so the rewritten coordinates are keyed by both
+    std::unordered_map<std::string, std::vector<float>> atlasTexCoords;
+    auto getTexCoordsKey = [](const MeshPrimitive& primitive) { return primitive.uv0AccessorId + "|" + primitive.materialId; };
+    {
+        GLTFResourceReader reader(streamReader);
+        for (const auto& mesh : doc.meshes.Elements())
+        {
+            for (const auto& primitive : mesh.primitives)
+            {
+                auto candidate = candidatesByMaterial.find(primitive.materialId);
+                if (candidate == candidatesByMaterial.end() || atlasTexCoords.count(getTexCoordsKey(primitive)) > 0)
+                {
+                    continue;
+                }
+
+                const auto& place = candidates[candidate->second];
+                const auto& page = pages[place.pageIndex];
+
+                auto texCoords = reader.ReadBinaryData<float>(doc, doc.accessors.Get(primitive.uv0AccessorId));
+                for (size_t i = 0; i + 1 < texCoords.size(); i += 2)
+                {
+                    texCoords[i] = static_cast<float>((static_cast<double>(place.x) + texCoords[i] * static_cast<double>(place.width)) / static_cast<double>(page.width));
+                    texCoords[i + 1] = static_cast<float>((static_cast<double>(place.y) + texCoords[i + 1] * static_cast<double>(place.height)) / static_cast<double>(page.height));
+                }
+
+                atlasTexCoords.emplace(getTexCoordsKey(primitive), std::move(texCoords));
+            }
+        }
+    }
+
+    // 6. Add the atlases, and point the materials to them. Materials of a page that are then equal are merged into the first one.
+    std::unordered_set<std::string> atlasedTextureIds;
+    for (size_t i = 0; i < atlasJobs.size(); i++)
+    {
+        auto& page = pages[atlasJobs[i].first];
+        const auto slot = atlasJobs[i].second;
+
+        Image image;
+        image.id = std::to_string(doc.images.Size());
+        image.uri = atlasPaths[i];
+        image.mimeType = "image/png";
+
+        Texture texture;
+        texture.id = std::to_string(doc.textures.Size());
+        texture.imageId = image.id;
+        texture.samplerId = candidates[page.candidates[0]].samplerId;
+
+        page.textureIds[slot] = texture.id;
+        if (slot == MetallicRoughness && candidates[page.candidates[0]].occlusionSharesMetallicRoughness)
+        {
+            page.textureIds[Occlusion] = texture.id;
+        }
+
+        doc.images.Append(std::move(image));
+        doc.textures.Append(std::move(texture));
+    }
+
+    std::unordered_map<std::string, std::string> mergedMaterialIds;
+    for (const auto& page : pages)
+    {
+        std::vector<Material> pageMaterials;
+        for (auto i : page.candidates)
+        {
+            Material material(doc.materials.Get(candidates[i].materialId));
+            for (size_t slot = 0; slot < SlotCount; slot++)
+            {
+                if (!GetTextureId(material, slot).empty())
+                {
+                    atlasedTextureIds.insert(GetTextureId(material, slot));
+                    SetTextureId(material, slot, page.textureIds[slot]);
+                }
+            }
+
+            doc.materials.Replace(material);
+
+            // Materials that only differ by their name are drawn the same way
+            Material unnamed(material);
+            unnamed.id.clear();
+            unnamed.name.clear();
+
+            auto merged = std::find_if(pageMaterials.begin(), pageMaterials.end(), [&](const Material& pageMaterial)
+            {
+                Material unnamedPageMaterial(pageMaterial);
+                unnamedPageMaterial.id.clear();
+                unnamedPageMaterial.name.clear();
+                return unnamedPageMaterial == unnamed;
+            });
+
+            if (merged != pageMaterials.end())
+            {
+                mergedMaterialIds.emplace(material.id, merged->id);
+            }
+            else
+            {
+                pageMaterials.push_back(material);
+            }
+        }
+    }
+
+    // 7. Point the primitives to the merged materials and the rewritten texture coordinates, and merge the primitives of each mesh
+    // that can be drawn together
+    GLTFResourceReader reader(streamReader);
+    BufferWriter writer(doc, outputDirectory, "atlas_meshes.bin");
+    std::unordered_map<std::string, std::string> atlasTexCoordIds;
+    size_t mergedPrimitiveCount = 0;
+
+    std::vector<Mesh> meshes(doc.meshes.Elements().begin(), doc.meshes.Elements().end());
+    for (auto& mesh : meshes)
+    {
+        bool changed = false;
+
+        std::vector<MeshPrimitive> primitives;
+        std::vector<std::optional<std::string>> mergeKeys;
+        std::unordered_map<std::string, std::vector<size_t>> mergeGroups;
+        for (const auto& primitive : mesh.primitives)
+        {
+            if (candidatesByMaterial.count(primitive.materialId) == 0)
+            {
+                primitives.push_back(primitive);
+                mergeKeys.push_back(std::nullopt);
+                continue;
+            }
+
+            changed = true;
+
+            MeshPrimitive atlasPrimitive(primitive);
+            auto merged = mergedMaterialIds.find(primitive.materialId);
+            if (merged != mergedMaterialIds.end())
+            {
+                atlasPrimitive.materialId = merged->second;
+            }
+
+            auto mergeKey = GetMergeKey(doc, atlasPrimitive);
+            if (mergeKey)
+            {
+                mergeGroups[*mergeKey].push_back(primitives.size());
+            }
+
+            // The original material keeps selecting the rewritten texture coordinates until they are written
+            primitives.push_back(primitive);
+            mergeKeys.push_back(mergeKey);
+        }
+
+        if (!changed)
+        {
+            continue;
+        }
+
+        std::vector<MeshPrimitive> outputPrimitives;
+        std::unordered_set<size_t> mergedPrimitives;
+        for (size_t i = 0; i < primitives.size(); i++)
+        {
+            const auto& primitive = primitives[i];
+            if (candidatesByMaterial.count(primitive.materialId) == 0)
+            {
+                outputPrimitives.push_back(primitive);
+                continue;
+            }
+
+            if (mergedPrimitives.count(i) > 0)
+            {
+                continue;
+            }
+
+            auto materialId = primitive.materialId;
+            auto merged = mergedMaterialIds.find(materialId);
+            if (merged != mergedMaterialIds.end())
+            {
+                materialId = merged->second;
+            }
+
+            const std::vector<size_t>* group = mergeKeys[i] ? &mergeGroups[*mergeKeys[i]] : nullptr;
+            if (group == nullptr || group->size() < 2)
+            {
+                // The primitive keeps its own vertices, with the rewritten texture coordinates
+                auto key = getTexCoordsKey(primitive);
+                auto inserted = atlasTexCoordIds.emplace(key, "");
+                if (inserted.second)
+                {
+                    const auto& texCoords = atlasTexCoords.at(key);
+                    const auto& accessor = doc.accessors.Get(primitive.uv0AccessorId);
+
+                    MergedVertexAttribute uv0;
+                    BufferUtils::AppendFloats(texCoords, 2, uv0);
+                    inserted.first->second = BufferUtils::AddVertexAccessor(doc, writer, accessor, uv0, accessor.count);
+                }
+
+                MeshPrimitive atlasPrimitive(primitive);
+                atlasPrimitive.materialId = materialId;
+                atlasPrimitive.uv0AccessorId = inserted.first->second;
+                outputPrimitives.push_back(std::move(atlasPrimitive));
+                continue;
+            }
+
+            // The primitives of the group are drawn as one, in their original order. Primitives that share the same
+            // vertices and texture coordinates share them in the merged primitive.
+            std::array<MergedVertexAttribute, ATTRIBUTE_COUNT> attributes;
+
+            std::unordered_map<std::string, uint32_t> vertexOffsets;
+            size_t vertexCount = 0;
+            std::vector<uint32_t> indices;
+            for (auto j : *group)
+            {
+                const auto& groupPrimitive = primitives[j];
+                const auto attributeIds = BufferUtils::GetAttributeIds(groupPrimitive);
+                const auto primitiveVertexCount = doc.accessors.Get(groupPrimitive.positionsAccessorId).count;
+
+                std::string verticesKey = getTexCoordsKey(groupPrimitive);
+                for (const auto& id : attributeIds)
+                {
+                    verticesKey += "|" + id;
+                }
+
+                auto inserted = vertexOffsets.emplace(verticesKey, static_cast<uint32_t>(vertexCount));
+                if (inserted.second)
+                {
+                    for (size_t attribute = 0; attribute < ATTRIBUTE_COUNT; attribute++)
+                    {
+                        if (attributeIds[attribute].empty())
+                        {
+                            continue;
+                        }
+
+                        const auto& accessor = doc.accessors.Get(attributeIds[attribute]);
+                        if (accessor.count != primitiveVertexCount)
+                        {
+                            throw GLTFException("The vertex accessors of a primitive have different counts.");
+                        }
+
+                        if (attribute == UV0_ATTRIBUTE)
+                        {
+                            BufferUtils::AppendFloats(atlasTexCoords.at(getTexCoordsKey(groupPrimitive)), 2, attributes[attribute]);
+                        }
+                        else
+                        {
+                            BufferUtils::AppendElements(reader, doc, accessor, attributes[attribute]);
+                        }
+                    }
+
+                    vertexCount += primitiveVertexCount;
+                }
+
+                for (auto index : ReadIndices(reader, doc, groupPrimitive, primitiveVertexCount))
+                {
+                    indices.push_back(inserted.first->second + index);
+                }
+
+                mergedPrimitives.insert(j);
+            }
+
+            MeshPrimitive mergedPrimitive(primitive);
+            mergedPrimitive.materialId = materialId;
+
+            auto attributeIds = BufferUtils::GetAttributeIds(primitive);
+            for (size_t attribute = 0; attribute < ATTRIBUTE_COUNT; attribute++)
+            {
+                if (attributeIds[attribute].empty())
+                {
+                    continue;
+                }
+
+                attributeIds[attribute] = BufferUtils::AddVertexAccessor(doc, writer, doc.accessors.Get(attributeIds[attribute]), attributes[attribute], vertexCount);
+            }
+
+            BufferUtils::SetAttributeIds(mergedPrimitive, attributeIds);
+
+            const bool shortIndices = vertexCount <= std::numeric_limits<uint16_t>::max();
+
+            Accessor indicesAccessor;
+            indicesAccessor.id = std::to_string(doc.accessors.Size());
+            indicesAccessor.bufferViewId = writer.AddBufferView(shortIndices ? GetIndexData<uint16_t>(indices) : GetIndexData<uint32_t>(indices), 0, BufferViewTarget::ELEMENT_ARRAY_BUFFER);
+            indicesAccessor.byteOffset = 0;
+            indicesAccessor.componentType = shortIndices ? ComponentType::COMPONENT_UNSIGNED_SHORT : ComponentType::COMPONENT_UNSIGNED_INT;
+            indicesAccessor.type = AccessorType::TYPE_SCALAR;
+            indicesAccessor.count = indices.size();
+
+            mergedPrimitive.indicesAccessorId = indicesAccessor.id;
+            doc.accessors.Append(std::move(indicesAccessor));
+
+            mergedPrimitiveCount += group->size() - 1;
+            outputPrimitives.push_back(std::move(mergedPrimitive));
+        }
+
+        mesh.primitives = std::move(outputPrimitives);
+        doc.meshes.Replace(mesh);
+    }
+
+    writer.Finish();
+
+    stage.SetProperty("merged_primitives", std::to_string(mergedPrimitiveCount));
+
+    // 8. Images that are now only referenced by unused textures would still be exported. They are pointed to an atlas
+    // of the same slot, which a deduplicating export stores once. Textures could also be referenced by unknown material
+    // extensions, in which case their images are kept.
+    bool hasMaterialExtensions = std::any_of(doc.materials.Elements().begin(), doc.materials.Elements().end(), [](const Material& material)
+    {
+        return !material.extensions.empty();
+    });
+
+    if (hasMaterialExtensions)
+    {
+        return;
+    }
+
+    std::unordered_set<std::string> usedImageIds;
+    for (const auto& material : doc.materials.Elements())
+    {
+        for (size_t slot = 0; slot < SlotCount; slot++)
+        {
+            if (!GetTextureId(material, slot).empty())
+            {
+                usedImageIds.insert(doc.textures.Get(GetTextureId(material, slot)).imageId);
+            }
+        }
+    }
+
+    for (const auto& texture : doc.textures.Elements())
+    {
+        if (atlasedTextureIds.count(texture.id) == 0)
+        {
+            usedImageIds.insert(texture.imageId);
+        }
+    }
+
+    const auto atlasImageUri = doc.images.Get(doc.textures.Get(pages[0].textureIds[atlasJobs[0].second]).imageId).uri;
+    for (const auto& imageId : imageIds)
+    {
+        if (usedImageIds.count(imageId) == 0)
+        {
+            Image image(doc.images.Get(imageId));
+            image.uri = atlasImageUri;
+            image.mimeType = "image/png";
+            image.bufferViewId.clear();
+            doc.images.Replace(image);
+        }
+    }
+}
@@ -7,9 +7,15 @@
 #include "GLTFTexturePackingUtils.h"
 #include "GLTFTextureCompressionUtils.h"
 #include "DeviceResources.h"
+#include "DeviceResourcesPool.h"
+#include "GLTFExtensionUtils.h"
+#include "HashUtils.h"
+#include "Instrumentation.h"
+#include "ParallelUtils.h"
 
 #include <GLTFSDK/GLTF.h>
 #include <GLTFSDK/GLTFConstants.h>
+#include <GLTFSDK/GLTFResourceReader.h>
 #include <GLTFSDK/Deserialize.h>
 #include <GLTFSDK/RapidJsonUtils.h>
 #include <GLTFSDK/Schema.h>
@@ -24,240 +30,512 @@ using namespace Microsoft::glTF::Toolkit;
 
 #include <DirectXTex.h>
 
+#include <unordered_map>
+#include <unordered_set>
+
 const char* Microsoft::glTF::Toolkit::EXTENSION_MSFT_TEXTURE_DDS = "MSFT_texture_dds";
 
-GLTFDocument GLTFTextureCompressionUtils::CompressTextureAsDDS(const IStreamReader& streamReader, const GLTFDocument & doc, const Texture & texture, TextureCompression compression, const std::string& outputDirectory, size_t maxTextureSize, bool generateMipMaps, bool retainOriginalImage)
+namespace
 {
-    GLTFDocument outputDoc(doc);
+    const JsonMemberPaths MSFT_PACKING_ORM_TEXTURE_PATHS =
+    {
+        { "roughnessMetallicOcclusionTexture", "index" },
+        { "occlusionRoughnessMetallicTexture", "index" },
+        { "normalTexture", "index" }
+    };
+    const size_t MSFT_PACKING_ORM_NORMAL_PATH = 2;
 
     // Early return cases:
     // - No compression requested
     // - This texture doesn't have an image associated
     // - The texture already has a DDS extension
-    if (compression == TextureCompression::None ||
-        texture.imageId.empty() ||
-        texture.extensions.find(EXTENSION_MSFT_TEXTURE_DDS) != texture.extensions.end())
+    bool ShouldCompressTexture(const Texture& texture, TextureCompression compression)
     {
-        // Return copy of document
-        return outputDoc;
+        return compression != TextureCompression::None &&
+            !texture.imageId.empty() &&
+            texture.extensions.find(EXTENSION_MSFT_TEXTURE_DDS) == texture.extensions.end();
     }
 
-    auto image = std::make_unique<DirectX::ScratchImage>(GLTFTextureLoadingUtils::LoadTexture(streamReader, doc, texture.id));
-
-    // Resize
-    auto metadata = image->GetMetadata();
-    if (maxTextureSize < metadata.width || maxTextureSize < metadata.height)
+    std::string GetCompressionSuffix(TextureCompression compression)
     {
-        auto scaleFactor = static_cast<double>(maxTextureSize) / std::max(metadata.width, metadata.height);
-        auto resizedWidth = static_cast<size_t>(std::llround(metadata.width * scaleFactor));
-        auto resizedHeight = static_cast<size_t>(std::llround(metadata.height * scaleFactor));
-        auto resized = std::make_unique<DirectX::ScratchImage>();
-        if (FAILED(DirectX::Resize(image->GetImages(), image->GetImageCount(), image->GetMetadata(), resizedWidth, resizedHeight, DirectX::TEX_FILTER_DEFAULT, *resized)))
+        switch (compression)
         {
-            throw GLTFException("Failed to resize image.");
+        case TextureCompression::BC3:
+            return "_BC3";
+        case TextureCompression::BC5:
+            return "_BC5";
+        case TextureCompression::BC7:
+            return "_BC7";
+        default:
+            throw GLTFException("Invalid compression.");
         }
-
-        image = std::move(resized);
     }
 
-    if (generateMipMaps)
+    std::string GetQualityName(TextureCompressionQuality quality)
     {
-        auto mipChain = std::make_unique<DirectX::ScratchImage>();
-        if (FAILED(DirectX::GenerateMipMaps(image->GetImages(), image->GetImageCount(), image->GetMetadata(), DirectX::TEX_FILTER_DEFAULT, 0, *mipChain)))
+        switch (quality)
         {
-            throw GLTFException("Failed to generate mip maps.");
+        case TextureCompressionQuality::Fast:
+            return "fast";
+        case TextureCompressionQuality::Balanced:
+            return "balanced";
+        case TextureCompressionQuality::Max:
+            return "max";
+        default:
+            throw GLTFException("Invalid compression quality.");
         }
-
-        image = std::move(mipChain);
     }
 
-    CompressImage(*image, compression);
-
-    // Save image to file
-    std::string outputImagePath = "texture_" + texture.id;
-
-    if (!generateMipMaps)
+    DWORD GetCompressionFlags(TextureCompressionQuality quality)
     {
-        // The default is to have mips, so note on the texture when it doesn't
-        outputImagePath += "_nomips";
+        switch (quality)
+        {
+        case TextureCompressionQuality::Fast:
+            return DirectX::TEX_COMPRESS_BC7_QUICK;
+        case TextureCompressionQuality::Balanced:
+            return DirectX::TEX_COMPRESS_DEFAULT;
+        case TextureCompressionQuality::Max:
+            return DirectX::TEX_COMPRESS_BC7_USE_3SUBSETS;
+        default:
+            throw GLTFException("Invalid compression quality.");
+        }
     }
 
-    switch (compression)
+    DXGI_FORMAT GetCompressionFormat(TextureCompression compression)
     {
-    case TextureCompression::BC3:
-        outputImagePath += "_BC3";
-        break;
-    case TextureCompression::BC5:
-        outputImagePath += "_BC5";
-        break;
-    case TextureCompression::BC7:
-        outputImagePath += "_BC7";
-        break;
-    default:
-        throw GLTFException("Invalid compression.");
-        break;
+        switch (compression)
+        {
+        case TextureCompression::BC3:
+            return DXGI_FORMAT_BC3_UNORM;
+        case TextureCompression::BC5:
+            return DXGI_FORMAT_BC5_UNORM;
+        case TextureCompression::BC7:
+            return DXGI_FORMAT_BC7_UNORM;
+        default:
+            throw std::invalid_argument("Invalid compression specified.");
+        }
     }
 
-    outputImagePath += ".dds";
-    std::wstring outputImagePathW(outputImagePath.begin(), outputImagePath.end());
+    // Compresses the images into output, on a GPU device leased from the pool, or in software if there is none or it fails.
+    // Software compression only uses every hardware thread if parallel is true, which callers that already compress
+    // several images at once leave false so that each of them does not start its own thread per core.
+    // Returns true if the images were compressed on the GPU.
+    bool CompressImages(const DirectX::Image* images, size_t imageCount, const DirectX::TexMetadata& metadata, TextureCompression compression, DeviceResourcesPool& devicePool, TextureCompressionQuality quality, bool parallel, DirectX::ScratchImage& output)
+    {
+        DXGI_FORMAT compressionFormat = GetCompressionFormat(compression);
+        DWORD compressionFlags = GetCompressionFlags(quality);
 
-    wchar_t outputImageFullPath[MAX_PATH];
+        bool gpuCompressionSuccessful = false;
+        {
+            auto deviceLease = devicePool.Acquire();
+            if (deviceLease)
+            {
+                auto compressOnDevice = [&]()
+                {
+                    return SUCCEEDED(DirectX::Compress(deviceLease->GetD3DDevice(), images, imageCount, metadata, compressionFormat, compressionFlags, 0, output));
+                };
+
+                gpuCompressionSuccessful = compressOnDevice();
+
+                // If the device was removed or reset (e.g. driver update or TDR), recreate it and try once more
+                if (!gpuCompressionSuccessful &&
+                    FAILED(deviceLease->GetD3DDevice()->GetDeviceRemovedReason()) &&
+                    deviceLease.HandleDeviceLost())
+                {
+                    gpuCompressionSuccessful = compressOnDevice();
+                }
+            }
+        }
+
+        if (!gpuCompressionSuccessful)
+        {
+            // Try software compression, on every hardware thread if nothing else is compressing, since this is the slow path
+            if (parallel)
+            {
+                compressionFlags |= DirectX::TEX_COMPRESS_PARALLEL;
+            }
 
-    std::wstring outputDirectoryW(outputDirectory.begin(), outputDirectory.end());
+            if (FAILED(DirectX::Compress(images, imageCount, metadata, compressionFormat, compressionFlags, 0, output)))
+            {
+                throw GLTFException("Failed to compress data using software compression");
+            }
+        }
 
-    if (FAILED(::PathCchCombine(outputImageFullPath, ARRAYSIZE(outputImageFullPath), outputDirectoryW.c_str(), outputImagePathW.c_str())))
-    {
-        throw GLTFException("Failed to compose output file path.");
+        return gpuCompressionSuccessful;
     }
 
-    if (FAILED(SaveToDDSFile(image->GetImages(), image->GetImageCount(), image->GetMetadata(), DirectX::DDS_FLAGS::DDS_FLAGS_NONE, outputImageFullPath)))
+    // Compresses the image in place, if compression is not None
+    void CompressScratchImage(DirectX::ScratchImage& image, TextureCompression compression, DeviceResourcesPool& devicePool, TextureCompressionQuality quality, bool parallel)
     {
-        throw GLTFException("Failed to save image as DDS.");
-    }
+        if (compression == TextureCompression::None)
+        {
+            return;
+        }
 
-    std::wstring outputImageFullPathW(outputImageFullPath);
-    std::string outputImageFullPathA(outputImageFullPathW.begin(), outputImageFullPathW.end());
+        Instrumentation::Stage stage("Encode");
+        stage.SetProperty("quality", GetQualityName(quality));
 
-    // Add back to GLTF
-    std::string ddsImageId(texture.imageId);
+        DirectX::ScratchImage compressedImage;
+        bool gpuCompressionSuccessful = CompressImages(image.GetImages(), image.GetImageCount(), image.GetMetadata(), compression, devicePool, quality, parallel, compressedImage);
 
-    Image ddsImage(doc.images.Get(texture.imageId));
-    ddsImage.mimeType = "image/vnd-ms.dds";
-    ddsImage.uri = outputImageFullPathA;
+        stage.SetProperty("device", gpuCompressionSuccessful ? "GPU" : "CPU");
 
-    if (retainOriginalImage)
-    {
-        ddsImageId.assign(std::to_string(doc.images.Size()));
-        ddsImage.id = ddsImageId;
-        outputDoc.images.Append(std::move(ddsImage));
+        image = std::move(compressedImage);
     }
-    else
+
+    // Decodes, generates mips for and compresses an image read by WIC a band of rows at a time, into output. BC blocks
+    // are independent of each other, so the result is the same as compressing the whole image at once.
+    // Returns false if the image cannot be read by WIC.
+    bool CompressImageDataTiled(const std::vector<uint8_t>& sourceImageData, TextureCompression compression, size_t maxTextureSize, bool generateMipMaps, size_t tileRows, TextureCompressionQuality quality, bool parallel, DirectX::ScratchImage& output)
     {
-        outputDoc.images.Replace(ddsImage);
-    }
+        Instrumentation::Stage stage("EncodeTiled");
+        stage.SetProperty("quality", GetQualityName(quality));
+        stage.SetProperty("tile_rows", std::to_string(tileRows));
 
-    Texture ddsTexture(texture);
+        bool allOnGPU = true;
+        bool tiled = GLTFTextureLoadingUtils::LoadImageDataTiled(sourceImageData.data(), sourceImageData.size(), maxTextureSize, generateMipMaps, tileRows,
+            [&](const DirectX::TexMetadata& metadata, size_t mipLevel, size_t firstRow, const DirectX::Image& band)
+        {
+            if (mipLevel == 0 && firstRow == 0)
+            {
+                if (FAILED(output.Initialize2D(GetCompressionFormat(compression), metadata.width, metadata.height, 1, metadata.mipLevels)))
+                {
+                    throw GLTFException("Failed to allocate the compressed image.");
+                }
+            }
 
-    // Create the JSON for the DDS extension element
-    rapidjson::Document ddsExtensionJson;
-    ddsExtensionJson.SetObject();
+            DirectX::TexMetadata bandMetadata = metadata;
+            bandMetadata.width = band.width;
+            bandMetadata.height = band.height;
+            bandMetadata.mipLevels = 1;
 
-    ddsExtensionJson.AddMember("source", rapidjson::Value(std::stoi(ddsImageId)), ddsExtensionJson.GetAllocator());
+            DirectX::ScratchImage compressedBand;
+            if (!CompressImages(&band, 1, bandMetadata, compression, DeviceResourcesPool::GetShared(), quality, parallel, compressedBand))
+            {
+                allOnGPU = false;
+            }
 
-    rapidjson::StringBuffer buffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    ddsExtensionJson.Accept(writer);
+            // Bands start on a block row, and have the width of their level, so their blocks are a contiguous range of the level
+            const DirectX::Image* source = compressedBand.GetImage(0, 0, 0);
+            const DirectX::Image* target = output.GetImage(mipLevel, 0, 0);
+            size_t targetOffset = (firstRow / 4) * target->rowPitch;
+            if (source->rowPitch != target->rowPitch || targetOffset + source->slicePitch > target->slicePitch)
+            {
+                throw GLTFException("Failed to compress image band.");
+            }
 
-    ddsTexture.extensions.insert(std::pair<std::string, std::string>(EXTENSION_MSFT_TEXTURE_DDS, buffer.GetString()));
+            memcpy(target->pixels + targetOffset, source->pixels, source->slicePitch);
+        });
 
-    outputDoc.textures.Replace(ddsTexture);
+        stage.SetProperty("device", allOnGPU ? "GPU" : "CPU");
 
-    outputDoc.extensionsUsed.insert(EXTENSION_MSFT_TEXTURE_DDS);
+        return tiled;
+    }
 
-    if (!retainOriginalImage)
+    std::wstring CombinePath(const std::string& directory, const std::string& fileName)
     {
-        outputDoc.extensionsRequired.insert(EXTENSION_MSFT_TEXTURE_DDS);
+        std::wstring directoryW(directory.begin(), directory.end());
+        std::wstring fileNameW(fileName.begin(), fileName.end());
+
+        wchar_t fullPath[MAX_PATH];
+
+        if (FAILED(::PathCchCombine(fullPath, ARRAYSIZE(fullPath), directoryW.c_str(), fileNameW.c_str())))
+        {
+            throw GLTFException("Failed to compose output file path.");
+        }
+
+        return fullPath;
     }
 
-    return outputDoc;
-}
+    // The cache key identifies the source image by its contents, so renamed or moved images still hit the cache,
+    // and includes every parameter that changes the encoded result.
+    std::wstring GetCachedDDSPath(const std::string& cacheDirectory, const std::vector<uint8_t>& sourceImageData, TextureCompression compression, size_t maxTextureSize, bool generateMipMaps, TextureCompressionQuality quality)
+    {
+        std::string cacheFileName = HashUtils::ComputeSHA256(sourceImageData.data(), sourceImageData.size());
+        cacheFileName += GetCompressionSuffix(compression);
+        cacheFileName += "_" + std::to_string(maxTextureSize);
 
-GLTFDocument GLTFTextureCompressionUtils::CompressAllTexturesForWindowsMR(const IStreamReader& streamReader, const GLTFDocument & doc, const std::string& outputDirectory, size_t maxTextureSize, bool retainOriginalImages)
-{
-    GLTFDocument outputDoc(doc);
+        if (!generateMipMaps)
+        {
+            cacheFileName += "_nomips";
+        }
+
+        // Balanced keeps the names of the entries cached before the quality could be chosen
+        if (quality != TextureCompressionQuality::Balanced)
+        {
+            cacheFileName += "_" + GetQualityName(quality);
+        }
+
+        cacheFileName += ".dds";
+
+        return CombinePath(cacheDirectory, cacheFileName);
+    }
 
-    for (auto material : doc.materials.Elements())
+    void AddToCache(const std::wstring& ddsPath, const std::wstring& cachedDDSPath)
     {
-        auto compressIfNotEmpty = [&outputDoc, &streamReader, &outputDirectory, maxTextureSize, retainOriginalImages](const std::string& textureId, TextureCompression compression)
+        // Copy to a unique temporary name and rename it, so that other converters sharing the
+        // cache directory never see a partially written file. Failing to cache is not an error.
+        GUID guid = { 0 };
+        wchar_t guidRaw[MAX_PATH];
+        if (FAILED(CoCreateGuid(&guid)) || StringFromGUID2(guid, guidRaw, ARRAYSIZE(guidRaw)) == 0)
         {
-            if (!textureId.empty())
+            return;
+        }
+
+        std::wstring temporaryPath = cachedDDSPath + guidRaw + L".tmp";
+        if (CopyFileW(ddsPath.c_str(), temporaryPath.c_str(), FALSE))
+        {
+            if (!MoveFileExW(temporaryPath.c_str(), cachedDDSPath.c_str(), MOVEFILE_REPLACE_EXISTING))
             {
-                outputDoc = CompressTextureAsDDS(streamReader, outputDoc, outputDoc.textures.Get(textureId), compression, outputDirectory, maxTextureSize, true, retainOriginalImages);
+                DeleteFileW(temporaryPath.c_str());
             }
-        };
+        }
+    }
 
-        // Compress base and emissive texture as BC7
-        compressIfNotEmpty(material.metallicRoughness.baseColorTextureId, TextureCompression::BC7);
-        compressIfNotEmpty(material.emissiveTextureId, TextureCompression::BC7);
+    // Loads, resizes, generates mips for and compresses the texture, and saves the result as a DDS file
+    // in the output directory. Returns the full path to the saved file. Does not modify the document.
+    // If a cache directory is specified, reuses a previous result for the same image and parameters when available.
+    // If tileRows is not 0, images read by WIC are decoded and compressed a band of rows at a time.
+    // If parallel is true, software compression uses every hardware thread.
+    std::string CompressTextureToDDSFile(const IStreamReader& streamReader, const GLTFDocument& doc, const Texture& texture, TextureCompression compression, const std::string& outputDirectory, size_t maxTextureSize, bool generateMipMaps, const std::string& cacheDirectory, TextureCompressionQuality quality, size_t tileRows, bool parallel)
+    {
+        // Named after the public entry point, which every compression goes through
+        Instrumentation::Stage stage("CompressTextureAsDDS");
+        stage.SetProperty("texture", texture.id);
+        stage.SetProperty("compression", GetCompressionSuffix(compression).substr(1));
+        stage.SetProperty("quality", GetQualityName(quality));
 
-        // Get other textures from the MSFT_packing_occlusionRoughnessMetallic extension
-        if (material.extensions.find(EXTENSION_MSFT_PACKING_ORM) != material.extensions.end())
+        std::string outputImagePath = "texture_" + texture.id;
+
+        if (!generateMipMaps)
         {
-            rapidjson::Document packingOrmContents;
-            packingOrmContents.Parse(material.extensions[EXTENSION_MSFT_PACKING_ORM].c_str());
+            // The default is to have mips, so note on the texture when it doesn't
+            outputImagePath += "_nomips";
+        }
 
-            // Compress packed textures as BC7
-            if (packingOrmContents.HasMember("roughnessMetallicOcclusionTexture"))
-            {
-                auto rmoTextureId = packingOrmContents["roughnessMetallicOcclusionTexture"]["index"].GetInt();
-                compressIfNotEmpty(std::to_string(rmoTextureId), TextureCompression::BC7);
-            }
+        outputImagePath += GetCompressionSuffix(compression);
+        outputImagePath += ".dds";
 
-            if (packingOrmContents.HasMember("occlusionRoughnessMetallicTexture"))
-            {
-                auto ormTextureId = packingOrmContents["occlusionRoughnessMetallicTexture"]["index"].GetInt();
-                compressIfNotEmpty(std::to_string(ormTextureId), TextureCompression::BC7);
-            }
+        std::wstring outputImageFullPathW = CombinePath(outputDirectory, outputImagePath);
+        std::string outputImageFullPathA(outputImageFullPathW.begin(), outputImageFullPathW.end());
+
+        // Read the source image once, both to identify it in the cache and to decode it
+        GLTFResourceReader gltfResourceReader(streamReader);
+        auto sourceImageData = gltfResourceReader.ReadBinaryData(doc, doc.images.Get(texture.imageId));
+        stage.AddBytesRead(sourceImageData.size());
+
+        std::wstring cachedDDSPath;
+        if (!cacheDirectory.empty())
+        {
+            cachedDDSPath = GetCachedDDSPath(cacheDirectory, sourceImageData, compression, maxTextureSize, generateMipMaps, quality);
 
-            // Compress normal texture as BC5
-            if (packingOrmContents.HasMember("normalTexture"))
+            if (CopyFileW(cachedDDSPath.c_str(), outputImageFullPathW.c_str(), FALSE))
             {
-                auto normalTextureId = packingOrmContents["normalTexture"]["index"].GetInt();
-                compressIfNotEmpty(std::to_string(normalTextureId), TextureCompression::BC5);
+                // Cache hit
+                stage.SetProperty("cache", "hit");
+                stage.AddFileWritten(outputImageFullPathW);
+                return outputImageFullPathA;
             }
+
+            stage.SetProperty("cache", "miss");
+        }
+
+        // Held until the compressed image is saved, since every step until then keeps a decoded copy in memory
+        auto imageLease = GLTFTextureLoadingUtils::GetInFlightImageLimit().Acquire();
+
+        // The cache key does not depend on tiling, since the compressed blocks are the same either way
+        auto image = std::make_unique<DirectX::ScratchImage>();
+        if (tileRows == 0 || !CompressImageDataTiled(sourceImageData, compression, maxTextureSize, generateMipMaps, tileRows, quality, parallel, *image))
+        {
+            // Decode straight to the output size, with the mip chain generated in the same buffer when possible
+            *image = GLTFTextureLoadingUtils::LoadImageData(sourceImageData.data(), sourceImageData.size(), DXGI_FORMAT_R8G8B8A8_UNORM, maxTextureSize, generateMipMaps);
+
+            // The encoded data is no longer needed, release it before compressing
+            std::vector<uint8_t>().swap(sourceImageData);
+
+            CompressScratchImage(*image, compression, DeviceResourcesPool::GetShared(), quality, parallel);
+        }
+
+        // Save image to file
+        if (FAILED(SaveToDDSFile(image->GetImages(), image->GetImageCount(), image->GetMetadata(), DirectX::DDS_FLAGS::DDS_FLAGS_NONE, outputImageFullPathW.c_str())))
+        {
+            throw GLTFException("Failed to save image as DDS.");
+        }
+
+        stage.AddFileWritten(outputImageFullPathW);
+
+        if (!cachedDDSPath.empty())
+        {
+            AddToCache(outputImageFullPathW, cachedDDSPath);
+        }
+
+        return outputImageFullPathA;
+    }
+
+    // Adds the DDS image saved at ddsImagePath to the document, and points the texture to it
+    // using the MSFT_texture_dds extension.
+    void AddDDSImageToDocument(GLTFDocument& outputDoc, const Texture& texture, const std::string& ddsImagePath, bool retainOriginalImage)
+    {
+        std::string ddsImageId(texture.imageId);
+
+        Image ddsImage(outputDoc.images.Get(texture.imageId));
+        ddsImage.mimeType = "image/vnd-ms.dds";
+        ddsImage.uri = ddsImagePath;
+
+        if (retainOriginalImage)
+        {
+            ddsImageId.assign(std::to_string(outputDoc.images.Size()));
+            ddsImage.id = ddsImageId;
+            outputDoc.images.Append(std::move(ddsImage));
+        }
+        else
+        {
+            outputDoc.images.Replace(ddsImage);
+        }
+
+        Texture ddsTexture(texture);
+
+        // Create the JSON for the DDS extension element
+        rapidjson::Document ddsExtensionJson;
+        ddsExtensionJson.SetObject();
+
+        ddsExtensionJson.AddMember("source", rapidjson::Value(std::stoi(ddsImageId)), ddsExtensionJson.GetAllocator());
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        ddsExtensionJson.Accept(writer);
+
+        ddsTexture.extensions.insert(std::pair<std::string, std::string>(EXTENSION_MSFT_TEXTURE_DDS, buffer.GetString()));
+
+        outputDoc.textures.Replace(ddsTexture);
+
+        outputDoc.extensionsUsed.insert(EXTENSION_MSFT_TEXTURE_DDS);
+
+        if (!retainOriginalImage)
+        {
+            outputDoc.extensionsRequired.insert(EXTENSION_MSFT_TEXTURE_DDS);
         }
     }
+}
+
+GLTFDocument GLTFTextureCompressionUtils::CompressTextureAsDDS(const IStreamReader& streamReader, const GLTFDocument & doc, const Texture & texture, TextureCompression compression, const std::string& outputDirectory, size_t maxTextureSize, bool generateMipMaps, bool retainOriginalImage, const std::string& cacheDirectory, TextureCompressionQuality quality, size_t tileRows)
+{
+    GLTFDocument outputDoc(doc);
+
+    CompressTextureAsDDSInPlace(streamReader, outputDoc, texture, compression, outputDirectory, maxTextureSize, generateMipMaps, retainOriginalImage, cacheDirectory, quality, tileRows);
 
     return outputDoc;
 }
 
-void GLTFTextureCompressionUtils::CompressImage(DirectX::ScratchImage& image, TextureCompression compression)
+void GLTFTextureCompressionUtils::CompressTextureAsDDSInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const Texture& texture, TextureCompression compression, const std::string& outputDirectory, size_t maxTextureSize, bool generateMipMaps, bool retainOriginalImage, const std::string& cacheDirectory, TextureCompressionQuality quality, size_t tileRows)
 {
-    if (compression == TextureCompression::None)
+    if (!ShouldCompressTexture(texture, compression))
     {
         return;
     }
 
-    DXGI_FORMAT compressionFormat = DXGI_FORMAT_BC7_UNORM;
-    switch (compression)
-    {
-    case TextureCompression::BC3:
-        compressionFormat = DXGI_FORMAT_BC3_UNORM;
-        break;
-    case TextureCompression::BC5:
-        compressionFormat = DXGI_FORMAT_BC5_UNORM;
-        break;
-    case TextureCompression::BC7:
-        compressionFormat = DXGI_FORMAT_BC7_UNORM;
-        break;
-    default:
-        throw std::invalid_argument("Invalid compression specified.");
-        break;
-    }
+    // Copy the texture, since it may be an element of the document that is about to change
+    Texture sourceTexture(texture);
+
+    auto ddsImagePath = CompressTextureToDDSFile(streamReader, doc, sourceTexture, compression, outputDirectory, maxTextureSize, generateMipMaps, cacheDirectory, quality, tileRows, true);
+
+    // Add back to GLTF
+    AddDDSImageToDocument(doc, sourceTexture, ddsImagePath, retainOriginalImage);
+}
+
+GLTFDocument GLTFTextureCompressionUtils::CompressAllTexturesForWindowsMR(const IStreamReader& streamReader, const GLTFDocument & doc, const std::string& outputDirectory, size_t maxTextureSize, bool retainOriginalImages, size_t maxParallelism, const std::string& cacheDirectory, TextureCompressionQuality quality, size_t tileRows)
+{
+    GLTFDocument outputDoc(doc);
 
-    DX::DeviceResources deviceResources;
-    deviceResources.CreateDeviceResources();
-    ComPtr<ID3D11Device> device(deviceResources.GetD3DDevice());
-    
-    DirectX::ScratchImage compressedImage;
+    CompressAllTexturesForWindowsMRInPlace(streamReader, outputDoc, outputDirectory, maxTextureSize, retainOriginalImages, maxParallelism, cacheDirectory, quality, tileRows);
 
-    bool gpuCompressionSuccessful = false;
-    if (device != nullptr)
+    return outputDoc;
+}
+
+void GLTFTextureCompressionUtils::CompressAllTexturesForWindowsMRInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const std::string& outputDirectory, size_t maxTextureSize, bool retainOriginalImages, size_t maxParallelism, const std::string& cacheDirectory, TextureCompressionQuality quality, size_t tileRows)
+{
+    // 1. Collect the compression jobs. Each texture is only compressed once, with the
+    // compression of the first material slot that references it.
+    std::vector<std::pair<std::string, TextureCompression>> jobs;
+    std::unordered_set<std::string> queuedTextureIds;
+
+    for (const auto& material : doc.materials.Elements())
     {
-        if (SUCCEEDED(DirectX::Compress(device.Get(), image.GetImages(), image.GetImageCount(), image.GetMetadata(), compressionFormat, DirectX::TEX_COMPRESS_DEFAULT, 0, compressedImage)))
+        auto queueIfNotEmpty = [&doc, &jobs, &queuedTextureIds](const std::string& textureId, TextureCompression compression)
+        {
+            if (!textureId.empty() &&
+                ShouldCompressTexture(doc.textures.Get(textureId), compression) &&
+                queuedTextureIds.insert(textureId).second)
+            {
+                jobs.emplace_back(textureId, compression);
+            }
+        };
+
+        // Compress base and emissive texture as BC7
+        queueIfNotEmpty(material.metallicRoughness.baseColorTextureId, TextureCompression::BC7);
+        queueIfNotEmpty(material.emissiveTextureId, TextureCompression::BC7);
+
+        // Get other textures from the MSFT_packing_occlusionRoughnessMetallic extension
+        auto packingOrmIt = material.extensions.find(EXTENSION_MSFT_PACKING_ORM);
+        if (packingOrmIt != material.extensions.end())
         {
-            gpuCompressionSuccessful = true;
+            auto packedTextures = GLTFExtensionUtils::ReadIndices(packingOrmIt->second, MSFT_PACKING_ORM_TEXTURE_PATHS);
+
+            // Compress packed textures as BC7, and the normal texture as BC5
+            for (size_t path = 0; path < packedTextures.size(); path++)
+            {
+                for (auto textureIndex : packedTextures[path])
+                {
+                    queueIfNotEmpty(std::to_string(textureIndex), path == MSFT_PACKING_ORM_NORMAL_PATH ? TextureCompression::BC5 : TextureCompression::BC7);
+                }
+            }
         }
     }
 
-    if (!gpuCompressionSuccessful)
+    // 2. Encode each distinct (image, compression) pair once. Textures that share an image and
+    // compression reuse the file encoded for the first of them.
+    std::vector<size_t> encodeJobs;
+    std::vector<size_t> encodeIndexForJob(jobs.size());
+    std::unordered_map<std::string, size_t> encodeIndexForImage;
+
+    for (size_t jobIndex = 0; jobIndex < jobs.size(); jobIndex++)
     {
-        // Try software compression
-        if (FAILED(DirectX::Compress(image.GetImages(), image.GetImageCount(), image.GetMetadata(), compressionFormat, DirectX::TEX_COMPRESS_DEFAULT, 0, compressedImage)))
+        const auto& job = jobs[jobIndex];
+        auto key = doc.textures.Get(job.first).imageId + "|" + std::to_string(static_cast<int>(job.second));
+        auto inserted = encodeIndexForImage.emplace(key, encodeJobs.size());
+        if (inserted.second)
         {
-            throw GLTFException("Failed to compress data using software compression");
+            encodeJobs.push_back(jobIndex);
         }
+
+        encodeIndexForJob[jobIndex] = inserted.first->second;
     }
 
-    image = std::move(compressedImage);
+    // Each encode only reads from the document and writes its own file
+    std::vector<std::string> ddsImagePaths(encodeJobs.size());
+
+    ParallelUtils::ParallelFor(encodeJobs.size(), maxParallelism, [&](size_t encodeIndex)
+    {
+        const auto& job = jobs[encodeJobs[encodeIndex]];
+        // Software compression can use every core when no other image is compressed at the same time
+        const bool parallelCompression = maxParallelism == 1 || encodeJobs.size() == 1;
+        ddsImagePaths[encodeIndex] = CompressTextureToDDSFile(streamReader, doc, doc.textures.Get(job.first), job.second, outputDirectory, maxTextureSize, true, cacheDirectory, quality, tileRows, parallelCompression);
+    });
+
+    // 3. Merge the results back in job order, so image ids do not depend on which job finished first
+    for (size_t jobIndex = 0; jobIndex < jobs.size(); jobIndex++)
+    {
+        Texture texture(doc.textures.Get(jobs[jobIndex].first));
+        AddDDSImageToDocument(doc, texture, ddsImagePaths[encodeIndexForJob[jobIndex]], retainOriginalImages);
+    }
+}
+
+void GLTFTextureCompressionUtils::CompressImage(DirectX::ScratchImage& image, TextureCompression compression, TextureCompressionQuality quality)
+{
+    CompressImage(image, compression, DeviceResourcesPool::GetShared(), quality);
+}
+
+void GLTFTextureCompressionUtils::CompressImage(DirectX::ScratchImage& image, TextureCompression compression, DeviceResourcesPool& devicePool, TextureCompressionQuality quality)
+{
+    CompressScratchImage(image, compression, devicePool, quality, true);
 }
\ No newline at end of file
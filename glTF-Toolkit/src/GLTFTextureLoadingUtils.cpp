@@ -7,17 +7,271 @@
 #include <GLTFSDK/GLTFResourceReader.h>
 
 #include "GLTFTextureLoadingUtils.h"
+#include "Instrumentation.h"
+#include "ScratchArena.h"
 
+using namespace Microsoft::WRL;
 using namespace Microsoft::glTF;
 using namespace Microsoft::glTF::Toolkit;
 
 namespace
 {
+    // The size of an image scaled down so that neither of its sides is larger than maxSize
+    std::pair<size_t, size_t> GetScaledSize(size_t width, size_t height, size_t maxSize)
+    {
+        if (maxSize >= width && maxSize >= height)
+        {
+            return { width, height };
+        }
+
+        auto scaleFactor = static_cast<double>(maxSize) / std::max(width, height);
+        return {
+            std::max<size_t>(1, static_cast<size_t>(std::llround(width * scaleFactor))),
+            std::max<size_t>(1, static_cast<size_t>(std::llround(height * scaleFactor)))
+        };
+    }
+
+    bool IsDDS(const uint8_t* imageData, size_t imageDataSize)
+    {
+        return imageDataSize >= 4 && imageData[0] == 'D' && imageData[1] == 'D' && imageData[2] == 'S' && imageData[3] == ' ';
+    }
+
+    // Builds the WIC chain that decodes the first frame of an image as RGBA8, scaled to the size returned by getSize for
+    // the size of the frame. The scaler pulls rows from the decoder as it needs them, and uses the scaled decoding of codecs
+    // that have it. Returns false if WIC cannot decode the image this way.
+    bool OpenScaledWICSource(const uint8_t* imageData, size_t imageDataSize, const std::function<std::pair<size_t, size_t>(size_t, size_t)>& getSize,
+        ComPtr<IWICStream>& stream, ComPtr<IWICBitmapSource>& source, size_t& scaledWidth, size_t& scaledHeight)
+    {
+        bool isWIC2 = false;
+        IWICImagingFactory* factory = DirectX::GetWICFactory(isWIC2);
+        if (factory == nullptr || imageDataSize > std::numeric_limits<DWORD>::max() || IsDDS(imageData, imageDataSize))
+        {
+            return false;
+        }
+
+        ComPtr<IWICBitmapDecoder> decoder;
+        ComPtr<IWICBitmapFrameDecode> frame;
+        if (FAILED(factory->CreateStream(&stream)) ||
+            FAILED(stream->InitializeFromMemory(const_cast<uint8_t*>(imageData), static_cast<DWORD>(imageDataSize))) ||
+            FAILED(factory->CreateDecoderFromStream(stream.Get(), nullptr, WICDecodeMetadataCacheOnDemand, &decoder)) ||
+            FAILED(decoder->GetFrame(0, &frame)))
+        {
+            return false;
+        }
+
+        UINT width = 0;
+        UINT height = 0;
+        if (FAILED(frame->GetSize(&width, &height)))
+        {
+            return false;
+        }
+
+        auto scaledSize = getSize(width, height);
+        if (scaledSize.first == 0 || scaledSize.second == 0 ||
+            scaledSize.first > std::numeric_limits<UINT>::max() || scaledSize.second > std::numeric_limits<UINT>::max())
+        {
+            return false;
+        }
+
+        scaledWidth = scaledSize.first;
+        scaledHeight = scaledSize.second;
+
+        auto createConverter = [&](IWICBitmapSource* converterSource, ComPtr<IWICFormatConverter>& converter)
+        {
+            return SUCCEEDED(factory->CreateFormatConverter(&converter)) &&
+                SUCCEEDED(converter->Initialize(converterSource, GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom));
+        };
+
+        auto createScaler = [&](IWICBitmapSource* scalerSource, ComPtr<IWICBitmapScaler>& scaler)
+        {
+            return SUCCEEDED(factory->CreateBitmapScaler(&scaler)) &&
+                SUCCEEDED(scaler->Initialize(scalerSource, static_cast<UINT>(scaledWidth), static_cast<UINT>(scaledHeight), WICBitmapInterpolationModeFant));
+        };
+
+        ComPtr<IWICBitmapScaler> scaler;
+        ComPtr<IWICFormatConverter> converter;
+        if (scaledWidth == width && scaledHeight == height)
+        {
+            if (!createConverter(frame.Get(), converter))
+            {
+                return false;
+            }
+
+            source = converter;
+        }
+        else if (createScaler(frame.Get(), scaler) && createConverter(scaler.Get(), converter))
+        {
+            // Scaling the frame itself lets codecs such as JPEG downscale while decoding
+            source = converter;
+        }
+        else
+        {
+            // Some pixel formats (e.g. palettes) can't be scaled as they are, convert them first
+            if (!createConverter(frame.Get(), converter) || !createScaler(converter.Get(), scaler))
+            {
+                return false;
+            }
+
+            source = scaler;
+        }
+
+        return true;
+    }
+
+    // Decodes the first frame of a WIC image as RGBA8, scaled to fit in maxSize, into the first mip level of output,
+    // so the image is never held in memory at full size. Returns false if WIC cannot decode the image this way.
+    bool DecodeScaledWICImage(const uint8_t* imageData, size_t imageDataSize, size_t maxSize, bool generateMipMaps, DirectX::ScratchImage& output)
+    {
+        auto reader = TiledImageReader::Open(imageData, imageDataSize, maxSize);
+        if (reader == nullptr)
+        {
+            return false;
+        }
+
+        if (FAILED(output.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, reader->GetWidth(), reader->GetHeight(), 1, generateMipMaps ? 0 : 1)))
+        {
+            throw GLTFException("Failed to allocate the decoded image.");
+        }
+
+        const DirectX::Image* topLevel = output.GetImage(0, 0, 0);
+        if (!reader->ReadRows(0, topLevel->height, topLevel->pixels, topLevel->rowPitch))
+        {
+            output.Release();
+            return false;
+        }
+
+        return true;
+    }
+
+    // Fills one row of an RGBA8 mip level from two rows of the level above it with a 2x2 box filter. The target width is
+    // half the source width rounded down, so the last column of an odd width is not sampled, except for a 1-pixel-wide
+    // source, whose only column is used twice.
+    void DownsampleRow(const uint8_t* sourceRow0, const uint8_t* sourceRow1, size_t sourceWidth, uint8_t* targetRow, size_t targetWidth)
+    {
+        for (size_t x = 0; x < targetWidth; x++)
+        {
+            size_t x0 = std::min(2 * x, sourceWidth - 1) * 4;
+            size_t x1 = std::min(2 * x + 1, sourceWidth - 1) * 4;
+            for (size_t channel = 0; channel < 4; channel++)
+            {
+                unsigned int sum = sourceRow0[x0 + channel] + sourceRow0[x1 + channel] + sourceRow1[x0 + channel] + sourceRow1[x1 + channel];
+                targetRow[x * 4 + channel] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+
+    // Fills every mip level of an RGBA8 image but the first, each from the level above it with a 2x2 box filter.
+    // Like columns in DownsampleRow, the last row of an odd height is not sampled, and the only row of a 1-pixel-high level is used twice.
+    void GenerateMipMapsInPlace(DirectX::ScratchImage& image)
+    {
+        for (size_t level = 1; level < image.GetMetadata().mipLevels; level++)
+        {
+            const DirectX::Image* source = image.GetImage(level - 1, 0, 0);
+            const DirectX::Image* target = image.GetImage(level, 0, 0);
+
+            for (size_t y = 0; y < target->height; y++)
+            {
+                const uint8_t* sourceRow0 = source->pixels + std::min(2 * y, source->height - 1) * source->rowPitch;
+                const uint8_t* sourceRow1 = source->pixels + std::min(2 * y + 1, source->height - 1) * source->rowPitch;
+                DownsampleRow(sourceRow0, sourceRow1, source->width, target->pixels + y * target->rowPitch, target->width);
+            }
+        }
+    }
+
+    // The number of levels in a full mip chain, halving each side (rounding down) until both are 1, like DirectXTex
+    size_t CountMipLevels(size_t width, size_t height)
+    {
+        size_t mipLevels = 1;
+        while (width > 1 || height > 1)
+        {
+            width = std::max<size_t>(1, width / 2);
+            height = std::max<size_t>(1, height / 2);
+            mipLevels++;
+        }
+
+        return mipLevels;
+    }
+
+    // One band of rows of a mip level, held while it is streamed
+    struct MipLevelBand
+    {
+        size_t width;
+        size_t height;
+        size_t rowPitch;
+        size_t firstRow;
+        size_t rowCount;
+        ScratchArena::Lease pixels;
+    };
+}
+
+std::unique_ptr<TiledImageReader> TiledImageReader::Open(const uint8_t* imageData, size_t imageDataSize, size_t maxSize)
+{
+    ComPtr<IWICStream> stream;
+    ComPtr<IWICBitmapSource> source;
+    size_t width = 0;
+    size_t height = 0;
+    auto getSize = [maxSize](size_t frameWidth, size_t frameHeight) { return GetScaledSize(frameWidth, frameHeight, maxSize); };
+    if (!OpenScaledWICSource(imageData, imageDataSize, getSize, stream, source, width, height))
+    {
+        return nullptr;
+    }
+
+    return std::unique_ptr<TiledImageReader>(new TiledImageReader(std::move(stream), std::move(source), width, height));
+}
+
+std::unique_ptr<TiledImageReader> TiledImageReader::Open(const uint8_t* imageData, size_t imageDataSize, size_t width, size_t height)
+{
+    ComPtr<IWICStream> stream;
+    ComPtr<IWICBitmapSource> source;
+    auto getSize = [width, height](size_t, size_t) { return std::make_pair(width, height); };
+    if (!OpenScaledWICSource(imageData, imageDataSize, getSize, stream, source, width, height))
+    {
+        return nullptr;
+    }
+
+    return std::unique_ptr<TiledImageReader>(new TiledImageReader(std::move(stream), std::move(source), width, height));
+}
+
+TiledImageReader::TiledImageReader(ComPtr<IWICStream> stream, ComPtr<IWICBitmapSource> source, size_t width, size_t height) :
+    m_stream(std::move(stream)),
+    m_source(std::move(source)),
+    m_width(width),
+    m_height(height)
+{
+}
+
+TiledImageReader::~TiledImageReader() = default;
+
+bool TiledImageReader::ReadRows(size_t firstRow, size_t rowCount, uint8_t* pixels, size_t rowPitch) const
+{
+    if (firstRow + rowCount > m_height)
+    {
+        throw std::invalid_argument("The rows are outside of the image.");
+    }
+
+    if (rowCount == 0)
+    {
+        return true;
+    }
+
+    if (rowPitch > std::numeric_limits<UINT>::max() || rowPitch * rowCount > std::numeric_limits<UINT>::max())
+    {
+        return false;
+    }
+
+    WICRect rect = { 0, static_cast<INT>(firstRow), static_cast<INT>(m_width), static_cast<INT>(rowCount) };
+    return SUCCEEDED(m_source->CopyPixels(&rect, static_cast<UINT>(rowPitch), static_cast<UINT>(rowPitch * rowCount), pixels));
 }
 
 DirectX::ScratchImage GLTFTextureLoadingUtils::LoadTexture(const IStreamReader& streamReader, const GLTFDocument& doc, const std::string& textureId)
 {
-    DirectX::ScratchImage output;
+    return LoadTexture(streamReader, doc, textureId, DXGI_FORMAT_R32G32B32A32_FLOAT);
+}
+
+DirectX::ScratchImage GLTFTextureLoadingUtils::LoadTexture(const IStreamReader& streamReader, const GLTFDocument& doc, const std::string& textureId, DXGI_FORMAT format)
+{
+    Instrumentation::Stage stage("LoadTexture");
+    stage.SetProperty("texture", textureId);
 
     const Texture& texture = doc.textures.Get(textureId);
 
@@ -26,34 +280,206 @@ DirectX::ScratchImage GLTFTextureLoadingUtils::LoadTexture(const IStreamReader&
     const Image& image = doc.images.Get(texture.imageId);
 
     std::vector<uint8_t> imageData = gltfResourceReader.ReadBinaryData(doc, image);
+    stage.AddBytesRead(imageData.size());
 
-    auto data = std::make_unique<uint8_t[]>(imageData.size());
-    memcpy_s(data.get(), imageData.size(), imageData.data(), imageData.size());
+    return LoadImageData(imageData.data(), imageData.size(), format);
+}
+
+DirectX::ScratchImage GLTFTextureLoadingUtils::LoadImageData(const uint8_t* imageData, size_t imageDataSize, DXGI_FORMAT format)
+{
+    DirectX::ScratchImage output;
 
     DirectX::TexMetadata info;
-    if (FAILED(DirectX::LoadFromDDSMemory(data.get(), imageData.size(), DirectX::DDS_FLAGS_NONE, &info, output)))
+    if (FAILED(DirectX::LoadFromDDSMemory(imageData, imageDataSize, DirectX::DDS_FLAGS_NONE, &info, output)))
     {
         // DDS failed, try WIC
         // Note: try DDS first since WIC can load some DDS (but not all), so we wouldn't want to get 
         // a partial or invalid DDS loaded from WIC.
-        if (FAILED(DirectX::LoadFromWICMemory(data.get(), imageData.size(), DirectX::WIC_FLAGS_IGNORE_SRGB, &info, output)))
+        if (FAILED(DirectX::LoadFromWICMemory(imageData, imageDataSize, DirectX::WIC_FLAGS_IGNORE_SRGB, &info, output)))
         {
             throw GLTFException("Failed to load image - Image could not be loaded as DDS or read by WIC.");
         }
     }
 
-    if (info.format == DXGI_FORMAT_R32G32B32A32_FLOAT)
+    if (format == DXGI_FORMAT_UNKNOWN || info.format == format)
     {
         return output;
     }
+    else if (DirectX::IsCompressed(info.format))
+    {
+        DirectX::ScratchImage decompressed;
+        if (FAILED(DirectX::Decompress(*output.GetImage(0, 0, 0), format, decompressed)))
+        {
+            throw GLTFException("Failed to decompress texture to the requested format for processing.");
+        }
+
+        return decompressed;
+    }
     else 
     {
         DirectX::ScratchImage converted;
-        if (FAILED(DirectX::Convert(*output.GetImage(0, 0, 0), DXGI_FORMAT_R32G32B32A32_FLOAT, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, converted)))
+        if (FAILED(DirectX::Convert(*output.GetImage(0, 0, 0), format, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, converted)))
         {
-            throw GLTFException("Failed to convert texture to DXGI_FORMAT_R32G32B32A32_FLOAT for processing.");
+            throw GLTFException("Failed to convert texture to the requested format for processing.");
         }
 
         return converted;
     }
+}
+
+DirectX::ScratchImage GLTFTextureLoadingUtils::LoadImageData(const uint8_t* imageData, size_t imageDataSize, DXGI_FORMAT format, size_t maxSize, bool generateMipMaps)
+{
+    if (format == DXGI_FORMAT_R8G8B8A8_UNORM && !IsDDS(imageData, imageDataSize))
+    {
+        DirectX::ScratchImage output;
+        bool decoded = false;
+        {
+            Instrumentation::Stage decodeStage("Decode");
+            decoded = DecodeScaledWICImage(imageData, imageDataSize, maxSize, generateMipMaps, output);
+            decodeStage.SetProperty("scaled", decoded ? "true" : "false");
+        }
+
+        if (decoded)
+        {
+            if (generateMipMaps)
+            {
+                Instrumentation::Stage mipsStage("GenerateMipMaps");
+                GenerateMipMapsInPlace(output);
+            }
+
+            return output;
+        }
+    }
+
+    std::unique_ptr<DirectX::ScratchImage> image;
+    {
+        Instrumentation::Stage decodeStage("Decode");
+        image = std::make_unique<DirectX::ScratchImage>(LoadImageData(imageData, imageDataSize, format));
+    }
+
+    auto metadata = image->GetMetadata();
+    auto resizedSize = GetScaledSize(metadata.width, metadata.height, maxSize);
+    if (resizedSize.first != metadata.width || resizedSize.second != metadata.height)
+    {
+        Instrumentation::Stage resizeStage("Resize");
+
+        auto resized = std::make_unique<DirectX::ScratchImage>();
+        if (FAILED(DirectX::Resize(image->GetImages(), image->GetImageCount(), image->GetMetadata(), resizedSize.first, resizedSize.second, DirectX::TEX_FILTER_DEFAULT, *resized)))
+        {
+            throw GLTFException("Failed to resize image.");
+        }
+
+        image = std::move(resized);
+    }
+
+    if (generateMipMaps)
+    {
+        Instrumentation::Stage mipsStage("GenerateMipMaps");
+
+        auto mipChain = std::make_unique<DirectX::ScratchImage>();
+        if (FAILED(DirectX::GenerateMipMaps(image->GetImages(), image->GetImageCount(), image->GetMetadata(), DirectX::TEX_FILTER_DEFAULT, 0, *mipChain)))
+        {
+            throw GLTFException("Failed to generate mip maps.");
+        }
+
+        image = std::move(mipChain);
+    }
+
+    return std::move(*image);
+}
+
+bool GLTFTextureLoadingUtils::LoadImageDataTiled(const uint8_t* imageData, size_t imageDataSize, size_t maxSize, bool generateMipMaps, size_t tileRows,
+    const std::function<void(const DirectX::TexMetadata& metadata, size_t mipLevel, size_t firstRow, const DirectX::Image& band)>& processBand)
+{
+    auto reader = TiledImageReader::Open(imageData, imageDataSize, maxSize);
+    if (reader == nullptr)
+    {
+        return false;
+    }
+
+    // Bands start on a block boundary, and on an even row so that no filtered row straddles two bands
+    size_t bandRows = std::max<size_t>(4, (tileRows + 3) / 4 * 4);
+
+    DirectX::TexMetadata metadata = {};
+    metadata.width = reader->GetWidth();
+    metadata.height = reader->GetHeight();
+    metadata.depth = 1;
+    metadata.arraySize = 1;
+    metadata.mipLevels = generateMipMaps ? CountMipLevels(metadata.width, metadata.height) : 1;
+    metadata.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    metadata.dimension = DirectX::TEX_DIMENSION_TEXTURE2D;
+
+    std::vector<MipLevelBand> levels(metadata.mipLevels);
+    for (size_t level = 0; level < levels.size(); level++)
+    {
+        auto& band = levels[level];
+        band.width = level == 0 ? metadata.width : std::max<size_t>(1, levels[level - 1].width / 2);
+        band.height = level == 0 ? metadata.height : std::max<size_t>(1, levels[level - 1].height / 2);
+        band.rowPitch = band.width * 4;
+        band.firstRow = 0;
+        band.rowCount = 0;
+        band.pixels = ScratchArena::GetShared().Acquire(band.rowPitch * std::min(bandRows, band.height));
+    }
+
+    // Passes on the band of a level, filters it into the band of the next level, and passes that one on too once it is full
+    std::function<void(size_t)> flush = [&](size_t level)
+    {
+        auto& band = levels[level];
+
+        DirectX::Image image = {};
+        image.width = band.width;
+        image.height = band.rowCount;
+        image.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        image.rowPitch = band.rowPitch;
+        image.slicePitch = band.rowPitch * band.rowCount;
+        image.pixels = band.pixels.data();
+        processBand(metadata, level, band.firstRow, image);
+
+        if (level + 1 < levels.size())
+        {
+            auto& next = levels[level + 1];
+            for (size_t y = band.firstRow / 2; y < next.height && 2 * y < band.firstRow + band.rowCount; y++)
+            {
+                // The second row is only outside of the band at the bottom of the level, where it is clamped
+                size_t sourceRow0 = 2 * y - band.firstRow;
+                size_t sourceRow1 = std::min(2 * y + 1, band.height - 1) - band.firstRow;
+                DownsampleRow(band.pixels.data() + sourceRow0 * band.rowPitch, band.pixels.data() + sourceRow1 * band.rowPitch, band.width,
+                    next.pixels.data() + next.rowCount * next.rowPitch, next.width);
+                next.rowCount++;
+
+                if (next.rowCount == bandRows || next.firstRow + next.rowCount == next.height)
+                {
+                    flush(level + 1);
+                }
+            }
+        }
+
+        band.firstRow += band.rowCount;
+        band.rowCount = 0;
+    };
+
+    auto& topLevel = levels[0];
+    while (topLevel.firstRow < topLevel.height)
+    {
+        topLevel.rowCount = std::min(bandRows, topLevel.height - topLevel.firstRow);
+
+        {
+            Instrumentation::Stage decodeStage("Decode");
+            decodeStage.SetProperty("scaled", "true");
+            if (!reader->ReadRows(topLevel.firstRow, topLevel.rowCount, topLevel.pixels.data(), topLevel.rowPitch))
+            {
+                throw GLTFException("Failed to decode image.");
+            }
+        }
+
+        flush(0);
+    }
+
+    return true;
+}
+
+ConcurrencyLimit& GLTFTextureLoadingUtils::GetInFlightImageLimit()
+{
+    static ConcurrencyLimit sharedLimit;
+    return sharedLimit;
 }
\ No newline at end of file
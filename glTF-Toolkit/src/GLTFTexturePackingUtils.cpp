@@ -16,7 +16,14 @@
 
 #include "GLTFTextureLoadingUtils.h"
 #include "GLTFTexturePackingUtils.h"
+#include "Instrumentation.h"
+#include "ScratchArena.h"
 
+#include <emmintrin.h>
+#include <optional>
+#include <unordered_map>
+
+using namespace Microsoft::WRL;
 using namespace Microsoft::glTF;
 using namespace Microsoft::glTF::Toolkit;
 
@@ -24,25 +31,140 @@ const char* Microsoft::glTF::Toolkit::EXTENSION_MSFT_PACKING_ORM = "MSFT_packing
 
 namespace
 {
-    enum Channel
+    // Packs one row of DXGI_FORMAT_R32G32B32A32_FLOAT pixels. Channels that are not read from
+    // either source are set to 1.
+    void PackRowFloat(const uint8_t* mrRow, const uint8_t* occlusionRow, uint8_t* outputRow, size_t width, TexturePacking packing)
     {
-        Red = 0,
-        Green = 4,
-        Blue = 8,
-        Alpha = 12
-    };
-
-    // Constants for the format DXGI_FORMAT_R32G32B32A32_FLOAT
-    const size_t DXGI_FORMAT_R32G32B32A32_FLOAT_STRIDE = 16;
-
-    // Gets the value of channel `channel` in pixel index `offset` in image `imageData`
-    // assumed to be formatted as DXGI_FORMAT_R32G32B32A32_FLOAT
-    float* GetChannelValue(uint8_t * imageData, size_t offset, Channel channel)
+        auto mrPixels = reinterpret_cast<const DirectX::XMFLOAT4*>(mrRow);
+        auto occlusionPixels = reinterpret_cast<const DirectX::XMFLOAT4*>(occlusionRow);
+        auto outputPixels = reinterpret_cast<DirectX::XMFLOAT4*>(outputRow);
+
+        const DirectX::XMVECTOR selectAlpha = DirectX::XMVectorSelectControl(0, 0, 0, 1);
+
+        if (packing == TexturePacking::OcclusionRoughnessMetallic)
+        {
+            // Occlusion: Occ [R] -> ORM [R], Roughness: MR [G] -> ORM [G], Metalness: MR [B] -> ORM [B]
+            const DirectX::XMVECTOR selectRed = DirectX::XMVectorSelectControl(1, 0, 0, 0);
+
+            for (size_t i = 0; i < width; i++)
+            {
+                auto mr = DirectX::XMLoadFloat4(&mrPixels[i]);
+                auto occlusion = DirectX::XMLoadFloat4(&occlusionPixels[i]);
+                auto orm = DirectX::XMVectorSelect(mr, occlusion, selectRed);
+                DirectX::XMStoreFloat4(&outputPixels[i], DirectX::XMVectorSelect(orm, DirectX::g_XMOne, selectAlpha));
+            }
+        }
+        else
+        {
+            // Roughness: MR [G] -> RMO [R], Metalness: MR [B] -> RMO [G], Occlusion: Occ [R] -> RMO [B]
+            const DirectX::XMVECTOR selectBlue = DirectX::XMVectorSelectControl(0, 0, 1, 0);
+
+            for (size_t i = 0; i < width; i++)
+            {
+                auto mr = DirectX::XMVectorSwizzle<1, 2, 0, 3>(DirectX::XMLoadFloat4(&mrPixels[i]));
+                auto occlusion = DirectX::XMVectorSplatX(DirectX::XMLoadFloat4(&occlusionPixels[i]));
+                auto rmo = DirectX::XMVectorSelect(mr, occlusion, selectBlue);
+                DirectX::XMStoreFloat4(&outputPixels[i], DirectX::XMVectorSelect(rmo, DirectX::g_XMOne, selectAlpha));
+            }
+        }
+    }
+
+    uint32_t PackPixelR8G8B8A8(uint32_t mr, uint32_t occlusion, TexturePacking packing)
     {
-        return reinterpret_cast<float*>(imageData + offset * DXGI_FORMAT_R32G32B32A32_FLOAT_STRIDE + channel);
+        if (packing == TexturePacking::OcclusionRoughnessMetallic)
+        {
+            return (occlusion & 0x000000FF) | (mr & 0x00FFFF00) | 0xFF000000;
+        }
+        else
+        {
+            return ((mr >> 8) & 0x0000FFFF) | ((occlusion << 16) & 0x00FF0000) | 0xFF000000;
+        }
     }
 
-    std::string SaveAsPng(std::unique_ptr<DirectX::ScratchImage>& image, const std::string& fileName, const std::string& directory)
+    // Packs one row of DXGI_FORMAT_R8G8B8A8_UNORM pixels, four pixels at a time. Channels that
+    // are not read from either source are set to 255.
+    void PackRowR8G8B8A8(const uint8_t* mrRow, const uint8_t* occlusionRow, uint8_t* outputRow, size_t width, TexturePacking packing)
+    {
+        auto mrPixels = reinterpret_cast<const uint32_t*>(mrRow);
+        auto occlusionPixels = reinterpret_cast<const uint32_t*>(occlusionRow);
+        auto outputPixels = reinterpret_cast<uint32_t*>(outputRow);
+
+        const __m128i opaque = _mm_set1_epi32(0xFF000000);
+        const __m128i redMask = _mm_set1_epi32(0x000000FF);
+        const __m128i greenBlueMask = _mm_set1_epi32(0x00FFFF00);
+        const __m128i redGreenMask = _mm_set1_epi32(0x0000FFFF);
+        const __m128i blueMask = _mm_set1_epi32(0x00FF0000);
+
+        size_t i = 0;
+        if (packing == TexturePacking::OcclusionRoughnessMetallic)
+        {
+            for (; i + 4 <= width; i += 4)
+            {
+                auto mr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mrPixels + i));
+                auto occlusion = _mm_loadu_si128(reinterpret_cast<const __m128i*>(occlusionPixels + i));
+                auto orm = _mm_or_si128(_mm_and_si128(occlusion, redMask), _mm_and_si128(mr, greenBlueMask));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(outputPixels + i), _mm_or_si128(orm, opaque));
+            }
+        }
+        else
+        {
+            for (; i + 4 <= width; i += 4)
+            {
+                auto mr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mrPixels + i));
+                auto occlusion = _mm_loadu_si128(reinterpret_cast<const __m128i*>(occlusionPixels + i));
+                auto rmo = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(mr, 8), redGreenMask), _mm_and_si128(_mm_slli_epi32(occlusion, 16), blueMask));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(outputPixels + i), _mm_or_si128(rmo, opaque));
+            }
+        }
+
+        // Remaining pixels
+        for (; i < width; i++)
+        {
+            outputPixels[i] = PackPixelR8G8B8A8(mrPixels[i], occlusionPixels[i], packing);
+        }
+    }
+
+    // Packs the metallic roughness and occlusion images into a new image with the specified packing.
+    // Either source may be null, in which case the channels it provides are set to their maximum value.
+    // Both sources must have the same format and dimensions.
+    std::unique_ptr<DirectX::ScratchImage> PackImages(const DirectX::ScratchImage* metallicRoughnessImage, const DirectX::ScratchImage* occlusionImage, TexturePacking packing)
+    {
+        auto sourceImage = metallicRoughnessImage != nullptr ? *metallicRoughnessImage->GetImage(0, 0, 0) : *occlusionImage->GetImage(0, 0, 0);
+
+        auto packed = std::make_unique<DirectX::ScratchImage>();
+        if (FAILED(packed->Initialize2D(sourceImage.format, sourceImage.width, sourceImage.height, 1, 1)))
+        {
+            throw GLTFException("Failed to initialize from texture.");
+        }
+
+        auto packedImage = packed->GetImage(0, 0, 0);
+
+        auto packRow = sourceImage.format == DXGI_FORMAT_R8G8B8A8_UNORM ? &PackRowR8G8B8A8 : &PackRowFloat;
+
+        // Missing sources read from a single row of white pixels, so the kernels never branch on them
+        ScratchArray<uint8_t> whiteRow(sourceImage.rowPitch);
+        if (sourceImage.format == DXGI_FORMAT_R8G8B8A8_UNORM)
+        {
+            std::fill(whiteRow.data(), whiteRow.data() + whiteRow.size(), static_cast<uint8_t>(0xFF));
+        }
+        else
+        {
+            auto whitePixels = reinterpret_cast<float*>(whiteRow.data());
+            std::fill(whitePixels, whitePixels + whiteRow.size() / sizeof(float), 1.0f);
+        }
+
+        for (size_t y = 0; y < sourceImage.height; y++)
+        {
+            auto mrRow = metallicRoughnessImage != nullptr ? metallicRoughnessImage->GetImage(0, 0, 0)->pixels + y * sourceImage.rowPitch : whiteRow.data();
+            auto occlusionRow = occlusionImage != nullptr ? occlusionImage->GetImage(0, 0, 0)->pixels + y * sourceImage.rowPitch : whiteRow.data();
+
+            packRow(mrRow, occlusionRow, packedImage->pixels + y * packedImage->rowPitch, sourceImage.width, packing);
+        }
+
+        return packed;
+    }
+
+    std::wstring CombinePath(const std::string& directory, const std::string& fileName)
     {
         wchar_t outputImageFullPath[MAX_PATH];
         auto fileNameW = std::wstring(fileName.begin(), fileName.end());
@@ -53,14 +175,153 @@ namespace
             throw GLTFException("Failed to compose output file path.");
         }
 
+        return outputImageFullPath;
+    }
+
+    // Packs the metallic roughness and occlusion textures into a PNG a band of rows at a time, as they are decoded, so that
+    // neither the sources nor the packed image are held in memory as a whole. Either texture may be empty. The occlusion
+    // texture is scaled to the size of the metallic roughness texture while it is decoded.
+    // Returns false if a source cannot be read by WIC, in which case nothing is written.
+    bool PackTexturesAsPngTiled(const IStreamReader& streamReader, const GLTFDocument& doc, const std::string& metallicRoughness, const std::string& occlusion, TexturePacking packing, size_t tileRows, const std::wstring& outputImageFullPath)
+    {
+        if (metallicRoughness.empty() && occlusion.empty())
+        {
+            return false;
+        }
+
+        Instrumentation::Stage stage("PackTiled");
+        stage.SetProperty("tile_rows", std::to_string(tileRows));
+
+        GLTFResourceReader gltfResourceReader(streamReader);
+
+        // Both textures may read the same image, which is then decoded only once
+        bool sharedImage = !metallicRoughness.empty() && !occlusion.empty() &&
+            doc.textures.Get(metallicRoughness).imageId == doc.textures.Get(occlusion).imageId;
+
+        std::vector<uint8_t> metallicRoughnessData;
+        std::unique_ptr<TiledImageReader> metallicRoughnessReader;
+        if (!metallicRoughness.empty())
+        {
+            metallicRoughnessData = gltfResourceReader.ReadBinaryData(doc, doc.images.Get(doc.textures.Get(metallicRoughness).imageId));
+            stage.AddBytesRead(metallicRoughnessData.size());
+
+            metallicRoughnessReader = TiledImageReader::Open(metallicRoughnessData.data(), metallicRoughnessData.size());
+            if (metallicRoughnessReader == nullptr)
+            {
+                return false;
+            }
+        }
+
+        std::vector<uint8_t> occlusionData;
+        std::unique_ptr<TiledImageReader> occlusionReader;
+        if (!occlusion.empty() && !sharedImage)
+        {
+            occlusionData = gltfResourceReader.ReadBinaryData(doc, doc.images.Get(doc.textures.Get(occlusion).imageId));
+            stage.AddBytesRead(occlusionData.size());
+
+            occlusionReader = metallicRoughnessReader != nullptr ?
+                TiledImageReader::Open(occlusionData.data(), occlusionData.size(), metallicRoughnessReader->GetWidth(), metallicRoughnessReader->GetHeight()) :
+                TiledImageReader::Open(occlusionData.data(), occlusionData.size());
+            if (occlusionReader == nullptr)
+            {
+                return false;
+            }
+        }
+
+        auto width = metallicRoughnessReader != nullptr ? metallicRoughnessReader->GetWidth() : occlusionReader->GetWidth();
+        auto height = metallicRoughnessReader != nullptr ? metallicRoughnessReader->GetHeight() : occlusionReader->GetHeight();
+        auto bandRows = std::min(std::max<size_t>(1, tileRows), height);
+
+        // The packed image is written with the same pixel format as SaveAsPng, one band at a time
+        bool isWIC2 = false;
+        IWICImagingFactory* factory = DirectX::GetWICFactory(isWIC2);
+        ComPtr<IWICStream> stream;
+        ComPtr<IWICBitmapEncoder> encoder;
+        ComPtr<IWICBitmapFrameEncode> frame;
+        ComPtr<IPropertyBag2> frameProperties;
+        WICPixelFormatGUID pixelFormat = GUID_WICPixelFormat24bppBGR;
+        if (factory == nullptr ||
+            width > std::numeric_limits<UINT>::max() / 4 || height > std::numeric_limits<UINT>::max() ||
+            FAILED(factory->CreateStream(&stream)) ||
+            FAILED(stream->InitializeFromFilename(outputImageFullPath.c_str(), GENERIC_WRITE)) ||
+            FAILED(factory->CreateEncoder(GUID_ContainerFormatPng, nullptr, &encoder)) ||
+            FAILED(encoder->Initialize(stream.Get(), WICBitmapEncoderNoCache)) ||
+            FAILED(encoder->CreateNewFrame(&frame, &frameProperties)) ||
+            FAILED(frame->Initialize(frameProperties.Get())) ||
+            FAILED(frame->SetSize(static_cast<UINT>(width), static_cast<UINT>(height))) ||
+            FAILED(frame->SetPixelFormat(&pixelFormat)) ||
+            pixelFormat != GUID_WICPixelFormat24bppBGR)
+        {
+            throw GLTFException("Failed to save file.");
+        }
+
+        // Missing sources read from a band of white pixels, like in PackImages. A shared image is only read into the
+        // metallic roughness band.
+        size_t rowPitch = width * 4;
+        size_t outputRowPitch = width * 3;
+        ScratchArray<uint8_t> metallicRoughnessBand(rowPitch * bandRows);
+        ScratchArray<uint8_t> occlusionBand(sharedImage ? 0 : rowPitch * bandRows);
+        ScratchArray<uint8_t> packedRow(rowPitch);
+        ScratchArray<uint8_t> outputBand(outputRowPitch * bandRows);
+        std::fill(metallicRoughnessBand.data(), metallicRoughnessBand.data() + metallicRoughnessBand.size(), static_cast<uint8_t>(0xFF));
+        std::fill(occlusionBand.data(), occlusionBand.data() + occlusionBand.size(), static_cast<uint8_t>(0xFF));
+
+        const uint8_t* occlusionPixels = sharedImage ? metallicRoughnessBand.data() : occlusionBand.data();
+
+        for (size_t firstRow = 0; firstRow < height; firstRow += bandRows)
+        {
+            size_t rowCount = std::min(bandRows, height - firstRow);
+
+            if ((metallicRoughnessReader != nullptr && !metallicRoughnessReader->ReadRows(firstRow, rowCount, metallicRoughnessBand.data(), rowPitch)) ||
+                (occlusionReader != nullptr && !occlusionReader->ReadRows(firstRow, rowCount, occlusionBand.data(), rowPitch)))
+            {
+                throw GLTFException("Failed to load texture.");
+            }
+
+            for (size_t y = 0; y < rowCount; y++)
+            {
+                PackRowR8G8B8A8(metallicRoughnessBand.data() + y * rowPitch, occlusionPixels + y * rowPitch, packedRow.data(), width, packing);
+
+                // RGBA to BGR
+                uint8_t* outputRow = outputBand.data() + y * outputRowPitch;
+                for (size_t x = 0; x < width; x++)
+                {
+                    outputRow[x * 3] = packedRow[x * 4 + 2];
+                    outputRow[x * 3 + 1] = packedRow[x * 4 + 1];
+                    outputRow[x * 3 + 2] = packedRow[x * 4];
+                }
+            }
+
+            if (FAILED(frame->WritePixels(static_cast<UINT>(rowCount), static_cast<UINT>(outputRowPitch), static_cast<UINT>(outputRowPitch * rowCount), outputBand.data())))
+            {
+                throw GLTFException("Failed to save file.");
+            }
+        }
+
+        if (FAILED(frame->Commit()) || FAILED(encoder->Commit()))
+        {
+            throw GLTFException("Failed to save file.");
+        }
+
+        stage.AddFileWritten(outputImageFullPath);
+
+        return true;
+    }
+
+    std::string SaveAsPng(std::unique_ptr<DirectX::ScratchImage>& image, const std::string& fileName, const std::string& directory)
+    {
+        auto outputImageFullPath = CombinePath(directory, fileName);
+
         const DirectX::Image* img = image->GetImage(0, 0, 0);
-        if (FAILED(SaveToWICFile(*img, DirectX::WIC_FLAGS::WIC_FLAGS_NONE, GUID_ContainerFormatPng, outputImageFullPath, &GUID_WICPixelFormat24bppBGR)))
+        Instrumentation::Stage stage("SavePNG");
+        if (FAILED(SaveToWICFile(*img, DirectX::WIC_FLAGS::WIC_FLAGS_NONE, GUID_ContainerFormatPng, outputImageFullPath.c_str(), &GUID_WICPixelFormat24bppBGR)))
         {
             throw GLTFException("Failed to save file.");
         }
 
-        std::wstring outputImageFullPathStr(outputImageFullPath);
-        return std::string(outputImageFullPathStr.begin(), outputImageFullPathStr.end());
+        stage.AddFileWritten(outputImageFullPath);
+
+        return std::string(outputImageFullPath.begin(), outputImageFullPath.end());
     }
 
     std::string AddImageToDocument(GLTFDocument& doc, const std::string& imageUri)
@@ -74,14 +335,19 @@ namespace
         return imageId;
     }
 
-    void AddTextureToOrmExtension(const std::string& imageId, TexturePacking packing, GLTFDocument& doc, rapidjson::Value& ormExtensionJson, rapidjson::MemoryPoolAllocator<>& a)
+    std::string AddTextureToDocument(GLTFDocument& doc, const std::string& imageId)
     {
-        Texture ormTexture;
+        Texture texture;
         auto textureId = std::to_string(doc.textures.Size());
-        ormTexture.id = textureId;
-        ormTexture.imageId = imageId;
-        doc.textures.Append(std::move(ormTexture));
+        texture.id = textureId;
+        texture.imageId = imageId;
+        doc.textures.Append(std::move(texture));
+
+        return textureId;
+    }
 
+    void AddTextureToOrmExtension(const std::string& textureId, TexturePacking packing, rapidjson::Value& ormExtensionJson, rapidjson::MemoryPoolAllocator<>& a)
+    {
         rapidjson::Value ormTextureJson(rapidjson::kObjectType);
         {
             ormTextureJson.AddMember("index", rapidjson::Value(std::stoi(textureId)), a);
@@ -98,189 +364,262 @@ namespace
             throw GLTFException("Invalid packing.");
         }
     }
-}
 
-GLTFDocument GLTFTexturePackingUtils::PackMaterialForWindowsMR(const IStreamReader& streamReader, const GLTFDocument& doc, const Material& material, TexturePacking packing, const std::string& outputDirectory)
-{
-    GLTFDocument outputDoc(doc);
+    // Maps a (metallic roughness image, occlusion image, packing) triple to the packed texture
+    // already created for it, so that materials sharing the same source images share the output
+    typedef std::unordered_map<std::string, std::string> PackedTextureCache;
 
-    // No packing requested, return copy of document
-    if (packing == TexturePacking::None)
+    std::string GetPackedTextureCacheKey(const GLTFDocument& doc, const std::string& metallicRoughness, const std::string& occlusion, TexturePacking packing)
     {
-        return outputDoc;
-    }
-
-    // Read images from material
-    auto metallicRoughness = material.metallicRoughness.metallicRoughnessTextureId;
-    auto normal = material.normalTexture.id;
-    auto occlusion = material.occlusionTexture.id;
-
-    bool hasMR = !metallicRoughness.empty();
-    bool hasNormal = !normal.empty();
-    bool hasOcclusion = !occlusion.empty();
+        auto metallicRoughnessImage = metallicRoughness.empty() ? "" : doc.textures.Get(metallicRoughness).imageId;
+        auto occlusionImage = occlusion.empty() ? "" : doc.textures.Get(occlusion).imageId;
 
-    // Early return if there's nothing to pack
-    if (!hasMR && !hasOcclusion && !hasNormal)
-    {
-        // RM, O and Normal are empty, and the packing requires at least one of them
-        return outputDoc;
+        return metallicRoughnessImage + "|" + occlusionImage + "|" + std::to_string(static_cast<int>(packing));
     }
 
-    // TODO: Optimization - If the texture pair (MR + O) has already been packed together with the 
-    // current packing, point to that existing texture instead of creating a new one
-
-    Material outputMaterial = outputDoc.materials.Get(material.id);
-
-    // Create the JSON for the material extension element
-    rapidjson::Document ormExtensionJson;
-    ormExtensionJson.SetObject();
-    rapidjson::MemoryPoolAllocator<>& allocator = ormExtensionJson.GetAllocator();
-
-    std::unique_ptr<DirectX::ScratchImage> metallicRoughnessImage = nullptr;
-    uint8_t *mrPixels = nullptr;
-    if (hasMR)
+    void PackMaterial(const IStreamReader& streamReader, GLTFDocument& doc, const Material& material, TexturePacking packing, const std::string& outputDirectory, DXGI_FORMAT packingFormat, size_t tileRows, PackedTextureCache& cache)
     {
-        try
-        {
-            metallicRoughnessImage = std::make_unique<DirectX::ScratchImage>(GLTFTextureLoadingUtils::LoadTexture(streamReader, doc, metallicRoughness));
-            mrPixels = metallicRoughnessImage->GetPixels();
-        }
-        catch (GLTFException)
-        {
-            throw GLTFException("Failed to load metallic roughness texture.");
-        }
-    }
+        // Named after the public entry point, which every packing goes through
+        Instrumentation::Stage stage("PackMaterialForWindowsMR");
+        stage.SetProperty("material", material.id);
 
-    std::unique_ptr<DirectX::ScratchImage> occlusionImage = nullptr;
-    uint8_t *occlusionPixels = nullptr;
-    if (hasOcclusion)
-    {
-        try
+        // No packing requested, leave the document untouched
+        if (packing == TexturePacking::None)
         {
-            occlusionImage = std::make_unique<DirectX::ScratchImage>(GLTFTextureLoadingUtils::LoadTexture(streamReader, doc, occlusion));
-            occlusionPixels = occlusionImage->GetPixels();
+            return;
         }
-        catch (GLTFException)
+
+        if (packingFormat != DXGI_FORMAT_R32G32B32A32_FLOAT && packingFormat != DXGI_FORMAT_R8G8B8A8_UNORM)
         {
-            throw GLTFException("Failed to load occlusion texture.");
+            throw GLTFException("Invalid packing format.");
         }
-    }
 
-    // Pack textures using DirectXTex
+        // Read images from material
+        auto metallicRoughness = material.metallicRoughness.metallicRoughnessTextureId;
+        auto normal = material.normalTexture.id;
+        auto occlusion = material.occlusionTexture.id;
 
-    if (packing & TexturePacking::OcclusionRoughnessMetallic)
-    {
-        std::string ormImageId;
+        bool hasMR = !metallicRoughness.empty();
+        bool hasNormal = !normal.empty();
+        bool hasOcclusion = !occlusion.empty();
 
-        // If occlusion and metallic roughness are pointing to the same texture,
-        // according to the GLTF spec, that texture is already packed as ORM
-        // (occlusion = R, roughness = G, metalness = B)
-        if (occlusion == metallicRoughness && hasOcclusion)
+        // Early return if there's nothing to pack
+        if (!hasMR && !hasOcclusion && !hasNormal)
         {
-            ormImageId = metallicRoughness;
+            // RM, O and Normal are empty, and the packing requires at least one of them
+            return;
         }
-        else
-        {
-            auto orm = std::make_unique<DirectX::ScratchImage>();
 
-            auto sourceImage = hasMR ? *metallicRoughnessImage->GetImage(0, 0, 0) : *occlusionImage->GetImage(0, 0, 0);
-            if (FAILED(orm->Initialize2D(sourceImage.format, sourceImage.width, sourceImage.height, 1, 1)))
+        Material outputMaterial = doc.materials.Get(material.id);
+
+        // Create the JSON for the material extension element
+        rapidjson::Document ormExtensionJson;
+        ormExtensionJson.SetObject();
+        rapidjson::MemoryPoolAllocator<>& allocator = ormExtensionJson.GetAllocator();
+
+        // The source images are only loaded if some packed texture is not in the cache yet. The lease
+        // is declared first so that it outlives them.
+        std::optional<ConcurrencyLimit::Lease> imageLease;
+        std::shared_ptr<DirectX::ScratchImage> metallicRoughnessImage = nullptr;
+        std::shared_ptr<DirectX::ScratchImage> occlusionImage = nullptr;
+        auto loadSourceImages = [&]()
+        {
+            // All the images of the material count as one job, which holds its lease until the material is packed
+            if (!imageLease)
             {
-                throw GLTFException("Failed to initialize from texture.");
+                imageLease.emplace(GLTFTextureLoadingUtils::GetInFlightImageLimit().Acquire());
             }
 
-            auto ormPixels = orm->GetPixels();
-            auto metadata = orm->GetMetadata();
+            if (hasMR && metallicRoughnessImage == nullptr)
+            {
+                try
+                {
+                    metallicRoughnessImage = std::make_shared<DirectX::ScratchImage>(GLTFTextureLoadingUtils::LoadTexture(streamReader, doc, metallicRoughness, packingFormat));
+                }
+                catch (GLTFException)
+                {
+                    throw GLTFException("Failed to load metallic roughness texture.");
+                }
+            }
 
-            // TODO: resize?
+            if (hasOcclusion && occlusionImage == nullptr && hasMR &&
+                doc.textures.Get(occlusion).imageId == doc.textures.Get(metallicRoughness).imageId)
+            {
+                // Both textures read the same image, so decode it only once
+                occlusionImage = metallicRoughnessImage;
+            }
 
-            for (size_t i = 0; i < metadata.width * metadata.height; i += 1)
+            if (hasOcclusion && occlusionImage == nullptr)
             {
-                // Occlusion: Occ [R] -> ORM [R]
-                *GetChannelValue(ormPixels, i, Channel::Red) = hasOcclusion ? *GetChannelValue(occlusionPixels, i, Channel::Red) : 255.0f;
-                // Roughness: MR [G] -> ORM [G]
-                *GetChannelValue(ormPixels, i, Channel::Green) = hasMR ? *GetChannelValue(mrPixels, i, Channel::Green) : 255.0f;
-                // Metalness: MR [B] -> ORM [B]
-                *GetChannelValue(ormPixels, i, Channel::Blue) = hasMR ? *GetChannelValue(mrPixels, i, Channel::Blue) : 255.0f;
+                try
+                {
+                    occlusionImage = std::make_shared<DirectX::ScratchImage>(GLTFTextureLoadingUtils::LoadTexture(streamReader, doc, occlusion, packingFormat));
+                }
+                catch (GLTFException)
+                {
+                    throw GLTFException("Failed to load occlusion texture.");
+                }
+
+                // The packed texture has the dimensions of the metallic roughness texture
+                if (hasMR)
+                {
+                    auto mrMetadata = metallicRoughnessImage->GetMetadata();
+                    auto occlusionMetadata = occlusionImage->GetMetadata();
+                    if (mrMetadata.width != occlusionMetadata.width || mrMetadata.height != occlusionMetadata.height)
+                    {
+                        auto resized = std::make_shared<DirectX::ScratchImage>();
+                        if (FAILED(DirectX::Resize(*occlusionImage->GetImage(0, 0, 0), mrMetadata.width, mrMetadata.height, DirectX::TEX_FILTER_DEFAULT, *resized)))
+                        {
+                            throw GLTFException("Failed to resize occlusion texture.");
+                        }
+
+                        occlusionImage = std::move(resized);
+                    }
+                }
             }
+        };
 
-            auto imagePath = SaveAsPng(orm, "packing_orm_" + material.id + ".png", outputDirectory);
+        // Packs the source textures into a PNG in the output directory, and returns its full path. Tiled packing
+        // reads the textures itself, and falls back to packing them in memory if they cannot be read a band at a time.
+        auto packAsPng = [&](TexturePacking packedPacking, const std::string& fileName)
+        {
+            if (tileRows != 0 && metallicRoughnessImage == nullptr && occlusionImage == nullptr)
+            {
+                auto outputImageFullPath = CombinePath(outputDirectory, fileName);
+                if (PackTexturesAsPngTiled(streamReader, doc, metallicRoughness, occlusion, packedPacking, tileRows, outputImageFullPath))
+                {
+                    return std::string(outputImageFullPath.begin(), outputImageFullPath.end());
+                }
+            }
 
-            ormImageId = AddImageToDocument(outputDoc, imagePath);
-        }
+            loadSourceImages();
 
-        AddTextureToOrmExtension(ormImageId, TexturePacking::OcclusionRoughnessMetallic, outputDoc, ormExtensionJson, allocator);
-    }
+            auto packed = PackImages(metallicRoughnessImage.get(), occlusionImage.get(), packedPacking);
 
-    if (packing & TexturePacking::RoughnessMetallicOcclusion)
-    {
-        auto rmo = std::make_unique<DirectX::ScratchImage>();
+            return SaveAsPng(packed, fileName, outputDirectory);
+        };
 
-        // TODO: resize?
+        // Pack textures using DirectXTex
 
-        auto sourceImage = hasMR ? *metallicRoughnessImage->GetImage(0, 0, 0) : *occlusionImage->GetImage(0, 0, 0);
-        if (FAILED(rmo->Initialize2D(sourceImage.format, sourceImage.width, sourceImage.height, 1, 1)))
+        if (packing & TexturePacking::OcclusionRoughnessMetallic)
         {
-            throw GLTFException("Failed to initialize from texture.");
-        }
+            auto cacheKey = GetPackedTextureCacheKey(doc, metallicRoughness, occlusion, TexturePacking::OcclusionRoughnessMetallic);
+            auto cached = cache.find(cacheKey);
 
-        auto rmoPixels = rmo->GetPixels();
-        auto metadata = rmo->GetMetadata();
+            std::string ormTextureId;
+            if (cached != cache.end())
+            {
+                ormTextureId = cached->second;
+            }
+            else
+            {
+                std::string ormImageId;
+
+                // If occlusion and metallic roughness are pointing to the same texture,
+                // according to the GLTF spec, that texture is already packed as ORM
+                // (occlusion = R, roughness = G, metalness = B)
+                if (occlusion == metallicRoughness && hasOcclusion)
+                {
+                    ormImageId = metallicRoughness;
+                }
+                else
+                {
+                    auto imagePath = packAsPng(TexturePacking::OcclusionRoughnessMetallic, "packing_orm_" + material.id + ".png");
+
+                    ormImageId = AddImageToDocument(doc, imagePath);
+                }
+
+                ormTextureId = AddTextureToDocument(doc, ormImageId);
+                cache.emplace(cacheKey, ormTextureId);
+            }
 
-        for (size_t i = 0; i < metadata.width * metadata.height; i += 1)
-        {
-            // Roughness: MR [G] -> RMO [R]
-            *GetChannelValue(rmoPixels, i, Channel::Red) = hasMR ? *GetChannelValue(mrPixels, i, Channel::Green) : 255.0f;
-            // Metalness: MR [B] -> RMO [G]
-            *GetChannelValue(rmoPixels, i, Channel::Green) = hasMR ? *GetChannelValue(mrPixels, i, Channel::Blue) : 255.0f;
-            // Occlusion: Occ [R] -> RMO [B]
-            *GetChannelValue(rmoPixels, i, Channel::Blue) = hasOcclusion ? *GetChannelValue(occlusionPixels, i, Channel::Red) : 255.0f;
+            AddTextureToOrmExtension(ormTextureId, TexturePacking::OcclusionRoughnessMetallic, ormExtensionJson, allocator);
         }
 
-        auto imagePath = SaveAsPng(rmo, "packing_rmo_" + material.id + ".png", outputDirectory);
+        if (packing & TexturePacking::RoughnessMetallicOcclusion)
+        {
+            auto cacheKey = GetPackedTextureCacheKey(doc, metallicRoughness, occlusion, TexturePacking::RoughnessMetallicOcclusion);
+            auto cached = cache.find(cacheKey);
 
-        // Add back to GLTF
-        auto rmoImageId = AddImageToDocument(outputDoc, imagePath);
+            std::string rmoTextureId;
+            if (cached != cache.end())
+            {
+                rmoTextureId = cached->second;
+            }
+            else
+            {
+                auto imagePath = packAsPng(TexturePacking::RoughnessMetallicOcclusion, "packing_rmo_" + material.id + ".png");
 
-        AddTextureToOrmExtension(rmoImageId, TexturePacking::RoughnessMetallicOcclusion, outputDoc, ormExtensionJson, allocator);
-    }
+                // Add back to GLTF
+                auto rmoImageId = AddImageToDocument(doc, imagePath);
 
-    if (!normal.empty())
-    {
-        rapidjson::Value ormNormalTextureJson(rapidjson::kObjectType);
+                rmoTextureId = AddTextureToDocument(doc, rmoImageId);
+                cache.emplace(cacheKey, rmoTextureId);
+            }
+
+            AddTextureToOrmExtension(rmoTextureId, TexturePacking::RoughnessMetallicOcclusion, ormExtensionJson, allocator);
+        }
+
+        if (!normal.empty())
         {
-            ormNormalTextureJson.AddMember("index", rapidjson::Value(std::stoi(normal)), allocator);
+            rapidjson::Value ormNormalTextureJson(rapidjson::kObjectType);
+            {
+                ormNormalTextureJson.AddMember("index", rapidjson::Value(std::stoi(normal)), allocator);
+            }
+            ormExtensionJson.AddMember("normalTexture", ormNormalTextureJson, allocator);
         }
-        ormExtensionJson.AddMember("normalTexture", ormNormalTextureJson, allocator);
-    }
 
-    rapidjson::StringBuffer buffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    ormExtensionJson.Accept(writer);
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        ormExtensionJson.Accept(writer);
+
+        outputMaterial.extensions.insert(std::pair<std::string, std::string>(EXTENSION_MSFT_PACKING_ORM, buffer.GetString()));
 
-    outputMaterial.extensions.insert(std::pair<std::string, std::string>(EXTENSION_MSFT_PACKING_ORM, buffer.GetString()));
+        doc.materials.Replace(outputMaterial);
 
-    outputDoc.materials.Replace(outputMaterial);
+        doc.extensionsUsed.insert(EXTENSION_MSFT_PACKING_ORM);
+    }
+}
+
+GLTFDocument GLTFTexturePackingUtils::PackMaterialForWindowsMR(const IStreamReader& streamReader, const GLTFDocument& doc, const Material& material, TexturePacking packing, const std::string& outputDirectory, DXGI_FORMAT packingFormat, size_t tileRows)
+{
+    GLTFDocument outputDoc(doc);
 
-    outputDoc.extensionsUsed.insert(EXTENSION_MSFT_PACKING_ORM);
+    PackMaterialForWindowsMRInPlace(streamReader, outputDoc, material, packing, outputDirectory, packingFormat, tileRows);
 
     return outputDoc;
 }
 
-GLTFDocument GLTFTexturePackingUtils::PackAllMaterialsForWindowsMR(const IStreamReader& streamReader, const GLTFDocument & doc, TexturePacking packing, const std::string& outputDirectory)
+void GLTFTexturePackingUtils::PackMaterialForWindowsMRInPlace(const IStreamReader& streamReader, GLTFDocument& doc, const Material& material, TexturePacking packing, const std::string& outputDirectory, DXGI_FORMAT packingFormat, size_t tileRows)
+{
+    PackedTextureCache cache;
+    PackMaterial(streamReader, doc, material, packing, outputDirectory, packingFormat, tileRows, cache);
+}
+
+GLTFDocument GLTFTexturePackingUtils::PackAllMaterialsForWindowsMR(const IStreamReader& streamReader, const GLTFDocument & doc, TexturePacking packing, const std::string& outputDirectory, DXGI_FORMAT packingFormat, size_t tileRows)
 {
     GLTFDocument outputDoc(doc);
 
-    // No packing requested, return copy of document
+    PackAllMaterialsForWindowsMRInPlace(streamReader, outputDoc, packing, outputDirectory, packingFormat, tileRows);
+
+    return outputDoc;
+}
+
+void GLTFTexturePackingUtils::PackAllMaterialsForWindowsMRInPlace(const IStreamReader& streamReader, GLTFDocument& doc, TexturePacking packing, const std::string& outputDirectory, DXGI_FORMAT packingFormat, size_t tileRows)
+{
+    // No packing requested, leave the document untouched
     if (packing == TexturePacking::None)
     {
-        return outputDoc;
+        return;
     }
 
-    for (auto material : doc.materials.Elements())
+    // Materials that share the same source textures also share the packed textures
+    PackedTextureCache cache;
+
+    // Iterate by index on copies, since packing replaces the material in the document
+    for (size_t i = 0; i < doc.materials.Size(); i++)
     {
-        outputDoc = PackMaterialForWindowsMR(streamReader, outputDoc, material, packing, outputDirectory);
+        Material material(doc.materials[i]);
+        PackMaterial(streamReader, doc, material, packing, outputDirectory, packingFormat, tileRows, cache);
     }
-
-    return outputDoc;
 }
\ No newline at end of file
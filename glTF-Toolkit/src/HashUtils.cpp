@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "HashUtils.h"
+
+#include <GLTFSDK/GLTF.h>
+
+#include <bcrypt.h>
+
+#pragma comment(lib, "bcrypt.lib")
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    const size_t SHA256_HASH_SIZE = 32;
+
+    // Opens the SHA-256 provider once per process. The handle can be used from several threads at once.
+    class SHA256Provider
+    {
+    public:
+        SHA256Provider() : m_algorithm(nullptr)
+        {
+            if (!BCRYPT_SUCCESS(BCryptOpenAlgorithmProvider(&m_algorithm, BCRYPT_SHA256_ALGORITHM, nullptr, 0)))
+            {
+                m_algorithm = nullptr;
+            }
+        }
+
+        ~SHA256Provider()
+        {
+            if (m_algorithm != nullptr)
+            {
+                BCryptCloseAlgorithmProvider(m_algorithm, 0);
+            }
+        }
+
+        BCRYPT_ALG_HANDLE Get() const { return m_algorithm; }
+
+    private:
+        BCRYPT_ALG_HANDLE m_algorithm;
+    };
+}
+
+std::string HashUtils::ComputeSHA256(const void* data, size_t size)
+{
+    SHA256Hasher hasher;
+    hasher.Update(data, size);
+    return hasher.Finish();
+}
+
+HashUtils::SHA256Hasher::SHA256Hasher() : m_hash(nullptr)
+{
+    static SHA256Provider provider;
+    if (provider.Get() == nullptr)
+    {
+        throw GLTFException("Failed to open the SHA-256 algorithm provider.");
+    }
+
+    BCRYPT_HASH_HANDLE hash = nullptr;
+    if (!BCRYPT_SUCCESS(BCryptCreateHash(provider.Get(), &hash, nullptr, 0, nullptr, 0, 0)))
+    {
+        throw GLTFException("Failed to create SHA-256 hash.");
+    }
+
+    m_hash = hash;
+}
+
+HashUtils::SHA256Hasher::~SHA256Hasher()
+{
+    if (m_hash != nullptr)
+    {
+        BCryptDestroyHash(static_cast<BCRYPT_HASH_HANDLE>(m_hash));
+    }
+}
+
+void HashUtils::SHA256Hasher::Update(const void* data, size_t size)
+{
+    if (m_hash == nullptr)
+    {
+        throw GLTFException("The SHA-256 hash has already been completed.");
+    }
+
+    // BCryptHashData takes a 32-bit length, so hash large buffers in chunks
+    auto bytes = static_cast<const uint8_t*>(data);
+    while (size > 0)
+    {
+        auto chunkSize = static_cast<ULONG>(std::min(size, static_cast<size_t>(ULONG_MAX)));
+        if (!BCRYPT_SUCCESS(BCryptHashData(static_cast<BCRYPT_HASH_HANDLE>(m_hash), const_cast<PUCHAR>(bytes), chunkSize, 0)))
+        {
+            throw GLTFException("Failed to compute SHA-256 hash.");
+        }
+
+        bytes += chunkSize;
+        size -= chunkSize;
+    }
+}
+
+std::string HashUtils::SHA256Hasher::Finish()
+{
+    if (m_hash == nullptr)
+    {
+        throw GLTFException("The SHA-256 hash has already been completed.");
+    }
+
+    uint8_t digest[SHA256_HASH_SIZE];
+    bool succeeded = BCRYPT_SUCCESS(BCryptFinishHash(static_cast<BCRYPT_HASH_HANDLE>(m_hash), digest, ARRAYSIZE(digest), 0));
+    BCryptDestroyHash(static_cast<BCRYPT_HASH_HANDLE>(m_hash));
+    m_hash = nullptr;
+
+    if (!succeeded)
+    {
+        throw GLTFException("Failed to compute SHA-256 hash.");
+    }
+
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string result;
+    result.reserve(SHA256_HASH_SIZE * 2);
+    for (auto b : digest)
+    {
+        result += hexDigits[b >> 4];
+        result += hexDigits[b & 0xF];
+    }
+
+    return result;
+}
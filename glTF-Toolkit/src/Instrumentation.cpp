@@ -0,0 +1,325 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "Instrumentation.h"
+
+#include <psapi.h>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    // The records of every thread, and the clock they are measured against
+    class Recorder
+    {
+    public:
+        static Recorder& GetShared()
+        {
+            static Recorder sharedRecorder;
+            return sharedRecorder;
+        }
+
+        std::atomic<bool> enabled{ false };
+        std::atomic<uint64_t> lastStageId{ 0 };
+        std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+        std::mutex mutex;
+        std::vector<StageRecord> records;
+    };
+
+    thread_local Instrumentation::Context t_context;
+
+    int64_t GetMicrosecondsSinceEpoch()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Recorder::GetShared().epoch).count();
+    }
+
+    int64_t GetThreadCpuTime()
+    {
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+        {
+            return 0;
+        }
+
+        auto toHundredsOfNanoseconds = [](const FILETIME& time)
+        {
+            return static_cast<int64_t>((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime);
+        };
+
+        return (toHundredsOfNanoseconds(kernelTime) + toHundredsOfNanoseconds(userTime)) / 10;
+    }
+
+    uint64_t GetPeakWorkingSet()
+    {
+        PROCESS_MEMORY_COUNTERS counters = {};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return 0;
+        }
+
+        return counters.PeakWorkingSetSize;
+    }
+
+    template<typename Writer>
+    void WriteString(Writer& writer, const std::string& value)
+    {
+        writer.String(value.c_str(), static_cast<rapidjson::SizeType>(value.length()));
+    }
+}
+
+Instrumentation::Stage::Stage(const char* name) :
+    m_startCpuTime(0),
+    m_uncaughtExceptions(0)
+{
+    auto& recorder = Recorder::GetShared();
+    if (!recorder.enabled)
+    {
+        return;
+    }
+
+    m_record = std::make_unique<StageRecord>();
+    m_record->name = name;
+    m_record->context = t_context.label;
+    m_record->id = ++recorder.lastStageId;
+    m_record->parentId = t_context.stageId;
+    m_record->threadId = GetCurrentThreadId();
+    m_record->startTime = GetMicrosecondsSinceEpoch();
+    m_startCpuTime = GetThreadCpuTime();
+    m_uncaughtExceptions = std::uncaught_exceptions();
+
+    t_context.stageId = m_record->id;
+}
+
+Instrumentation::Stage::~Stage()
+{
+    if (m_record == nullptr)
+    {
+        return;
+    }
+
+    t_context.stageId = m_record->parentId;
+
+    m_record->wallTime = GetMicrosecondsSinceEpoch() - m_record->startTime;
+    m_record->cpuTime = GetThreadCpuTime() - m_startCpuTime;
+    m_record->peakWorkingSet = GetPeakWorkingSet();
+
+    if (std::uncaught_exceptions() > m_uncaughtExceptions)
+    {
+        m_record->properties.emplace_back("failed", "true");
+    }
+
+    auto& recorder = Recorder::GetShared();
+    std::lock_guard<std::mutex> lock(recorder.mutex);
+    recorder.records.push_back(std::move(*m_record));
+}
+
+void Instrumentation::Stage::AddBytesRead(uint64_t byteCount)
+{
+    if (m_record != nullptr)
+    {
+        m_record->bytesRead += byteCount;
+    }
+}
+
+void Instrumentation::Stage::AddBytesWritten(uint64_t byteCount)
+{
+    if (m_record != nullptr)
+    {
+        m_record->bytesWritten += byteCount;
+    }
+}
+
+void Instrumentation::Stage::AddFileWritten(const std::wstring& filePath)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (m_record != nullptr && GetFileAttributesExW(filePath.c_str(), GetFileExInfoStandard, &attributes))
+    {
+        m_record->bytesWritten += (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+    }
+}
+
+void Instrumentation::Stage::SetProperty(const std::string& key, const std::string& value)
+{
+    if (m_record != nullptr)
+    {
+        m_record->properties.emplace_back(key, value);
+    }
+}
+
+Instrumentation::ContextScope::ContextScope(Context context) :
+    m_previousContext(std::move(t_context))
+{
+    t_context = std::move(context);
+}
+
+Instrumentation::ContextScope::~ContextScope()
+{
+    t_context = std::move(m_previousContext);
+}
+
+void Instrumentation::SetEnabled(bool enabled)
+{
+    auto& recorder = Recorder::GetShared();
+    if (enabled && !recorder.enabled)
+    {
+        recorder.epoch = std::chrono::steady_clock::now();
+    }
+
+    recorder.enabled = enabled;
+}
+
+bool Instrumentation::IsEnabled()
+{
+    return Recorder::GetShared().enabled;
+}
+
+Instrumentation::Context Instrumentation::GetContext()
+{
+    return t_context;
+}
+
+std::vector<StageRecord> Instrumentation::GetRecords()
+{
+    auto& recorder = Recorder::GetShared();
+
+    std::vector<StageRecord> records;
+    {
+        std::lock_guard<std::mutex> lock(recorder.mutex);
+        records = recorder.records;
+    }
+
+    // Stages are recorded when they end, so containing stages come after the stages they contain
+    std::sort(records.begin(), records.end(), [](const StageRecord& a, const StageRecord& b)
+    {
+        return a.startTime != b.startTime ? a.startTime < b.startTime : a.id < b.id;
+    });
+
+    return records;
+}
+
+void Instrumentation::Clear()
+{
+    auto& recorder = Recorder::GetShared();
+    std::lock_guard<std::mutex> lock(recorder.mutex);
+    recorder.records.clear();
+}
+
+void Instrumentation::WriteJson(std::ostream& output)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+    writer.StartObject();
+    writer.Key("stages");
+    writer.StartArray();
+
+    for (const auto& record : GetRecords())
+    {
+        writer.StartObject();
+        writer.Key("name");
+        WriteString(writer, record.name);
+        writer.Key("context");
+        WriteString(writer, record.context);
+        writer.Key("id");
+        writer.Uint64(record.id);
+        writer.Key("parentId");
+        writer.Uint64(record.parentId);
+        writer.Key("threadId");
+        writer.Uint(record.threadId);
+        writer.Key("startTime");
+        writer.Int64(record.startTime);
+        writer.Key("wallTime");
+        writer.Int64(record.wallTime);
+        writer.Key("cpuTime");
+        writer.Int64(record.cpuTime);
+        writer.Key("peakWorkingSet");
+        writer.Uint64(record.peakWorkingSet);
+        writer.Key("bytesRead");
+        writer.Uint64(record.bytesRead);
+        writer.Key("bytesWritten");
+        writer.Uint64(record.bytesWritten);
+
+        writer.Key("properties");
+        writer.StartObject();
+        for (const auto& property : record.properties)
+        {
+            WriteString(writer, property.first);
+            WriteString(writer, property.second);
+        }
+        writer.EndObject();
+
+        writer.EndObject();
+    }
+
+    writer.EndArray();
+    writer.EndObject();
+
+    output << buffer.GetString();
+}
+
+void Instrumentation::WriteChromeTrace(std::ostream& output)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+    const auto processId = GetCurrentProcessId();
+
+    writer.StartObject();
+    writer.Key("traceEvents");
+    writer.StartArray();
+
+    for (const auto& record : GetRecords())
+    {
+        writer.StartObject();
+        writer.Key("name");
+        WriteString(writer, record.name);
+        writer.Key("cat");
+        WriteString(writer, record.context.empty() ? std::string("glTF-Toolkit") : record.context);
+        writer.Key("ph");
+        writer.String("X");
+        writer.Key("ts");
+        writer.Int64(record.startTime);
+        writer.Key("dur");
+        writer.Int64(record.wallTime);
+        writer.Key("pid");
+        writer.Uint(processId);
+        writer.Key("tid");
+        writer.Uint(record.threadId);
+
+        writer.Key("args");
+        writer.StartObject();
+        writer.Key("cpuTime");
+        writer.Int64(record.cpuTime);
+        writer.Key("peakWorkingSet");
+        writer.Uint64(record.peakWorkingSet);
+        writer.Key("bytesRead");
+        writer.Uint64(record.bytesRead);
+        writer.Key("bytesWritten");
+        writer.Uint64(record.bytesWritten);
+        for (const auto& property : record.properties)
+        {
+            WriteString(writer, property.first);
+            WriteString(writer, property.second);
+        }
+        writer.EndObject();
+
+        writer.EndObject();
+    }
+
+    writer.EndArray();
+    writer.Key("displayTimeUnit");
+    writer.String("ms");
+    writer.EndObject();
+
+    output << buffer.GetString();
+}
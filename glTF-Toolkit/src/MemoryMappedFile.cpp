@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "MemoryMappedFile.h"
+
+#include <GLTFSDK/GLTF.h>
+
+using namespace Microsoft::glTF;
+using namespace Microsoft::glTF::Toolkit;
+
+MemoryMappedFile::MemoryMappedFile(const std::string& path) :
+    m_file(INVALID_HANDLE_VALUE),
+    m_mapping(nullptr),
+    m_data(nullptr),
+    m_size(0)
+{
+    std::wstring pathW(path.begin(), path.end());
+
+    m_file = CreateFileW(pathW.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        throw GLTFException("Failed to open file " + path + ".");
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_file, &fileSize))
+    {
+        CloseHandle(m_file);
+        throw GLTFException("Failed to get the size of file " + path + ".");
+    }
+
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+
+    // Empty files cannot be mapped
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr)
+    {
+        CloseHandle(m_file);
+        throw GLTFException("Failed to map file " + path + ".");
+    }
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr)
+    {
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        throw GLTFException("Failed to map file " + path + ".");
+    }
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+    }
+}
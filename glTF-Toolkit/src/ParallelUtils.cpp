@@ -0,0 +1,255 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "Instrumentation.h"
+#include "ParallelUtils.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <system_error>
+#include <thread>
+
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    // The threads shared by every ParallelFor call in the process. Threads are started the first time a loop
+    // asks for more helpers than the pool has, and then wait for tasks until the process exits.
+    class WorkerPool
+    {
+    public:
+        static WorkerPool& GetShared()
+        {
+            // Never destroyed: joining threads from a static destructor can deadlock when the toolkit is linked into a DLL
+            static WorkerPool* sharedPool = new WorkerPool();
+            return *sharedPool;
+        }
+
+        // Queues a task, and starts threads until the pool has at least threadCount of them
+        void Submit(std::function<void()> task, size_t threadCount)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.push_back(std::move(task));
+
+                while (m_threadCount < threadCount)
+                {
+                    try
+                    {
+                        std::thread([this]() { Run(); }).detach();
+                        m_threadCount++;
+                    }
+                    catch (const std::system_error&)
+                    {
+                        // Could not start more threads, continue with the ones we have
+                        break;
+                    }
+                }
+            }
+
+            m_taskAdded.notify_one();
+        }
+
+    private:
+        WorkerPool() : m_threadCount(0) {}
+
+        void Run()
+        {
+            // WIC (and therefore DirectXTex) requires COM on every thread that uses it
+            CoInitializeEx(NULL, COINIT_MULTITHREADED);
+
+            for (;;)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_taskAdded.wait(lock, [this]() { return !m_tasks.empty(); });
+
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                }
+
+                task();
+            }
+        }
+
+        std::mutex m_mutex;
+        std::condition_variable m_taskAdded;
+        std::deque<std::function<void()>> m_tasks;
+        size_t m_threadCount;
+    };
+
+    // The progress of one ParallelFor call. Helpers that only start after the loop is over still reach it,
+    // so it is shared with them, but they find no index left and never call the action.
+    struct LoopState
+    {
+        LoopState(size_t count, const std::function<void(size_t)>& action) :
+            count(count),
+            action(action),
+            context(Instrumentation::GetContext()),
+            nextIndex(0),
+            failed(false),
+            activeHelpers(0)
+        {
+        }
+
+        void Work()
+        {
+            for (size_t i = nextIndex++; i < count && !failed; i = nextIndex++)
+            {
+                try
+                {
+                    action(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!firstException)
+                    {
+                        firstException = std::current_exception();
+                    }
+
+                    failed = true;
+                }
+            }
+        }
+
+        const size_t count;
+        const std::function<void(size_t)>& action;
+        const Instrumentation::Context context;
+        std::atomic<size_t> nextIndex;
+        std::atomic<bool> failed;
+
+        std::mutex mutex;
+        std::condition_variable helpersDone;
+        size_t activeHelpers;
+        std::exception_ptr firstException;
+    };
+}
+
+void ParallelUtils::ParallelFor(size_t count, size_t maxParallelism, const std::function<void(size_t)>& action)
+{
+    if (maxParallelism == 0)
+    {
+        maxParallelism = GetDefaultParallelism();
+    }
+
+    auto workerCount = std::min(maxParallelism, count);
+
+    if (workerCount <= 1)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            action(i);
+        }
+
+        return;
+    }
+
+    auto state = std::make_shared<LoopState>(count, action);
+
+    auto& pool = WorkerPool::GetShared();
+    for (size_t i = 1; i < workerCount; i++)
+    {
+        pool.Submit([state]()
+        {
+            // Registered before taking an index, so that the calling thread waits for every helper that gets one
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->activeHelpers++;
+            }
+
+            {
+                // Stages recorded by the helper belong to the stage that started the loop
+                Instrumentation::ContextScope contextScope(state->context);
+                state->Work();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->activeHelpers--;
+            }
+
+            state->helpersDone.notify_all();
+        }, workerCount - 1);
+    }
+
+    state->Work();
+
+    // Only helpers that are running are waited for, so a nested loop never waits for a thread blocked on its caller
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->helpersDone.wait(lock, [&state]() { return state->activeHelpers == 0; });
+
+    if (state->firstException)
+    {
+        std::rethrow_exception(state->firstException);
+    }
+}
+
+size_t ParallelUtils::GetDefaultParallelism()
+{
+    return std::max(static_cast<size_t>(std::thread::hardware_concurrency()), static_cast<size_t>(1));
+}
+
+ConcurrencyLimit::Lease::Lease(ConcurrencyLimit* limit) :
+    m_limit(limit)
+{
+}
+
+ConcurrencyLimit::Lease::Lease(Lease&& other) :
+    m_limit(other.m_limit)
+{
+    other.m_limit = nullptr;
+}
+
+ConcurrencyLimit::Lease::~Lease()
+{
+    if (m_limit != nullptr)
+    {
+        m_limit->Release();
+    }
+}
+
+ConcurrencyLimit::ConcurrencyLimit(size_t limit) :
+    m_limit(limit),
+    m_leaseCount(0)
+{
+}
+
+void ConcurrencyLimit::SetLimit(size_t limit)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_limit = limit;
+    }
+
+    m_released.notify_all();
+}
+
+size_t ConcurrencyLimit::GetLimit() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_limit;
+}
+
+ConcurrencyLimit::Lease ConcurrencyLimit::Acquire()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_released.wait(lock, [this]() { return m_limit == 0 || m_leaseCount < m_limit; });
+
+    m_leaseCount++;
+    return Lease(this);
+}
+
+void ConcurrencyLimit::Release()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_leaseCount--;
+    }
+
+    m_released.notify_one();
+}
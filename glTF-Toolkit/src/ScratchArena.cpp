@@ -0,0 +1,192 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "ScratchArena.h"
+
+using namespace Microsoft::glTF::Toolkit;
+
+namespace
+{
+    const size_t MIN_CAPACITY = 4096;
+    const size_t SIZE_CLASSES_PER_POWER_OF_TWO = 4;
+
+    // Rounds a size up to its size class, which wastes at most a quarter of the buffer
+    size_t GetCapacity(size_t byteLength)
+    {
+        if (byteLength <= MIN_CAPACITY)
+        {
+            return MIN_CAPACITY;
+        }
+
+        size_t powerOfTwo = MIN_CAPACITY;
+        while (powerOfTwo <= (byteLength - 1) / 2)
+        {
+            powerOfTwo *= 2;
+        }
+
+        const size_t step = powerOfTwo / SIZE_CLASSES_PER_POWER_OF_TWO;
+        return (byteLength + step - 1) / step * step;
+    }
+}
+
+ScratchArena::Lease::Lease() :
+    m_arena(nullptr),
+    m_size(0),
+    m_capacity(0)
+{
+}
+
+ScratchArena::Lease::Lease(ScratchArena* arena, std::unique_ptr<uint8_t[]> buffer, size_t size, size_t capacity) :
+    m_arena(arena),
+    m_buffer(std::move(buffer)),
+    m_size(size),
+    m_capacity(capacity)
+{
+}
+
+ScratchArena::Lease::Lease(Lease&& other) :
+    m_arena(other.m_arena),
+    m_buffer(std::move(other.m_buffer)),
+    m_size(other.m_size),
+    m_capacity(other.m_capacity)
+{
+    other.m_arena = nullptr;
+    other.m_size = 0;
+    other.m_capacity = 0;
+}
+
+ScratchArena::Lease& ScratchArena::Lease::operator=(Lease&& other)
+{
+    if (this != &other)
+    {
+        Release();
+
+        m_arena = other.m_arena;
+        m_buffer = std::move(other.m_buffer);
+        m_size = other.m_size;
+        m_capacity = other.m_capacity;
+
+        other.m_arena = nullptr;
+        other.m_size = 0;
+        other.m_capacity = 0;
+    }
+
+    return *this;
+}
+
+ScratchArena::Lease::~Lease()
+{
+    Release();
+}
+
+void ScratchArena::Lease::Release()
+{
+    if (m_arena != nullptr)
+    {
+        m_arena->Release(std::move(m_buffer), m_capacity);
+        m_arena = nullptr;
+    }
+}
+
+ScratchArena::ScratchArena(size_t maxIdleBytes) :
+    m_maxIdleBytes(maxIdleBytes)
+{
+}
+
+ScratchArena::~ScratchArena() = default;
+
+ScratchArena::Lease ScratchArena::Acquire(size_t byteLength)
+{
+    if (byteLength == 0)
+    {
+        return Lease();
+    }
+
+    const size_t capacity = GetCapacity(byteLength);
+    std::unique_ptr<uint8_t[]> buffer;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_statistics.acquisitions++;
+        m_statistics.bytesInUse += capacity;
+        m_statistics.peakBytesInUse = std::max(m_statistics.peakBytesInUse, m_statistics.bytesInUse);
+
+        auto idle = m_idleBuffers.find(capacity);
+        if (idle != m_idleBuffers.end() && !idle->second.empty())
+        {
+            buffer = std::move(idle->second.back());
+            idle->second.pop_back();
+
+            m_statistics.reuses++;
+            m_statistics.bytesIdle -= capacity;
+        }
+
+        m_statistics.peakBytesReserved = std::max(m_statistics.peakBytesReserved, m_statistics.bytesInUse + m_statistics.bytesIdle);
+    }
+
+    // Allocate outside the lock, since large allocations can be slow
+    if (buffer == nullptr)
+    {
+        try
+        {
+            buffer.reset(new uint8_t[capacity]);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_statistics.bytesInUse -= capacity;
+            throw;
+        }
+    }
+
+    return Lease(this, std::move(buffer), byteLength, capacity);
+}
+
+ScratchArena::Statistics ScratchArena::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+}
+
+void ScratchArena::ResetPeaks()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_statistics.peakBytesInUse = m_statistics.bytesInUse;
+    m_statistics.peakBytesReserved = m_statistics.bytesInUse + m_statistics.bytesIdle;
+}
+
+void ScratchArena::Trim()
+{
+    decltype(m_idleBuffers) idleBuffers;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        idleBuffers.swap(m_idleBuffers);
+        m_statistics.bytesIdle = 0;
+    }
+
+    // The buffers are freed outside the lock
+}
+
+ScratchArena& ScratchArena::GetShared()
+{
+    static ScratchArena sharedArena;
+    return sharedArena;
+}
+
+void ScratchArena::Release(std::unique_ptr<uint8_t[]> buffer, size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_statistics.bytesInUse -= capacity;
+
+    // Buffers past the limit are freed when they go out of scope
+    if (m_statistics.bytesIdle + capacity <= m_maxIdleBytes)
+    {
+        m_idleBuffers[capacity].push_back(std::move(buffer));
+        m_statistics.bytesIdle += capacity;
+    }
+}
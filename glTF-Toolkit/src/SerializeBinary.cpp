@@ -4,20 +4,61 @@
 #include "pch.h"
 
 #include "AccessorUtils.h"
+#include "GLBUtils.h"
+#include "GLTFExtensionUtils.h"
+#include "GLTFLODUtils.h"
+#include "GLTFMeshCompressionUtils.h"
+#include "GLTFTextureCompressionUtils.h"
+#include "GLTFTexturePackingUtils.h"
+#include "HashUtils.h"
+#include "Instrumentation.h"
+#include "ParallelUtils.h"
+#include "ScratchArena.h"
 #include "SerializeBinary.h"
 
 #include "GLTFSDK/GLTF.h"
 #include "GLTFSDK/GLTFDocument.h"
 #include "GLTFSDK/GLBResourceReader.h"
-#include "GLTFSDK/GLBResourceWriter2.h"
 #include "GLTFSDK/Serialize.h"
-#include "GLTFSDK/BufferBuilder.h"
+
+#include <functional>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 
 using namespace Microsoft::glTF;
 using namespace Microsoft::glTF::Toolkit;
 
 namespace
 {
+    const size_t COPY_BLOCK_SIZE = 1024 * 1024;
+    const size_t PAYLOAD_BATCH_PER_WORKER = 4;
+    const size_t PAYLOAD_BATCH_BYTE_SIZE = 64 * 1024 * 1024;
+    const size_t VERTEX_ATTRIBUTE_ALIGNMENT = 4;
+    const size_t MESHOPT_ALIGNMENT = 4;
+    const char* MESHOPT_FALLBACK_BUFFER_ID = "meshopt_fallback";
+
+    const JsonMemberPaths MSFT_TEXTURE_DDS_INDEX_PATHS = { { "source" } };
+    const JsonMemberPaths MSFT_PACKING_ORM_INDEX_PATHS =
+    {
+        { "occlusionRoughnessMetallicTexture", "index" },
+        { "roughnessMetallicOcclusionTexture", "index" },
+        { "normalTexture", "index" }
+    };
+
+    // A run of bytes in the binary chunk, which is produced only when the chunk is written
+    struct BinaryPayload
+    {
+        size_t byteOffset;
+        size_t byteLength;
+        bool cpuBound; // Worth producing on a worker thread, rather than copied straight from the input
+        std::function<void(std::ostream&)> write;
+    };
+
     static std::string MimeTypeFromUri(const std::string& uri)
     {
         auto extension = uri.substr(uri.rfind('.') + 1, 3);
@@ -41,117 +82,924 @@ namespace
         return "text/plain";
     }
 
+    static bool IsDataUri(const std::string& uri)
+    {
+        return uri.compare(0, 5, "data:") == 0;
+    }
+
+    static size_t Align(size_t offset, size_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    static void WriteUInt32(std::ostream& output, uint32_t value)
+    {
+        const char bytes[] =
+        {
+            static_cast<char>(value & 0xFF),
+            static_cast<char>((value >> 8) & 0xFF),
+            static_cast<char>((value >> 16) & 0xFF),
+            static_cast<char>((value >> 24) & 0xFF)
+        };
+
+        output.write(bytes, sizeof(bytes));
+    }
+
+    static void WritePadding(std::ostream& output, size_t length, char value)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            output.put(value);
+        }
+    }
+
     template <typename T>
-    void SaveAccessor(const Accessor& accessor, const std::vector<T> accessorContents, BufferBuilder& builder)
+    static void WriteContents(std::ostream& output, const std::vector<T>& contents)
+    {
+        output.write(reinterpret_cast<const char*>(contents.data()), contents.size() * sizeof(T));
+    }
+
+    // Writes tightly packed elements, padding each one up to the stride
+    static void WriteElements(std::ostream& output, const void* elements, size_t elementCount, size_t elementSize, size_t byteStride)
     {
-        auto min = accessor.min;
-        auto max = accessor.max;
-        if ((min.empty() || max.empty()) && !accessorContents.empty())
+        auto bytes = reinterpret_cast<const char*>(elements);
+        if (byteStride == elementSize)
         {
-            auto minmax = AccessorUtils::CalculateMinMax(accessor, accessorContents);
-            min = minmax.first;
-            max = minmax.second;
+            output.write(bytes, elementCount * elementSize);
+            return;
         }
 
-        builder.AddAccessor(accessorContents, accessor.componentType, accessor.type, min, max);
+        for (size_t i = 0; i < elementCount; i++)
+        {
+            output.write(bytes + i * elementSize, elementSize);
+            WritePadding(output, byteStride - elementSize, '\0');
+        }
     }
 
+    // Converts accessor contents to another component type, extending min and max in the same pass. The converted
+    // contents are only needed until they are written, so they are in a scratch buffer that the next accessor reuses.
     template <typename OriginalType, typename NewType>
-    static std::vector<NewType> vector_static_cast(const std::vector<OriginalType>& original)
+    static ScratchArray<NewType> ConvertAccessorContents(const std::vector<OriginalType>& original, size_t typeCount, std::vector<float>& min, std::vector<float>& max)
     {
-        auto newData = std::vector<NewType>(original.size());
+        ScratchArray<NewType> newData(original.size());
+        const size_t elementCount = original.size() / typeCount;
 
-        std::transform(original.begin(), original.end(), newData.begin(),
-            [](const OriginalType& element)
+        switch (typeCount)
         {
-            return static_cast<NewType>(element);
-        });
+        case 1:
+            AccessorUtils::ConvertWithMinMax<OriginalType, NewType, 1>(original.data(), elementCount, newData.data(), min, max);
+            break;
+        case 2:
+            AccessorUtils::ConvertWithMinMax<OriginalType, NewType, 2>(original.data(), elementCount, newData.data(), min, max);
+            break;
+        case 3:
+            AccessorUtils::ConvertWithMinMax<OriginalType, NewType, 3>(original.data(), elementCount, newData.data(), min, max);
+            break;
+        case 4:
+            AccessorUtils::ConvertWithMinMax<OriginalType, NewType, 4>(original.data(), elementCount, newData.data(), min, max);
+            break;
+        case 9:
+            AccessorUtils::ConvertWithMinMax<OriginalType, NewType, 9>(original.data(), elementCount, newData.data(), min, max);
+            break;
+        case 16:
+            AccessorUtils::ConvertWithMinMax<OriginalType, NewType, 16>(original.data(), elementCount, newData.data(), min, max);
+            break;
+        default:
+            throw GLTFException("Unsupported accessor type");
+        }
 
         return newData;
     }
 
-    template <typename T>
-    void ConvertAndSaveAccessor(const Accessor& accessor, const std::vector<T> accessorContents, BufferBuilder& builder)
+    // Reads the contents of an accessor and hands them to the action, converted to the output component type.
+    // The min and max of the converted contents are accumulated along the way. Each call uses its own resource
+    // reader, so accessors can be visited from several threads.
+    template <typename T, typename Action>
+    void VisitAccessorContents(const Accessor& accessor, ComponentType outputComponentType, const GLTFDocument& doc, const IStreamReader& streamReader,
+        std::vector<float>& min, std::vector<float>& max, Action action)
+    {
+        GLTFResourceReader reader(streamReader);
+        const std::vector<T> accessorContents = reader.ReadBinaryData<T>(doc, accessor);
+        const size_t typeCount = Accessor::GetTypeCount(accessor.type);
+
+        if (outputComponentType == accessor.componentType)
+        {
+            AccessorUtils::AccumulateMinMax(accessorContents.data(), accessorContents.size() / typeCount, typeCount, min, max);
+            action(accessorContents);
+            return;
+        }
+
+        switch (outputComponentType)
+        {
+        case COMPONENT_BYTE:
+            action(ConvertAccessorContents<T, int8_t>(accessorContents, typeCount, min, max));
+            break;
+        case COMPONENT_UNSIGNED_BYTE:
+            action(ConvertAccessorContents<T, uint8_t>(accessorContents, typeCount, min, max));
+            break;
+        case COMPONENT_SHORT:
+            action(ConvertAccessorContents<T, int16_t>(accessorContents, typeCount, min, max));
+            break;
+        case COMPONENT_UNSIGNED_SHORT:
+            action(ConvertAccessorContents<T, uint16_t>(accessorContents, typeCount, min, max));
+            break;
+        case COMPONENT_UNSIGNED_INT:
+            action(ConvertAccessorContents<T, uint32_t>(accessorContents, typeCount, min, max));
+            break;
+        case COMPONENT_FLOAT:
+            action(ConvertAccessorContents<T, float>(accessorContents, typeCount, min, max));
+            break;
+        default:
+            throw GLTFException("Unsupported accessor ComponentType");
+        }
+    }
+
+    template <typename Action>
+    void VisitAccessorContents(const Accessor& accessor, ComponentType outputComponentType, const GLTFDocument& doc, const IStreamReader& streamReader,
+        std::vector<float>& min, std::vector<float>& max, Action action)
     {
         switch (accessor.componentType)
         {
         case COMPONENT_BYTE:
-            SaveAccessor(accessor, vector_static_cast<T, int8_t>(accessorContents), builder);
+            VisitAccessorContents<int8_t>(accessor, outputComponentType, doc, streamReader, min, max, action);
             break;
         case COMPONENT_UNSIGNED_BYTE:
-            SaveAccessor(accessor, vector_static_cast<T, uint8_t>(accessorContents), builder);
+            VisitAccessorContents<uint8_t>(accessor, outputComponentType, doc, streamReader, min, max, action);
             break;
         case COMPONENT_SHORT:
-            SaveAccessor(accessor, vector_static_cast<T, int16_t>(accessorContents), builder);
+            VisitAccessorContents<int16_t>(accessor, outputComponentType, doc, streamReader, min, max, action);
             break;
         case COMPONENT_UNSIGNED_SHORT:
-            SaveAccessor(accessor, vector_static_cast<T, uint16_t>(accessorContents), builder);
+            VisitAccessorContents<uint16_t>(accessor, outputComponentType, doc, streamReader, min, max, action);
             break;
         case COMPONENT_UNSIGNED_INT:
-            SaveAccessor(accessor, vector_static_cast<T, uint32_t>(accessorContents), builder);
+            VisitAccessorContents<uint32_t>(accessor, outputComponentType, doc, streamReader, min, max, action);
             break;
         case COMPONENT_FLOAT:
-            SaveAccessor(accessor, vector_static_cast<T, float>(accessorContents), builder);
+            VisitAccessorContents<float>(accessor, outputComponentType, doc, streamReader, min, max, action);
             break;
         default:
             throw GLTFException("Unsupported accessor ComponentType");
         }
     }
 
-    template <typename T>
-    void SerializeAccessor(const Accessor& accessor, const GLTFDocument& doc, const GLTFResourceReader& reader, BufferBuilder& builder, const AccessorConversionStrategy& accessorConversion)
+    // The location of an accessor's elements in its source buffer, for accessors that are copied through unchanged
+    struct RawAccessorSource
     {
-        builder.AddBufferView(doc.bufferViews.Get(accessor.bufferViewId).target);
-        const std::vector<T>& accessorContents = reader.ReadBinaryData<T>(doc, accessor);
+        std::string uri;
+        size_t byteOffset;
+        size_t elementSize;
+        size_t byteStride;
+        size_t count;
+    };
 
-        if (accessorConversion != nullptr && accessorConversion(accessor) != accessor.componentType)
+    bool TryGetRawAccessorSource(const Accessor& accessor, const GLTFDocument& doc, RawAccessorSource& source)
+    {
+        if (accessor.bufferViewId.empty())
         {
-            Accessor updatedAccessor(accessor);
-            updatedAccessor.componentType = accessorConversion(accessor);
+            return false;
+        }
 
-            // Force recalculation of min and max
-            updatedAccessor.min.clear();
-            updatedAccessor.max.clear();
+        const auto& bufferView = doc.bufferViews.Get(accessor.bufferViewId);
+        const auto& buffer = doc.buffers.Get(bufferView.bufferId);
 
-            ConvertAndSaveAccessor(updatedAccessor, accessorContents, builder);
+        // Embedded buffers have to be decoded, so they go through the resource reader
+        if (IsDataUri(buffer.uri))
+        {
+            return false;
         }
-        else
+
+        source.uri = buffer.uri;
+        source.byteOffset = bufferView.byteOffset + accessor.byteOffset;
+        source.elementSize = Accessor::GetTypeCount(accessor.type) * Accessor::GetComponentTypeSize(accessor.componentType);
+        source.byteStride = bufferView.byteStride > 0 ? bufferView.byteStride : source.elementSize;
+        source.count = accessor.count;
+
+        return true;
+    }
+
+    // Reads the elements of an accessor from its source buffer in blocks, and hands each block to the action tightly packed
+    template <typename Action>
+    void VisitRawAccessorElements(const RawAccessorSource& source, const IStreamReader& streamReader, Action action)
+    {
+        if (source.count == 0)
         {
-            SaveAccessor(accessor, accessorContents, builder);
+            return;
+        }
+
+        auto input = streamReader.GetInputStream(source.uri);
+
+        const size_t blockElementCount = std::max<size_t>(1, COPY_BLOCK_SIZE / source.byteStride);
+        ScratchArray<uint8_t> block(blockElementCount * source.byteStride);
+
+        for (size_t first = 0; first < source.count; first += blockElementCount)
+        {
+            const size_t elementCount = std::min(blockElementCount, source.count - first);
+
+            // The padding after the last element isn't read, as it may be past the end of the buffer
+            const size_t blockLength = (elementCount - 1) * source.byteStride + source.elementSize;
+
+            input->seekg(source.byteOffset + first * source.byteStride, std::ios::beg);
+            input->read(reinterpret_cast<char*>(block.data()), blockLength);
+            if (static_cast<size_t>(input->gcount()) != blockLength)
+            {
+                throw GLTFException("Accessor data is out of the range of buffer " + source.uri);
+            }
+
+            if (source.byteStride != source.elementSize)
+            {
+                for (size_t i = 1; i < elementCount; i++)
+                {
+                    memmove(block.data() + i * source.elementSize, block.data() + i * source.byteStride, source.elementSize);
+                }
+            }
+
+            action(block.data(), elementCount);
         }
     }
 
-    void SerializeAccessor(const Accessor& accessor, const GLTFDocument& doc, const GLTFResourceReader& reader, BufferBuilder& builder, const AccessorConversionStrategy& accessorConversion)
+    void AccumulateMinMax(ComponentType componentType, const uint8_t* elements, size_t elementCount, size_t typeCount, std::vector<float>& min, std::vector<float>& max)
     {
-        switch (accessor.componentType)
+        switch (componentType)
         {
         case COMPONENT_BYTE:
-            SerializeAccessor<int8_t>(accessor, doc, reader, builder, accessorConversion);
+            AccessorUtils::AccumulateMinMax(reinterpret_cast<const int8_t*>(elements), elementCount, typeCount, min, max);
             break;
         case COMPONENT_UNSIGNED_BYTE:
-            SerializeAccessor<uint8_t>(accessor, doc, reader, builder, accessorConversion);
+            AccessorUtils::AccumulateMinMax(reinterpret_cast<const uint8_t*>(elements), elementCount, typeCount, min, max);
             break;
         case COMPONENT_SHORT:
-            SerializeAccessor<int16_t>(accessor, doc, reader, builder, accessorConversion);
+            AccessorUtils::AccumulateMinMax(reinterpret_cast<const int16_t*>(elements), elementCount, typeCount, min, max);
             break;
         case COMPONENT_UNSIGNED_SHORT:
-            SerializeAccessor<uint16_t>(accessor, doc, reader, builder, accessorConversion);
+            AccessorUtils::AccumulateMinMax(reinterpret_cast<const uint16_t*>(elements), elementCount, typeCount, min, max);
             break;
         case COMPONENT_UNSIGNED_INT:
-            SerializeAccessor<uint32_t>(accessor, doc, reader, builder, accessorConversion);
+            AccessorUtils::AccumulateMinMax(reinterpret_cast<const uint32_t*>(elements), elementCount, typeCount, min, max);
             break;
         case COMPONENT_FLOAT:
-            SerializeAccessor<float>(accessor, doc, reader, builder, accessorConversion);
+            AccessorUtils::AccumulateMinMax(reinterpret_cast<const float*>(elements), elementCount, typeCount, min, max);
             break;
         default:
             throw GLTFException("Unsupported accessor ComponentType");
         }
     }
+
+    // What has to be known about an accessor before it can be laid out
+    struct AccessorPlan
+    {
+        Accessor outputAccessor;
+        bool copyRaw;
+        RawAccessorSource rawSource;
+        std::string contentHash; // Only computed when deduplicating
+        std::optional<MeshoptMode> meshoptMode; // Only set when compressing
+        size_t compressedLength;
+    };
+
+    // Everything needed to read an accessor again when its bufferView is written
+    struct AccessorSource
+    {
+        Accessor accessor;
+        ComponentType outputComponentType;
+        bool copyRaw;
+        RawAccessorSource rawSource;
+        size_t elementSize;
+        size_t byteStride;
+    };
+
+    AccessorSource GetAccessorSource(const Accessor& accessor, const AccessorPlan& plan, size_t byteStride)
+    {
+        const size_t elementSize = Accessor::GetTypeCount(accessor.type) * Accessor::GetComponentTypeSize(plan.outputAccessor.componentType);
+        return { accessor, plan.outputAccessor.componentType, plan.copyRaw, plan.rawSource, elementSize, byteStride };
+    }
+
+    // Writes the elements of an accessor as they are laid out in its bufferView
+    void WriteAccessorElements(std::ostream& output, const AccessorSource& source, const GLTFDocument& doc, const IStreamReader& streamReader)
+    {
+        if (source.copyRaw)
+        {
+            VisitRawAccessorElements(source.rawSource, streamReader, [&output, &source](const uint8_t* elements, size_t elementCount)
+            {
+                WriteElements(output, elements, elementCount, source.rawSource.elementSize, source.byteStride);
+            });
+        }
+        else
+        {
+            std::vector<float> min, max;
+            VisitAccessorContents(source.accessor, source.outputComponentType, doc, streamReader, min, max, [&output, &source](const auto& accessorContents)
+            {
+                WriteElements(output, accessorContents.data(), accessorContents.size() * sizeof(accessorContents[0]) / source.elementSize, source.elementSize, source.byteStride);
+            });
+        }
+    }
+
+    std::vector<uint8_t> EncodeAccessorElements(const AccessorSource& source, MeshoptMode mode, const GLTFDocument& doc, const IStreamReader& streamReader)
+    {
+        std::ostringstream stream(std::ios_base::binary | std::ios_base::out);
+        WriteAccessorElements(stream, source, doc, streamReader);
+
+        const std::string elements = stream.str();
+        return GLTFMeshCompressionUtils::Encode(mode, elements.data(), source.accessor.count, source.byteStride);
+    }
+
+    size_t GetByteStride(const Accessor& accessor, ComponentType outputComponentType, BufferViewTarget target)
+    {
+        // Each element of a vertex attribute must start on a 4-byte boundary, which takes padding for narrow
+        // component types such as quantized normals
+        const size_t elementSize = Accessor::GetTypeCount(accessor.type) * Accessor::GetComponentTypeSize(outputComponentType);
+        return target == BufferViewTarget::ARRAY_BUFFER ? Align(elementSize, VERTEX_ATTRIBUTE_ALIGNMENT) : elementSize;
+    }
+
+    // The accessors used as the indices of triangle lists, which can be compressed as triangles, unless they are also
+    // used as the indices of other primitives
+    struct IndexUsage
+    {
+        std::unordered_set<std::string> triangles;
+        std::unordered_set<std::string> others;
+    };
+
+    IndexUsage GetIndexUsage(const GLTFDocument& doc)
+    {
+        IndexUsage usage;
+        for (const auto& mesh : doc.meshes.Elements())
+        {
+            for (const auto& primitive : mesh.primitives)
+            {
+                if (!primitive.indicesAccessorId.empty())
+                {
+                    (primitive.mode == MeshMode::MESH_TRIANGLES ? usage.triangles : usage.others).insert(primitive.indicesAccessorId);
+                }
+            }
+        }
+
+        return usage;
+    }
+
+    // Chooses how the bufferView of an accessor is compressed, and compresses it once to learn its size. The compressed
+    // data is produced again when the binary chunk is written, so that it is not all held in memory.
+    void MeasureCompression(const Accessor& accessor, AccessorPlan& plan, const GLTFDocument& doc, const IStreamReader& streamReader, const IndexUsage& indexUsage)
+    {
+        const auto target = doc.bufferViews.Get(accessor.bufferViewId).target;
+        const size_t byteStride = GetByteStride(accessor, plan.outputAccessor.componentType, target);
+
+        if (target == BufferViewTarget::ARRAY_BUFFER)
+        {
+            plan.meshoptMode = MeshoptMode::Attributes;
+        }
+        else if (target == BufferViewTarget::ELEMENT_ARRAY_BUFFER && (byteStride == 2 || byteStride == 4))
+        {
+            const bool triangles = indexUsage.triangles.count(accessor.id) > 0 && indexUsage.others.count(accessor.id) == 0 && accessor.count % 3 == 0;
+            plan.meshoptMode = triangles ? MeshoptMode::Triangles : MeshoptMode::Indices;
+        }
+        else
+        {
+            return;
+        }
+
+        plan.compressedLength = EncodeAccessorElements(GetAccessorSource(accessor, plan, byteStride), *plan.meshoptMode, doc, streamReader).size();
+
+        // Triangle indices may be rotated when decoded, so they can't share a bufferView with the same indices compressed otherwise
+        if (!plan.contentHash.empty())
+        {
+            plan.contentHash += GLTFMeshCompressionUtils::GetModeName(*plan.meshoptMode);
+        }
+    }
+
+    std::string SerializeMeshoptExtension(size_t bufferIndex, size_t byteOffset, size_t byteLength, size_t byteStride, size_t count, MeshoptMode mode)
+    {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+        writer.StartObject();
+        writer.Key("buffer");
+        writer.Uint64(bufferIndex);
+        writer.Key("byteOffset");
+        writer.Uint64(byteOffset);
+        writer.Key("byteLength");
+        writer.Uint64(byteLength);
+        writer.Key("byteStride");
+        writer.Uint64(byteStride);
+        writer.Key("count");
+        writer.Uint64(count);
+        writer.Key("mode");
+        writer.String(GLTFMeshCompressionUtils::GetModeName(mode));
+        writer.EndObject();
+
+        return buffer.GetString();
+    }
+
+    // Where the bufferViews compressed with EXT_meshopt_compression are laid out
+    struct CompressionLayout
+    {
+        MeshCompression compression;
+        size_t fallbackLength; // The length of the buffer without data that the compressed bufferViews decompress to
+        size_t compressedBufferViews;
+    };
+
+    // Maps the contents of a bufferView to the first bufferView written with them
+    typedef std::unordered_map<std::string, std::string> BufferViewsByContent;
+
+    static std::string GetBufferViewContentKey(const std::string& contentHash, const BufferView& bufferView)
+    {
+        return contentHash + "|" + std::to_string(bufferView.byteLength) + "|" + std::to_string(bufferView.byteStride) + "|" + std::to_string(static_cast<int>(bufferView.target));
+    }
+
+    // Chooses the output component type of an accessor and computes min and max if they are missing. The accessor
+    // data is only kept in memory while min and max are computed, and is read again when the binary chunk is
+    // written. Accessors that keep their component type are copied through as raw bytes, one block at a time.
+    // Accessors don't depend on each other here, so this can run on several threads.
+    AccessorPlan MeasureAccessor(const Accessor& accessor, const GLTFDocument& doc, const IStreamReader& streamReader, const AccessorConversionStrategy& accessorConversion, bool deduplicate)
+    {
+        AccessorPlan plan { accessor, false, {}, {}, {}, 0 };
+        Accessor& outputAccessor = plan.outputAccessor;
+
+        if (accessorConversion != nullptr && accessorConversion(accessor) != accessor.componentType)
+        {
+            outputAccessor.componentType = accessorConversion(accessor);
+
+            // Force recalculation of min and max
+            outputAccessor.min.clear();
+            outputAccessor.max.clear();
+        }
+
+        plan.copyRaw = outputAccessor.componentType == accessor.componentType && TryGetRawAccessorSource(accessor, doc, plan.rawSource);
+
+        const bool computeMinMax = outputAccessor.min.empty() || outputAccessor.max.empty();
+        if (!computeMinMax && !deduplicate)
+        {
+            return plan;
+        }
+
+        // The hash covers the bytes as they will be written, so it is taken in the same pass as min and max
+        std::optional<HashUtils::SHA256Hasher> hasher;
+        if (deduplicate)
+        {
+            hasher.emplace();
+        }
+
+        std::vector<float> min, max;
+
+        if (plan.copyRaw)
+        {
+            const size_t typeCount = Accessor::GetTypeCount(accessor.type);
+            VisitRawAccessorElements(plan.rawSource, streamReader, [&](const uint8_t* elements, size_t elementCount)
+            {
+                if (computeMinMax)
+                {
+                    AccumulateMinMax(outputAccessor.componentType, elements, elementCount, typeCount, min, max);
+                }
+
+                if (hasher)
+                {
+                    hasher->Update(elements, elementCount * plan.rawSource.elementSize);
+                }
+            });
+        }
+        else
+        {
+            VisitAccessorContents(accessor, outputAccessor.componentType, doc, streamReader, min, max, [&hasher](const auto& accessorContents)
+            {
+                if (hasher)
+                {
+                    hasher->Update(accessorContents.data(), accessorContents.size() * sizeof(accessorContents[0]));
+                }
+            });
+        }
+
+        if (computeMinMax)
+        {
+            outputAccessor.min = std::move(min);
+            outputAccessor.max = std::move(max);
+        }
+
+        if (hasher)
+        {
+            plan.contentHash = hasher->Finish();
+        }
+
+        return plan;
+    }
+
+    // The streaming level of each accessor and image: the order in which a loader needs them, from 0
+    struct StreamingLevels
+    {
+        std::vector<size_t> accessors;
+        std::vector<size_t> images;
+        size_t count;
+    };
+
+    void LowerLevel(std::unordered_map<std::string, size_t>& levels, const std::string& id, size_t level)
+    {
+        if (!id.empty())
+        {
+            auto inserted = levels.emplace(id, level);
+            if (!inserted.second)
+            {
+                inserted.first->second = std::min(inserted.first->second, level);
+            }
+        }
+    }
+
+    // The nodes of each MSFT_lod chain are numbered from its coarsest LOD, at level 0, to the node that has the
+    // extension, and the nodes below them inherit the level of the chain. Nodes outside of any chain are always
+    // drawn, so they are at level 0. An element used at several levels is at the lowest of them.
+    std::unordered_map<std::string, size_t> GetNodeLevels(const GLTFDocument& doc)
+    {
+        std::unordered_map<std::string, size_t> chainLevels;
+        const LODMap lods = GLTFLODUtils::ParseDocumentNodeLODs(doc);
+        for (const auto& node : doc.nodes.Elements())
+        {
+            const auto& nodeLods = *lods.at(node.id);
+            if (!nodeLods.empty())
+            {
+                LowerLevel(chainLevels, node.id, nodeLods.size());
+                for (size_t i = 0; i < nodeLods.size(); i++)
+                {
+                    LowerLevel(chainLevels, nodeLods[i], nodeLods.size() - 1 - i);
+                }
+            }
+        }
+
+        std::unordered_set<std::string> children;
+        for (const auto& node : doc.nodes.Elements())
+        {
+            children.insert(node.children.begin(), node.children.end());
+        }
+
+        std::unordered_map<std::string, size_t> nodeLevels;
+        std::function<void(const std::string&, size_t)> visit = [&](const std::string& nodeId, size_t level)
+        {
+            auto chainLevel = chainLevels.find(nodeId);
+            if (chainLevel != chainLevels.end())
+            {
+                level = chainLevel->second;
+            }
+
+            // Levels only decrease when a node is visited again, so this ends even if the hierarchy has cycles
+            auto inserted = nodeLevels.emplace(nodeId, level);
+            if (!inserted.second)
+            {
+                if (inserted.first->second <= level)
+                {
+                    return;
+                }
+
+                inserted.first->second = level;
+            }
+
+            for (const auto& child : doc.nodes.Get(nodeId).children)
+            {
+                visit(child, level);
+            }
+        };
+
+        for (const auto& node : doc.nodes.Elements())
+        {
+            if (children.count(node.id) == 0)
+            {
+                visit(node.id, 0);
+            }
+        }
+
+        return nodeLevels;
+    }
+
+    // Accessors and images that no LOD draws, such as animation data, are at level 0
+    StreamingLevels GetStreamingLevels(const GLTFDocument& doc)
+    {
+        std::unordered_map<std::string, size_t> meshLevels;
+        for (const auto& nodeLevel : GetNodeLevels(doc))
+        {
+            LowerLevel(meshLevels, doc.nodes.Get(nodeLevel.first).meshId, nodeLevel.second);
+        }
+
+        std::unordered_map<std::string, size_t> accessorLevels;
+        std::unordered_map<std::string, size_t> materialLevels;
+        for (const auto& meshLevel : meshLevels)
+        {
+            for (const auto& primitive : doc.meshes.Get(meshLevel.first).primitives)
+            {
+                for (const auto& accessorId : {
+                    primitive.positionsAccessorId, primitive.normalsAccessorId, primitive.tangentsAccessorId,
+                    primitive.uv0AccessorId, primitive.uv1AccessorId, primitive.color0AccessorId,
+                    primitive.joints0AccessorId, primitive.weights0AccessorId, primitive.indicesAccessorId })
+                {
+                    LowerLevel(accessorLevels, accessorId, meshLevel.second);
+                }
+
+                for (const auto& target : primitive.targets)
+                {
+                    LowerLevel(accessorLevels, target.positionsAccessorId, meshLevel.second);
+                    LowerLevel(accessorLevels, target.normalsAccessorId, meshLevel.second);
+                    LowerLevel(accessorLevels, target.tangentsAccessorId, meshLevel.second);
+                }
+
+                LowerLevel(materialLevels, primitive.materialId, meshLevel.second);
+            }
+        }
+
+        std::unordered_map<std::string, size_t> textureLevels;
+        for (const auto& materialLevel : materialLevels)
+        {
+            const auto& material = doc.materials.Get(materialLevel.first);
+            for (const auto& textureId : {
+                material.normalTexture.id, material.occlusionTexture.id, material.emissiveTextureId,
+                material.metallicRoughness.baseColorTextureId, material.metallicRoughness.metallicRoughnessTextureId,
+                material.specularGlossiness.diffuseTextureId, material.specularGlossiness.specularGlossinessTextureId })
+            {
+                LowerLevel(textureLevels, textureId, materialLevel.second);
+            }
+
+            auto ormExtensionIt = material.extensions.find(EXTENSION_MSFT_PACKING_ORM);
+            if (ormExtensionIt != material.extensions.end() && !ormExtensionIt->second.empty())
+            {
+                for (const auto& textureIndices : GLTFExtensionUtils::ReadIndices(ormExtensionIt->second, MSFT_PACKING_ORM_INDEX_PATHS))
+                {
+                    for (auto textureIndex : textureIndices)
+                    {
+                        LowerLevel(textureLevels, std::to_string(textureIndex), materialLevel.second);
+                    }
+                }
+            }
+        }
+
+        std::unordered_map<std::string, size_t> imageLevels;
+        for (const auto& textureLevel : textureLevels)
+        {
+            const auto& texture = doc.textures.Get(textureLevel.first);
+            LowerLevel(imageLevels, texture.imageId, textureLevel.second);
+
+            auto ddsExtensionIt = texture.extensions.find(EXTENSION_MSFT_TEXTURE_DDS);
+            if (ddsExtensionIt != texture.extensions.end() && !ddsExtensionIt->second.empty())
+            {
+                for (auto imageIndex : GLTFExtensionUtils::ReadIndices(ddsExtensionIt->second, MSFT_TEXTURE_DDS_INDEX_PATHS)[0])
+                {
+                    LowerLevel(imageLevels, std::to_string(imageIndex), textureLevel.second);
+                }
+            }
+        }
+
+        StreamingLevels levels { std::vector<size_t>(doc.accessors.Size()), std::vector<size_t>(doc.images.Size()), 1 };
+        auto assignLevels = [&levels](const auto& elements, const std::unordered_map<std::string, size_t>& elementLevels, std::vector<size_t>& output)
+        {
+            for (size_t i = 0; i < elements.size(); i++)
+            {
+                auto level = elementLevels.find(elements[i].id);
+                output[i] = level != elementLevels.end() ? level->second : 0;
+                levels.count = std::max(levels.count, output[i] + 1);
+            }
+        };
+
+        assignLevels(doc.accessors.Elements(), accessorLevels, levels.accessors);
+        assignLevels(doc.images.Elements(), imageLevels, levels.images);
+
+        return levels;
+    }
+
+    // Lays out a measured accessor in its own bufferView, after everything that was laid out before it. When
+    // deduplicating, an accessor whose contents were already laid out points to the existing bufferView instead.
+    // A compressed bufferView is decompressed from data laid out after it, or stands for data that is only stored compressed.
+    // Returns the output accessor, which is appended to the output document in the order of the input accessors.
+    Accessor LayoutAccessor(const Accessor& accessor, size_t accessorIndex, AccessorPlan plan, const GLTFDocument& doc, const IStreamReader& streamReader,
+        size_t& binaryLength, GLTFDocument& outputDoc, std::vector<BinaryPayload>& payloads, BufferViewsByContent* bufferViewsByContent, CompressionLayout& compressionLayout)
+    {
+        Accessor& outputAccessor = plan.outputAccessor;
+
+        BufferView bufferView;
+        bufferView.id = std::to_string(outputDoc.bufferViews.Size());
+        bufferView.bufferId = GLB_BUFFER_ID;
+        bufferView.target = doc.bufferViews.Get(accessor.bufferViewId).target;
+        bufferView.byteOffset = Align(binaryLength, GLB_BUFFER_OFFSET_ALIGNMENT);
+
+        const size_t elementSize = Accessor::GetTypeCount(accessor.type) * Accessor::GetComponentTypeSize(outputAccessor.componentType);
+        const size_t byteStride = GetByteStride(accessor, outputAccessor.componentType, bufferView.target);
+        if (byteStride != elementSize)
+        {
+            bufferView.byteStride = byteStride;
+        }
+
+        bufferView.byteLength = accessor.count * byteStride;
+
+        outputAccessor.id = std::to_string(accessorIndex);
+        outputAccessor.bufferViewId = bufferView.id;
+        outputAccessor.byteOffset = 0;
+
+        if (bufferViewsByContent != nullptr)
+        {
+            auto inserted = bufferViewsByContent->emplace(GetBufferViewContentKey(plan.contentHash, bufferView), bufferView.id);
+            if (!inserted.second)
+            {
+                outputAccessor.bufferViewId = inserted.first->second;
+                return std::move(outputAccessor);
+            }
+        }
+
+        const AccessorSource source = GetAccessorSource(accessor, plan, byteStride);
+        const bool compressed = plan.meshoptMode.has_value();
+
+        if (compressed && compressionLayout.compression == MeshCompression::Meshopt)
+        {
+            bufferView.bufferId = MESHOPT_FALLBACK_BUFFER_ID;
+            bufferView.byteOffset = Align(compressionLayout.fallbackLength, MESHOPT_ALIGNMENT);
+            compressionLayout.fallbackLength = bufferView.byteOffset + bufferView.byteLength;
+        }
+        else
+        {
+            payloads.push_back({ bufferView.byteOffset, bufferView.byteLength, true, [source, &doc, &streamReader](std::ostream& output)
+            {
+                WriteAccessorElements(output, source, doc, streamReader);
+            }});
+
+            binaryLength = bufferView.byteOffset + bufferView.byteLength;
+        }
+
+        if (compressed)
+        {
+            const MeshoptMode mode = *plan.meshoptMode;
+            const size_t compressedOffset = Align(binaryLength, MESHOPT_ALIGNMENT);
+            payloads.push_back({ compressedOffset, plan.compressedLength, true, [source, mode, &doc, &streamReader](std::ostream& output)
+            {
+                auto encoded = EncodeAccessorElements(source, mode, doc, streamReader);
+                output.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+            }});
+
+            // The GLB buffer is always the first one
+            bufferView.extensions.emplace(EXTENSION_EXT_MESHOPT_COMPRESSION, SerializeMeshoptExtension(0, compressedOffset, plan.compressedLength, byteStride, accessor.count, mode));
+
+            binaryLength = compressedOffset + plan.compressedLength;
+            compressionLayout.compressedBufferViews++;
+        }
+
+        outputDoc.bufferViews.Append(std::move(bufferView));
+        return std::move(outputAccessor);
+    }
+
+    // Lays out an image in its own bufferView. Images referenced by file are copied to the output in blocks when
+    // the binary chunk is written, rather than being loaded whole.
+    void PlanImage(const Image& image, const GLTFDocument& doc, const IStreamReader& streamReader, const GLTFResourceReader& reader,
+        size_t& binaryLength, GLTFDocument& outputDoc, std::vector<BinaryPayload>& payloads, BufferViewsByContent* bufferViewsByContent)
+    {
+        Image newImage(image);
+
+        BufferView bufferView;
+        bufferView.id = std::to_string(outputDoc.bufferViews.Size());
+        bufferView.bufferId = GLB_BUFFER_ID;
+        bufferView.byteOffset = Align(binaryLength, GLB_BUFFER_OFFSET_ALIGNMENT);
+
+        std::function<void(std::ostream&)> write;
+        std::string contentHash;
+
+        if (!image.uri.empty() && !IsDataUri(image.uri))
+        {
+            auto stream = streamReader.GetInputStream(image.uri);
+            stream->seekg(0, std::ios::end);
+            auto streamLength = stream->tellg();
+            if (streamLength < 0)
+            {
+                throw GLTFException("Could not determine the size of image " + image.uri);
+            }
+
+            bufferView.byteLength = static_cast<size_t>(streamLength);
+
+            if (bufferViewsByContent != nullptr)
+            {
+                HashUtils::SHA256Hasher hasher;
+                ScratchArray<char> block(COPY_BLOCK_SIZE);
+                stream->seekg(0, std::ios::beg);
+                while (*stream)
+                {
+                    stream->read(block.data(), block.size());
+                    hasher.Update(block.data(), static_cast<size_t>(stream->gcount()));
+                }
+
+                contentHash = hasher.Finish();
+            }
+
+            std::string uri = image.uri;
+            write = [uri, &streamReader](std::ostream& output)
+            {
+                auto input = streamReader.GetInputStream(uri);
+                ScratchArray<char> block(COPY_BLOCK_SIZE);
+                while (*input)
+                {
+                    input->read(block.data(), block.size());
+                    output.write(block.data(), input->gcount());
+                }
+            };
+        }
+        else
+        {
+            // Embedded images are small enough to be decoded once to learn their size, or to hash them
+            if (image.uri.empty() && bufferViewsByContent == nullptr)
+            {
+                bufferView.byteLength = doc.bufferViews.Get(image.bufferViewId).byteLength;
+            }
+            else
+            {
+                auto data = reader.ReadBinaryData(doc, image);
+                bufferView.byteLength = data.size();
+
+                if (bufferViewsByContent != nullptr)
+                {
+                    contentHash = HashUtils::ComputeSHA256(data.data(), data.size());
+                }
+            }
+
+            write = [image, &doc, &reader](std::ostream& output)
+            {
+                WriteContents(output, reader.ReadBinaryData(doc, image));
+            };
+        }
+
+        newImage.bufferViewId = bufferView.id;
+        if (image.mimeType.empty())
+        {
+            newImage.mimeType = MimeTypeFromUri(image.uri);
+        }
+
+        newImage.uri.clear();
+
+        if (bufferViewsByContent != nullptr)
+        {
+            auto inserted = bufferViewsByContent->emplace(GetBufferViewContentKey(contentHash, bufferView), bufferView.id);
+            if (!inserted.second)
+            {
+                newImage.bufferViewId = inserted.first->second;
+                outputDoc.images.Replace(newImage);
+                return;
+            }
+        }
+
+        payloads.push_back({ bufferView.byteOffset, bufferView.byteLength, false, std::move(write) });
+
+        binaryLength = bufferView.byteOffset + bufferView.byteLength;
+        outputDoc.bufferViews.Append(std::move(bufferView));
+        outputDoc.images.Replace(newImage);
+    }
+    // Writes the payloads in layout order. With more than one worker, runs of CPU-bound payloads are produced
+    // concurrently into memory, and then written in order, so the output doesn't depend on the parallelism.
+    void WritePayloads(std::ostream& output, const std::vector<BinaryPayload>& payloads, size_t maxParallelism)
+    {
+        if (maxParallelism == 0)
+        {
+            maxParallelism = ParallelUtils::GetDefaultParallelism();
+        }
+
+        size_t position = 0;
+        auto writePayload = [&output, &position](const BinaryPayload& payload, const std::string* contents)
+        {
+            WritePadding(output, payload.byteOffset - position, '\0');
+            if (contents != nullptr)
+            {
+                output.write(contents->data(), contents->size());
+            }
+            else
+            {
+                payload.write(output);
+            }
+
+            position = payload.byteOffset + payload.byteLength;
+        };
+
+        size_t next = 0;
+        while (next < payloads.size())
+        {
+            if (maxParallelism == 1 || !payloads[next].cpuBound)
+            {
+                writePayload(payloads[next++], nullptr);
+                continue;
+            }
+
+            // Bound the memory held by one batch
+            size_t batchEnd = next;
+            size_t batchLength = 0;
+            while (batchEnd < payloads.size() && payloads[batchEnd].cpuBound &&
+                batchEnd - next < maxParallelism * PAYLOAD_BATCH_PER_WORKER && (batchEnd == next || batchLength + payloads[batchEnd].byteLength <= PAYLOAD_BATCH_BYTE_SIZE))
+            {
+                batchLength += payloads[batchEnd++].byteLength;
+            }
+
+            std::vector<std::string> contents(batchEnd - next);
+            ParallelUtils::ParallelFor(contents.size(), maxParallelism, [&](size_t i)
+            {
+                std::ostringstream stream(std::ios_base::binary | std::ios_base::out);
+                payloads[next + i].write(stream);
+                contents[i] = stream.str();
+            });
+
+            for (size_t i = 0; i < contents.size(); i++)
+            {
+                writePayload(payloads[next + i], &contents[i]);
+            }
+
+            next = batchEnd;
+        }
+    }
 }
 
-void Microsoft::glTF::Toolkit::SerializeBinary(const GLTFDocument& gltfDocument, const IStreamReader& inputStreamReader, std::unique_ptr<const IStreamFactory>& outputStreamFactory, const AccessorConversionStrategy& accessorConversion)
+void Microsoft::glTF::Toolkit::SerializeBinary(const GLTFDocument& gltfDocument, const IStreamReader& inputStreamReader, std::unique_ptr<const IStreamFactory>& outputStreamFactory, const AccessorConversionStrategy& accessorConversion, size_t maxParallelism, bool deduplicate, MeshCompression compression, BinaryLayout layout)
 {
-    auto writer = std::make_unique<GLBResourceWriter2>(std::move(outputStreamFactory), std::string());
+    Instrumentation::Stage stage("SerializeBinary");
 
     GLTFDocument outputDoc(gltfDocument);
 
@@ -161,47 +1009,99 @@ void Microsoft::glTF::Toolkit::SerializeBinary(const GLTFDocument& gltfDocument,
 
     GLTFResourceReader gltfResourceReader(inputStreamReader);
 
-    std::unique_ptr<BufferBuilder> builder = std::make_unique<BufferBuilder>(std::move(writer));
+    // Lay out the binary chunk first, so the JSON chunk is complete before any payload is written
+    std::vector<BinaryPayload> payloads;
+    size_t binaryLength = 0;
+
+    const auto& accessors = gltfDocument.accessors.Elements();
+    const IndexUsage indexUsage = compression != MeshCompression::None ? GetIndexUsage(gltfDocument) : IndexUsage();
+    std::vector<AccessorPlan> accessorPlans(accessors.size());
+    ParallelUtils::ParallelFor(accessors.size(), maxParallelism, [&](size_t i)
+    {
+        accessorPlans[i] = MeasureAccessor(accessors[i], gltfDocument, inputStreamReader, accessorConversion, deduplicate);
+        if (compression != MeshCompression::None)
+        {
+            MeasureCompression(accessors[i], accessorPlans[i], gltfDocument, inputStreamReader, indexUsage);
+        }
+    });
 
-    // GLB buffer
-    builder->AddBuffer(GLB_BUFFER_ID);
+    BufferViewsByContent bufferViewsByContent;
+    BufferViewsByContent* dedupMap = deduplicate ? &bufferViewsByContent : nullptr;
+    CompressionLayout compressionLayout { compression, 0, 0 };
 
-    // Serialize accessors
-    for (auto accessor : gltfDocument.accessors.Elements())
+    const auto& images = gltfDocument.images.Elements();
+    StreamingLevels levels { std::vector<size_t>(accessors.size()), std::vector<size_t>(images.size()), 1 };
+    if (layout == BinaryLayout::CoarsestLODFirst)
     {
-        SerializeAccessor(accessor, gltfDocument, gltfResourceReader, *builder, accessorConversion);
+        levels = GetStreamingLevels(gltfDocument);
+        stage.SetProperty("streaming_levels", std::to_string(levels.count));
     }
 
-    // Serialize images
-    for (auto image : outputDoc.images.Elements())
+    // The accessors and then the images of each level are laid out before those of the next level
+    std::vector<Accessor> outputAccessors(accessors.size());
+    for (size_t level = 0; level < levels.count; level++)
     {
-        if (!image.uri.empty())
+        for (size_t i = 0; i < accessors.size(); i++)
         {
-            Image newImage(image);
-
-            auto data = gltfResourceReader.ReadBinaryData(gltfDocument, image);
-
-            auto imageBufferView = builder->AddBufferView(data);
+            if (levels.accessors[i] == level)
+            {
+                outputAccessors[i] = LayoutAccessor(accessors[i], i, std::move(accessorPlans[i]), gltfDocument, inputStreamReader, binaryLength, outputDoc, payloads, dedupMap, compressionLayout);
+            }
+        }
 
-            newImage.bufferViewId = imageBufferView.id;
-            if (image.mimeType.empty())
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            if (levels.images[i] == level && (!images[i].uri.empty() || !images[i].bufferViewId.empty()))
             {
-                newImage.mimeType = MimeTypeFromUri(image.uri);
+                PlanImage(images[i], gltfDocument, inputStreamReader, gltfResourceReader, binaryLength, outputDoc, payloads, dedupMap);
             }
+        }
+    }
 
-            newImage.uri.clear();
+    for (auto& outputAccessor : outputAccessors)
+    {
+        outputDoc.accessors.Append(std::move(outputAccessor));
+    }
 
-            outputDoc.images.Replace(newImage);
-        }
+    if (binaryLength > 0)
+    {
+        // GLB buffer
+        Buffer buffer;
+        buffer.id = GLB_BUFFER_ID;
+        buffer.byteLength = binaryLength;
+        outputDoc.buffers.Append(std::move(buffer));
     }
 
-    builder->Output(outputDoc);
+    if (compressionLayout.compressedBufferViews > 0)
+    {
+        stage.SetProperty("compressed_buffer_views", std::to_string(compressionLayout.compressedBufferViews));
+
+        outputDoc.extensionsUsed.insert(EXTENSION_EXT_MESHOPT_COMPRESSION);
+
+        if (compression == MeshCompression::Meshopt)
+        {
+            // The buffer without data that loaders decompress into
+            Buffer fallbackBuffer;
+            fallbackBuffer.id = MESHOPT_FALLBACK_BUFFER_ID;
+            fallbackBuffer.byteLength = compressionLayout.fallbackLength;
+            fallbackBuffer.extensions.emplace(EXTENSION_EXT_MESHOPT_COMPRESSION, "{\"fallback\":true}");
+            outputDoc.buffers.Append(std::move(fallbackBuffer));
+
+            outputDoc.extensionsRequired.insert(EXTENSION_EXT_MESHOPT_COMPRESSION);
+        }
+    }
 
     // Add extensions and extras to bufferViews, if any
     for (auto bufferView : gltfDocument.bufferViews.Elements())
     {
+        if (!outputDoc.bufferViews.Has(bufferView.id))
+        {
+            continue;
+        }
+
+        // The extensions written when laying out the bufferView take precedence
         auto fixedBufferView = outputDoc.bufferViews.Get(bufferView.id);
-        fixedBufferView.extensions = bufferView.extensions;
+        fixedBufferView.extensions.insert(bufferView.extensions.begin(), bufferView.extensions.end());
         fixedBufferView.extras = bufferView.extras;
 
         outputDoc.bufferViews.Replace(fixedBufferView);
@@ -209,9 +1109,42 @@ void Microsoft::glTF::Toolkit::SerializeBinary(const GLTFDocument& gltfDocument,
 
     auto manifest = Serialize(outputDoc);
 
-    auto outputWriter = dynamic_cast<GLBResourceWriter2 *>(&builder->GetResourceWriter());
-    if (outputWriter != nullptr)
+    const size_t chunkHeaderSize = GLB_CHUNK_TYPE_SIZE * 2;
+    const size_t jsonChunkLength = Align(manifest.length(), GLB_BUFFER_OFFSET_ALIGNMENT);
+    const size_t binaryChunkLength = Align(binaryLength, GLB_BUFFER_OFFSET_ALIGNMENT);
+    const size_t totalLength = GLB2_HEADER_BYTE_SIZE + chunkHeaderSize + jsonChunkLength + (binaryLength > 0 ? chunkHeaderSize + binaryChunkLength : 0);
+
+    if (totalLength > std::numeric_limits<uint32_t>::max())
     {
-        outputWriter->Flush(manifest, std::string());
+        throw GLTFException("The asset is too large to be saved as a GLB file");
     }
-}
\ No newline at end of file
+
+    auto output = outputStreamFactory->GetOutputStream(std::string());
+
+    WriteUInt32(*output, GLB_MAGIC);
+    WriteUInt32(*output, GLB_VERSION);
+    WriteUInt32(*output, static_cast<uint32_t>(totalLength));
+
+    WriteUInt32(*output, static_cast<uint32_t>(jsonChunkLength));
+    WriteUInt32(*output, GLB_CHUNK_JSON);
+    output->write(manifest.data(), manifest.length());
+    WritePadding(*output, jsonChunkLength - manifest.length(), ' ');
+
+    if (binaryLength > 0)
+    {
+        WriteUInt32(*output, static_cast<uint32_t>(binaryChunkLength));
+        WriteUInt32(*output, GLB_CHUNK_BIN);
+
+        WritePayloads(*output, payloads, maxParallelism);
+        WritePadding(*output, binaryChunkLength - binaryLength, '\0');
+    }
+
+    output->flush();
+
+    if (!*output)
+    {
+        throw GLTFException("Failed to write the GLB file");
+    }
+
+    stage.AddBytesWritten(totalLength);
+}